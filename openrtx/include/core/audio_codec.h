@@ -24,11 +24,39 @@
 #include <audio_path.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * CODEC2 operating modes supported by the codec manager.
+ */
+enum CodecMode
+{
+    CODEC_MODE_3200 = 0,    ///< 3200 bit/s, 8 byte frames of 20ms of speech.
+    CODEC_MODE_1600 = 1,    ///< 1600 bit/s, 8 byte frames of 40ms of speech.
+    CODEC_MODE_700C = 2     ///< 700 bit/s, 4 byte frames of 40ms of speech.
+};
+
+/**
+ * Maximum number of frames encoded or decoded by the codec thread on each
+ * wakeup.
+ */
+#define CODEC_MAX_BATCH 4
+
+/**
+ * Function providing encoded frames to the decoder, called by the codec thread
+ * each time a new frame has to be decoded.
+ *
+ * @param frame: destination buffer, large as a frame of the current mode.
+ * @param arg: argument given when the decoding was started.
+ * @return 1 if a frame has been written, 0 if no frame is available in time
+ * and -1 if the data stream ended.
+ */
+typedef int (*codecSource_t)(uint8_t *frame, void *arg);
+
 /**
  * Initialise audio codec manager, allocating data buffers.
  *
@@ -48,10 +76,17 @@ void codec_terminate();
  * Only an encoding or decoding operation at a time is possible: in case there
  * is already an operation in progress, this function returns false.
  *
+ * The codec thread wakes up once every batch of frames: larger batches reduce
+ * the scheduling overhead at the cost of an increased latency.
+ *
  * @param path: audio path for encoding source.
+ * @param mode: CODEC2 operating mode, one of the CodecMode values.
+ * @param batch: number of frames encoded on each wakeup of the codec thread,
+ * from 1 to CODEC_MAX_BATCH.
  * @return true on success, false on failure.
  */
-bool codec_startEncode(const pathId path);
+bool codec_startEncode(const pathId path, const uint8_t mode,
+                       const uint8_t batch);
 
 /**
  * Start dencoding of audio data sending the uncompressed samples to a given
@@ -59,13 +94,46 @@ bool codec_startEncode(const pathId path);
  * Only an encoding or decoding operation at a time is possible: in case there
  * is already an operation in progress, this function returns false.
  *
+ * The codec thread wakes up once every batch of frames: larger batches reduce
+ * the scheduling overhead at the cost of an increased latency.
+ *
  * @param path: audio path for decoded audio.
+ * @param mode: CODEC2 operating mode, one of the CodecMode values.
+ * @param batch: number of frames decoded on each wakeup of the codec thread,
+ * from 1 to CODEC_MAX_BATCH.
  * @return true on success, false on failure.
  */
-bool codec_startDecode(const pathId path);
+bool codec_startDecode(const pathId path, const uint8_t mode,
+                       const uint8_t batch);
 
 /**
- * Stop an ongoing encoding or decoding operation.
+ * Start decoding of audio data, sending the uncompressed samples to a given
+ * audio destination and getting the encoded frames directly from a source
+ * function instead of the internal queue. The source function is called from
+ * the codec thread, thus the data flow does not depend on the scheduling of the
+ * thread producing the frames.
+ *
+ * If the codec is already decoding from the internal queue on a path which can
+ * be mixed with the given one (see audioPath_mixable()), the frames from the
+ * source function are decoded as well and mixed over the other ones, each with
+ * the gain of its own path. The same happens, with the roles swapped, when
+ * codec_startDecode() is called while decoding from a source function.
+ *
+ * @param path: audio path for decoded audio.
+ * @param mode: CODEC2 operating mode, one of the CodecMode values.
+ * @param batch: number of frames decoded on each wakeup of the codec thread,
+ * from 1 to CODEC_MAX_BATCH.
+ * @param source: function providing the encoded frames.
+ * @param arg: argument passed to the source function.
+ * @return true on success, false on failure.
+ */
+bool codec_startDecodeFrom(const pathId path, const uint8_t mode,
+                           const uint8_t batch, codecSource_t source,
+                           void *arg);
+
+/**
+ * Stop an ongoing encoding or decoding operation. When two mixed streams are
+ * being decoded, only the one on the given path is stopped.
  *
  * @param path: audio path on which the encoding or decoding operation was
  * started.
@@ -80,29 +148,63 @@ void codec_stop(const pathId path);
 bool codec_running();
 
 /**
- * Get a compressed audio frame from the internal queue. Each frame is composed
- * of 8 bytes.
+ * Get the number of frames replaced by silence during the current or last
+ * decoding operation, because no encoded data was available in time.
+ *
+ * @return number of decoder underruns.
+ */
+uint32_t codec_getUnderruns();
+
+/**
+ * Get the size of an encoded frame for a given CODEC2 mode.
+ *
+ * @param mode: CODEC2 operating mode, one of the CodecMode values.
+ * @return size of an encoded frame in bytes, zero if the mode is not valid.
+ */
+size_t codec_frameSize(const uint8_t mode);
+
+/**
+ * Get the number of audio samples, at 8kHz, contained in a frame for a given
+ * CODEC2 mode.
+ *
+ * @param mode: CODEC2 operating mode, one of the CodecMode values.
+ * @return number of samples in a frame, zero if the mode is not valid.
+ */
+size_t codec_frameSamples(const uint8_t mode);
+
+/**
+ * Get one or more compressed audio frames from the internal queue. The number
+ * of frames retrieved is given by the size of the destination buffer divided
+ * by the frame size of the current CODEC2 mode.
  *
- * @param frame: pointer to a destination buffer where to put the encoded frame.
+ * @param frame: pointer to a destination buffer where to put the encoded frames.
+ * @param size: size of the destination buffer, in bytes.
  * @param blocking: if true the execution flow will be blocked whenever the
  * internal buffer is empty and resumed as soon as an encoded frame is available.
- * @return zero on success, -EAGAIN if the queue is empty and the function is
- * nonblocking or -EPERM if there is no encoding operation ongoing.
+ * @return number of bytes written on success, -EAGAIN if the queue does not
+ * contain enough frames and the function is nonblocking, -EINVAL if the buffer
+ * size is not a multiple of the frame size or -EPERM if there is no encoding
+ * operation ongoing. If a blocking call stops waiting before all the frames
+ * are available, the frames already retrieved are kept and the number of bytes
+ * written is less than the buffer size.
  */
-int codec_popFrame(uint8_t *frame, const bool blocking);
+int codec_popFrame(uint8_t *frame, const size_t size, const bool blocking);
 
 /**
- * Push a a compressed audio frame to the internal queue for decoding.
- * Each frame is composed of 8 bytes.
+ * Push one or more compressed audio frames to the internal queue for decoding.
+ * The data size must be a multiple of the frame size of the current CODEC2
+ * mode.
  *
- * @param frame: frame to be pushed to the queue.
+ * @param frame: frames to be pushed to the queue.
+ * @param size: size of the data to be pushed, in bytes.
  * @param blocking: if true the execution flow will be blocked whenever the
  * internal buffer is full and resumed as soon as space for an encoded frame is
  * available.
- * @return zero on success, -EAGAIN if the queue is full and the function is
- * nonblocking or -EPERM if there is no decoding operation ongoing.
+ * @return zero on success, -EAGAIN if the queue has not enough free space and
+ * the function is nonblocking, -EINVAL if the data size is not valid or -EPERM
+ * if there is no decoding operation ongoing.
  */
-int codec_pushFrame(const uint8_t *frame, const bool blocking);
+int codec_pushFrame(const uint8_t *frame, const size_t size, const bool blocking);
 
 #ifdef __cplusplus
 }
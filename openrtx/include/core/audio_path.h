@@ -22,6 +22,8 @@
 
 #include <interfaces/audio.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +47,9 @@ pathInfo_t;
 
 typedef int32_t pathId;
 
+#define AUDIO_GAIN_UNITY 256    ///< Unity gain of a path, Q8 format.
+#define AUDIO_GAIN_DUCK  64     ///< Gain applied to ducked paths, -12dB.
+
 
 /**
  * Request to set up an audio path, returns an error if the path is already used
@@ -58,6 +63,23 @@ typedef int32_t pathId;
 pathId audioPath_request(enum AudioSource source, enum AudioSink sink,
                          enum AudioPriority prio);
 
+/**
+ * Request to set up an audio path which can be mixed with other mixed paths
+ * having the same sink. Only paths sourcing audio from the MCU can be mixed:
+ * when the source is not the MCU the function behaves as audioPath_request().
+ * Instead of being suspended, mixed paths with lower priority get ducked.
+ * Mixing is done in software by the producer of the audio samples, see
+ * audioPath_mix().
+ *
+ * @param source: identifier of the input audio peripheral.
+ * @param sink: identifier of the output audio peripheral.
+ * @param prio: priority of the requester.
+ * @param gain: gain of the path, in Q8 format.
+ * @return a unique identifier of the opened path or -1 if path is already in use.
+ */
+pathId audioPath_requestMixed(enum AudioSource source, enum AudioSink sink,
+                              enum AudioPriority prio, const uint16_t gain);
+
 /**
  * Get all the informations of an audio path.
  *
@@ -74,6 +96,43 @@ pathInfo_t audioPath_getInfo(const pathId id);
  */
 enum PathStatus audioPath_getStatus(const pathId id);
 
+/**
+ * Check if two audio paths are open and mixed together on the same sink.
+ *
+ * @param id1: ID of the first audio path.
+ * @param id2: ID of the second audio path.
+ * @return true if the audio of the two paths can be mixed.
+ */
+bool audioPath_mixable(const pathId id1, const pathId id2);
+
+/**
+ * Get the effective gain of an audio path, ducking included.
+ *
+ * @param id: ID of the audio path.
+ * @return gain of the path in Q8 format, zero if the path is not open.
+ */
+uint16_t audioPath_getGain(const pathId id);
+
+/**
+ * Set the gain of an audio path.
+ *
+ * @param id: ID of the audio path.
+ * @param gain: new gain of the path, in Q8 format.
+ */
+void audioPath_setGain(const pathId id, const uint16_t gain);
+
+/**
+ * Accumulate a block of samples into a mix buffer, applying the effective gain
+ * of the path and saturating the result.
+ *
+ * @param id: ID of the audio path.
+ * @param dst: mix buffer.
+ * @param src: samples to be mixed.
+ * @param length: number of samples.
+ */
+void audioPath_mix(const pathId id, stream_sample_t *dst,
+                   const stream_sample_t *src, const size_t length);
+
 /**
  * Release an audio path.
  *
@@ -39,6 +39,11 @@ enum StreamMode
 
 typedef int8_t streamId;
 
+/**
+ * Maximum number of readers of a shared input stream.
+ */
+#define MAX_STREAM_READERS 2
+
 
 typedef struct
 {
@@ -47,6 +52,29 @@ typedef struct
 }
 dataBlock_t;
 
+/**
+ * Lease of a block of samples from a shared input stream. The samples are
+ * accessed directly in the stream buffer and remain valid until the lease is
+ * released or the driver starts overwriting them, that is when the next block
+ * is ready. The history samples preceding the block can be accessed using
+ * negative indices, down to data[-history]: for blocks in the second half of
+ * the buffer they are the tail of the first half, which the driver overwrites
+ * at the end of the block period. For blocks in the first half they are the
+ * tail of the previous block, copied when the primary reader releases it: if
+ * that lease was stale, because the block was overwritten before its release
+ * or the reader missed the blocks before it, the history is zeroed instead.
+ */
+typedef struct
+{
+    stream_sample_t *data;       ///< Pointer to the first sample of the block.
+    size_t           len;        ///< Number of samples in the block.
+    size_t           history;    ///< Number of valid samples before data[0].
+    uint32_t         seq;        ///< Sequence number of the block.
+    uint32_t         lost;       ///< Blocks missed by the reader since its last lease.
+    uint8_t          reader;     ///< Reader holding the lease.
+}
+streamLease_t;
+
 /**
  * Start an audio stream, either in input or output mode as specified by the
  * corresponding parameter.
@@ -93,6 +121,54 @@ void audioStream_terminate(const streamId id);
  */
 dataBlock_t inputStream_getData(streamId id);
 
+/**
+ * Start a shared input stream, running in circular double buffered mode, whose
+ * data is accessed by one or more readers through buffer leases. The first
+ * part of the buffer is reserved for the history samples, made available
+ * before the first sample of each block; the remaining part is split in two
+ * halves for double buffering.
+ *
+ * Reader zero is the primary reader: when the stream has a single reader it
+ * can process the leased samples in place and the processed samples become the
+ * history of the following block. Secondary readers, if any, must treat the
+ * leased samples as read-only.
+ *
+ * @param path: audio path for the stream.
+ * @param buf: buffer for the history and audio samples.
+ * @param length: length of the buffer, history included, in elements.
+ * @param history: number of history samples, at most half of the remaining
+ * buffer length.
+ * @param sampleRate: sample rate in Hz.
+ * @param readers: number of readers, up to MAX_STREAM_READERS.
+ * @return a unique identifier for the stream or a negative error code.
+ */
+streamId inputStream_startShared(const pathId path, stream_sample_t * const buf,
+                                 const size_t length, const size_t history,
+                                 const uint32_t sampleRate, const uint8_t readers);
+
+/**
+ * Acquire the lease of the next block of samples from a shared input stream,
+ * blocking function. If the reader already leased the most recent block, the
+ * execution is blocked until a new one is available. Readers lagging behind
+ * get the most recent block and the number of blocks they missed.
+ *
+ * @param id: identifier of the shared input stream.
+ * @param reader: reader index.
+ * @return the lease of the block, with a NULL data pointer in case of error.
+ */
+streamLease_t inputStream_acquire(const streamId id, const uint8_t reader);
+
+/**
+ * Release a lease acquired with inputStream_acquire().
+ *
+ * @param id: identifier of the shared input stream.
+ * @param lease: lease to be released.
+ * @return true if the leased block was still valid at release time, false if
+ * a newer block has been published in the meantime, meaning that the leased
+ * samples may have been overwritten.
+ */
+bool inputStream_release(const streamId id, const streamLease_t *lease);
+
 /**
  * Get a pointer to the section of the sample buffer not currently being read
  * by the DMA peripheral. The function is to be used primarily when the output
@@ -28,6 +28,58 @@
 extern "C" {
 #endif
 
+/**
+ * Table-driven computation of 16-bit CRCs, processing multiple bytes per
+ * iteration through slice-by-N lookup tables generated at compile time.
+ * The number of tables, and thus of bytes processed for each iteration, is
+ * set by the CRC_SLICES macro: it defaults to 8 on Linux and to 4 on the
+ * embedded platforms, to limit the flash occupation.
+ */
+
+/**
+ * Supported CRC algorithms.
+ */
+enum crcType
+{
+    CRC_CCITT = 0,    ///< CCITT/XMODEM: polynomial 0x1021, initial value 0x0000
+    CRC_M17   = 1     ///< M17: polynomial 0x5935, initial value 0xFFFF
+};
+
+/**
+ * Running CRC computation.
+ */
+typedef struct
+{
+    uint16_t value;    ///< Current CRC value
+    uint8_t  type;     ///< CRC algorithm
+}
+crc16_t;
+
+/**
+ * Start a new CRC computation.
+ *
+ * @param crc: pointer to the CRC data structure.
+ * @param type: CRC algorithm.
+ */
+void crc_init(crc16_t *crc, const enum crcType type);
+
+/**
+ * Update a running CRC computation with a new block of data.
+ *
+ * @param crc: pointer to the CRC data structure.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ */
+void crc_update(crc16_t *crc, const void *data, const size_t len);
+
+/**
+ * Terminate a CRC computation.
+ *
+ * @param crc: pointer to the CRC data structure.
+ * @return CRC of all the data blocks processed.
+ */
+uint16_t crc_final(const crc16_t *crc);
+
 /**
  * Compute the CCITT 16-bit CRC over a given block of data.
  *
@@ -37,6 +89,15 @@ extern "C" {
  */
 uint16_t crc_ccitt(const void *data, const size_t len);
 
+/**
+ * Compute the M17 16-bit CRC over a given block of data.
+ *
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return M17 CRC.
+ */
+uint16_t crc_m17(const void *data, const size_t len);
+
 #ifdef __cplusplus
 }
 #endif
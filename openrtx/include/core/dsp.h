@@ -65,6 +65,43 @@ void dsp_resetFilterState(filter_state_t *state);
  */
 void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length);
 
+/**
+ * Remove the DC offset from a collection of audio samples, applying a gain
+ * stage before and after the DC removal filter and saturating the result to
+ * the range of the audio samples. Data is processed in-place.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ * @param buffer: buffer containing the audio samples.
+ * @param length: number of samples contained in the buffer.
+ * @param preGain: gain applied before the DC removal filter.
+ * @param postGain: gain applied after the DC removal filter.
+ */
+void dsp_dcRemovalGain(filter_state_t *state, audio_sample_t *buffer,
+                       size_t length, int16_t preGain, int16_t postGain);
+
+/**
+ * Multiply a collection of audio samples by an integer gain, saturating the
+ * result to the range of the audio samples. Data is processed in-place.
+ *
+ * @param buffer: buffer containing the audio samples.
+ * @param length: number of samples contained in the buffer.
+ * @param gain: gain to be applied.
+ */
+void dsp_applyGain(audio_sample_t *buffer, size_t length, int16_t gain);
+
+/**
+ * Convert a collection of floating point values to audio samples, multiplying
+ * them by a scale factor. Values are rounded to the nearest integer and
+ * saturated to the range of the audio samples.
+ *
+ * @param in: buffer containing the floating point values.
+ * @param out: buffer for the audio samples.
+ * @param length: number of values to be converted.
+ * @param scale: scale factor.
+ */
+void dsp_fromFloat(const float *in, audio_sample_t *out, size_t length,
+                   float scale);
+
 /*
  * Inverts the phase of the audio buffer passed as paramenter.
  * The buffer will be processed in place to save memory.
@@ -26,12 +26,165 @@
 #endif
 
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Compute the dot product between two vectors of Q15 values, accumulating the
+ * result on 32 bits. The kernel used is selected at compile time according to
+ * the SIMD extensions available on the target: SMLAD on Cortex-M4/M7 cores
+ * with DSP extension, NEON on ARM application processors, SSE2 on x86 and a
+ * plain scalar loop otherwise.
+ *
+ * Calling code must ensure that the result fits in 32 bits, that is the sum
+ * of the absolute values of the coefficients must be less than two for full
+ * scale input signals.
+ *
+ * @param x: pointer to the first vector.
+ * @param h: pointer to the second vector.
+ * @param n: number of elements of the two vectors.
+ * @return the dot product between the two vectors.
+ */
+static inline int32_t fir_dotProductQ15(const int16_t *x, const int16_t *h,
+                                        const size_t n)
+{
+    int32_t acc = 0;
+    size_t  i   = 0;
+
+    #if defined(__ARM_FEATURE_DSP)
+    for(; (i + 2) <= n; i += 2)
+    {
+        uint32_t a, b;
+        memcpy(&a, x + i, sizeof(a));
+        memcpy(&b, h + i, sizeof(b));
+        asm("smlad %0, %1, %2, %0" : "+r"(acc) : "r"(a), "r"(b));
+    }
+    #elif defined(__ARM_NEON)
+    int32x4_t vacc = vdupq_n_s32(0);
+    for(; (i + 4) <= n; i += 4)
+    {
+        vacc = vmlal_s16(vacc, vld1_s16(x + i), vld1_s16(h + i));
+    }
+
+    acc = vgetq_lane_s32(vacc, 0) + vgetq_lane_s32(vacc, 1)
+        + vgetq_lane_s32(vacc, 2) + vgetq_lane_s32(vacc, 3);
+    #elif defined(__SSE2__)
+    __m128i vacc = _mm_setzero_si128();
+    for(; (i + 8) <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast< const __m128i * >(x + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast< const __m128i * >(h + i));
+        vacc      = _mm_add_epi32(vacc, _mm_madd_epi16(a, b));
+    }
+
+    vacc = _mm_add_epi32(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(1, 0, 3, 2)));
+    vacc = _mm_add_epi32(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(2, 3, 0, 1)));
+    acc  = _mm_cvtsi128_si32(vacc);
+    #endif
+
+    for(; i < n; i++)
+    {
+        acc += static_cast< int32_t >(x[i]) * static_cast< int32_t >(h[i]);
+    }
+
+    return acc;
+}
+
+/**
+ * Filter a block of floating point values, computing y[k] as the sum of
+ * h[i] * x[k - i] for i from 0 to taps - 1. The input pointer refers to the
+ * first value of the block and the taps - 1 values preceding it must hold the
+ * history of past inputs.
+ *
+ * Four outputs are computed at once, each tap is loaded a single time for
+ * the four of them and the accumulations are independent: the kernel uses
+ * NEON on ARM application processors, SSE on x86 and four scalar
+ * accumulators otherwise. Each output is summed in the order of the taps, the
+ * results are the same of a plain scalar loop.
+ *
+ * @param x: pointer to the first input value of the block.
+ * @param h: pointer to the filter coefficients.
+ * @param taps: number of filter coefficients.
+ * @param y: pointer to the output buffer, must not overlap with the input.
+ * @param n: number of values to be processed.
+ */
+static inline void fir_blockF32(const float *x, const float *h,
+                                const size_t taps, float *y, const size_t n)
+{
+    size_t k = 0;
+
+    for(; (k + 4) <= n; k += 4)
+    {
+        const float *xk = x + k;
+
+        #if defined(__ARM_NEON)
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for(size_t i = 0; i < taps; i++)
+        {
+            acc = vmlaq_n_f32(acc, vld1q_f32(xk - i), h[i]);
+        }
+
+        vst1q_f32(y + k, acc);
+        #elif defined(__SSE2__)
+        __m128 acc = _mm_setzero_ps();
+        for(size_t i = 0; i < taps; i++)
+        {
+            __m128 prod = _mm_mul_ps(_mm_loadu_ps(xk - i), _mm_set1_ps(h[i]));
+            acc         = _mm_add_ps(acc, prod);
+        }
+
+        _mm_storeu_ps(y + k, acc);
+        #else
+        float acc0 = 0.0f;
+        float acc1 = 0.0f;
+        float acc2 = 0.0f;
+        float acc3 = 0.0f;
+        for(size_t i = 0; i < taps; i++)
+        {
+            const float  tap = h[i];
+            const float *xi  = xk - i;
+            acc0 += xi[0] * tap;
+            acc1 += xi[1] * tap;
+            acc2 += xi[2] * tap;
+            acc3 += xi[3] * tap;
+        }
+
+        y[k]     = acc0;
+        y[k + 1] = acc1;
+        y[k + 2] = acc2;
+        y[k + 3] = acc3;
+        #endif
+    }
+
+    for(; k < n; k++)
+    {
+        float acc = 0.0f;
+        for(size_t i = 0; i < taps; i++)
+        {
+            acc += x[k - i] * h[i];
+        }
+
+        y[k] = acc;
+    }
+}
 
 /**
  * Class for FIR filter with configurable coefficients.
  * Adapted from the original implementation by Rob Riggs, Mobilinkd LLC.
+ *
+ * Input values are stored in a linear buffer of 2N elements, in arrival
+ * order: the last N - 1 inputs are followed by the space for the new ones.
+ * When the buffer is full, the history is moved back to its beginning. In
+ * this way the filter runs without any modulo indexing and a whole block of
+ * inputs is filtered by a single pass of the fir_blockF32() kernel.
  */
 template < size_t N >
 class Fir
@@ -44,7 +197,7 @@ public:
      * @param taps: reference to a std::array of floating poing values representing
      * the FIR filter coefficients.
      */
-    Fir(const std::array< float, N >& taps) : taps(taps), pos(0)
+    Fir(const std::array< float, N >& taps) : taps(taps), pos(N - 1)
     {
         reset();
     }
@@ -63,35 +216,321 @@ public:
      */
     float operator()(const float& input)
     {
+        if(pos == hist.size()) slide();
+
         hist[pos] = input;
-        pos = (pos + 1) % N;
 
-        float  result = 0.0;
-        size_t index  = pos;
+        // Newest input value is at hist[pos], oldest at hist[pos - N + 1]
+        const float *h = &hist[pos];
+        float result   = 0.0;
 
         for(size_t i = 0; i < N; i++)
         {
-            index   = (index != 0 ? index - 1 : N - 1);
-            result += hist[index] * taps[i];
+            result += h[-static_cast< ptrdiff_t >(i)] * taps[i];
         }
 
+        pos++;
         return result;
     }
 
+    /**
+     * Filter a block of floating point values. Input and output buffers can
+     * be the same, allowing for in-place processing. The inputs are copied
+     * in the history buffer and filtered in chunks of up to N + 1 values.
+     *
+     * @param in: pointer to the input values.
+     * @param out: pointer to the output buffer.
+     * @param n: number of values to be processed.
+     */
+    void process(const float *in, float *out, const size_t n)
+    {
+        size_t done = 0;
+
+        while(done < n)
+        {
+            if(pos == hist.size()) slide();
+
+            size_t len = hist.size() - pos;
+            if(len > (n - done)) len = n - done;
+
+            // Copying the inputs before writing the outputs allows in-place
+            // processing.
+            memcpy(&hist[pos], in + done, len * sizeof(float));
+            fir_blockF32(&hist[pos], taps.data(), N, out + done, len);
+
+            pos  += len;
+            done += len;
+        }
+    }
+
     /**
      * Reset FIR history, clearing the memory of past values.
      */
     void reset()
     {
         hist.fill(0);
-        pos = 0;
+        pos = N - 1;
     }
 
 private:
 
+    /**
+     * Move the last N - 1 inputs at the beginning of the history buffer.
+     */
+    void slide()
+    {
+        memmove(hist.data(), &hist[pos - (N - 1)], (N - 1) * sizeof(float));
+        pos = N - 1;
+    }
+
     const std::array< float, N >& taps;    ///< FIR filter coefficients.
-    std::array< float, N >        hist;    ///< History of past inputs.
-    size_t                        pos;     ///< Current position in history.
+    std::array< float, 2 * N >    hist;    ///< Past inputs followed by the new ones.
+    size_t                        pos;     ///< Position of the next input in history.
+};
+
+/**
+ * Class for FIR filter operating on 16-bit samples with Q15 fixed point
+ * coefficients. Coefficients are converted from their floating point form
+ * when the filter is constructed.
+ *
+ * The history of past input values is kept in a doubled buffer, each value is
+ * written twice at a distance of N elements, so that the last N inputs are
+ * always contiguous. The filter output is rounded and saturated to 16 bits.
+ */
+template < size_t N >
+class FirQ15
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param taps: reference to a std::array of floating poing values representing
+     * the FIR filter coefficients, in the range [-1, 1).
+     */
+    FirQ15(const std::array< float, N >& taps) : pos(0)
+    {
+        for(size_t i = 0; i < N; i++)
+        {
+            long tap = std::lround(taps[i] * 32768.0f);
+            if(tap > INT16_MAX) tap = INT16_MAX;
+            if(tap < INT16_MIN) tap = INT16_MIN;
+            this->taps[i] = static_cast< int16_t >(tap);
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~FirQ15() { }
+
+    /**
+     * Perform one step of the FIR filter, computing a new output value given
+     * the input value and the history of previous input values.
+     *
+     * @param input: FIR input value for the current time step.
+     * @return FIR output as a function of the current and past input values.
+     */
+    int16_t operator()(const int16_t input)
+    {
+        return output(accumulate(input));
+    }
+
+    /**
+     * Filter a block of 16-bit samples. Input and output buffers can be the
+     * same, allowing for in-place processing.
+     *
+     * @param in: pointer to the input samples.
+     * @param out: pointer to the output buffer.
+     * @param n: number of samples to be processed.
+     */
+    void process(const int16_t *in, int16_t *out, const size_t n)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            out[i] = (*this)(in[i]);
+        }
+    }
+
+    /**
+     * Filter a block of 16-bit samples, optionally inverting their phase.
+     * Since the filter is linear, the inversion is applied to the filter
+     * output without any additional pass over the data. Input and output
+     * buffers can be the same, allowing for in-place processing.
+     *
+     * @param in: pointer to the input samples.
+     * @param out: pointer to the output buffer.
+     * @param n: number of samples to be processed.
+     * @param invert: invert the phase of the signal.
+     */
+    void process(const int16_t *in, int16_t *out, const size_t n,
+                 const bool invert)
+    {
+        if(invert == false)
+        {
+            process(in, out, n);
+            return;
+        }
+
+        for(size_t i = 0; i < n; i++)
+        {
+            out[i] = output(-accumulate(in[i]));
+        }
+    }
+
+    /**
+     * Reset FIR history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        hist.fill(0);
+        pos = 0;
+    }
+
+private:
+
+    /**
+     * Push a new input value in the history and compute the filter output
+     * before rounding and saturation.
+     *
+     * @param input: FIR input value for the current time step.
+     * @return filter output, in Q15 format on 32 bits.
+     */
+    inline int32_t accumulate(const int16_t input)
+    {
+        pos = (pos != 0) ? (pos - 1) : (N - 1);
+        hist[pos]     = input;
+        hist[pos + N] = input;
+
+        return fir_dotProductQ15(&hist[pos], taps.data(), N);
+    }
+
+    /**
+     * Round and saturate a filter output value to 16 bits.
+     *
+     * @param acc: filter output, in Q15 format on 32 bits.
+     * @return filter output value.
+     */
+    static inline int16_t output(int32_t acc)
+    {
+        acc = (acc + (1 << 14)) >> 15;
+
+        if(acc > INT16_MAX) acc = INT16_MAX;
+        if(acc < INT16_MIN) acc = INT16_MIN;
+
+        return static_cast< int16_t >(acc);
+    }
+
+    std::array< int16_t, N >     taps;    ///< FIR filter coefficients.
+    std::array< int16_t, 2 * N > hist;    ///< History of past inputs.
+    size_t                       pos;     ///< Current position in history.
+};
+
+/**
+ * Class for polyphase interpolating FIR filter with configurable coefficients.
+ * Each input value produces L output values, the result is the same obtained
+ * by inserting L - 1 zeroes after each input value and filtering the resulting
+ * sequence with a FIR filter having the given coefficients, but without
+ * computing the products by the inserted zeroes.
+ *
+ * Coefficients are rearranged in L sub-filters of ceil(N/L) taps each. Each
+ * sub-filter is a plain FIR filter over the input values: history is kept in a
+ * linear buffer, as in the Fir class, and each sub-filter runs over a whole
+ * block of inputs with a single pass of the fir_blockF32() kernel.
+ */
+template < size_t N, size_t L >
+class FirInterpolator
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param taps: reference to a std::array of floating poing values representing
+     * the FIR filter coefficients.
+     */
+    FirInterpolator(const std::array< float, N >& taps) : pos(M - 1)
+    {
+        // Sub-filter p is made by the taps p, p + L, p + 2L, ...
+        phases.fill(0.0f);
+        for(size_t i = 0; i < N; i++)
+        {
+            phases[((i % L) * M) + (i / L)] = taps[i];
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~FirInterpolator() { }
+
+    /**
+     * Interpolate a block of floating point values. The output buffer must
+     * have room for L * n values.
+     *
+     * @param in: pointer to the input values.
+     * @param out: pointer to the output buffer.
+     * @param n: number of input values to be processed.
+     */
+    void process(const float *in, float *out, const size_t n)
+    {
+        std::array< float, M + 1 > phaseOut;
+        size_t done = 0;
+
+        while(done < n)
+        {
+            if(pos == hist.size()) slide();
+
+            size_t len = hist.size() - pos;
+            if(len > (n - done)) len = n - done;
+
+            memcpy(&hist[pos], in + done, len * sizeof(float));
+
+            // Output k of sub-filter p is the output value p of input k
+            for(size_t p = 0; p < L; p++)
+            {
+                fir_blockF32(&hist[pos], &phases[p * M], M, phaseOut.data(), len);
+
+                for(size_t k = 0; k < len; k++)
+                {
+                    out[((done + k) * L) + p] = phaseOut[k];
+                }
+            }
+
+            pos  += len;
+            done += len;
+        }
+    }
+
+    /**
+     * Reset FIR history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        hist.fill(0);
+        pos = M - 1;
+    }
+
+private:
+
+    static constexpr size_t M = (N + L - 1) / L;    ///< Taps per sub-filter.
+
+    /**
+     * Move the last M - 1 inputs at the beginning of the history buffer.
+     */
+    void slide()
+    {
+        memmove(hist.data(), &hist[pos - (M - 1)], (M - 1) * sizeof(float));
+        pos = M - 1;
+    }
+
+    std::array< float, L * M > phases;    ///< Sub-filter coefficients.
+    std::array< float, 2 * M > hist;      ///< Past inputs followed by the new ones.
+    size_t                     pos;       ///< Position of the next input in history.
 };
 
-#endif /* DSP_H */
+#endif /* FIR_H */
@@ -0,0 +1,157 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef GPS_PARSER_H
+#define GPS_PARSER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <gps.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Streaming parser for the data coming from a GNSS module. The parser accepts
+ * NMEA 0183 sentences and u-blox UBX binary messages, fed one byte at a time,
+ * and assembles the information carried by the sentences of a navigation epoch
+ * into a gps_t data structure. The epoch data is published only when all the
+ * sentences belonging to it have been received.
+ *
+ * The end of an epoch is detected when either the UTC time carried by a
+ * sentence changes or a sentence type already received in the current epoch
+ * is received again. Once the last sentence of the epoch has been identified,
+ * the epoch data is published as soon as that sentence is parsed.
+ */
+
+/**
+ * Size of the parser receive buffer: maximum NMEA sentence length is 82
+ * characters, UBX NAV-PVT payload is 92 bytes long.
+ */
+#define GPS_PARSER_BUF_SIZE 96
+
+/**
+ * Maximum number of entries of an NMEA sentence set.
+ */
+#define GPS_PARSER_MAX_SENTENCES 16
+
+/**
+ * Handler function for an NMEA sentence. The handler is called with a
+ * complete, checksum-verified sentence and updates the epoch data with the
+ * sentence content.
+ *
+ * @param sentence: NMEA sentence, null-terminated.
+ * @param data: epoch data to be updated.
+ * @return -1 if the sentence is not valid, 0 if the sentence is part of a
+ * group and more sentences of the same group are expected, 1 otherwise.
+ */
+typedef int (*gpsSentenceHandler_t)(const char *sentence, gps_t *data);
+
+/**
+ * Descriptor of an NMEA sentence supported by the parser.
+ */
+typedef struct
+{
+    char                 type[4];     // Sentence type, without talker ID
+    uint8_t              timeField;   // Index of the UTC time field, 0 if none
+    bool                 multiple;    // Sentence can be sent many times per epoch
+    gpsSentenceHandler_t handler;     // Sentence handler function
+}
+gpsSentence_t;
+
+/**
+ * Default NMEA sentence set: RMC, GGA, GSA, GSV, VTG and ZDA.
+ */
+extern const gpsSentence_t gpsParser_defaultSentences[];
+extern const size_t        gpsParser_numDefaultSentences;
+
+/**
+ * GNSS data parser state.
+ */
+typedef struct
+{
+    const gpsSentence_t *sentences;     // Set of NMEA sentences to be parsed
+    uint8_t  numSentences;              // Number of entries of the set
+    uint8_t  state;                     // State of the framing state machine
+    uint8_t  pos;                       // Write position inside the buffer
+    uint8_t  ckA;                       // NMEA checksum or UBX checksum A
+    uint8_t  ckB;                       // NMEA received checksum or UBX checksum B
+    uint8_t  ubxClass;                  // UBX message class
+    uint8_t  ubxId;                     // UBX message ID
+    uint16_t ubxLen;                    // UBX payload length
+    uint16_t ubxCount;                  // UBX payload bytes received
+    char     buf[GPS_PARSER_BUF_SIZE];  // Receive buffer
+
+    gps_t    epoch;                     // Data of the epoch being assembled
+    int32_t  epochTime;                 // UTC time of the epoch, in ms
+    uint16_t seen;                      // Sentences received in current epoch
+    int8_t   lastSentence;              // Last sentence parsed
+    int8_t   endSentence;               // Last sentence of an epoch
+    bool     epochOpen;                 // Epoch contains unpublished data
+
+    uint32_t numParsed;                 // Sentences successfully parsed
+    uint32_t numErrors;                 // Sentences discarded due to errors
+    uint32_t numEpochs;                 // Number of epochs published
+}
+gpsParser_t;
+
+/**
+ * Initialise the parser.
+ *
+ * @param parser: pointer to the parser state.
+ * @param sentences: set of NMEA sentences to be parsed, if NULL the default
+ * sentence set is used.
+ * @param numSentences: number of elements of the sentence set.
+ */
+void gpsParser_init(gpsParser_t *parser, const gpsSentence_t *sentences,
+                    const size_t numSentences);
+
+/**
+ * Feed a new byte to the parser.
+ *
+ * @param parser: pointer to the parser state.
+ * @param byte: new byte received from the GNSS module.
+ * @param fix: pointer to a gps_t to which the epoch data is written when an
+ * epoch is complete.
+ * @return true if a complete epoch has been written to fix.
+ */
+bool gpsParser_feed(gpsParser_t *parser, const uint8_t byte, gps_t *fix);
+
+/**
+ * Feed a block of data to the parser. If more than one epoch is completed
+ * by the data block, the most recent one is written to fix.
+ *
+ * @param parser: pointer to the parser state.
+ * @param data: data received from the GNSS module.
+ * @param length: number of bytes to be parsed.
+ * @param fix: pointer to a gps_t to which the epoch data is written when an
+ * epoch is complete.
+ * @return true if a complete epoch has been written to fix.
+ */
+bool gpsParser_feedBlock(gpsParser_t *parser, const uint8_t *data,
+                         const size_t length, gps_t *fix);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GPS_PARSER_H */
@@ -122,14 +122,16 @@ void gfx_terminate();
  * Copy a given section, between two given rows, of framebuffer content to the
  * display.
  * @param startRow: first row of the framebuffer section to be copied
- * @param endRow: last row of the framebuffer section to be copied
+ * @param endRow: one past the last row of the framebuffer section to be copied
  */
 void gfx_renderRows(uint8_t startRow, uint8_t endRow);
 
 /**
- * This function calls the correspondent method of the low level interface display.h
  * Copy framebuffer content to the display internal buffer. To be called
  * whenever there is need to update the display.
+ * Only the rows modified since the previous call, and whose content actually
+ * changed, are sent to the display: the first call after gfx_init() always
+ * sends the whole framebuffer.
  */
 void gfx_render();
 
@@ -146,7 +148,7 @@ bool gfx_renderingInProgress();
  * This results in a black screen on color displays
  * And a white screen on B/W displays
  * @param startRow: first row of the framebuffer section to be cleared
- * @param endRow: last row of the framebuffer section to be cleared
+ * @param endRow: one past the last row of the framebuffer section to be cleared
  */
 void gfx_clearRows(uint8_t startRow, uint8_t endRow);
 
@@ -59,6 +59,13 @@ kbd_msg_t;
  */
 bool input_scanKeyboard(kbd_msg_t *msg);
 
+/**
+ * Check if at least one key was found pressed during the last keyboard scan.
+ *
+ * @return true if at least one key is being held down.
+ */
+bool input_keyHeld();
+
 /**
  * This function returns true if at least one number is pressed on the
  * keyboard.
@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef NVMEM_JOURNAL_H
+#define NVMEM_JOURNAL_H
+
+#include <interfaces/nvmem.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Log-structured key-value store for small, frequently updated data blocks
+ * like radio settings and VFO configuration.
+ *
+ * The store uses two partitions of the same NVM area as ping-pong banks, each
+ * one starting with a header carrying a sequence number. Every update of a
+ * value is appended to the active bank as a record containing only the range
+ * of bytes which changed with respect to the previous value. When the active
+ * bank is full, the current content of all the values is written to the other
+ * bank which then becomes the active one.
+ *
+ * The current value of each key is kept in RAM, together with the position of
+ * the first free byte of the active bank: reads never access the NVM device
+ * and writes do not need any scan. The log is replayed only when the store is
+ * opened.
+ *
+ * Each record and each bank header is protected by a CRC, an interrupted write
+ * leaves the store with either the old or the new value of the key being
+ * written. Bank partitions must be aligned to the erase size of the device.
+ *
+ * A compaction erases the target bank first, unless it is already erased. On
+ * large erase units, like the 128kB sectors of the STM32F4 flash, this stalls
+ * the write which triggered the compaction for up to a couple of seconds, and
+ * on single-bank MCU flash the whole system with it. Drivers should call
+ * nvmJournal_prepare() when such a stall is harmless, for instance during the
+ * shutdown sequence, so that the next compaction finds its bank ready.
+ */
+
+#define NVM_JOURNAL_MAX_KEYS   4       ///< Maximum number of keys in a store
+#define NVM_JOURNAL_MAX_SIZE   128     ///< Maximum size of a value, in bytes
+
+/**
+ * Descriptor of a key: the data structure pointed by this descriptor holds the
+ * current value of the key.
+ */
+struct nvmJournalKey
+{
+    void   *data;    ///< RAM copy of the value
+    size_t  size;    ///< Size of the value, in bytes
+};
+
+/**
+ * Journal data structure.
+ */
+typedef struct
+{
+    const struct nvmArea       *area;               ///< NVM area of the store
+    const struct nvmJournalKey *keys;               ///< Key descriptors
+    uint8_t                     numKeys;            ///< Number of keys
+    uint8_t                     valid;              ///< Bitmask of the keys holding a value
+    uint8_t                     bank;               ///< Currently active bank
+    bool                        mounted;            ///< Active bank contains a valid header
+    bool                        dirty;              ///< Active bank has a damaged tail
+    uint32_t                    bankAddr[2];        ///< Start address of the banks
+    size_t                      bankSize;           ///< Size of each bank
+    size_t                      wrSize;             ///< Device write unit
+    uint32_t                    head;               ///< First free byte in the active bank
+    uint32_t                    sequence;           ///< Sequence number of the active bank
+    uint32_t                    numRecords;         ///< Number of records written
+    uint32_t                    numCompactions;     ///< Number of bank switches
+    uint8_t                     record[8 + NVM_JOURNAL_MAX_SIZE];   ///< Scratch buffer
+}
+nvmJournal_t;
+
+/**
+ * Open a journal, replaying the records of the active bank into the RAM copy
+ * of the keys. Keys without a stored value are left untouched.
+ * The two partitions must have the same size.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param area: NVM area containing the journal.
+ * @param bank0: partition number of the first bank.
+ * @param bank1: partition number of the second bank.
+ * @param keys: descriptors of the keys.
+ * @param numKeys: number of keys.
+ * @return 0 if a valid journal has been found, -ENOENT if the store is empty,
+ * a negative error code otherwise.
+ */
+int nvmJournal_open(nvmJournal_t *j, const struct nvmArea *area,
+                    const uint32_t bank0, const uint32_t bank1,
+                    const struct nvmJournalKey *keys, const size_t numKeys);
+
+/**
+ * Check if a key has a stored value.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param key: key index.
+ * @return true if the RAM copy of the key holds a value loaded from or saved
+ * to the store.
+ */
+static inline bool nvmJournal_hasValue(const nvmJournal_t *j, const uint8_t key)
+{
+    return (j->valid & (1 << key)) != 0;
+}
+
+/**
+ * Read the value of a key. Data is copied from the RAM copy of the key.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param key: key index.
+ * @param data: destination buffer, of the same size of the key.
+ * @return 0 on success, -ENOENT if the key has no value.
+ */
+int nvmJournal_read(const nvmJournal_t *j, const uint8_t key, void *data);
+
+/**
+ * Write a new value for a key. Only the range of bytes differing from the
+ * current value is appended to the log, nothing is written if the value did
+ * not change. If the active bank is full, all the values are moved to the
+ * other bank.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param key: key index.
+ * @param data: new value, of the same size of the key.
+ * @return 0 on success, a negative error code otherwise.
+ */
+int nvmJournal_write(nvmJournal_t *j, const uint8_t key, const void *data);
+
+/**
+ * Erase the bank which is going to be the target of the next compaction, if
+ * not already erased. The data in the store is not affected, also in case the
+ * erase is interrupted.
+ *
+ * @param j: pointer to the journal data structure.
+ * @return 0 on success, a negative error code otherwise.
+ */
+int nvmJournal_prepare(nvmJournal_t *j);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVMEM_JOURNAL_H */
@@ -27,12 +27,18 @@
 
 #include <pthread.h>
 #include <cstdint>
+#include <atomic>
+#include <type_traits>
 
 /**
  * Class implementing a statically allocated circular buffer with blocking and
  * non-blocking push and pop functions.
+ *
+ * When the LockFree parameter is set to true the buffer is implemented as a
+ * lock-free single-producer, single-consumer queue: only one thread can push
+ * and only one thread can pop elements.
  */
-template < typename T, size_t N >
+template < typename T, size_t N, bool LockFree = false >
 class RingBuffer
 {
 public:
@@ -187,4 +193,204 @@ private:
     pthread_cond_t  not_full;   ///< Queue not full condition.
 };
 
+/**
+ * Lock-free single-producer, single-consumer implementation of the circular
+ * buffer. Push and pop operations never take a lock, the mutex and condition
+ * variable are used only when a blocking call has to wait and only when the
+ * other side is effectively sleeping. Capacity must be a power of two.
+ */
+template < typename T, size_t N >
+class RingBuffer< T, N, true >
+{
+public:
+
+    static_assert((N != 0) && ((N & (N - 1)) == 0),
+                  "Lock-free ring buffer size must be a power of two");
+    static_assert(std::is_trivially_copyable< T >::value,
+                  "Lock-free ring buffer elements must be trivially copyable");
+
+    /**
+     * Constructor.
+     */
+    RingBuffer() : readPos(0), writePos(0), waiters(0)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&cond, NULL);
+    }
+
+    /**
+     * Destructor.
+     */
+    ~RingBuffer()
+    {
+        pthread_mutex_destroy(&mutex);
+        pthread_cond_destroy(&cond);
+    }
+
+    /**
+     * Push an element to the buffer. To be called only from the producer
+     * thread.
+     *
+     * @param elem: element to be pushed.
+     * @param blocking: if set to true, when the buffer is full this function
+     * blocks the execution flow until at least one empty slot is available.
+     * @return true if the element has been successfully pushed to the queue,
+     * false if the queue is full.
+     */
+    bool push(const T& elem, bool blocking)
+    {
+        size_t wr = writePos.load(std::memory_order_relaxed);
+        size_t rd = readPos.load(std::memory_order_acquire);
+
+        if((wr - rd) >= N)
+        {
+            if(blocking == false)
+                return false;
+
+            // The call is blocking: wait until there is some free space
+            pthread_mutex_lock(&mutex);
+            waiters.fetch_add(1);
+
+            while(full())
+            {
+                pthread_cond_wait(&cond, &mutex);
+            }
+
+            waiters.fetch_sub(1);
+            pthread_mutex_unlock(&mutex);
+        }
+
+        data[wr % N] = elem;
+        writePos.store(wr + 1, std::memory_order_release);
+        wakeWaiters();
+
+        return true;
+    }
+
+    /**
+     * Pop an element from the buffer. To be called only from the consumer
+     * thread.
+     *
+     * @param elem: place where to store the popped element.
+     * @param blocking: if set to true, when the buffer is empty this function
+     * blocks the execution flow until at least one element is available.
+     * @return true if the element has been successfully popped from the queue,
+     * false if the queue is empty.
+     */
+    bool pop(T& elem, bool blocking)
+    {
+        size_t rd = readPos.load(std::memory_order_acquire);
+
+        while(true)
+        {
+            size_t wr = writePos.load(std::memory_order_acquire);
+
+            if(wr == rd)
+            {
+                if(blocking == false)
+                    return false;
+
+                // The call is blocking: wait until there is something into
+                // the queue
+                pthread_mutex_lock(&mutex);
+                waiters.fetch_add(1);
+
+                while(empty())
+                {
+                    pthread_cond_wait(&cond, &mutex);
+                }
+
+                waiters.fetch_sub(1);
+                pthread_mutex_unlock(&mutex);
+
+                rd = readPos.load(std::memory_order_acquire);
+                continue;
+            }
+
+            elem = data[rd % N];
+
+            // Exchange fails only if the element has been discarded by a
+            // concurrent call to eraseElement(): retry with the next one.
+            if(readPos.compare_exchange_strong(rd, rd + 1,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire))
+                break;
+        }
+
+        wakeWaiters();
+
+        return true;
+    }
+
+    /**
+     * Check if the buffer is empty.
+     *
+     * @return true if the buffer is empty.
+     */
+    bool empty()
+    {
+        return writePos.load() == readPos.load();
+    }
+
+    /**
+     * Check if the buffer is full.
+     *
+     * @return true if the buffer is full.
+     */
+    bool full()
+    {
+        size_t wr = writePos.load();
+        size_t rd = readPos.load();
+
+        return (wr - rd) >= N;
+    }
+
+    /**
+     * Discard one element from the buffer's tail, creating a new empty slot.
+     * This function can be called either from the producer or from the
+     * consumer thread. In case the buffer is full calling this function
+     * unlocks the eventual threads waiting to push data.
+     */
+    void eraseElement()
+    {
+        size_t rd = readPos.load(std::memory_order_acquire);
+        size_t wr = writePos.load(std::memory_order_acquire);
+
+        // Nothing to erase
+        if(wr == rd) return;
+
+        // If the exchange fails the consumer popped the element in the
+        // meantime, there is nothing left to do.
+        if(readPos.compare_exchange_strong(rd, rd + 1,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+            wakeWaiters();
+    }
+
+private:
+
+    /**
+     * Wake up the threads eventually blocked on the buffer. The mutex is taken
+     * only if there is someone waiting.
+     */
+    void wakeWaiters()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters.load() == 0)
+            return;
+
+        pthread_mutex_lock(&mutex);
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    std::atomic< size_t >   readPos;   ///< Read index, free running.
+    std::atomic< size_t >   writePos;  ///< Write index, free running.
+    std::atomic< unsigned > waiters;   ///< Number of threads blocked.
+    T                       data[N];   ///< Data storage.
+
+    pthread_mutex_t mutex;  ///< Mutex for the blocking calls.
+    pthread_cond_t  cond;   ///< Buffer state change condition.
+};
+
 #endif  // RINGBUF_H
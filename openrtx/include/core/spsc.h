@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+#error This header is C only, use RingBuffer< T, N, true > from C++ code
+#endif
+
+/**
+ * spscQueue_t is a lock-free, fixed size queue for data exchange between one
+ * producer and one consumer thread. Element storage is provided by the caller
+ * and its capacity, expressed in number of elements, must be a power of two.
+ *
+ * Push and pop operations never take a lock. When the queue is initialised
+ * with wakeup support, a thread can block waiting for data or free space: in
+ * this case the mutex and condition variable are touched only when the other
+ * side is effectively sleeping.
+ */
+typedef struct spscQueue_t
+{
+    atomic_size_t   head;       ///< Write index, advanced by the producer.
+    atomic_size_t   tail;       ///< Read index, advanced by the consumer.
+    atomic_uint     waiters;    ///< Number of threads sleeping on the queue.
+    size_t          mask;       ///< Capacity minus one, for index wrapping.
+    size_t          elemSize;   ///< Size of a single element, in bytes.
+    uint8_t        *data;       ///< Element storage.
+    bool            wakeup;     ///< Blocking operations enabled.
+    pthread_mutex_t mutex;      ///< Mutex for the sleeping side.
+    pthread_cond_t  cond;       ///< Condition for the sleeping side.
+}
+spscQueue_t;
+
+/**
+ * Initialise a queue.
+ *
+ * @param q: queue to be initialised.
+ * @param storage: pointer to a memory area of at least capacity * elemSize
+ * bytes, used to store the queue elements.
+ * @param elemSize: size of a single element, in bytes.
+ * @param capacity: maximum number of elements, must be a power of two.
+ * @param wakeup: enable the blocking push and pop functions.
+ * @return true on success, false if capacity is not a power of two.
+ */
+bool spsc_init(spscQueue_t *q, void *storage, const size_t elemSize,
+               const size_t capacity, const bool wakeup);
+
+/**
+ * Release the resources allocated by a queue. No thread must be waiting on
+ * the queue when this function is called.
+ *
+ * @param q: queue to be terminated.
+ */
+void spsc_terminate(spscQueue_t *q);
+
+/**
+ * Discard all the elements present in the queue. This function must be called
+ * only when neither the producer nor the consumer are accessing the queue.
+ *
+ * @param q: queue to be cleared.
+ */
+void spsc_reset(spscQueue_t *q);
+
+/**
+ * Push an element to the queue. To be called only from the producer thread.
+ *
+ * @param q: queue.
+ * @param elem: element to be pushed.
+ * @param blocking: if set to true and the queue was initialised with wakeup
+ * support, when the queue is full this function blocks the execution flow
+ * until at least one empty slot is available.
+ * @return true if the element has been pushed, false if the queue is full.
+ */
+bool spsc_push(spscQueue_t *q, const void *elem, const bool blocking);
+
+/**
+ * Push an element to the queue, discarding the oldest one if the queue is
+ * full. To be called only from the producer thread. This function is
+ * lock-free but, differently from spsc_push(), it may force the consumer to
+ * retry its pop operation.
+ *
+ * @param q: queue.
+ * @param elem: element to be pushed.
+ * @return true if an element has been discarded to make room for the new one.
+ */
+bool spsc_pushOverwrite(spscQueue_t *q, const void *elem);
+
+/**
+ * Pop an element from the queue. To be called only from the consumer thread.
+ *
+ * @param q: queue.
+ * @param elem: place where to store the popped element.
+ * @param blocking: if set to true and the queue was initialised with wakeup
+ * support, when the queue is empty this function blocks the execution flow
+ * until at least one element is available.
+ * @return true if an element has been popped, false if the queue is empty.
+ */
+bool spsc_pop(spscQueue_t *q, void *elem, const bool blocking);
+
+/**
+ * Get the number of elements currently present in the queue. The value is a
+ * snapshot and may be already outdated when the function returns.
+ *
+ * @param q: queue.
+ * @return number of elements in the queue.
+ */
+size_t spsc_size(spscQueue_t *q);
+
+#endif /* SPSC_H */
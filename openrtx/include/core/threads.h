@@ -28,6 +28,17 @@
  */
 void create_threads();
 
+#if defined(PLATFORM_LINUX)
+/**
+ * Get the average number of wakeups per second of the UI and device management
+ * threads, computed over the time elapsed since the previous call of this
+ * function. The first call always returns zero.
+ *
+ * @return number of wakeups per second.
+ */
+float threads_getWakeupRate();
+#endif
+
 /**
  * Stack size for state update task, in bytes.
  */
@@ -66,6 +66,14 @@ bool ui_updateGUI();
  */
 bool ui_pushEvent(const uint8_t type, const uint32_t data);
 
+/**
+ * Check if the UI event queue contains events not yet processed by
+ * ui_updateFSM().
+ *
+ * @return true if there is at least one pending event.
+ */
+bool ui_eventPending();
+
 /**
  * This function terminates the User Interface.
  */
@@ -316,6 +316,14 @@ void vp_play();
  */
 void vp_tick();
 
+/**
+ * Get the maximum time interval between two consecutive calls of vp_tick().
+ *
+ * @return tick interval in milliseconds, zero if no voice prompt or beep is
+ * in progress and vp_tick() does not need to be called.
+ */
+uint32_t vp_tickInterval();
+
 /**
  * Check if a voice prompt is being played.
  *
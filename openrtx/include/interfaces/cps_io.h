@@ -41,7 +41,22 @@ extern "C" {
 int cps_open(char *cps_name);
 
 /**
- * Close a codeplug.
+ * Flush to nonvolatile memory all the modifications made to the open
+ * codeplug. Backends may keep part of the modifications in RAM until this
+ * function is called: once it returns successfully, all of them survive a
+ * power loss. On failure the modifications are kept in RAM and the call can
+ * be retried.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int cps_sync();
+
+/**
+ * Close a codeplug, flushing any pending modification as cps_sync() does.
+ * If the modifications cannot be saved the codeplug is left open, with its
+ * content unchanged, and opening another codeplug fails until a call to
+ * cps_sync() or cps_close() succeeds. Callers needing to know the outcome
+ * of the save have to call cps_sync() before closing the codeplug.
  */
 void cps_close();
 
@@ -89,6 +104,28 @@ int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos);
  */
 int cps_readBankData(uint16_t bank_pos, uint16_t pos);
 
+/**
+ * Read a run of consecutive contacts from nonvolatile memory in a single
+ * access, keeping them in cache to speed up the subsequent calls to
+ * cps_readContact(). Backends not caching the codeplug may ignore this call.
+ *
+ * @param pos: position, inside the contact table, of the first contact.
+ * @param count: number of contacts to be prefetched.
+ * @return 0 on success, -1 on failure
+ */
+int cps_prefetchContacts(uint16_t pos, uint16_t count);
+
+/**
+ * Read a run of consecutive channels from nonvolatile memory in a single
+ * access, keeping them in cache to speed up the subsequent calls to
+ * cps_readChannel(). Backends not caching the codeplug may ignore this call.
+ *
+ * @param pos: position, inside the channel table, of the first channel.
+ * @param count: number of channels to be prefetched.
+ * @return 0 on success, -1 on failure
+ */
+int cps_prefetchChannels(uint16_t pos, uint16_t count);
+
 /**
  * Overwrite one contact to the codeplug stored in nonvolatile memory.
  *
@@ -81,9 +81,10 @@ void display_terminate();
 
 /**
  * Copy a given section, between two given rows, of framebuffer content to the
- * display.
+ * display. Rows are framebuffer pixel rows: drivers for controllers organised
+ * in pages send all the pages overlapping the requested section.
  * @param startRow: first row of the framebuffer section to be copied
- * @param endRow: last row of the framebuffer section to be copied
+ * @param endRow: one past the last row of the framebuffer section to be copied
  */
 void display_renderRows(uint8_t startRow, uint8_t endRow);
 
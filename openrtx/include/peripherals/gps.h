@@ -66,27 +66,16 @@ void gps_disable();
 bool gps_detect(uint16_t timeout);
 
 /**
- * Start the acquisition of a new NMEA sentence from the GPS module.
- * The function returns immediately and acquisition is stopped when a complete
- * sentence is received or maximum buffer length is reached.
+ * Read the data received from the GPS module since the last call. Data is
+ * received in background and buffered by the driver as long as the GPS module
+ * is enabled. This function never blocks: if no new data is available it
+ * returns immediately.
  *
- * @param buf: buffer to which the NMEA sentence is written.
- * @param maxLength: maximum writable length inside the buffer.
- * @return number of characters written in the buffer or -1 on error.
+ * @param buf: buffer to which the received data is written.
+ * @param maxLength: maximum number of bytes to be read.
+ * @return number of bytes written in the buffer.
  */
-int gps_getNmeaSentence(char *buf, const size_t maxLength);
-
-/**
- * Check if a newly acquired NMEA sentence is available.
- *
- * @return true if a NMEA sentence has been read from the GPS.
- */
-bool gps_nmeaSentenceReady();
-
-/**
- * Wait until a new NMEA sentence is ready, blocking the execution flow.
- */
-void gps_waitForNmeaSentence();
+size_t gps_readData(uint8_t *buf, const size_t maxLength);
 
 #ifdef __cplusplus
 }
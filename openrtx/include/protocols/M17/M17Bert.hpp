@@ -0,0 +1,198 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_BERT_H
+#define M17_BERT_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include "M17Datatypes.hpp"
+#include "M17Prbs.hpp"
+
+namespace M17
+{
+
+static constexpr size_t  M17_BERT_BITS       = 197;   // PRBS9 bits carried by each BERT frame
+static constexpr uint8_t M17_BERT_MAX_ERRORS = 49;    // Bit errors in a frame before sync is considered lost
+static constexpr uint8_t M17_BERT_MAX_LOST   = 8;     // Longest run of lost frames which can be recovered
+
+/**
+ * Source of the payload of M17 BERT frames: each frame carries the next 197
+ * bits of the PRBS9 sequence, which runs continuously across frames.
+ */
+class M17BertGenerator
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17BertGenerator() { }
+
+    /**
+     * Destructor.
+     */
+    ~M17BertGenerator() { }
+
+    /**
+     * Restart the PRBS9 sequence.
+     */
+    void reset()
+    {
+        prbs.reset();
+    }
+
+    /**
+     * Fill the payload of the next BERT frame.
+     *
+     * @param data: destination payload, the unused bits at its end are zeroed.
+     */
+    void nextFrame(bert_t& data);
+
+private:
+
+    PRBS9 prbs;    ///< PRBS9 generator.
+};
+
+/**
+ * Bit error rate meter fed with the payload of the received M17 BERT frames.
+ *
+ * The PRBS9 validator syncronises with the incoming bit stream and then counts
+ * the bits that differ from the expected sequence. A frame with too many
+ * errors is either the consequence of missed frames, in which case the
+ * validator skips ahead the corresponding number of frames, or of a loss of
+ * syncronisation, in which case the validator syncronises again.
+ */
+class M17BertReceiver
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17BertReceiver();
+
+    /**
+     * Destructor.
+     */
+    ~M17BertReceiver() { }
+
+    /**
+     * Clear the statistics and drop the syncronisation.
+     */
+    void reset();
+
+    /**
+     * Process the payload of a received BERT frame.
+     *
+     * @param data: payload of the BERT frame.
+     * @return true if the validator is syncronised with the received stream.
+     */
+    bool process(const bert_t& data);
+
+    /**
+     * Check if the validator is syncronised with the received stream.
+     *
+     * @return true if the validator is syncronised.
+     */
+    bool synced() const
+    {
+        return locked;
+    }
+
+    /**
+     * Get the number of bits checked against the PRBS9 sequence.
+     *
+     * @return number of bits checked.
+     */
+    uint32_t bits() const
+    {
+        return totBits;
+    }
+
+    /**
+     * Get the number of bit errors found.
+     *
+     * @return number of bit errors.
+     */
+    uint32_t errors() const
+    {
+        return totErrors;
+    }
+
+    /**
+     * Get the number of BERT frames received.
+     *
+     * @return number of frames received.
+     */
+    uint32_t frames() const
+    {
+        return totFrames;
+    }
+
+    /**
+     * Get the number of BERT frames missed while syncronised, inferred from
+     * the position in the PRBS9 sequence of the frames following them.
+     *
+     * @return number of frames lost.
+     */
+    uint32_t lostFrames() const
+    {
+        return totLost;
+    }
+
+    /**
+     * Get the bit error rate measured since the last reset.
+     *
+     * @return bit error rate, zero if no bit has been checked yet.
+     */
+    float ber() const
+    {
+        if(totBits == 0) return 0.0f;
+        return static_cast< float >(totErrors) / static_cast< float >(totBits);
+    }
+
+private:
+
+    /**
+     * Count the bits of a frame differing from the ones produced by a PRBS9
+     * generator, advancing the generator state.
+     *
+     * @param data: payload of the BERT frame.
+     * @param gen: syncronised PRBS9 generator.
+     * @return number of bit errors.
+     */
+    static uint8_t countErrors(const bert_t& data, PRBS9& gen);
+
+    PRBS9    prbs;         ///< PRBS9 validator.
+    bool     locked;       ///< Validator syncronised at the end of the last frame.
+    uint32_t totBits;      ///< Bits checked.
+    uint32_t totErrors;    ///< Bit errors found.
+    uint32_t totFrames;    ///< Frames received.
+    uint32_t totLost;      ///< Frames lost.
+};
+
+}      // namespace M17
+
+#endif // M17_BERT_H
@@ -25,12 +25,192 @@
 #error This header is C++ only!
 #endif
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
 #include "M17Datatypes.hpp"
 
 namespace M17
 {
 
+static constexpr size_t   CALLSIGN_MAX_LEN   = 9;                 ///< Maximum length of a callsign.
+static constexpr uint64_t CALLSIGN_BROADCAST = 0xFFFFFFFFFFFFULL; ///< Broadcast address.
+
+/**
+ * Get the base-40 digit corresponding to a callsign character.
+ *
+ * \param c: character to be converted.
+ * \return base-40 digit, -1 if the character is not allowed.
+ */
+constexpr int8_t base40Digit(const char c)
+{
+    return ((c >= 'A') && (c <= 'Z')) ? (c - 'A') + 1  :
+           ((c >= '0') && (c <= '9')) ? (c - '0') + 27 :
+           (c == '-')                 ? 37             :
+           (c == '/')                 ? 38             :
+           (c == '.')                 ? 39             :
+           (c == ' ')                 ? 0              : -1;
+}
+
+/**
+ * Encode a callsign in base-40 format, starting with the right-most character.
+ * Invalid characters are assigned a value of 0.
+ *
+ * \param callsign: callsign text.
+ * \param len: length of the callsign text, at most nine characters.
+ * \return base-40 value of the callsign.
+ */
+constexpr uint64_t base40Encode(const char *callsign, const size_t len)
+{
+    uint64_t encoded = 0;
+
+    for(size_t i = len; i > 0; i--)
+    {
+        int8_t digit = base40Digit(callsign[i - 1]);
+        encoded = (encoded * 40) + ((digit < 0) ? 0 : digit);
+    }
+
+    return encoded;
+}
+
+/**
+ * Get the numeric value of an encoded callsign, stored in big-endian form.
+ *
+ * \param encodedCall: encoded callsign.
+ * \return numeric value of the callsign.
+ */
+constexpr uint64_t callValue(const call_t& encodedCall)
+{
+    uint64_t value = 0;
+
+    for(size_t i = 0; i < encodedCall.size(); i++)
+        value = (value << 8) | encodedCall[i];
+
+    return value;
+}
+
+/**
+ * Fixed-size callsign value type, holding up to nine characters in plain text
+ * form. No dynamic memory is used, allowing its usage in the RX and TX paths.
+ */
+class Callsign
+{
+public:
+
+    /**
+     * Constructor, empty callsign.
+     */
+    constexpr Callsign() : text{}, len(0) { }
+
+    /**
+     * Constructor from text. Callsigns longer than nine characters are
+     * truncated.
+     *
+     * \param callsign: NULL-terminated callsign text.
+     */
+    constexpr Callsign(const char *callsign) : text{}, len(0)
+    {
+        while((len < CALLSIGN_MAX_LEN) && (callsign[len] != '\0'))
+        {
+            text[len] = callsign[len];
+            len++;
+        }
+    }
+
+    /**
+     * Constructor from a base-40 value, decoding it to its text representation.
+     * The broadcast address is decoded as "ALL".
+     *
+     * \param value: base-40 value of the callsign.
+     */
+    constexpr explicit Callsign(uint64_t value) : text{}, len(0)
+    {
+        constexpr char charMap[] = " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-/.";
+
+        if(value == CALLSIGN_BROADCAST)
+        {
+            text[0] = 'A';
+            text[1] = 'L';
+            text[2] = 'L';
+            len     = 3;
+            return;
+        }
+
+        while((value != 0) && (len < CALLSIGN_MAX_LEN))
+        {
+            text[len++] = charMap[value % 40];
+            value /= 40;
+        }
+    }
+
+    /**
+     * Constructor from an encoded callsign.
+     *
+     * \param encodedCall: base-40 encoded callsign, in big-endian form.
+     */
+    constexpr explicit Callsign(const call_t& encodedCall)
+        : Callsign(callValue(encodedCall)) { }
+
+    /**
+     * Get the base-40 value of the callsign.
+     *
+     * \return base-40 value.
+     */
+    constexpr uint64_t value() const
+    {
+        return base40Encode(text, len);
+    }
+
+    /**
+     * Get the callsign text.
+     *
+     * \return pointer to the NULL-terminated callsign text.
+     */
+    constexpr const char *c_str() const
+    {
+        return text;
+    }
+
+    /**
+     * Get the callsign length.
+     *
+     * \return number of characters of the callsign.
+     */
+    constexpr size_t size() const
+    {
+        return len;
+    }
+
+    /**
+     * Check if the callsign is empty.
+     *
+     * \return true if the callsign has no characters.
+     */
+    constexpr bool empty() const
+    {
+        return len == 0;
+    }
+
+    /**
+     * Copy the callsign text to a character buffer, always NULL-terminated.
+     *
+     * \param dest: destination buffer.
+     * \param size: size of the destination buffer.
+     */
+    void copyTo(char *dest, const size_t size) const;
+
+    bool operator==(const Callsign& other) const;
+
+    bool operator!=(const Callsign& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+
+    char    text[CALLSIGN_MAX_LEN + 1];   ///< Callsign text, NULL-terminated.
+    uint8_t len;                          ///< Callsign length.
+};
+
 /**
  * Encode a callsign in base-40 format, starting with the right-most character.
  * The final value is written out in "big-endian" form, with the most-significant
@@ -43,7 +223,7 @@ namespace M17
  * function return an error.
  * @return true if the callsign was successfully encoded, false on error.
  */
-bool encode_callsign(const std::string& callsign, call_t& encodedCall,
+bool encode_callsign(const Callsign& callsign, call_t& encodedCall,
                      bool strict = false);
 
 /**
@@ -51,9 +231,22 @@ bool encode_callsign(const std::string& callsign, call_t& encodedCall,
  * a 6-byte big-endian value into a string of up to 9 characters.
  *
  * \param encodedCall base-40 encoded callsign.
- * \return a string containing the decoded text.
+ * \return the decoded callsign.
+ */
+Callsign decode_callsign(const call_t& encodedCall);
+
+/**
+ * Compare a plain text callsign with an encoded one, without decoding it.
+ * The comparison does not take into account the country prefixes (strips
+ * the '/' and whatever is in front, when placed within the first three
+ * characters). It does take into account the dash and whatever is after it.
+ * Broadcast address and "ALL" always match.
+ *
+ * \param local: plain text callsign.
+ * \param encodedCall: base-40 encoded callsign.
+ * \return true if the callsigns match.
  */
-std::string decode_callsign(const call_t& encodedCall);
+bool compare_callsign(const Callsign& local, const call_t& encodedCall);
 
 }      // namespace M17
 
@@ -33,10 +33,60 @@
 namespace M17
 {
 
+/**
+ * Lookup table for the convolutional encoding of four input bits.
+ */
+struct ConvEncoderTable
+{
+    uint8_t out[256];
+};
+
+/**
+ * Compute the parity of a value.
+ */
+constexpr uint8_t convParity(const uint8_t value)
+{
+    return (value == 0) ? 0 : ((value & 0x01) ^ convParity(value >> 1));
+}
+
+/**
+ * Generate the convolutional encoder lookup table: the entry for a given state
+ * and input nibble is the result of shifting the nibble into the encoder
+ * memory, most significant bit first, emitting the G1 and G2 outputs for each
+ * bit.
+ */
+constexpr ConvEncoderTable makeConvEncoderTable()
+{
+    ConvEncoderTable table{};
+
+    for(uint16_t i = 0; i < 256; i++)
+    {
+        uint8_t reg    = i >> 4;
+        uint8_t result = 0;
+
+        for(uint8_t bit = 0; bit < 4; bit++)
+        {
+            reg    = ((reg << 1) | ((i >> (3 - bit)) & 0x01)) & 0x1F;
+            result = (result << 1) | convParity(reg & 0x19);
+            result = (result << 1) | convParity(reg & 0x17);
+        }
+
+        table.out[i] = result;
+    }
+
+    return table;
+}
+
 /**
  * Convolutional encoder tailored on M17 protocol specifications, requiring a
  * coder rate R = 1/2, a constraint length K = 5 and polynomials G1 = 0x19 and
  * G2 = 0x17.
+ *
+ * Encoding is table driven: the encoder state is made by the last four input
+ * bits, thus the eight output bits corresponding to four input bits depend only
+ * on the current state and on the input nibble. These are precomputed in a
+ * 256-entry table indexed by (state << 4) | nibble, after which the new state
+ * is the nibble itself.
  */
 class M17ConvolutionalEncoder
 {
@@ -58,12 +108,19 @@ public:
      */
     void encode(const void *data, void *convolved, const size_t len)
     {
-        const uint8_t  *src  = reinterpret_cast< const uint8_t * >(data);
-        uint16_t       *dest = reinterpret_cast< uint16_t * >(convolved);
+        static constexpr ConvEncoderTable table = makeConvEncoderTable();
+
+        const uint8_t *src  = reinterpret_cast< const uint8_t * >(data);
+        uint8_t       *dest = reinterpret_cast< uint8_t * >(convolved);
 
         for(size_t i = 0; i < len; i++)
         {
-            dest[i] = convolveByte(src[i]);
+            uint8_t hi = src[i] >> 4;
+            uint8_t lo = src[i] & 0x0F;
+
+            dest[2 * i]     = table.out[(memory << 4) | hi];
+            dest[2 * i + 1] = table.out[(hi << 4) | lo];
+            memory          = lo;
         }
     }
 
@@ -75,7 +132,11 @@ public:
      */
     uint16_t flush()
     {
-        return convolveByte(0x00);
+        uint8_t  zero = 0;
+        uint16_t result;
+
+        encode(&zero, &result, 1);
+        return result;
     }
 
     /**
@@ -88,30 +149,7 @@ public:
 
 private:
 
-    /**
-     * Compute the convolutional encoding of a byte, using the M17 encoding
-     * scheme.
-     *
-     * \param value: byte to be convolved.
-     * \return result of the convolutional encoding process.
-     */
-    uint16_t convolveByte(uint8_t value)
-    {
-        uint16_t result = 0;
-
-        for(uint8_t i = 0; i < 8; i++)
-        {
-            memory  = (memory << 1) | ((value & 0x80) >> 7);
-            memory &= 0x1F;
-            result  = (result << 1) | (__builtin_popcount(memory & 0x19) & 0x01);
-            result  = (result << 1) | (__builtin_popcount(memory & 0x17) & 0x01);
-            value <<= 1;
-        }
-
-        return __builtin_bswap16(result);
-    }
-
-    uint8_t memory = 0;    ///< Convolutional encoder memory.
+    uint8_t memory = 0;    ///< Convolutional encoder memory, last four input bits.
 };
 
 }      // namespace M17
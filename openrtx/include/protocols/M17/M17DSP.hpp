@@ -86,10 +86,11 @@ static constexpr std::array<float, 41> rrc_taps_24k =
 };
 
 /*
- * FIR implementations of the RRC filter for baseband audio generation.
+ * FIR implementation of the RRC filter for baseband reception, operating
+ * directly on the 16-bit baseband samples using Q15 arithmetic. The transmit
+ * filter is the polyphase interpolator owned by the modulator.
  */
-extern Fir< std::tuple_size< decltype(rrc_taps_48k) >::value > rrc_48k;
-extern Fir< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc_24k;
+extern FirQ15< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc_24k;
 
 } /* M17 */
 
@@ -33,9 +33,12 @@ namespace M17
 
 using call_t    = std::array< uint8_t, 6 >;    // Data type for encoded callsign
 using payload_t = std::array< uint8_t, 16 >;   // Data type for frame payload field
+using pktData_t = std::array< uint8_t, 25 >;   // Data type for packet frame payload field
+using bert_t    = std::array< uint8_t, 25 >;   // Data type for BERT frame payload, 197 bits
 using lich_t    = std::array< uint8_t, 12 >;   // Data type for Golay(24,12) encoded LICH data
 using frame_t   = std::array< uint8_t, 48 >;   // Data type for a full M17 data frame, including sync word
 using syncw_t   = std::array< uint8_t, 2  >;   // Data type for a sync word
+using sframe_t  = std::array< uint16_t, 384 >; // Data type for a full M17 frame in soft-decision form, one value per bit
 
 enum M17DataMode
 {
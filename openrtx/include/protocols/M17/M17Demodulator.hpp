@@ -37,17 +37,11 @@
 #include <audio_stream.h>
 #include <M17/M17Datatypes.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17SyncDetector.hpp>
 
 namespace M17
 {
 
-typedef struct
-{
-    int32_t index;
-    bool lsf;
-}
-sync_t;
-
 class M17Demodulator
 {
 public:
@@ -90,6 +84,16 @@ public:
      */
     const frame_t& getFrame();
 
+    /**
+     * Returns the last decoded frame in soft-decision form, that is with one
+     * soft value per bit. The soft frame is updated alongside the hard one
+     * returned by getFrame().
+     *
+     * @return reference to the internal data structure containing the last
+     * decoded frame in soft-decision form.
+     */
+    const sframe_t& getSoftFrame();
+
     /**
      * @return true if the last decoded frame is an LSF.
      */
@@ -115,6 +119,14 @@ public:
      */
     void invertPhase(const bool status);
 
+    /**
+     * Enable the detection of BERT and packet syncwords alongside the LSF and
+     * stream ones.
+     *
+     * @param status: if set to true BERT and packet syncwords are detected.
+     */
+    void enableExtendedSync(const bool status);
+
 private:
 
     /**
@@ -132,16 +144,8 @@ private:
     static constexpr int8_t  SYNC_SWEEP_OFFSET      = ceil(SYNC_SWEEP_WIDTH / M17_SAMPLES_PER_SYMBOL);
     static constexpr int16_t M17_BRIDGE_SIZE        = M17_SYNCWORD_SAMPLES + 2 * SYNC_SWEEP_WIDTH;
 
-    static constexpr float  CONV_STATS_ALPHA       = 0.005f;
-    static constexpr float  CONV_THRESHOLD_FACTOR  = 3.40;
     static constexpr int16_t QNT_SMA_WINDOW        = 8;
 
-    /**
-     * M17 syncwords;
-     */
-    int8_t  lsf_syncword[M17_SYNCWORD_SYMBOLS]    = { +3, +3, +3, +3, -3, -3, +3, -3 };
-    int8_t  stream_syncword[M17_SYNCWORD_SYMBOLS] = { -3, -3, -3, -3, +3, +3, -3, +3 };
-
     /*
      * Buffers
      */
@@ -152,12 +156,15 @@ private:
     uint16_t                     frame_index;     ///< Index for filling the raw frame.
     std::unique_ptr<frame_t >    demodFrame;      ///< Frame being demodulated.
     std::unique_ptr<frame_t >    readyFrame;      ///< Fully demodulated frame to be returned.
+    std::unique_ptr<sframe_t >   demodSoftFrame;  ///< Soft-decision frame being demodulated.
+    std::unique_ptr<sframe_t >   readySoftFrame;  ///< Fully demodulated soft-decision frame.
     bool                         syncDetected;    ///< A syncword was detected.
     bool                         locked;          ///< A syncword was correctly demodulated.
     bool                         newFrame;        ///< A new frame has been fully decoded.
-    int16_t                      basebandBridge[M17_BRIDGE_SIZE] = { 0 }; ///< Bridge buffer
     int16_t                      phase;           ///< Phase of the signal w.r.t. sampling
     bool                         invPhase;        ///< Invert signal phase
+    bool                         extendedSync;    ///< Detect also BERT and packet syncwords
+    SyncType                     frameSync;       ///< Syncword of the frame being demodulated
 
     /*
      * State variables
@@ -165,9 +172,9 @@ private:
     bool         m17RxEnabled;     ///< M17 Reception Enabled
 
     /*
-     * Convolution statistics computation
+     * Syncword detection
      */
-    float conv_emvar = 0.0f;
+    M17SyncDetector< M17_SAMPLES_PER_SYMBOL > syncDetector;
 
     /*
      * Quantization statistics computation
@@ -184,26 +191,6 @@ private:
      */
     filter_state_t dsp_state;
 
-    /**
-     * Resets the exponential mean and variance/stddev computation.
-     */
-    void resetCorrelationStats();
-
-    /**
-     * Updates the mean and variance with the given correlation value.
-     *
-     * @param value: value to be added to the exponential moving
-     * average/variance computation
-     */
-    void updateCorrelationStats(int32_t value);
-
-    /**
-     * Returns the standard deviation from all the correlation values.
-     *
-     * @returns float numerical value of the standard deviation
-     */
-    float getCorrelationStddev();
-
     /**
      * Resets the quantization max, min and ema computation.
      */
@@ -217,17 +204,6 @@ private:
      */
     void updateQuantizationStats(int32_t frame_index, int32_t symbol_index);
 
-    /**
-     * Computes the convolution between a stride of samples starting from
-     * a given offset and a target waveform.
-     *
-     * @param offset: the offset in the active buffer where to start the stride
-     * @param target: a buffer containing the target waveform to be convoluted
-     * @param target_size: the number of symbols of the target waveform
-     * @return uint16_t numerical value of the convolution
-     */
-    int32_t convolution(int32_t offset, int8_t *target, size_t target_size);
-
     /**
      * Finds the index of the next frame syncword in the baseband stream.
      *
@@ -246,6 +222,16 @@ private:
      */
     int8_t quantize(int32_t offset);
 
+    /**
+     * Takes the value from the input baseband at a given offset and converts
+     * it to the soft-decision values of the two bits of the corresponding
+     * symbol, leveraging the same quantization statistics used by quantize().
+     *
+     * @param offset: the offset in the input baseband
+     * @param symbol: position of the symbol inside the soft frame
+     */
+    void softQuantize(int32_t offset, size_t symbol);
+
     /**
      * Perform a limited search for a syncword using correlation
      *
@@ -26,11 +26,11 @@
 #endif
 
 #include <cstdint>
-#include <string>
 #include <array>
 #include "M17LinkSetupFrame.hpp"
 #include "M17Viterbi.hpp"
 #include "M17StreamFrame.hpp"
+#include "M17PacketFrame.hpp"
 
 namespace M17
 {
@@ -41,7 +41,8 @@ enum class M17FrameType : uint8_t
     LINK_SETUP = 1,    ///< Frame is a Link Setup Frame.
     STREAM     = 2,    ///< Frame is a stream data frame.
     PACKET     = 3,    ///< Frame is a packet data frame.
-    UNKNOWN    = 4     ///< Frame is unknown.
+    BERT       = 4,    ///< Frame is a BERT frame.
+    UNKNOWN    = 5     ///< Frame is unknown.
 };
 
 /**
@@ -75,6 +76,17 @@ public:
      */
     M17FrameType decodeFrame(const frame_t& frame);
 
+    /**
+     * Decode an M17 frame in soft-decision form, identifying its type. Frame
+     * data must contain the sync word in the first sixteen elements.
+     * Convolutionally encoded data is decoded using the soft-decision Viterbi
+     * decoder.
+     *
+     * @param frame: soft bit array containg frame data.
+     * @return the type of frame recognized.
+     */
+    M17FrameType decodeFrame(const sframe_t& frame);
+
     /**
      * Get the latest Link Setup Frame decoded. Check of the validity of the
      * data contained in the LSF is left to application code.
@@ -96,6 +108,41 @@ public:
         return streamFrame;
     }
 
+    /**
+     * Get the latest packet data frame decoded.
+     *
+     * @return a reference to the latest packet data frame decoded.
+     */
+    const M17PacketFrame& getPacketFrame()
+    {
+        return packetFrame;
+    }
+
+    /**
+     * Get the payload of the latest BERT frame decoded.
+     *
+     * @return a reference to the latest BERT payload decoded.
+     */
+    const bert_t& getBertFrame()
+    {
+        return bertFrame;
+    }
+
+    /**
+     * Get the path metric computed by the Viterbi decoder for the latest
+     * frame, excluding the contribution of the punctured bits to within one
+     * unit per punctured bit. The metric is on the soft-decision scale, where
+     * a bit received with full confidence and wrong value costs 0xFFFF: for
+     * hard-decision frames it is the number of corrected errors times 0xFFFF.
+     * Frames without convolutionally encoded data have a null metric.
+     *
+     * @return Viterbi path metric of the latest frame decoded.
+     */
+    uint32_t getViterbiCost()
+    {
+        return viterbiCost;
+    }
+
 private:
 
     /**
@@ -117,6 +164,14 @@ private:
      */
     void decodeLSF(const std::array< uint8_t, 46 >& data);
 
+    /**
+     * Decode Link Setup Frame soft-decision data and update the internal LSF
+     * field with the new frame data.
+     *
+     * @param data: soft bit array containg frame data, without sync word.
+     */
+    void decodeLSF(const std::array< uint16_t, 368 >& data);
+
     /**
      * Decode stream data and update the internal LSF field with the new
      * frame data.
@@ -125,6 +180,65 @@ private:
      */
     void decodeStream(const std::array< uint8_t, 46 >& data);
 
+    /**
+     * Decode stream soft-decision data and update the internal LSF field with
+     * the new frame data.
+     *
+     * @param data: soft bit array containg frame data, without sync word.
+     */
+    void decodeStream(const std::array< uint16_t, 368 >& data);
+
+    /**
+     * Decode packet data and update the internal packet frame field with the
+     * new frame data.
+     *
+     * @param data: byte array containg frame data, without sync word.
+     */
+    void decodePacket(const std::array< uint8_t, 46 >& data);
+
+    /**
+     * Decode packet soft-decision data and update the internal packet frame
+     * field with the new frame data.
+     *
+     * @param data: soft bit array containg frame data, without sync word.
+     */
+    void decodePacket(const std::array< uint16_t, 368 >& data);
+
+    /**
+     * Decode BERT data and update the internal BERT payload field with the
+     * new frame data.
+     *
+     * @param data: byte array containg frame data, without sync word.
+     */
+    void decodeBert(const std::array< uint8_t, 46 >& data);
+
+    /**
+     * Decode BERT soft-decision data and update the internal BERT payload
+     * field with the new frame data. The last encoded bit of a BERT frame is
+     * dropped by the puncturing, it is decoded as an erasure.
+     *
+     * @param data: soft bit array containg frame data, without sync word.
+     */
+    void decodeBert(const std::array< uint16_t, 368 >& data);
+
+    /**
+     * Store the output of the Viterbi decoder in the internal packet frame
+     * field. Packet frames carry 206 bits, thus the decoded bytes begin with
+     * two spurious bits which are discarded.
+     *
+     * @param decoded: output of the Viterbi decoder.
+     */
+    void unpackPacket(const std::array< uint8_t, sizeof(M17PacketFrame) >& decoded);
+
+    /**
+     * Decode the LICH block of a stream frame and use it to reassemble the
+     * Link Setup Frame. When all the six segments have been received and the
+     * resulting LSF is valid, the internal LSF field is updated.
+     *
+     * @param lich: LICH block to be processed.
+     */
+    void processLich(const lich_t& lich);
+
     /**
      * Decode a LICH block.
      *
@@ -140,7 +254,11 @@ private:
     M17LinkSetupFrame lsf;              ///< Latest LSF received.
     M17LinkSetupFrame lsfFromLich;      ///< LSF assembled from LICH segments.
     M17StreamFrame    streamFrame;      ///< Latest stream dat frame received.
+    M17PacketFrame    packetFrame;      ///< Latest packet data frame received.
+    bert_t            bertFrame;        ///< Latest BERT payload received.
+    uint32_t          viterbiCost;      ///< Viterbi path metric of the latest frame.
     M17HardViterbi    viterbi;          ///< Viterbi decoder.
+    M17SoftViterbi    softViterbi;      ///< Soft-decision Viterbi decoder.
 
     ///< Maximum allowed hamming distance when determining the frame type.
     static constexpr uint8_t MAX_SYNC_HAMM_DISTANCE = 4;
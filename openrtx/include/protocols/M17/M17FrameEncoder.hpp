@@ -25,11 +25,11 @@
 #error This header is C++ only!
 #endif
 
-#include <string>
 #include <array>
 #include "M17ConvolutionalEncoder.hpp"
 #include "M17LinkSetupFrame.hpp"
 #include "M17StreamFrame.hpp"
+#include "M17PacketFrame.hpp"
 
 namespace M17
 {
@@ -85,6 +85,24 @@ public:
     uint16_t encodeStreamFrame(const payload_t& payload, frame_t& output,
                                const bool isLast = false);
 
+    /**
+     * Encode a packet data frame into a frame ready for transmission,
+     * prepended with the corresponding sync word.
+     *
+     * @param frame: packet frame to be encoded.
+     * @param output: destination buffer for the encoded data.
+     */
+    void encodePacketFrame(const M17PacketFrame& frame, frame_t& output);
+
+    /**
+     * Encode a BERT frame into a frame ready for transmission, prepended with
+     * the corresponding sync word.
+     *
+     * @param data: BERT payload, 197 bits of the PRBS9 sequence.
+     * @param output: destination buffer for the encoded data.
+     */
+    void encodeBertFrame(const bert_t& data, frame_t& output);
+
     /**
      * Encode an End Of Transmission marker frame.
      *
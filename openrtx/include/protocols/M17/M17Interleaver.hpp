@@ -33,27 +33,145 @@ namespace M17
 {
 
 /**
- * Interleave a block of data using the quadratic permutation polynomial from
- * M17 protocol specification. Polynomial used is P(x) = 45*x + 92*x^2.
+ * Permutation table of the M17 interleaver for a block of NB bits, in gather
+ * form: element i of the table is the position of the source bit for the
+ * destination bit i.
+ */
+template < size_t NB >
+struct InterleaverTable
+{
+    uint16_t idx[NB];
+};
+
+/**
+ * Compute the position of bit i after interleaving, using the quadratic
+ * permutation polynomial from M17 protocol specification.
+ * Polynomial used is P(x) = 45*x + 92*x^2.
  *
- * \param data: input byte array.
+ * \param i: bit position.
+ * \return position of the bit in the interleaved block.
  */
-template < size_t N >
-void interleave(std::array< uint8_t, N >& data)
+template < size_t NB >
+constexpr size_t qppIndex(const size_t i)
+{
+    return ((45 * i) + (92 * i * i)) % NB;
+}
+
+/**
+ * Generate the permutation table for the deinterleaving of a block of NB bits:
+ * destination bit i comes from the interleaved bit P(i).
+ */
+template < size_t NB >
+constexpr InterleaverTable< NB > makeDeinterleaverTable()
+{
+    InterleaverTable< NB > table{};
+
+    for(size_t i = 0; i < NB; i++)
+        table.idx[i] = qppIndex< NB >(i);
+
+    return table;
+}
+
+/**
+ * Generate the permutation table for the interleaving of a block of NB bits,
+ * that is the inverse of the deinterleaving one: interleaved bit P(i) comes
+ * from bit i.
+ */
+template < size_t NB >
+constexpr InterleaverTable< NB > makeInterleaverTable()
 {
-    std::array< uint8_t, N > interleaved;
+    InterleaverTable< NB > table{};
+
+    for(size_t i = 0; i < NB; i++)
+        table.idx[qppIndex< NB >(i)] = i;
+
+    return table;
+}
 
-    static constexpr size_t F1 = 45;
-    static constexpr size_t F2 = 92;
-    static constexpr size_t NB = N*8;
+/**
+ * Check that the permutation polynomial is a bijection over NB bits, as
+ * required for the table inversion to be valid.
+ */
+template < size_t NB >
+constexpr bool isPermutation()
+{
+    bool hit[NB] = {};
 
     for(size_t i = 0; i < NB; i++)
     {
-        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
-        setBit(interleaved, index, getBit(data, i));
+        size_t index = qppIndex< NB >(i);
+        if(hit[index])
+            return false;
+
+        hit[index] = true;
+    }
+
+    return true;
+}
+
+/**
+ * Compile-time permutation tables for a block of NB bits.
+ */
+template < size_t NB >
+struct QppTables
+{
+    static_assert(NB <= 65536, "Block too long for 16-bit permutation tables");
+    static_assert(isPermutation< NB >(), "Polynomial is not a permutation");
+
+    static constexpr InterleaverTable< NB > interleave   = makeInterleaverTable< NB >();
+    static constexpr InterleaverTable< NB > deinterleave = makeDeinterleaverTable< NB >();
+};
+
+template < size_t NB >
+constexpr InterleaverTable< NB > QppTables< NB >::interleave;
+
+template < size_t NB >
+constexpr InterleaverTable< NB > QppTables< NB >::deinterleave;
+
+/**
+ * Permute the bits of a byte array gathering, for each destination byte, the
+ * eight source bits given by a permutation table.
+ *
+ * \param table: permutation table, in gather form.
+ * \param data: byte array to be permuted.
+ */
+template < size_t N >
+inline void permuteBits(const InterleaverTable< N * 8 >& table,
+                        std::array< uint8_t, N >& data)
+{
+    std::array< uint8_t, N > permuted;
+    const uint16_t *idx = table.idx;
+
+    for(size_t i = 0; i < N; i++)
+    {
+        uint32_t byte = 0;
+
+        // Bits are gathered independently of each other, avoiding a serial
+        // dependency between the eight iterations.
+        for(size_t j = 0; j < 8; j++)
+        {
+            uint16_t src = idx[j];
+            uint32_t bit = (data[src >> 3] >> (7 - (src & 0x07))) & 0x01;
+            byte |= bit << (7 - j);
+        }
+
+        permuted[i] = byte;
+        idx += 8;
     }
 
-    std::copy(interleaved.begin(), interleaved.end(), data.begin());
+    std::copy(permuted.begin(), permuted.end(), data.begin());
+}
+
+/**
+ * Interleave a block of data using the quadratic permutation polynomial from
+ * M17 protocol specification. Polynomial used is P(x) = 45*x + 92*x^2.
+ *
+ * \param data: input byte array.
+ */
+template < size_t N >
+void interleave(std::array< uint8_t, N >& data)
+{
+    permuteBits(QppTables< N * 8 >::interleave, data);
 }
 
 /**
@@ -66,17 +184,24 @@ void interleave(std::array< uint8_t, N >& data)
 template < size_t N >
 void deinterleave(std::array< uint8_t, N >& data)
 {
-    std::array< uint8_t, N > deinterleaved;
+    permuteBits(QppTables< N * 8 >::deinterleave, data);
+}
 
-    static constexpr size_t F1 = 45;
-    static constexpr size_t F2 = 92;
-    static constexpr size_t NB = N*8;
+/**
+ * Perform the deinterleaving operation on a block of soft bits, using the
+ * quadratic permutation polynomial from M17 protocol specification.
+ * Polynomial used is P(x) = 45*x + 92*x^2.
+ *
+ * \param data: input soft bit array, one element per bit.
+ */
+template < size_t N >
+void deinterleave(std::array< uint16_t, N >& data)
+{
+    std::array< uint16_t, N > deinterleaved;
+    const uint16_t *idx = QppTables< N >::deinterleave.idx;
 
-    for(size_t i = 0; i < NB; i++)
-    {
-        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
-        setBit(deinterleaved, i, getBit(data, index));
-    }
+    for(size_t i = 0; i < N; i++)
+        deinterleaved[i] = data[idx[i]];
 
     std::copy(deinterleaved.begin(), deinterleaved.end(), data.begin());
 }
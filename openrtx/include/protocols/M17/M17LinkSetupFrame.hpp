@@ -25,9 +25,9 @@
 #error This header is C++ only!
 #endif
 
-#include <string>
 #include <array>
 #include "M17Datatypes.hpp"
+#include "M17Callsign.hpp"
 
 namespace M17
 {
@@ -62,37 +62,45 @@ public:
     /**
      * Set source callsign.
      *
-     * @param callsign: string containing the source callsign.
+     * @param callsign: source callsign.
      */
-    void setSource(const std::string& callsign);
+    void setSource(const Callsign& callsign);
 
     /**
      * Get source callsign.
      *
-     * @return: string containing the source callsign.
+     * @return: the source callsign.
      */
-    std::string getSource();
+    Callsign getSource() const;
 
     /**
      * Set destination callsign.
      *
-     * @param callsign: string containing the destination callsign.
+     * @param callsign: destination callsign.
      */
-    void setDestination(const std::string& callsign);
+    void setDestination(const Callsign& callsign);
 
     /**
      * Get destination callsign.
      *
-     * @return: string containing the destination callsign.
+     * @return: the destination callsign.
      */
-    std::string getDestination();
+    Callsign getDestination() const;
+
+    /**
+     * Get the encoded destination callsign, allowing to compare it without
+     * decoding.
+     *
+     * @return a reference to the base-40 encoded destination callsign.
+     */
+    const call_t& getEncodedDestination() const;
 
     /**
      * Get stream type field.
      *
      * @return a copy of the frame's tream type field.
      */
-    streamType_t getType();
+    streamType_t getType() const;
 
     /**
      * Set stream type field.
@@ -109,6 +117,21 @@ public:
      */
     meta_t& metadata();
 
+    /**
+     * Get metadata field.
+     *
+     * @return a const reference to frame's metadata field.
+     */
+    const meta_t& metadata() const;
+
+    /**
+     * Get the CRC field of the frame, as received or as computed by the last
+     * call to updateCrc().
+     *
+     * @return CRC field value.
+     */
+    uint16_t getCrc() const;
+
     /**
      * Compute a new CRC over the frame content and update the corresponding
      * field.
@@ -142,17 +165,6 @@ public:
 
 private:
 
-    /**
-     * Compute the CRC16 of a given chunk of data using the polynomial 0x5935
-     * with an initial value set to 0xFFFF, as per M17 specification.
-     *
-     * \param data: pointer to the data block.
-     * \param len: lenght of the data block, in bytes.
-     * \return computed CRC16 over the data block.
-     */
-    uint16_t crc16(const void *data, const size_t len) const;
-
-
     struct __attribute__((packed))
     {
         call_t       dst;    ///< Destination callsign
@@ -28,6 +28,7 @@
 #include <audio_stream.h>
 #include <M17/PwmCompensator.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17DSP.hpp>
 #include <audio_path.h>
 #include <cstdint>
 #include <memory>
@@ -109,7 +110,11 @@ private:
     static constexpr float  M17_RRC_GAIN          = 23000.0f;
     static constexpr float  M17_RRC_OFFSET        = 0.0f;
 
+    using RrcInterpolator = FirInterpolator< std::tuple_size< decltype(rrc_taps_48k) >::value,
+                                             M17_SAMPLES_PER_SYMBOL >;
+
     std::array< int8_t, M17_FRAME_SYMBOLS > symbols;
+    RrcInterpolator              rrcShaper;        ///< Polyphase RRC pulse shaping filter.
     std::unique_ptr< int16_t[] > baseband_buffer;  ///< Buffer for baseband audio handling.
     stream_sample_t              *idleBuffer;      ///< Half baseband buffer, free for processing.
     streamId                     outStream;        ///< Baseband output stream ID.
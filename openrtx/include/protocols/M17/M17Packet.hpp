@@ -0,0 +1,171 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_PACKET_H
+#define M17_PACKET_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <crc.h>
+#include "M17PacketFrame.hpp"
+
+namespace M17
+{
+
+static constexpr size_t M17_PACKET_FRAME_BYTES = 25;    // Packet bytes carried by each frame
+static constexpr size_t M17_PACKET_MAX_FRAMES  = 33;    // 32 numbered frames plus the last one
+static constexpr size_t M17_PACKET_MAX_SIZE    = M17_PACKET_MAX_FRAMES
+                                               * M17_PACKET_FRAME_BYTES - 2;
+
+/**
+ * Result of the reassembly of a packet.
+ */
+enum class PacketStatus : uint8_t
+{
+    INCOMPLETE = 0,    ///< More frames are needed to complete the packet.
+    COMPLETE   = 1,    ///< Packet complete, with a valid CRC.
+    ERROR      = 2     ///< Frame out of sequence or CRC mismatch.
+};
+
+/**
+ * This class holds an M17 data packet, that is the application data followed
+ * by its CRC, in a statically allocated buffer. The packet can be split into
+ * packet frames for transmission or reassembled from the received ones.
+ *
+ * The content of the application data, including the leading protocol
+ * identifier, is not interpreted.
+ */
+class M17Packet
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17Packet();
+
+    /**
+     * Destructor.
+     */
+    ~M17Packet();
+
+    /**
+     * Clear the packet content and restart the reassembly.
+     */
+    void reset();
+
+    /**
+     * Load the application data of a packet to be transmitted and append its
+     * CRC.
+     *
+     * @param data: application data.
+     * @param len: length of the application data, in bytes.
+     * @return false if len is zero or exceeds M17_PACKET_MAX_SIZE.
+     */
+    bool set(const void *data, const size_t len);
+
+    /**
+     * Complete a packet whose application data has been written in place
+     * through data(), appending its CRC.
+     *
+     * @param len: length of the application data, in bytes.
+     * @return false if len is zero or exceeds M17_PACKET_MAX_SIZE.
+     */
+    bool setSize(const size_t len);
+
+    /**
+     * Access the application data.
+     *
+     * @return pointer to the application data, with room for up to
+     * M17_PACKET_MAX_SIZE bytes.
+     */
+    uint8_t *data()
+    {
+        return buffer.data();
+    }
+
+    /**
+     * Access the application data.
+     *
+     * @return pointer to the application data.
+     */
+    const uint8_t *data() const
+    {
+        return buffer.data();
+    }
+
+    /**
+     * Get the length of the application data, meaningful only for packets
+     * being transmitted or for complete received packets.
+     *
+     * @return length of the application data, in bytes.
+     */
+    size_t size() const
+    {
+        return (length > 2) ? (length - 2) : 0;
+    }
+
+    /**
+     * Get the number of packet frames needed to transmit the packet.
+     *
+     * @return number of packet frames.
+     */
+    size_t numFrames() const
+    {
+        return (length + M17_PACKET_FRAME_BYTES - 1) / M17_PACKET_FRAME_BYTES;
+    }
+
+    /**
+     * Build one of the packet frames carrying the packet.
+     *
+     * @param index: frame index, less than numFrames().
+     * @param frame: destination packet frame.
+     */
+    void getFrame(const size_t index, M17PacketFrame& frame) const;
+
+    /**
+     * Append a received packet frame to the packet being reassembled. The CRC
+     * is computed while the frames are received and is checked when the last
+     * frame arrives. After a complete packet or an error, the next frame
+     * starts the reassembly of a new packet.
+     *
+     * @param frame: received packet frame.
+     * @return the status of the packet reassembly.
+     */
+    PacketStatus append(const M17PacketFrame& frame);
+
+private:
+
+    ///< Application data followed by the CRC.
+    std::array< uint8_t, M17_PACKET_MAX_FRAMES * M17_PACKET_FRAME_BYTES > buffer;
+    uint16_t length;       ///< Packet length, including the CRC.
+    uint8_t  nextFrame;    ///< Number of the next frame expected.
+    bool     done;         ///< Reassembly terminated.
+    crc16_t  crc;          ///< Running CRC of the received data.
+};
+
+}      // namespace M17
+
+#endif // M17_PACKET_H
@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_PACKET_FRAME_H
+#define M17_PACKET_FRAME_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstring>
+#include "M17Datatypes.hpp"
+
+namespace M17
+{
+
+class M17FrameDecoder;
+
+/**
+ * This class describes and handles an M17 packet data frame, carrying a chunk
+ * of 25 bytes of a packet followed by a control field. The control field is
+ * made by the End Of Frame bit and by a five bit counter, holding the frame
+ * number for all the frames but the last one, where it holds the number of
+ * valid bytes in the chunk.
+ */
+class M17PacketFrame
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    M17PacketFrame()
+    {
+        clear();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~M17PacketFrame(){ }
+
+    /**
+     * Clear the frame content, filling it with zeroes.
+     */
+    void clear()
+    {
+        memset(&data, 0x00, sizeof(data));
+    }
+
+    /**
+     * Set frame sequence number.
+     *
+     * @param seqNum: frame number, between 0 and 31.
+     */
+    void setFrameNumber(const uint8_t seqNum)
+    {
+        data.control = (seqNum & CNT_MASK) << CNT_SHIFT;
+    }
+
+    /**
+     * Get the value of the frame counter: the frame sequence number or, for
+     * the last frame, the number of valid bytes in the payload.
+     *
+     * @return frame counter, between 0 and 31.
+     */
+    uint8_t getFrameNumber() const
+    {
+        return (data.control >> CNT_SHIFT) & CNT_MASK;
+    }
+
+    /**
+     * Mark this frame as the last one of the packet, setting the number of
+     * valid bytes in its payload.
+     *
+     * @param numBytes: number of valid payload bytes, between 1 and 25.
+     */
+    void lastFrame(const uint8_t numBytes)
+    {
+        data.control = EOF_BIT | ((numBytes & CNT_MASK) << CNT_SHIFT);
+    }
+
+    /**
+     * Check if this frame is the last one of the packet that is, get the value
+     * of the EOF bit.
+     *
+     * @return true if the frame has the EOF bit set.
+     */
+    bool isLastFrame() const
+    {
+        return ((data.control & EOF_BIT) != 0) ? true : false;
+    }
+
+    /**
+     * Access frame payload.
+     *
+     * @return a reference to frame's paylod field, allowing for both read and
+     * write access.
+     */
+    pktData_t& payload()
+    {
+        return data.payload;
+    }
+
+    /**
+     * Access frame payload.
+     *
+     * @return a const reference to frame's paylod field.
+     */
+    const pktData_t& payload() const
+    {
+        return data.payload;
+    }
+
+    /**
+     * Get underlying data.
+     *
+     * @return a pointer to const uint8_t allowing direct access to frame data.
+     */
+    const uint8_t *getData() const
+    {
+        return reinterpret_cast < const uint8_t * > (&data);
+    }
+
+private:
+
+    struct __attribute__((packed))
+    {
+        pktData_t payload;    // Payload data
+        uint8_t   control;    // EOF bit, frame counter and two padding bits
+    }
+    data;
+                                                  ///< Frame data.
+    static constexpr uint8_t EOF_BIT   = 0x80;    ///< End Of Frame bit.
+    static constexpr uint8_t CNT_MASK  = 0x1F;    ///< Bitmask for frame counter.
+    static constexpr uint8_t CNT_SHIFT = 2;       ///< Position of frame counter.
+
+    // Frame decoder class needs to access raw frame data
+    friend class M17FrameDecoder;
+};
+
+}      // namespace M17
+
+#endif // M17_PACKET_FRAME_H
@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_PACKET_QUEUE_H
+#define M17_PACKET_QUEUE_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <pthread.h>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include "M17Packet.hpp"
+
+namespace M17
+{
+
+static constexpr size_t M17_PACKET_QUEUE_SIZE = 1200;   // Default queue size, in bytes
+
+/**
+ * Statically allocated queue of variable length packets, stored back to back
+ * in a circular buffer of N bytes, each one preceded by its length. Push and
+ * pop are protected by a mutex, allowing any number of threads to post
+ * packets.
+ */
+template < size_t N = M17_PACKET_QUEUE_SIZE >
+class M17PacketQueue
+{
+public:
+
+    static_assert(N >= M17_PACKET_MAX_SIZE + 2, "Queue too small");
+
+    /**
+     * Constructor.
+     */
+    M17PacketQueue() : readPos(0), writePos(0), used(0)
+    {
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    /**
+     * Destructor.
+     */
+    ~M17PacketQueue()
+    {
+        pthread_mutex_destroy(&mutex);
+    }
+
+    /**
+     * Push a packet to the queue, without blocking.
+     *
+     * @param data: packet data.
+     * @param len: packet length, in bytes.
+     * @return true if the packet has been pushed, false if its length is zero
+     * or exceeds M17_PACKET_MAX_SIZE or if there is not enough free space.
+     */
+    bool push(const void *data, const size_t len)
+    {
+        if((len == 0) || (len > M17_PACKET_MAX_SIZE))
+            return false;
+
+        pthread_mutex_lock(&mutex);
+
+        if((used + len + 2) > N)
+        {
+            pthread_mutex_unlock(&mutex);
+            return false;
+        }
+
+        const uint8_t header[] = { static_cast< uint8_t >(len >> 8),
+                                   static_cast< uint8_t >(len & 0xFF) };
+        write(header, sizeof(header));
+        write(reinterpret_cast< const uint8_t * >(data), len);
+        used += len + 2;
+
+        pthread_mutex_unlock(&mutex);
+        return true;
+    }
+
+    /**
+     * Pop the oldest packet from the queue, without blocking. A packet longer
+     * than the destination buffer is discarded.
+     *
+     * @param data: destination buffer.
+     * @param size: size of the destination buffer, in bytes.
+     * @return length of the packet popped, zero if the queue is empty or the
+     * packet has been discarded.
+     */
+    size_t pop(void *data, const size_t size)
+    {
+        pthread_mutex_lock(&mutex);
+
+        if(used == 0)
+        {
+            pthread_mutex_unlock(&mutex);
+            return 0;
+        }
+
+        uint8_t header[2];
+        read(header, sizeof(header));
+        size_t len = (header[0] << 8) | header[1];
+        used      -= len + 2;
+
+        if(len <= size)
+        {
+            read(reinterpret_cast< uint8_t * >(data), len);
+        }
+        else
+        {
+            readPos = (readPos + len) % N;
+            len     = 0;
+        }
+
+        pthread_mutex_unlock(&mutex);
+        return len;
+    }
+
+    /**
+     * Check if the queue is empty.
+     *
+     * @return true if the queue is empty.
+     */
+    bool empty()
+    {
+        return used == 0;
+    }
+
+    /**
+     * Discard all the packets in the queue.
+     */
+    void clear()
+    {
+        pthread_mutex_lock(&mutex);
+        readPos  = 0;
+        writePos = 0;
+        used     = 0;
+        pthread_mutex_unlock(&mutex);
+    }
+
+private:
+
+    /**
+     * Copy a block of data to the buffer, wrapping around its end.
+     */
+    void write(const uint8_t *src, const size_t len)
+    {
+        size_t first = std::min(len, N - writePos);
+        memcpy(buffer + writePos, src, first);
+        memcpy(buffer, src + first, len - first);
+        writePos = (writePos + len) % N;
+    }
+
+    /**
+     * Copy a block of data from the buffer, wrapping around its end.
+     */
+    void read(uint8_t *dest, const size_t len)
+    {
+        size_t first = std::min(len, N - readPos);
+        memcpy(dest, buffer + readPos, first);
+        memcpy(dest + first, buffer, len - first);
+        readPos = (readPos + len) % N;
+    }
+
+    size_t  readPos;      ///< Read pointer.
+    size_t  writePos;     ///< Write pointer.
+    size_t  used;         ///< Number of bytes in use, including the headers.
+    uint8_t buffer[N];    ///< Data storage.
+
+    pthread_mutex_t mutex;    ///< Mutex for concurrent access.
+};
+
+}      // namespace M17
+
+#endif // M17_PACKET_QUEUE_H
@@ -26,7 +26,6 @@
 #endif
 
 #include <cstring>
-#include <string>
 #include "M17Datatypes.hpp"
 
 namespace M17
@@ -115,6 +114,16 @@ public:
         return data.payload;
     }
 
+    /**
+     * Access frame payload.
+     *
+     * @return a const reference to frame's paylod field.
+     */
+    const payload_t& payload() const
+    {
+        return data.payload;
+    }
+
     /**
      * Get underlying data.
      *
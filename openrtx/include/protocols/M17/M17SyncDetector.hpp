@@ -0,0 +1,249 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_SYNC_DETECTOR_H
+#define M17_SYNC_DETECTOR_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <cmath>
+#include <M17/M17Constants.hpp>
+
+namespace M17
+{
+
+/**
+ * Syncword types recognised by the syncword detector.
+ */
+enum class SyncType : uint8_t
+{
+    NONE   = 0,    ///< No syncword found.
+    LSF    = 1,    ///< Link setup frame syncword.
+    STREAM = 2,    ///< Stream frame syncword.
+    BERT   = 3,    ///< BERT frame syncword.
+    PACKET = 4     ///< Packet frame syncword.
+};
+
+typedef struct
+{
+    int32_t  index;
+    SyncType type;
+}
+sync_t;
+
+/**
+ * Syncword detector for M17 baseband signals, sampled at SPS samples per
+ * symbol.
+ *
+ * The LSF syncword is the opposite of the stream one and the packet syncword
+ * is the opposite of the BERT one: a single correlation detects both members
+ * of each pair, distinguishing them by the sign of the correlation peak.
+ * The correlation threshold adapts to the signal level through an exponential
+ * moving variance of the stream syncword correlation.
+ *
+ * Samples are accessed as a contiguous array: when searching across block
+ * boundaries calling code must provide the tail of the previous block right
+ * before the current one.
+ */
+template < size_t SPS >
+class M17SyncDetector
+{
+public:
+
+    /**
+     * Number of samples spanned by a syncword, from the first to the last
+     * symbol.
+     */
+    static constexpr size_t SYNC_SPAN = (M17_SYNCWORD_SYMBOLS - 1) * SPS + 1;
+
+    /**
+     * Constructor.
+     */
+    M17SyncDetector() : multiHypothesis(false)
+    {
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~M17SyncDetector() { }
+
+    /**
+     * Reset the correlation statistics.
+     */
+    void reset()
+    {
+        emvar = 40000000.0f;
+    }
+
+    /**
+     * Enable or disable the detection of BERT and packet syncwords alongside
+     * the LSF and stream ones.
+     *
+     * @param enable: if set to true BERT and packet syncwords are searched.
+     */
+    void enableMultiHypothesis(const bool enable)
+    {
+        multiHypothesis = enable;
+    }
+
+    /**
+     * Compute the correlation between the samples starting from a given
+     * position and the stream and BERT syncwords.
+     *
+     * @param x: pointer to the first sample of the syncword, at least
+     * SYNC_SPAN samples have to be accessible from here.
+     * @param stream: correlation with the stream syncword, negative for LSF.
+     * @param bert: correlation with the BERT syncword, negative for packet.
+     */
+    static inline void correlate(const int16_t *x, int32_t& stream,
+                                 int32_t& bert)
+    {
+        /*
+         * Stream syncword: -3, -3, -3, -3, +3, +3, -3, +3
+         * BERT syncword:   -3, +3, -3, -3, +3, +3, +3, +3
+         * The two share all the symbols except the second and the seventh.
+         */
+        int32_t common = x[4*SPS] + x[5*SPS] + x[7*SPS]
+                       - x[0]     - x[2*SPS] - x[3*SPS];
+        int32_t diff   = x[SPS] + x[6*SPS];
+
+        stream = 3 * (common - diff);
+        bert   = 3 * (common + diff);
+    }
+
+    /**
+     * Compute the correlation with the stream and BERT syncwords for a block
+     * of consecutive positions.
+     *
+     * @param x: pointer to the first sample, at least n + SYNC_SPAN - 1
+     * samples have to be accessible from here.
+     * @param stream: output buffer for stream syncword correlation.
+     * @param bert: output buffer for BERT syncword correlation.
+     * @param n: number of positions to be evaluated.
+     */
+    static void correlate(const int16_t *x, int32_t *stream, int32_t *bert,
+                          const size_t n)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            correlate(x + i, stream[i], bert[i]);
+        }
+    }
+
+    /**
+     * Search for the first syncword starting in a given range of positions,
+     * updating the correlation statistics for each position evaluated.
+     *
+     * @param samples: pointer to the sample buffer.
+     * @param start: first position to be evaluated, can be negative if the
+     * samples before the buffer are accessible.
+     * @param end: last position to be evaluated, excluded.
+     * @return position and type of the syncword found, index is -1 if no
+     * syncword is found.
+     */
+    sync_t search(const int16_t *samples, const int32_t start, const int32_t end)
+    {
+        sync_t sync = { -1, SyncType::NONE };
+        std::array< int32_t, BLOCK_SIZE > streamCorr;
+        std::array< int32_t, BLOCK_SIZE > bertCorr;
+
+        for(int32_t base = start; base < end; base += BLOCK_SIZE)
+        {
+            size_t len = BLOCK_SIZE;
+            if((end - base) < static_cast< int32_t >(BLOCK_SIZE))
+                len = end - base;
+
+            correlate(samples + base, streamCorr.data(), bertCorr.data(), len);
+
+            for(size_t i = 0; i < len; i++)
+            {
+                // Threshold comparison is done on squared values to avoid
+                // computing the standard deviation at each step.
+                float conv = static_cast< float >(streamCorr[i]);
+                updateStats(conv);
+                float threshold = THRESHOLD_FACTOR * THRESHOLD_FACTOR * emvar;
+
+                if((conv * conv) > threshold)
+                {
+                    sync.index = base + i;
+                    sync.type  = (conv > 0.0f) ? SyncType::STREAM : SyncType::LSF;
+                    return sync;
+                }
+
+                if(multiHypothesis)
+                {
+                    float bconv = static_cast< float >(bertCorr[i]);
+                    if((bconv * bconv) > threshold)
+                    {
+                        sync.index = base + i;
+                        sync.type  = (bconv > 0.0f) ? SyncType::BERT
+                                                    : SyncType::PACKET;
+                        return sync;
+                    }
+                }
+            }
+        }
+
+        return sync;
+    }
+
+    /**
+     * Get the current value of the correlation threshold.
+     *
+     * @return correlation threshold.
+     */
+    float getThreshold()
+    {
+        return THRESHOLD_FACTOR * std::sqrt(emvar);
+    }
+
+private:
+
+    /**
+     * Update the exponential moving variance with a new correlation value.
+     * Algorithm taken from
+     * https://fanf2.user.srcf.net/hermes/doc/antiforgery/stats.pdf
+     *
+     * @param value: new correlation value.
+     */
+    inline void updateStats(const float value)
+    {
+        float incr = STATS_ALPHA * value;
+        emvar      = (1.0f - STATS_ALPHA) * (emvar + value * incr);
+    }
+
+    static constexpr size_t BLOCK_SIZE       = 32;
+    static constexpr float  STATS_ALPHA      = 0.005f;
+    static constexpr float  THRESHOLD_FACTOR = 3.40f;
+
+    float emvar;             ///< Exponential moving variance of correlation.
+    bool  multiHypothesis;   ///< Search also for BERT and packet syncwords.
+};
+
+}      // namespace M17
+
+#endif // M17_SYNC_DETECTOR_H
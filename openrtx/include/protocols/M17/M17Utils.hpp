@@ -124,6 +124,35 @@ inline void setSymbol(std::array< uint8_t, N >& array, const size_t pos,
 }
 
 
+/**
+ * Utility function allowing to set the soft-decision value of the two bits of
+ * a symbol on an array of soft bits. The symbol value has to be normalised so
+ * that its nominal values are -3, -1, +1 and +3, the bit mapping is the same
+ * of setSymbol(). Soft values range from 0x0000 (bit is zero with maximum
+ * confidence) to 0xFFFF (bit is one with maximum confidence).
+ *
+ * @param array: soft bit array.
+ * @param pos: symbol position inside the array.
+ * @param value: normalised symbol value.
+ */
+template < size_t N >
+inline void setSoftSymbol(std::array< uint16_t, N >& array, const size_t pos,
+                          const float value)
+{
+    // First bit is the sign of the symbol, second bit is its magnitude
+    float msb = (1.0f - value) * 0.5f;
+    float lsb = ((value < 0.0f ? -value : value) - 1.0f) * 0.5f;
+
+    if(msb < 0.0f) msb = 0.0f;
+    if(msb > 1.0f) msb = 1.0f;
+    if(lsb < 0.0f) lsb = 0.0f;
+    if(lsb > 1.0f) lsb = 1.0f;
+
+    array[2 * pos]     = static_cast< uint16_t >(msb * 65535.0f);
+    array[2 * pos + 1] = static_cast< uint16_t >(lsb * 65535.0f);
+}
+
+
 /**
  * Utility function to encode a given byte of data into 4FSK symbols. Each
  * byte is encoded in four symbols.
@@ -30,13 +30,244 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <array>
-#include <bitset>
 #include "M17Utils.hpp"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace M17
 {
 
+/**
+ * Branch selector for the eight butterflies of the M17 trellis. The butterfly
+ * i connects states i and i + 8 to states 2i and 2i + 1; bit 1 of the entry
+ * is the first encoder output on the branch from state i to state 2i, bit 0
+ * the second one. Branches leaving state i + 8 or entering state 2i + 1 carry
+ * the complementary outputs.
+ */
+static constexpr uint8_t VITERBI_BRANCH_SEL[] = {0, 1, 1, 0, 2, 3, 3, 2};
+
+/**
+ * Table of branch metrics for hard decision decoding, indexed by the pair of
+ * received symbols, each one having a cost of 0, 1 (punctured) or 2.
+ */
+struct HardBranchMetrics
+{
+    uint16_t bm[9][8];
+};
+
+static constexpr HardBranchMetrics makeHardBranchMetrics()
+{
+    HardBranchMetrics table{};
+
+    for(uint8_t s0 = 0; s0 < 3; s0++)
+    {
+        for(uint8_t s1 = 0; s1 < 3; s1++)
+        {
+            for(uint8_t i = 0; i < 8; i++)
+            {
+                uint8_t sel = VITERBI_BRANCH_SEL[i];
+                table.bm[(3 * s0) + s1][i] = ((sel & 0x02) ? (2 - s0) : s0)
+                                           + ((sel & 0x01) ? (2 - s1) : s1);
+            }
+        }
+    }
+
+    return table;
+}
+
+static constexpr HardBranchMetrics VITERBI_HARD_BM = makeHardBranchMetrics();
+
+/**
+ * Reference add-compare-select step over the sixteen states of the M17
+ * trellis, used when no packed arithmetic kernel is available for the given
+ * metric type.
+ *
+ * @param prev: path metrics of the previous step.
+ * @param curr: path metrics of the current step.
+ * @param bm: branch metrics of the eight butterflies.
+ * @param maxBm: sum of the metrics of two complementary branches.
+ * @return decision word, bit n is set if the survivor path of state n comes
+ * from the upper half of the states.
+ */
+template < typename T >
+static inline uint16_t viterbi_acsScalar(const T *prev, T *curr, const T *bm,
+                                         const T maxBm)
+{
+    uint16_t dec = 0;
+
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        T m0 = prev[i]     + bm[i];
+        T m1 = prev[i + 8] + (maxBm - bm[i]);
+        T m2 = prev[i]     + (maxBm - bm[i]);
+        T m3 = prev[i + 8] + bm[i];
+
+        bool d0 = (m0 >= m1);
+        bool d1 = (m2 >= m3);
+
+        curr[2 * i]     = d0 ? m1 : m0;
+        curr[2 * i + 1] = d1 ? m3 : m2;
+        dec |= (d0 << (2 * i)) | (d1 << (2 * i + 1));
+    }
+
+    return dec;
+}
+
+/**
+ * Add-compare-select step over the sixteen states of the M17 trellis, with
+ * path metrics on 16 bits. The kernel processes eight 16-bit lanes at once
+ * with SSE2 on x86 and two lanes packed in a 32-bit word elsewhere.
+ *
+ * Path metrics must be less than 0x8000: this holds for hard decision
+ * decoding of up to 244 bits, where the metric grows at most by four at each
+ * step.
+ *
+ * @param prev: path metrics of the previous step.
+ * @param curr: path metrics of the current step.
+ * @param bm: branch metrics of the eight butterflies.
+ * @param maxBm: sum of the metrics of two complementary branches.
+ * @return decision word, bit n is set if the survivor path of state n comes
+ * from the upper half of the states.
+ */
+static inline uint16_t viterbi_acs(const uint16_t *prev, uint16_t *curr,
+                                   const uint16_t *bm, const uint16_t maxBm)
+{
+    #if defined(__SSE2__)
+    const __m128i a   = _mm_loadu_si128(reinterpret_cast< const __m128i * >(prev));
+    const __m128i b   = _mm_loadu_si128(reinterpret_cast< const __m128i * >(prev + 8));
+    const __m128i bmv = _mm_loadu_si128(reinterpret_cast< const __m128i * >(bm));
+    const __m128i ibm = _mm_sub_epi16(_mm_set1_epi16(maxBm), bmv);
+
+    __m128i m0 = _mm_add_epi16(a, bmv);
+    __m128i m1 = _mm_add_epi16(b, ibm);
+    __m128i m2 = _mm_add_epi16(a, ibm);
+    __m128i m3 = _mm_add_epi16(b, bmv);
+
+    // Signed comparison is fine, as metrics are less than 0x8000
+    __m128i even = _mm_min_epi16(m0, m1);
+    __m128i odd  = _mm_min_epi16(m2, m3);
+    __m128i lt0  = _mm_cmplt_epi16(m0, m1);
+    __m128i lt1  = _mm_cmplt_epi16(m2, m3);
+
+    _mm_storeu_si128(reinterpret_cast< __m128i * >(curr),
+                     _mm_unpacklo_epi16(even, odd));
+    _mm_storeu_si128(reinterpret_cast< __m128i * >(curr + 8),
+                     _mm_unpackhi_epi16(even, odd));
+
+    __m128i lt = _mm_packs_epi16(_mm_unpacklo_epi16(lt0, lt1),
+                                 _mm_unpackhi_epi16(lt0, lt1));
+
+    return ~_mm_movemask_epi8(lt) & 0xFFFF;
+    #elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    const uint32_t max = (static_cast< uint32_t >(maxBm) << 16) | maxBm;
+    uint16_t dec = 0;
+
+    for(uint8_t i = 0; i < 8; i += 2)
+    {
+        uint32_t a, b, bmv;
+        memcpy(&a,   prev + i,     sizeof(a));
+        memcpy(&b,   prev + i + 8, sizeof(b));
+        memcpy(&bmv, bm + i,       sizeof(bmv));
+
+        // Lanes never overflow, thus the additions can be done on the whole
+        // word. Comparisons are done setting the top bit of each lane of the
+        // minuend, which then holds the result without borrowing from the
+        // lane above.
+        uint32_t ibm = max - bmv;
+        uint32_t m0  = a + bmv;
+        uint32_t m1  = b + ibm;
+        uint32_t m2  = a + ibm;
+        uint32_t m3  = b + bmv;
+
+        uint32_t ge0  = ((m0 | 0x80008000) - m1) & 0x80008000;
+        uint32_t ge1  = ((m2 | 0x80008000) - m3) & 0x80008000;
+        uint32_t msk0 = (ge0 >> 15) * 0xFFFF;
+        uint32_t msk1 = (ge1 >> 15) * 0xFFFF;
+
+        uint32_t even = (m1 & msk0) | (m0 & ~msk0);
+        uint32_t odd  = (m3 & msk1) | (m2 & ~msk1);
+        uint32_t lo   = (even & 0x0000FFFF) | (odd << 16);
+        uint32_t hi   = (even >> 16) | (odd & 0xFFFF0000);
+
+        memcpy(curr + (2 * i),     &lo, sizeof(lo));
+        memcpy(curr + (2 * i) + 2, &hi, sizeof(hi));
+
+        dec |= (((ge0 >> 15) & 0x01) << (2 * i))
+            |  (((ge1 >> 15) & 0x01) << (2 * i + 1))
+            |  ((ge0 >> 31)          << (2 * i + 2))
+            |  ((ge1 >> 31)          << (2 * i + 3));
+    }
+
+    return dec;
+    #else
+    return viterbi_acsScalar(prev, curr, bm, maxBm);
+    #endif
+}
+
+/**
+ * Add-compare-select step over the sixteen states of the M17 trellis, with
+ * path metrics on 32 bits. The kernel processes four 32-bit lanes at once
+ * with SSE2 on x86, elsewhere the reference implementation is used.
+ *
+ * Path metrics must be less than 0x80000000: this holds for soft decision
+ * decoding of up to 244 bits, where the metric grows at most by 0x1FFFE at
+ * each step.
+ *
+ * @param prev: path metrics of the previous step.
+ * @param curr: path metrics of the current step.
+ * @param bm: branch metrics of the eight butterflies.
+ * @param maxBm: sum of the metrics of two complementary branches.
+ * @return decision word, bit n is set if the survivor path of state n comes
+ * from the upper half of the states.
+ */
+static inline uint16_t viterbi_acs(const uint32_t *prev, uint32_t *curr,
+                                   const uint32_t *bm, const uint32_t maxBm)
+{
+    #if defined(__SSE2__)
+    const __m128i max = _mm_set1_epi32(maxBm);
+    __m128i lt[4];
+
+    for(uint8_t h = 0; h < 2; h++)
+    {
+        const __m128i a   = _mm_loadu_si128(reinterpret_cast< const __m128i * >(prev + (4 * h)));
+        const __m128i b   = _mm_loadu_si128(reinterpret_cast< const __m128i * >(prev + (4 * h) + 8));
+        const __m128i bmv = _mm_loadu_si128(reinterpret_cast< const __m128i * >(bm + (4 * h)));
+        const __m128i ibm = _mm_sub_epi32(max, bmv);
+
+        __m128i m0 = _mm_add_epi32(a, bmv);
+        __m128i m1 = _mm_add_epi32(b, ibm);
+        __m128i m2 = _mm_add_epi32(a, ibm);
+        __m128i m3 = _mm_add_epi32(b, bmv);
+
+        // Signed comparison is fine, as metrics are less than 0x80000000
+        __m128i lt0  = _mm_cmplt_epi32(m0, m1);
+        __m128i lt1  = _mm_cmplt_epi32(m2, m3);
+        __m128i even = _mm_or_si128(_mm_and_si128(lt0, m0), _mm_andnot_si128(lt0, m1));
+        __m128i odd  = _mm_or_si128(_mm_and_si128(lt1, m2), _mm_andnot_si128(lt1, m3));
+
+        _mm_storeu_si128(reinterpret_cast< __m128i * >(curr + (8 * h)),
+                         _mm_unpacklo_epi32(even, odd));
+        _mm_storeu_si128(reinterpret_cast< __m128i * >(curr + (8 * h) + 4),
+                         _mm_unpackhi_epi32(even, odd));
+
+        lt[2 * h]     = _mm_unpacklo_epi32(lt0, lt1);
+        lt[2 * h + 1] = _mm_unpackhi_epi32(lt0, lt1);
+    }
+
+    __m128i lt8 = _mm_packs_epi16(_mm_packs_epi32(lt[0], lt[1]),
+                                  _mm_packs_epi32(lt[2], lt[3]));
+
+    return ~_mm_movemask_epi8(lt8) & 0xFFFF;
+    #else
+    return viterbi_acsScalar(prev, curr, bm, maxBm);
+    #endif
+}
+
+
 /**
  * Hard decision Viterbi decoder tailored on M17 protocol specifications,
  * that is for decoding of data encoded with a convolutional encoder with a
@@ -147,46 +378,10 @@ private:
      */
     void decodeBit(uint8_t s0, uint8_t s1, size_t pos)
     {
-        static constexpr uint8_t COST_TABLE_0[] = {0, 0, 0, 0, 2, 2, 2, 2};
-        static constexpr uint8_t COST_TABLE_1[] = {0, 2, 2, 0, 0, 2, 2, 0};
-
-        for(uint8_t i = 0; i < NumStates/2; i++)
-        {
-            uint16_t metric = std::abs(COST_TABLE_0[i] - s0)
-                            + std::abs(COST_TABLE_1[i] - s1);
-
-
-            uint16_t m0 = (*prevMetrics)[i] + metric;
-            uint16_t m1 = (*prevMetrics)[i + NumStates/2] + (4 - metric);
-
-            uint16_t m2 = (*prevMetrics)[i] + (4 - metric);
-            uint16_t m3 = (*prevMetrics)[i + NumStates/2] + metric;
-
-            uint8_t i0 = 2 * i;
-            uint8_t i1 = i0 + 1;
+        const uint16_t *bm = VITERBI_HARD_BM.bm[(3 * s0) + s1];
 
-            if(m0 >= m1)
-            {
-                history[pos].set(i0, true);
-                (*currMetrics)[i0] = m1;
-            }
-            else
-            {
-                history[pos].set(i0, false);
-                (*currMetrics)[i0] = m0;
-            }
-
-            if(m2 >= m3)
-            {
-                history[pos].set(i1, true);
-                (*currMetrics)[i1] = m3;
-            }
-            else
-            {
-                history[pos].set(i1, false);
-                (*currMetrics)[i1] = m2;
-            }
-        }
+        history[pos] = viterbi_acs(prevMetrics->data(), currMetrics->data(),
+                                   bm, 4);
 
         std::swap(currMetrics, prevMetrics);
     }
@@ -208,7 +403,7 @@ private:
         {
             bitPos--;
             pos--;
-            bool bit = history[pos].test(state >> 4);
+            bool bit = (history[pos] >> (state >> 4)) & 0x01;
             state >>= 1;
             if(bit) state |= 0x80;
             setBit(out, bitPos, bit);
@@ -235,7 +430,7 @@ private:
     std::array< uint16_t, NumStates >  prevMetricsData;
     std::array< uint16_t, NumStates >  currMetricsData;
 
-    std::array< std::bitset< NumStates >, 244 > history;
+    std::array< uint16_t, 244 > history;    ///< Decision words, one bit per state.
 };
 
 /**
@@ -295,10 +490,12 @@ public:
      * @param in: input data.
      * @param out: destination array where decoded data are written.
      * @param punctureMatrix: puncturing matrix.
-     * @return number of bit errors corrected.
+     * @return path metric of the decoded sequence, excluding the contribution
+     * of the punctured bits to within one unit per bit: a bit error received
+     * with full confidence costs 0xFFFF.
      */
     template < size_t IN, size_t OUT, size_t P >
-    uint16_t decodePunctured(const std::array< uint16_t, IN >& in,
+    uint32_t decodePunctured(const std::array< uint16_t, IN >& in,
                                    std::array< uint8_t, OUT >& out,
                              const std::array< uint8_t, P   >& punctureMatrix)
     {
@@ -336,7 +533,8 @@ public:
             histPos++;
         }
 
-        return chainback(out, histPos) - punctBitCnt;
+        // Each punctured bit adds either 0x7FFF or 0x8000 to the metric
+        return chainback(out, histPos) - (punctBitCnt * 0x7FFF);
     }
 
 private:
@@ -350,49 +548,25 @@ private:
      */
     void decodeBit(uint16_t s0, uint16_t s1, size_t pos)
     {
-        static constexpr uint16_t COST_TABLE_0[] = {0, 0, 0, 0, 0xFFFF,
-                                                    0xFFFF, 0xFFFF, 0xFFFF};
-        static constexpr uint16_t COST_TABLE_1[] = {0, 0xFFFF, 0xFFFF, 0,
-                                                    0, 0xFFFF, 0xFFFF, 0};
+        // Only four different branch metrics exist for each step, selected by
+        // the encoder outputs expected on the branch.
+        const uint32_t metrics[] =
+        {
+            static_cast< uint32_t >(s0)          + s1,
+            static_cast< uint32_t >(s0)          + (0xFFFF - s1),
+            static_cast< uint32_t >(0xFFFF - s0) + s1,
+            static_cast< uint32_t >(0xFFFF - s0) + (0xFFFF - s1)
+        };
 
+        uint32_t bm[NumStates/2];
         for(uint8_t i = 0; i < NumStates/2; i++)
         {
-            uint32_t metric = q_AbsDiff(COST_TABLE_0[i], s0)
-                            + q_AbsDiff(COST_TABLE_1[i], s1);
-
-
-            uint32_t m0 = (*prevMetrics)[i] + metric;
-            uint32_t m1 = (*prevMetrics)[i + NumStates/2] + (0x1FFFE - metric);
-
-            uint32_t m2 = (*prevMetrics)[i] + (0x1FFFE - metric);
-            uint32_t m3 = (*prevMetrics)[i + NumStates/2] + metric;
-
-            uint8_t i0 = 2 * i;
-            uint8_t i1 = i0 + 1;
-
-            if(m0 >= m1)
-            {
-                history[pos].set(i0, true);
-                (*currMetrics)[i0] = m1;
-            }
-            else
-            {
-                history[pos].set(i0, false);
-                (*currMetrics)[i0] = m0;
-            }
-
-            if(m2 >= m3)
-            {
-                history[pos].set(i1, true);
-                (*currMetrics)[i1] = m3;
-            }
-            else
-            {
-                history[pos].set(i1, false);
-                (*currMetrics)[i1] = m2;
-            }
+            bm[i] = metrics[VITERBI_BRANCH_SEL[i]];
         }
 
+        history[pos] = viterbi_acs(prevMetrics->data(), currMetrics->data(),
+                                   bm, 0x1FFFE);
+
         std::swap(currMetrics, prevMetrics);
     }
 
@@ -413,7 +587,7 @@ private:
         {
             bitPos--;
             pos--;
-            bool bit = history[pos].test(state >> 4);
+            bool bit = (history[pos] >> (state >> 4)) & 0x01;
             state >>= 1;
             if(bit) state |= 0x80;
             setBit(out, bitPos, bit);
@@ -430,20 +604,6 @@ private:
         return cost;
     }
 
-    /**
-     * Utility function to compute the absolute value of a difference between
-     * two fixed-point values.
-     *
-     * @param v1: first value
-     * @param v2: second value
-     * @return abs(v1-v2)
-     */
-    inline uint16_t q_AbsDiff(const uint16_t v1, const uint16_t v2)
-    {
-        if(v2 > v1) return v2 - v1;
-        return v1 - v2;
-    }
-
 
     static constexpr size_t K = 5;
     static constexpr size_t NumStates = (1 << (K - 1));
@@ -454,7 +614,7 @@ private:
     std::array< uint32_t, NumStates >  prevMetricsData;
     std::array< uint32_t, NumStates >  currMetricsData;
 
-    std::array< std::bitset< NumStates >, 244 > history;
+    std::array< uint16_t, 244 > history;    ///< Decision words, one bit per state.
 };
 
 }      // namespace M17
@@ -25,7 +25,11 @@
 #include <M17/M17FrameEncoder.hpp>
 #include <M17/M17Demodulator.hpp>
 #include <M17/M17Modulator.hpp>
+#include <M17/M17PacketQueue.hpp>
+#include <M17/M17Packet.hpp>
+#include <M17/M17Bert.hpp>
 #include <audio_path.h>
+#include <atomic>
 #include "OpMode.hpp"
 
 /**
@@ -95,6 +99,44 @@ public:
         return dataValid;
     }
 
+    /**
+     * Queue a data packet for transmission. Packets are sent in order, each
+     * one in its own transmission, as soon as the channel is free. This
+     * function can be called from any thread.
+     *
+     * @param data: packet data.
+     * @param len: packet length, in bytes.
+     * @return true if the packet has been queued.
+     */
+    bool queuePacket(const void *data, const size_t len)
+    {
+        return txQueue.push(data, len);
+    }
+
+    /**
+     * Get the oldest data packet received. This function can be called from
+     * any thread.
+     *
+     * @param data: destination buffer.
+     * @param size: size of the destination buffer, in bytes.
+     * @return length of the packet, zero if no packet is available.
+     */
+    size_t popPacket(void *data, const size_t size)
+    {
+        return rxQueue.pop(data, size);
+    }
+
+    /**
+     * Enable or disable the BERT mode. Enabling the BERT mode clears the
+     * bit error rate statistics. This function can be called from any thread.
+     *
+     * @param enable: true to enable the BERT mode.
+     */
+    void setBertMode(const bool enable)
+    {
+        bertReq = enable;
+    }
+
 private:
 
     /**
@@ -122,17 +164,42 @@ private:
     void txState(rtxStatus_t *const status);
 
     /**
-     * Compare two callsigns in plain text form.
-     * The comparison does not take into account the country prefixes (strips
-     * the '/' and whatever is in front from all callsigns). It does take into
-     * account the dash and whatever is after it. In case the incoming callsign
-     * is "ALL" the function returns true.
+     * Transmit the next frame of the packet being sent, terminating the
+     * transmission after the last one.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
+     */
+    void txPacketState(rtxStatus_t *const status);
+
+    /**
+     * Transmit the next BERT frame, terminating the transmission when the PTT
+     * is released.
      *
-     * \param localCs plain text callsign from the user
-     * \param incomingCs plain text destination callsign
-     * \return true if local an incoming callsigns match.
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
+     */
+    void txBertState(rtxStatus_t *const status);
+
+    /**
+     * Check if a queued packet can be transmitted, that is if TX is allowed
+     * and the channel is free.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
+     * @return true if a packet transmission can be started.
+     */
+    bool packetTxReady(rtxStatus_t *const status);
+
+    /**
+     * Decode the callsigns carried by a new Link Setup Frame, storing them in
+     * the corresponding fields of the RTX status.
+     *
+     * @param lsf: the Link Setup Frame.
+     * @param status: pointer to the rtxStatus_t structure containing the
+     * current RTX status.
      */
-    bool compareCallsigns(const std::string& localCs, const std::string& incomingCs);
+    void decodeLsf(const M17::M17LinkSetupFrame& lsf, rtxStatus_t *const status);
 
 
     bool startRx;                      ///< Flag for RX management.
@@ -142,12 +209,26 @@ private:
     bool extendedCall;                 ///< Extended callsign data received
     bool invertTxPhase;                ///< TX signal phase inversion setting.
     bool invertRxPhase;                ///< RX signal phase inversion setting.
+    bool lsfCached;                    ///< Callsigns of the current LSF already decoded.
+    uint16_t lsfCrc;                   ///< CRC of the LSF whose callsigns are decoded.
+    bool txPacket;                     ///< Current transmission carries a packet.
+    uint8_t txFrame;                   ///< Index of the next packet frame to be sent.
+    bool bertMode;                     ///< BERT mode active.
+    bool txBert;                       ///< Current transmission carries BERT frames.
+    float viterbiCost;                 ///< Viterbi path metric of the last frame received.
+    std::atomic_bool bertReq;          ///< BERT mode requested.
     pathId rxAudioPath;                ///< Audio path ID for RX
     pathId txAudioPath;                ///< Audio path ID for TX
     M17::M17Modulator    modulator;    ///< M17 modulator.
     M17::M17Demodulator  demodulator;  ///< M17 demodulator.
     M17::M17FrameDecoder decoder;      ///< M17 frame decoder
     M17::M17FrameEncoder encoder;      ///< M17 frame encoder
+    M17::M17Packet       txData;       ///< Packet being transmitted.
+    M17::M17Packet       rxData;       ///< Packet being received.
+    M17::M17PacketQueue<> txQueue;     ///< Packets waiting for transmission.
+    M17::M17PacketQueue<> rxQueue;     ///< Packets received.
+    M17::M17BertGenerator bertTx;      ///< BERT payload generator.
+    M17::M17BertReceiver  bertRx;      ///< BERT bit error rate meter.
 };
 
 #endif /* OPMODE_M17_H */
@@ -23,6 +23,7 @@
 
 #include <datatypes.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <cps.h>
 #include <pthread.h>
 
@@ -66,6 +67,14 @@ typedef struct
     char     M17_src[10];              /**  M17 LSF source             */
     char     M17_link[10];             /**  M17 LSF traffic originator */
     char     M17_refl[10];             /**  M17 LSF reflector module   */
+    bool     M17_bertEn;               /**  M17 BERT mode active       */
+    bool     M17_bertSync;             /**  M17 BERT receiver in sync  */
+    uint32_t M17_bertBits;             /**  M17 BERT bits checked      */
+    uint32_t M17_bertErrors;           /**  M17 BERT bit errors        */
+    uint32_t M17_bertFrames;           /**  M17 BERT frames received   */
+    uint32_t M17_bertLost;             /**  M17 BERT frames lost       */
+    float    M17_bertBer;              /**  M17 BERT bit error rate    */
+    float    M17_viterbiCost;          /**  M17 last frame path metric */
 }
 rtxStatus_t;
 
@@ -147,6 +156,40 @@ float rtx_getRssi();
  */
 bool rtx_rxSquelchOpen();
 
+/**
+ * Queue an M17 data packet for transmission. Packets are sent in order, each
+ * one in its own transmission, when the M17 operating mode is active and the
+ * channel is free. This function is thread-safe and can be called by any
+ * subsystem, for example to post position reports or text messages.
+ * @param data: packet data, beginning with the packet protocol identifier.
+ * @param len: packet length, in bytes, at most 823.
+ * @return true if the packet has been queued, false if its length is not
+ * valid or there is not enough space left in the queue.
+ */
+bool rtx_m17SendPacket(const void *data, const size_t len);
+
+/**
+ * Get the oldest M17 data packet received and addressed to this station. This
+ * function is thread-safe and can be called from threads other than the one
+ * running the RTX task.
+ * @param data: destination buffer.
+ * @param size: size of the destination buffer, in bytes. Packets longer than
+ * the buffer are discarded.
+ * @return length of the packet, zero if no packet is available.
+ */
+size_t rtx_m17ReceivePacket(void *data, const size_t size);
+
+/**
+ * Enable or disable the M17 BERT mode. When enabled, the M17 operating mode
+ * transmits BERT frames carrying the PRBS9 sequence while the PTT is pressed
+ * and measures the bit error rate of the BERT frames received: the statistics
+ * are reported in the M17_bert fields of the RTX status and are cleared each
+ * time the BERT mode is enabled. This function is thread-safe and can be
+ * called from threads other than the one running the RTX task.
+ * @param enable: true to enable the BERT mode.
+ */
+void rtx_m17SetBertMode(const bool enable);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,200 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <datatypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <cps.h>
+#include <rtx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Scan engine of the RTX stage.
+ *
+ * A scan list is compiled, ahead of the scan, into an array of tuning records
+ * containing only the RTX parameters changing from one channel to the other,
+ * already converted in the format used by rtxStatus_t. While scanning, the RTX
+ * task applies one record at a time to its internal status, waits for the RF
+ * stage to settle and then samples the RSSI: channels below the squelch
+ * threshold are skipped immediately, otherwise the scan dwells on the channel
+ * and stops there as long as the squelch is open.
+ *
+ * Scan lists are built by the application thread, the scan itself runs in the
+ * RTX thread.
+ */
+
+#define SCAN_MAX_ENTRIES 128    /**< Maximum number of entries of a memory scan list */
+
+/**
+ * Tuning record of a scan list entry.
+ */
+typedef struct
+{
+    freq_t   rxFrequency;       /**< RX frequency, in Hz                       */
+    freq_t   txFrequency;       /**< TX frequency, in Hz                       */
+    float    txPower;           /**< TX power, in W                            */
+    uint16_t rxTone;            /**< RX CTCSS tone, in tenths of Hz            */
+    uint16_t txTone;            /**< TX CTCSS tone, in tenths of Hz            */
+    uint16_t index;             /**< Codeplug index of the channel             */
+    uint8_t  opMode    : 2,     /**< Operating mode                            */
+             bandwidth : 2,     /**< Channel bandwidth                         */
+             rxToneEn  : 1,     /**< RX CTCSS tone enable                      */
+             txToneEn  : 1,     /**< TX CTCSS tone enable                      */
+             rxOnly    : 1,     /**< TX disabled on this channel               */
+             _unused   : 1;
+}
+scanEntry_t;
+
+/**
+ * Scan timing parameters, all times are in milliseconds.
+ */
+typedef struct
+{
+    uint16_t settleTime;        /**< Wait between a hop and the RSSI sampling  */
+    uint16_t dwellTime;         /**< Time spent on a channel above squelch     */
+    uint16_t holdTime;          /**< Time spent on a channel after squelch closes */
+}
+scanTiming_t;
+
+/**
+ * Scan statistics, reset at each scan start.
+ */
+typedef struct
+{
+    uint32_t hops;              /**< Number of channel changes                 */
+    uint32_t skipped;           /**< Channels left after the RSSI sampling     */
+    uint32_t stops;             /**< Number of times the squelch opened        */
+    uint32_t elapsed;           /**< Time elapsed since scan start, in ms      */
+    uint16_t current;           /**< Position in the scan list                 */
+}
+scanStats_t;
+
+/**
+ * Compile the scan list from the channels of a codeplug bank. Only FM and M17
+ * channels are added to the list, up to SCAN_MAX_ENTRIES entries.
+ *
+ * @param bank: index of the bank, a negative value selects all the channels.
+ * @return number of entries in the scan list, -1 if a scan is in progress.
+ */
+int scan_loadBank(const int16_t bank);
+
+/**
+ * Compile the scan list for a frequency range. Apart from the RX and TX
+ * frequency, all the entries of the list share the same parameters of the
+ * channel used as a template. The TX frequency keeps the offset of the
+ * template channel.
+ *
+ * @param channel: template channel.
+ * @param start: first RX frequency of the range, in Hz.
+ * @param stop: last RX frequency of the range, in Hz.
+ * @param step: frequency step, in Hz.
+ * @return number of entries in the scan list, -1 if a scan is in progress or
+ * if the range is not valid.
+ */
+int scan_loadRange(const channel_t *channel, const freq_t start,
+                   const freq_t stop, const freq_t step);
+
+/**
+ * Get an entry of the current scan list.
+ *
+ * @param entry: pointer to the record to be filled.
+ * @param pos: position in the scan list.
+ * @return 0 on success, -1 if the position is outside the scan list.
+ */
+int scan_getEntry(scanEntry_t *entry, const uint16_t pos);
+
+/**
+ * Request the start of the scan. The scan begins with the next update of the
+ * RTX task, the RTX configuration in place is restored when the scan stops.
+ *
+ * @param timing: scan timing parameters, NULL selects the default ones.
+ * @return 0 on success, -1 if the scan list is empty or a scan is in progress.
+ */
+int scan_start(const scanTiming_t *timing);
+
+/**
+ * Request the stop of the scan.
+ */
+void scan_stop();
+
+/**
+ * Check if a scan is in progress.
+ *
+ * @return true if the scan has been requested or is running.
+ */
+bool scan_running();
+
+/**
+ * Get the statistics of the current scan, or of the last one if no scan is in
+ * progress. Hop rate is given by the number of hops over the elapsed time.
+ *
+ * @param stats: pointer to the structure to be filled.
+ */
+void scan_getStats(scanStats_t *stats);
+
+/**
+ * Actions requested by the scan engine to the RTX task.
+ */
+enum scanAction
+{
+    SCAN_NONE   = 0,    /**< Scan not running or channel being listened  */
+    SCAN_RETUNE = 1,    /**< Configuration changed, apply and settle     */
+    SCAN_SETTLE = 2     /**< Wait for the settling of the RF stage       */
+};
+
+/**
+ * Update step of the scan engine, called by the RTX task after the RSSI
+ * update. The engine can modify the RTX status to tune a new scan list entry.
+ *
+ * @param status: RTX status.
+ * @param sqlOpen: current status of the RX squelch.
+ * @return action to be taken by the RTX task.
+ */
+enum scanAction scan_update(rtxStatus_t *status, const bool sqlOpen);
+
+/**
+ * Re-apply the tuning of the current scan list entry, called by the RTX task
+ * after a new configuration has overwritten its status. The new configuration
+ * replaces the one to be restored at the end of the scan and the current
+ * channel is probed again.
+ *
+ * @param status: RTX status.
+ * @return true if a scan is running and the status has been modified.
+ */
+bool scan_reapply(rtxStatus_t *status);
+
+/**
+ * Get the settling time of the current scan.
+ *
+ * @return settling time, in milliseconds.
+ */
+uint16_t scan_settleTime();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCAN_H */
@@ -20,6 +20,7 @@
 
 #include <audio_stream.h>
 #include <audio_codec.h>
+#include <dsp.h>
 #include <pthread.h>
 #include <threads.h>
 // codec2 system library has a weird include prefix
@@ -33,10 +34,31 @@
 #include <stdio.h>
 #include <errno.h>
 #include <dsp.h>
+#include <spsc.h>
+
+#define BUF_SIZE 8    // Must be a power of two
+
+/**
+ * Parameters of the supported CODEC2 modes.
+ */
+typedef struct
+{
+    int      c2Mode;     ///< CODEC2 library mode identifier.
+    uint8_t  bytes;      ///< Size of an encoded frame, in bytes.
+    uint16_t samples;    ///< Number of audio samples in a frame.
+}
+modeParams_t;
 
-#define BUF_SIZE 4
+static const modeParams_t modeTable[] =
+{
+    { CODEC2_MODE_3200, 8, 160 },    // CODEC_MODE_3200
+    { CODEC2_MODE_1600, 8, 320 },    // CODEC_MODE_1600
+    { CODEC2_MODE_700C, 4, 320 }     // CODEC_MODE_700C
+};
 
 static pathId           audioPath;
+static uint8_t          codecMode;
+static uint8_t          batchSize;
 
 static uint8_t          initCnt = 0;
 static bool             running;
@@ -44,15 +66,27 @@ static bool             running;
 static bool             reqStop;
 static pthread_t        codecThread;
 static pthread_attr_t   codecAttr;
-static pthread_mutex_t  data_mutex  = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t  init_mutex  = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t   wakeup_cond = PTHREAD_COND_INITIALIZER;
 
-static uint8_t          readPos;
-static uint8_t          writePos;
-static uint8_t          numElements;
+static spscQueue_t      dataQueue;
 static uint64_t         dataBuffer[BUF_SIZE];
 
+static codecSource_t    frameSource;
+static void            *sourceArg;
+static uint32_t         underruns;
+static bool             decoding;
+
+/*
+ * Overlay decoder: a second stream of frames, pulled from a source function,
+ * decoded and mixed over the main one. Used to play voice prompts over the
+ * received voice, on two paths mixed on the same sink.
+ */
+static pthread_mutex_t  overlay_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pathId           overlayPath;
+static codecSource_t    overlaySource;
+static void            *overlayArg;
+static uint8_t          overlayBatch;
+
 #ifdef PLATFORM_MOD17
 static const uint8_t micGainPre  = 4;
 static const uint8_t micGainPost = 3;
@@ -63,7 +97,9 @@ static const uint8_t micGainPost = 4;
 
 static void *encodeFunc(void *arg);
 static void *decodeFunc(void *arg);
-static bool startThread(const pathId path, void *(*func) (void *));
+static bool startThread(const pathId path, void *(*func) (void *),
+                        const uint8_t mode, const uint8_t batch,
+                        codecSource_t source, void *arg);
 static void stopThread();
 
 
@@ -73,13 +109,13 @@ void codec_init()
     initCnt += 1;
     pthread_mutex_unlock(&init_mutex);
 
-    if(initCnt > 0)
+    if(initCnt > 1)
         return;
 
-    running     = false;
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
+    running   = false;
+    codecMode = CODEC_MODE_3200;
+    batchSize = 1;
+    spsc_init(&dataQueue, dataBuffer, sizeof(uint64_t), BUF_SIZE, true);
 }
 
 void codec_terminate()
@@ -93,20 +129,48 @@ void codec_terminate()
 
     if(running)
         stopThread();
+
+    spsc_terminate(&dataQueue);
+}
+
+bool codec_startEncode(const pathId path, const uint8_t mode,
+                       const uint8_t batch)
+{
+    return startThread(path, encodeFunc, mode, batch, NULL, NULL);
 }
 
-bool codec_startEncode(const pathId path)
+bool codec_startDecode(const pathId path, const uint8_t mode,
+                       const uint8_t batch)
 {
-    return startThread(path, encodeFunc);
+    return startThread(path, decodeFunc, mode, batch, NULL, NULL);
 }
 
-bool codec_startDecode(const pathId path)
+bool codec_startDecodeFrom(const pathId path, const uint8_t mode,
+                           const uint8_t batch, codecSource_t source,
+                           void *arg)
 {
-    return startThread(path, decodeFunc);
+    if(source == NULL)
+        return false;
+
+    return startThread(path, decodeFunc, mode, batch, source, arg);
 }
 
 void codec_stop(const pathId path)
 {
+    // Detach the overlay: once the lock is released, its source function is
+    // not going to be called anymore.
+    pthread_mutex_lock(&overlay_mutex);
+    codecSource_t ovSource = overlaySource;
+    void         *ovArg    = overlayArg;
+    pathId        ovPath   = overlayPath;
+    uint8_t       ovBatch  = overlayBatch;
+    if((ovSource != NULL) && ((path == ovPath) || (path == audioPath)))
+        overlaySource = NULL;
+    pthread_mutex_unlock(&overlay_mutex);
+
+    if((ovSource != NULL) && (path == ovPath))
+        return;
+
     if(running == false)
         return;
 
@@ -114,6 +178,10 @@ void codec_stop(const pathId path)
         return;
 
     stopThread();
+
+    // The overlay outlives the main stream and keeps playing on its own
+    if(ovSource != NULL)
+        startThread(ovPath, decodeFunc, codecMode, ovBatch, ovSource, ovArg);
 }
 
 bool codec_running()
@@ -121,90 +189,121 @@ bool codec_running()
     return running;
 }
 
-int codec_popFrame(uint8_t *frame, const bool blocking)
+uint32_t codec_getUnderruns()
+{
+    return underruns;
+}
+
+size_t codec_frameSize(const uint8_t mode)
+{
+    if(mode > CODEC_MODE_700C)
+        return 0;
+
+    return modeTable[mode].bytes;
+}
+
+size_t codec_frameSamples(const uint8_t mode)
+{
+    if(mode > CODEC_MODE_700C)
+        return 0;
+
+    return modeTable[mode].samples;
+}
+
+int codec_popFrame(uint8_t *frame, const size_t size, const bool blocking)
 {
     if(running == false)
         return -EPERM;
 
-    uint64_t element;
+    size_t frameSize = modeTable[codecMode].bytes;
+    size_t numFrames = size / frameSize;
 
-    // No data available and non-blocking call: just return false.
-    if((numElements == 0) && (blocking == false))
+    if((numFrames == 0) || (numFrames > BUF_SIZE) || ((size % frameSize) != 0))
+        return -EINVAL;
+
+    // Non-blocking call returns immediately if not enough frames are present.
+    // Elements can only be added by the encoder, thus the check stays valid.
+    if((blocking == false) && (spsc_size(&dataQueue) < numFrames))
         return -EAGAIN;
 
-    // Blocking call: wait until some data is pushed
-    pthread_mutex_lock(&data_mutex);
-    while(numElements == 0)
+    for(size_t i = 0; i < numFrames; i++)
     {
-        pthread_cond_wait(&wakeup_cond, &data_mutex);
-    }
+        uint64_t element;
 
-    element      = dataBuffer[readPos];
-    readPos      = (readPos + 1) % BUF_SIZE;
-    numElements -= 1;
-    pthread_mutex_unlock(&data_mutex);
+        // Blocking call: wait until some data is pushed. If the wait ends
+        // without data, the frames already popped are not lost: return them.
+        if(spsc_pop(&dataQueue, &element, blocking) == false)
+            return (i > 0) ? (int) (i * frameSize) : -EAGAIN;
 
-    // Do memcpy after mutex unlock to reduce execution time spent inside the
-    // critical section
-    memcpy(frame, &element, 8);
+        memcpy(frame + (i * frameSize), &element, frameSize);
+    }
 
-    return 0;
+    return numFrames * frameSize;
 }
 
-int codec_pushFrame(const uint8_t *frame, const bool blocking)
+int codec_pushFrame(const uint8_t *frame, const size_t size, const bool blocking)
 {
     if(running == false)
         return -EPERM;
 
-    // Copy data to a temporary variable before mutex lock to reduce execution
-    // time spent inside the critical section
-    uint64_t element;
-    memcpy(&element, frame, 8);
+    size_t frameSize = modeTable[codecMode].bytes;
+    size_t numFrames = size / frameSize;
 
+    if((numFrames == 0) || (numFrames > BUF_SIZE) || ((size % frameSize) != 0))
+        return -EINVAL;
 
-    // No space available and non-blocking call: return
-    if((numElements >= BUF_SIZE) && (blocking == false))
+    // Non-blocking call returns immediately if there is not enough free space.
+    // Free space can only grow when the decoder pops, thus the check stays valid.
+    if((blocking == false) && ((BUF_SIZE - spsc_size(&dataQueue)) < numFrames))
         return -EAGAIN;
 
-    // Blocking call: wait until there is some free space
-    pthread_mutex_lock(&data_mutex);
-    while(numElements >= BUF_SIZE)
+    for(size_t i = 0; i < numFrames; i++)
     {
-        pthread_cond_wait(&wakeup_cond, &data_mutex);
-    }
+        uint64_t element = 0;
+        memcpy(&element, frame + (i * frameSize), frameSize);
 
-    // There is free space, push data into the queue
-    dataBuffer[writePos] = element;
-    writePos = (writePos + 1) % BUF_SIZE;
-    numElements += 1;
+        // Blocking call: wait until there is some free space
+        if(spsc_push(&dataQueue, &element, blocking) == false)
+            return -EAGAIN;
+    }
 
-    pthread_mutex_unlock(&data_mutex);
     return 0;
 }
 
 
 
-
 static void *encodeFunc(void *arg)
 {
 
-    streamId        iStream;
-    pathId          iPath = (pathId) arg;
-    stream_sample_t audioBuf[320];
-    struct CODEC2   *codec2;
-    filter_state_t  dcrState;
+    streamId         iStream;
+    pathId           iPath    = (pathId) arg;
+    const size_t     nSamples = modeTable[codecMode].samples;
+    const size_t     blockLen = batchSize * nSamples;
+    stream_sample_t *audioBuf;
+    struct CODEC2    *codec2;
+    filter_state_t   dcrState;
+
+    // Double buffered stream, each half holds a batch of frames
+    audioBuf = (stream_sample_t *) malloc(2 * blockLen * sizeof(stream_sample_t));
+    if(audioBuf == NULL)
+    {
+        pthread_detach(pthread_self());
+        running = false;
+        return NULL;
+    }
 
-    iStream = audioStream_start(iPath, audioBuf, 320, 8000,
+    iStream = audioStream_start(iPath, audioBuf, 2 * blockLen, 8000,
                                 STREAM_INPUT | BUF_CIRC_DOUBLE);
     if(iStream < 0)
     {
+        free(audioBuf);
         pthread_detach(pthread_self());
         running = false;
         return NULL;
     }
 
     dsp_resetFilterState(&dcrState);
-    codec2 = codec2_create(CODEC2_MODE_3200);
+    codec2 = codec2_create(modeTable[codecMode].c2Mode);
 
     while(reqStop == false)
     {
@@ -217,45 +316,25 @@ static void *encodeFunc(void *arg)
             break;
 
         #ifndef PLATFORM_LINUX
-        // Pre-amplification stage
-        for(size_t i = 0; i < audio.len; i++) audio.data[i] *= micGainPre;
-
-        // DC removal
-        dsp_dcRemoval(&dcrState, audio.data, audio.len);
-
-        // Post-amplification stage
-        for(size_t i = 0; i < audio.len; i++) audio.data[i] *= micGainPost;
+        // Pre-amplification, DC removal and post-amplification stages
+        dsp_dcRemovalGain(&dcrState, audio.data, audio.len, micGainPre,
+                          micGainPost);
         #endif
 
-        // CODEC2 encodes 160ms of speech into 8 bytes: here we write the
-        // new encoded data into a buffer of 16 bytes writing the first
-        // half and then the second one, sequentially.
-        // Data ready flag is rised once all the 16 bytes contain new data.
-        uint64_t frame = 0;
-        codec2_encode(codec2, ((uint8_t*) &frame), audio.data);
-
-        pthread_mutex_lock(&data_mutex);
-
-        // If buffer is full erase the oldest frame
-        if(numElements >= BUF_SIZE)
+        // Encode all the frames of the batch, each one is pushed to the
+        // queue as soon as it is ready. If the queue is full the oldest
+        // frame gets erased.
+        for(size_t i = 0; i < batchSize; i++)
         {
-            readPos = (readPos + 1) % BUF_SIZE;
+            uint64_t frame = 0;
+            codec2_encode(codec2, ((uint8_t*) &frame), audio.data + (i * nSamples));
+            spsc_pushOverwrite(&dataQueue, &frame);
         }
-
-        dataBuffer[writePos] = frame;
-        writePos = (writePos + 1) % BUF_SIZE;
-
-        if(numElements == 0)
-            pthread_cond_signal(&wakeup_cond);
-
-        if(numElements < BUF_SIZE)
-            numElements += 1;
-
-        pthread_mutex_unlock(&data_mutex);
     }
 
     audioStream_terminate(iStream);
     codec2_destroy(codec2);
+    free(audioBuf);
 
     // In case thread terminates due to invalid path or stream error, detach it
     // to ensure that its memory gets freed by the OS.
@@ -268,23 +347,41 @@ static void *encodeFunc(void *arg)
 
 static void *decodeFunc(void *arg)
 {
-    streamId        oStream;
-    pathId          oPath = (pathId) arg;
-    stream_sample_t audioBuf[320];
-    struct CODEC2   *codec2;
+    streamId         oStream;
+    pathId           oPath    = (pathId) arg;
+    const size_t     nSamples = modeTable[codecMode].samples;
+    const size_t     blockLen = batchSize * nSamples;
+    stream_sample_t *streamBuf;
+    stream_sample_t *decodeBuf;
+    struct CODEC2    *codec2;
+    struct CODEC2    *ovCodec2 = NULL;
+
+    // Double buffered stream, each half holds a batch of frames, followed by
+    // a frame of decoded samples to be mixed.
+    streamBuf = (stream_sample_t *) malloc((2 * blockLen + nSamples)
+                                           * sizeof(stream_sample_t));
+    if(streamBuf == NULL)
+    {
+        pthread_detach(pthread_self());
+        running = false;
+        return NULL;
+    }
+
+    decodeBuf = streamBuf + (2 * blockLen);
 
     // Open output stream
-    memset(audioBuf, 0x00, 320 * sizeof(stream_sample_t));
-    oStream = audioStream_start(oPath, audioBuf, 320, 8000,
+    memset(streamBuf, 0x00, 2 * blockLen * sizeof(stream_sample_t));
+    oStream = audioStream_start(oPath, streamBuf, 2 * blockLen, 8000,
                                 STREAM_OUTPUT | BUF_CIRC_DOUBLE);
     if(oStream < 0)
     {
+        free(streamBuf);
         pthread_detach(pthread_self());
         running = false;
         return NULL;
     }
 
-    codec2 = codec2_create(CODEC2_MODE_3200);
+    codec2 = codec2_create(modeTable[codecMode].c2Mode);
 
     // Ensure that thread start is correctly synchronized with the output
     // stream to avoid having the decode function writing in a memory area
@@ -298,42 +395,68 @@ static void *decodeFunc(void *arg)
         if(audioPath_getStatus(oPath) != PATH_OPEN)
             break;
 
-        // Try popping data from the queue
-        uint64_t frame   = 0;
-        bool     newData = false;
-
-        pthread_mutex_lock(&data_mutex);
-
-        if(numElements != 0)
-        {
-            frame        = dataBuffer[readPos];
-            readPos      = (readPos + 1) % BUF_SIZE;
-            if(numElements >= BUF_SIZE)
-                pthread_cond_signal(&wakeup_cond);
-
-            numElements -= 1;
-            newData      = true;
-        }
-
-        pthread_mutex_unlock(&data_mutex);
-
         stream_sample_t *audioBuf = outputStream_getIdleBuffer(oStream);
         if(audioBuf == NULL)
             break;
 
-        if(newData)
-        {
-            codec2_decode(codec2, audioBuf, ((uint8_t *) &frame));
-
-            #ifdef PLATFORM_MD3x0
-            // Bump up volume a little bit, as on MD3x0 is quite low
-            for(size_t i = 0; i < 160; i++) audioBuf[i] *= 2;
-            #endif
-
-        }
-        else
+        // Decode a batch of frames, filling with silence the slots for which
+        // no data is available in the queue. Decoded frames are mixed in the
+        // output buffer with the gain of their path, which gets ducked while a
+        // mixed path with higher priority is open on the same sink.
+        for(size_t i = 0; i < batchSize; i++)
         {
-            memset(audioBuf, 0x00, 160 * sizeof(stream_sample_t));
+            uint64_t         frame = 0;
+            stream_sample_t *out   = audioBuf + (i * nSamples);
+            int              ret;
+
+            memset(out, 0x00, nSamples * sizeof(stream_sample_t));
+
+            if(frameSource != NULL)
+                ret = frameSource((uint8_t *) &frame, sourceArg);
+            else
+                ret = spsc_pop(&dataQueue, &frame, false) ? 1 : 0;
+
+            if(ret > 0)
+            {
+                codec2_decode(codec2, decodeBuf, ((uint8_t *) &frame));
+
+                #ifdef PLATFORM_MD3x0
+                // Bump up volume a little bit, as on MD3x0 is quite low
+                dsp_applyGain(decodeBuf, nSamples, 2);
+                #endif
+
+                audioPath_mix(oPath, out, decodeBuf, nSamples);
+            }
+            else if(ret == 0)
+            {
+                // Missing frame before the end of the stream
+                underruns++;
+            }
+
+            pthread_mutex_lock(&overlay_mutex);
+            if((overlaySource != NULL) && (ovCodec2 == NULL))
+                ovCodec2 = codec2_create(modeTable[codecMode].c2Mode);
+
+            if((overlaySource != NULL) && (ovCodec2 != NULL))
+            {
+                frame = 0;
+                if(overlaySource((uint8_t *) &frame, overlayArg) > 0)
+                {
+                    codec2_decode(ovCodec2, decodeBuf, ((uint8_t *) &frame));
+
+                    #ifdef PLATFORM_MD3x0
+                    dsp_applyGain(decodeBuf, nSamples, 2);
+                    #endif
+
+                    audioPath_mix(overlayPath, out, decodeBuf, nSamples);
+                }
+            }
+            else if((overlaySource == NULL) && (ovCodec2 != NULL))
+            {
+                codec2_destroy(ovCodec2);
+                ovCodec2 = NULL;
+            }
+            pthread_mutex_unlock(&overlay_mutex);
         }
 
         outputStream_sync(oStream, true);
@@ -342,6 +465,9 @@ static void *decodeFunc(void *arg)
     // Stop stream and wait until its effective termination
     audioStream_stop(oStream);
     codec2_destroy(codec2);
+    if(ovCodec2 != NULL)
+        codec2_destroy(ovCodec2);
+    free(streamBuf);
 
     // In case thread terminates due to invalid path or stream error, detach it
     // to ensure that its memory gets freed by the OS.
@@ -352,29 +478,81 @@ static void *decodeFunc(void *arg)
     return NULL;
 }
 
-static bool startThread(const pathId path, void *(*func) (void *))
+static bool startThread(const pathId path, void *(*func) (void *),
+                        const uint8_t mode, const uint8_t batch,
+                        codecSource_t source, void *arg)
 {
     // Bad incoming path
     if(audioPath_getStatus(path) != PATH_OPEN)
         return false;
 
+    // Bad codec configuration
+    if((mode > CODEC_MODE_700C) || (batch == 0) || (batch > CODEC_MAX_BATCH))
+        return false;
+
     // Handle access contention when starting the codec thread to ensure that
     // only one call at a time can effectively start the thread.
     pthread_mutex_lock(&init_mutex);
+    codecSource_t ovSource = NULL;
+    void         *ovArg    = NULL;
+    pathId        ovPath   = 0;
+    uint8_t       ovBatch  = 0;
+
     if(running)
     {
-        // Same path as before, path open, codec already running: all good.
-        if(path == audioPath)
+        bool sameConfig = (mode == codecMode) && (batch == batchSize) &&
+                          (source == frameSource) && (arg == sourceArg);
+
+        // Same path and configuration as before, path open, codec already
+        // running: all good.
+        if((path == audioPath) && sameConfig)
         {
             pthread_mutex_unlock(&init_mutex);
             return true;
         }
 
+        // Decoding on two paths mixed together: the stream pulled from a
+        // source function is decoded as an overlay of the one coming from the
+        // queue, instead of replacing it.
+        bool overlay = decoding && (func == decodeFunc) &&
+                       (mode == codecMode) && (overlaySource == NULL) &&
+                       audioPath_mixable(path, audioPath);
+
+        if(overlay && (source != NULL) && (frameSource == NULL))
+        {
+            pthread_mutex_lock(&overlay_mutex);
+            overlayPath   = path;
+            overlaySource = source;
+            overlayArg    = arg;
+            overlayBatch  = batch;
+            pthread_mutex_unlock(&overlay_mutex);
+
+            pthread_mutex_unlock(&init_mutex);
+            return true;
+        }
+
+        // Queue-based stream requested while a source function is decoded:
+        // restart the codec with the latter as the overlay.
+        if(overlay && (source == NULL) && (frameSource != NULL))
+        {
+            ovSource = frameSource;
+            ovArg    = sourceArg;
+            ovPath   = audioPath;
+            ovBatch  = batchSize;
+            stopThread();
+        }
+
         // New path takes over the current one only if it has an higher priority
-        // or the current one is closed/suspended.
+        // or the current one is closed/suspended. A new configuration on the
+        // same path restarts the codec.
         pathInfo_t newPath = audioPath_getInfo(path);
         pathInfo_t curPath = audioPath_getInfo(audioPath);
-        if((curPath.status == PATH_OPEN) && (curPath.prio >= newPath.prio))
+        if(ovSource != NULL)
+        {
+            // Already stopped above
+        }
+        else if((path != audioPath) && (curPath.status == PATH_OPEN) &&
+                (curPath.prio >= newPath.prio))
         {
             pthread_mutex_unlock(&init_mutex);
             return false;
@@ -385,14 +563,28 @@ static bool startThread(const pathId path, void *(*func) (void *))
         }
     }
 
-    running   = true;
-    audioPath = path;
+    running     = true;
+    audioPath   = path;
+    codecMode   = mode;
+    batchSize   = batch;
+    frameSource = source;
+    sourceArg   = arg;
+    decoding    = (func == decodeFunc);
+    underruns   = 0;
+
+    if(ovSource != NULL)
+    {
+        pthread_mutex_lock(&overlay_mutex);
+        overlayPath   = ovPath;
+        overlaySource = ovSource;
+        overlayArg    = ovArg;
+        overlayBatch  = ovBatch;
+        pthread_mutex_unlock(&overlay_mutex);
+    }
     pthread_mutex_unlock(&init_mutex);
 
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
-    reqStop     = false;
+    spsc_reset(&dataQueue);
+    reqStop = false;
 
     pthread_attr_init(&codecAttr);
 
@@ -424,6 +616,11 @@ static void stopThread()
     pthread_join(codecThread, NULL);
     running = false;
 
+    // The overlay does not survive the stream it was mixed to
+    pthread_mutex_lock(&overlay_mutex);
+    overlaySource = NULL;
+    pthread_mutex_unlock(&overlay_mutex);
+
     #ifdef __ZEPHYR__
     void  *addr;
     size_t size;
@@ -19,8 +19,13 @@
  ***************************************************************************/
 
 #include <audio_path.h>
-#include <map>
-#include <set>
+#include <cstddef>
+
+#define MAX_NUM_PATHS 8     // Maximum number of paths existing at the same time
+#define SLOT_BITS     3     // Bits of the path ID used for the slot index
+
+static_assert(MAX_NUM_PATHS <= (1 << SLOT_BITS), "Path slots exceed ID space");
+static_assert(MAX_NUM_PATHS <= 16, "Path slots exceed relationship masks");
 
 /**
  * \internal
@@ -74,100 +79,198 @@ struct Path
 
         return audio_checkPathCompatibility(p1Source, p1Sink, p2Source, p2Sink);
     }
-
-    bool operator<(const Path& other) const
-    {
-        if((isValid() == false) || (other.isValid() == false))
-            return false;
-
-        return (source      < other.source) &&
-               (destination < other.destination);
-    }
 };
 
 /**
  * \internal
- * Data structure representing an established audio route.
+ * Data structure representing an established audio route. Relationships with
+ * the other routes are stored as bitmasks of route slots.
  */
 struct Route
 {
-    Path path;                    ///< Path associated to this route.
-    std::set< int > suspendList;  ///< Suspended paths with lower priority.
-    std::set< int > suspendedBy;  ///< List of paths which suspended this route.
+    pathId   id          = 0;                  ///< Path ID, zero if slot is free.
+    Path     path;                             ///< Path associated to this route.
+    uint16_t suspendList = 0;                  ///< Suspended paths with lower priority.
+    uint16_t suspendedBy = 0;                  ///< Paths which suspended this route.
+    uint16_t gain        = AUDIO_GAIN_UNITY;   ///< Gain requested for the path.
+    bool     mixed       = false;              ///< Path can be mixed on its sink.
 
     bool isActive() const
     {
-        return suspendedBy.empty();
+        return suspendedBy == 0;
+    }
+
+    bool canMixWith(const Route& other) const
+    {
+        return mixed && other.mixed &&
+               (path.destination == other.path.destination);
     }
 };
 
 
-static std::set< int >        activePaths;      // IDs of currently active paths.
-static std::map< int, Route > routes;           // Route data of currently active paths.
-static int                    pathCounter = 1;  // Counter for path ID generation.
+static Route routes[MAX_NUM_PATHS];     // Route data, one slot per path.
+static int   pathCounter = 1;           // Counter for path ID generation.
 
 
-pathId audioPath_request(enum AudioSource source, enum AudioSink sink,
-                         enum AudioPriority prio)
+/**
+ * \internal
+ * Get the route associated to a given path ID.
+ *
+ * @param id: path ID.
+ * @return pointer to the route or nullptr if the path does not exist.
+ */
+static inline Route *getRoute(const pathId id)
+{
+    if(id <= 0)
+        return nullptr;
+
+    Route *route = &routes[id & ((1 << SLOT_BITS) - 1)];
+    if(route->id != id)
+        return nullptr;
+
+    return route;
+}
+
+/**
+ * \internal
+ * Close the hardware connection of a route, unless it is still used by another
+ * active route mixed on the same connection.
+ *
+ * @param slot: slot of the route.
+ */
+static void closeRoute(const size_t slot)
+{
+    const Route& route = routes[slot];
+
+    for(size_t i = 0; i < MAX_NUM_PATHS; i++)
+    {
+        const Route& other = routes[i];
+        if((i == slot) || (other.id == 0) || (other.isActive() == false))
+            continue;
+
+        if(route.canMixWith(other) && (route.path.source == other.path.source))
+            return;
+    }
+
+    route.path.close();
+}
+
+/**
+ * \internal
+ * Set up a new route, either exclusive or mixed.
+ *
+ * @param path: path to be established.
+ * @param mixed: route can share its sink with other mixed routes.
+ * @param gain: gain of the route.
+ * @return path ID or -1 if the route cannot be established.
+ */
+static pathId requestRoute(const Path& path, const bool mixed,
+                           const uint16_t gain)
 {
-    const Path path{source, sink, prio};
     if (!path.isValid())
         return -1;
 
-    std::set< int > pathsToSuspend;
+    // Search for a free slot
+    size_t slot = MAX_NUM_PATHS;
+    for(size_t i = 0; i < MAX_NUM_PATHS; i++)
+    {
+        if(routes[i].id == 0)
+        {
+            slot = i;
+            break;
+        }
+    }
+
+    if(slot >= MAX_NUM_PATHS)
+        return -1;
+
+    Route newRoute;
+    newRoute.path  = path;
+    newRoute.mixed = mixed;
+    newRoute.gain  = gain;
+
+    uint16_t pathsToSuspend = 0;
 
     // Check if this new path can be activated, otherwise return -1
-    for (const auto& id : activePaths)
+    for(size_t i = 0; i < MAX_NUM_PATHS; i++)
     {
-        const Path& activePath = routes.at(id).path;
-        if(path.isCompatible(activePath))
+        const Route& active = routes[i];
+        if((active.id == 0) || (active.isActive() == false))
+            continue;
+
+        // Mixed paths on the same sink coexist, the ones with lower priority
+        // get ducked.
+        if(newRoute.canMixWith(active))
+            continue;
+
+        if(path.isCompatible(active.path))
             continue;
 
         // Not compatible where active one has higher priority
-        if(activePath.priority >= path.priority)
+        if(active.path.priority >= path.priority)
             return -1;
 
         // Active path has lower priority than this new one
-        pathsToSuspend.insert(id);
+        pathsToSuspend |= (1 << i);
     }
 
     // New path can be activated
-    const int newPathId = pathCounter;
+    newRoute.id          = (pathCounter << SLOT_BITS) | slot;
+    newRoute.suspendList = pathsToSuspend;
     pathCounter += 1;
-    const Route newRoute{path, pathsToSuspend, {}};
+    if((pathCounter << SLOT_BITS) <= 0)
+        pathCounter = 1;
 
-    // Move active paths that should be suspended to the suspend-list and
-    // close them to free resources for the new path.
-    for(const auto& id : pathsToSuspend)
+    // Suspend the active paths with lower priority and close them to free
+    // resources for the new path.
+    for(size_t i = 0; i < MAX_NUM_PATHS; i++)
     {
-        activePaths.erase(id);
-        routes.at(id).suspendedBy.insert(newPathId);
-        routes.at(id).path.close();
+        if((pathsToSuspend & (1 << i)) != 0)
+        {
+            routes[i].suspendedBy |= (1 << slot);
+            closeRoute(i);
+        }
     }
 
     // Set this new path as active and open it
-    routes.insert(std::make_pair(newPathId, newRoute));
-    activePaths.insert(newPathId);
+    routes[slot] = newRoute;
     path.open();
 
-    return newPathId;
+    return newRoute.id;
 }
 
+
+pathId audioPath_request(enum AudioSource source, enum AudioSink sink,
+                         enum AudioPriority prio)
+{
+    const Path path{source, sink, prio};
+    return requestRoute(path, false, AUDIO_GAIN_UNITY);
+}
+
+pathId audioPath_requestMixed(enum AudioSource source, enum AudioSink sink,
+                              enum AudioPriority prio, const uint16_t gain)
+{
+    // Only audio generated by the MCU can be mixed in software
+    const Path path{source, sink, prio};
+    return requestRoute(path, (source == SOURCE_MCU), gain);
+}
+
+
 pathInfo_t audioPath_getInfo(const pathId id)
 {
     pathInfo_t info = {0, 0, 0, 0};
 
-    const auto it = routes.find(id);
-    if(it == routes.end())
+    const Route *route = getRoute(id);
+    if(route == nullptr)
     {
         info.status = PATH_CLOSED;
         return info;
     }
 
-    info.source = it->second.path.source;
-    info.sink   = it->second.path.destination;
-    info.prio   = it->second.path.priority;
-    if(it->second.isActive())
+    info.source = route->path.source;
+    info.sink   = route->path.destination;
+    info.prio   = route->path.priority;
+    if(route->isActive())
         info.status = PATH_OPEN;
     else
         info.status = PATH_SUSPENDED;
@@ -177,72 +280,130 @@ pathInfo_t audioPath_getInfo(const pathId id)
 
 enum PathStatus audioPath_getStatus(const pathId id)
 {
-    const auto it = routes.find(id);
+    const Route *route = getRoute(id);
 
-    if(it == routes.end())
+    if(route == nullptr)
         return PATH_CLOSED;
 
-    if(it->second.isActive())
+    if(route->isActive())
         return PATH_OPEN;
 
     return PATH_SUSPENDED;
 }
 
+bool audioPath_mixable(const pathId id1, const pathId id2)
+{
+    const Route *r1 = getRoute(id1);
+    const Route *r2 = getRoute(id2);
+
+    if((r1 == nullptr) || (r2 == nullptr))
+        return false;
+
+    if((r1->isActive() == false) || (r2->isActive() == false))
+        return false;
+
+    return r1->canMixWith(*r2);
+}
+
+uint16_t audioPath_getGain(const pathId id)
+{
+    const Route *route = getRoute(id);
+
+    if((route == nullptr) || (route->isActive() == false))
+        return 0;
+
+    // Duck the path if an active mixed path with higher priority shares the
+    // same sink.
+    for(size_t i = 0; i < MAX_NUM_PATHS; i++)
+    {
+        const Route& other = routes[i];
+        if((other.id == 0) || (other.isActive() == false))
+            continue;
+
+        if(route->canMixWith(other) &&
+           (other.path.priority > route->path.priority))
+            return (route->gain * AUDIO_GAIN_DUCK) / AUDIO_GAIN_UNITY;
+    }
+
+    return route->gain;
+}
+
+void audioPath_setGain(const pathId id, const uint16_t gain)
+{
+    Route *route = getRoute(id);
+
+    if(route != nullptr)
+        route->gain = gain;
+}
+
+void audioPath_mix(const pathId id, stream_sample_t *dst,
+                   const stream_sample_t *src, const size_t length)
+{
+    int32_t gain = audioPath_getGain(id);
+    if(gain == 0)
+        return;
+
+    for(size_t i = 0; i < length; i++)
+    {
+        int32_t sample = dst[i] + ((src[i] * gain) / AUDIO_GAIN_UNITY);
+
+        if(sample > INT16_MAX) sample = INT16_MAX;
+        if(sample < INT16_MIN) sample = INT16_MIN;
+
+        dst[i] = static_cast< stream_sample_t >(sample);
+    }
+}
+
 void audioPath_release(const pathId id)
 {
-    auto it = routes.find(id);
-    if(it == routes.end())  // Does not exists
+    Route *route = getRoute(id);
+    if(route == nullptr)    // Does not exists
         return;
 
-    Route routeToRemove = it->second;
-    routes.erase(it);
-    activePaths.erase(id);
+    size_t   slot          = id & ((1 << SLOT_BITS) - 1);
+    uint16_t bit           = (1 << slot);
+    Route    routeToRemove = *route;
 
     // If path is active, close it
     if(routeToRemove.isActive())
-        routeToRemove.path.close();
-
-    /*
-     * For each path that suspended the one to be removed:
-     * - remove the ID from its suspend list.
-     * - add to its suspend list the paths suspended by the one being removed.
-     */
-    for(const auto& i : routeToRemove.suspendedBy)
-    {
-        auto& suspendList = routes.at(i).suspendList;
-        suspendList.erase(id);
+        closeRoute(slot);
 
-        for(const auto& j : routeToRemove.suspendList)
-            suspendList.insert(j);
-    }
+    *route = Route();
 
-    /*
-     * For each path suspended by the one to be removed:
-     * - remove the ID from their suspended-by list.
-     * - add to their suspended-by list the paths which suspended the one being
-     *   removed.
-     * - if the path to be removed was not suspended by any other path, resume
-     *   the path.
-     */
-    for(const auto& i : routeToRemove.suspendList)
+    for(size_t i = 0; i < MAX_NUM_PATHS; i++)
     {
-        auto& suspendedBy = routes.at(i).suspendedBy;
-        suspendedBy.erase(id);
+        Route& other = routes[i];
+        if(other.id == 0)
+            continue;
 
-        if(routeToRemove.suspendedBy.empty() == false)
+        /*
+         * For each path that suspended the one to be removed:
+         * - remove the ID from its suspend list.
+         * - add to its suspend list the paths suspended by the one being
+         *   removed.
+         */
+        if((routeToRemove.suspendedBy & (1 << i)) != 0)
         {
-            // If I was suspended, propagate who suspended me
-            for(const auto& j : routeToRemove.suspendedBy)
-                suspendedBy.insert(j);
+            other.suspendList &= ~bit;
+            other.suspendList |= routeToRemove.suspendList;
         }
-        else
+
+        /*
+         * For each path suspended by the one to be removed:
+         * - remove the ID from their suspended-by list.
+         * - add to their suspended-by list the paths which suspended the one
+         *   being removed.
+         * - if the path to be removed was not suspended by any other path,
+         *   resume the path.
+         */
+        if((routeToRemove.suspendList & (1 << i)) != 0)
         {
+            other.suspendedBy &= ~bit;
+            other.suspendedBy |= routeToRemove.suspendedBy;
+
             // This path can be started again
-            if(suspendedBy.empty())
-            {
-                activePaths.insert(i);
-                routes.at(i).path.open();
-            }
+            if(other.isActive())
+                other.path.open();
         }
     }
 }
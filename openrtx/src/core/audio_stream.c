@@ -19,6 +19,8 @@
  ***************************************************************************/
 
 #include <audio_stream.h>
+#include <pthread.h>
+#include <string.h>
 #include <errno.h>
 
 #define MAX_NUM_STREAMS 3
@@ -29,9 +31,20 @@ struct streamState
     const struct audioDevice *dev;
     struct streamCtx          ctx;
     pathId                    path;
+
+    // Shared input stream management
+    uint8_t          numReaders;                     ///< Zero if not shared.
+    bool             syncing;                        ///< A reader is waiting for the driver.
+    size_t           history;                        ///< Number of history samples.
+    stream_sample_t *block;                          ///< Last block acquired.
+    size_t           blockLen;                       ///< Length of the last block.
+    uint32_t         seq;                            ///< Sequence number of the last block.
+    uint32_t         readerSeq[MAX_STREAM_READERS];  ///< Last block leased by each reader.
 };
 
 static struct streamState streams[MAX_NUM_STREAMS] = {0};
+static pthread_mutex_t    leaseMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t     leaseCond  = PTHREAD_COND_INITIALIZER;
 
 
 /**
@@ -120,6 +133,7 @@ streamId audioStream_start(const pathId path, stream_sample_t * const buf,
     // Setup new stream and start it
     streams[id].path           = path;
     streams[id].dev            = dev;
+    streams[id].numReaders     = 0;
     streams[id].ctx.buffer     = buf;
     streams[id].ctx.bufMode    = (mode & 0x0F);
     streams[id].ctx.bufSize    = length;
@@ -209,3 +223,146 @@ bool outputStream_sync(const streamId id, const bool bufChanged)
 
     return true;
 }
+
+streamId inputStream_startShared(const pathId path, stream_sample_t * const buf,
+                                 const size_t length, const size_t history,
+                                 const uint32_t sampleRate, const uint8_t readers)
+{
+    if((buf == NULL) || (readers == 0) || (readers > MAX_STREAM_READERS))
+        return -EINVAL;
+
+    // History samples of the second half of the buffer are the tail of the
+    // first half: history length cannot exceed half of the data area.
+    if((length <= history) || (history > ((length - history) / 2)))
+        return -EINVAL;
+
+    streamId id = audioStream_start(path, buf + history, length - history,
+                                    sampleRate, STREAM_INPUT | BUF_CIRC_DOUBLE);
+    if(id < 0)
+        return id;
+
+    memset(buf, 0x00, history * sizeof(stream_sample_t));
+
+    pthread_mutex_lock(&leaseMutex);
+    streams[id].history    = history;
+    streams[id].block      = NULL;
+    streams[id].blockLen   = 0;
+    streams[id].seq        = 0;
+    streams[id].syncing    = false;
+    streams[id].numReaders = readers;
+    for(size_t i = 0; i < MAX_STREAM_READERS; i++)
+        streams[id].readerSeq[i] = 0;
+    pthread_mutex_unlock(&leaseMutex);
+
+    return id;
+}
+
+streamLease_t inputStream_acquire(const streamId id, const uint8_t reader)
+{
+    streamLease_t lease;
+    memset(&lease, 0x00, sizeof(streamLease_t));
+
+    if(validateStream(id) == false)
+        return lease;
+
+    struct streamState *s = &streams[id];
+    if(reader >= s->numReaders)
+        return lease;
+
+    pthread_mutex_lock(&leaseMutex);
+
+    // Current block already leased by this reader, wait for a new one. The
+    // first reader getting here synchronises with the driver, the other ones
+    // wait for the new block to be published.
+    while(s->readerSeq[reader] == s->seq)
+    {
+        if(s->path == 0)
+        {
+            pthread_mutex_unlock(&leaseMutex);
+            return lease;
+        }
+
+        if(s->syncing)
+        {
+            pthread_cond_wait(&leaseCond, &leaseMutex);
+            continue;
+        }
+
+        s->syncing = true;
+        pthread_mutex_unlock(&leaseMutex);
+
+        stream_sample_t *block = NULL;
+        int ret = s->dev->driver->sync(&(s->ctx), false);
+        if(ret >= 0)
+            ret = s->dev->driver->data(&(s->ctx), &block);
+
+        pthread_mutex_lock(&leaseMutex);
+        s->syncing = false;
+
+        if(ret < 0)
+        {
+            pthread_cond_broadcast(&leaseCond);
+            pthread_mutex_unlock(&leaseMutex);
+            return lease;
+        }
+
+        s->block    = block;
+        s->blockLen = (size_t) ret;
+        s->seq     += 1;
+        pthread_cond_broadcast(&leaseCond);
+    }
+
+    lease.data    = s->block;
+    lease.len     = s->blockLen;
+    lease.history = s->history;
+    lease.seq     = s->seq;
+    lease.lost    = s->seq - s->readerSeq[reader] - 1;
+    lease.reader  = reader;
+    s->readerSeq[reader] = s->seq;
+
+    pthread_mutex_unlock(&leaseMutex);
+
+    return lease;
+}
+
+bool inputStream_release(const streamId id, const streamLease_t *lease)
+{
+    if((id < 0) || (id >= MAX_NUM_STREAMS) || (lease == NULL))
+        return false;
+
+    if(lease->data == NULL)
+        return false;
+
+    struct streamState *s = &streams[id];
+    pthread_mutex_lock(&leaseMutex);
+
+    // A newer block has been published meanwhile: the data of this lease has
+    // already been overwritten by the driver.
+    bool valid = (lease->seq == s->seq);
+
+    // When the primary reader releases the second half of the buffer, copy its
+    // tail in the history area before the first half. History of the second
+    // half is the tail of the first one and needs no copy. A stale lease, being
+    // overwritten or not following the previous one, clears the history
+    // instead: the next block starts from silence rather than from samples of
+    // a different point of the stream.
+    stream_sample_t *second = s->ctx.buffer + (s->ctx.bufSize / 2);
+    if((lease->reader == 0) && (lease->data == second) && (s->history > 0))
+    {
+        stream_sample_t *hist = s->ctx.buffer - s->history;
+
+        if(valid && (lease->lost == 0))
+        {
+            memcpy(hist, lease->data + lease->len - s->history,
+                   s->history * sizeof(stream_sample_t));
+        }
+        else
+        {
+            memset(hist, 0x00, s->history * sizeof(stream_sample_t));
+        }
+    }
+
+    pthread_mutex_unlock(&leaseMutex);
+
+    return valid;
+}
@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <crc.h>
+
+#ifndef CRC_SLICES
+#ifdef PLATFORM_LINUX
+#define CRC_SLICES 8
+#else
+#define CRC_SLICES 4
+#endif
+#endif
+
+static_assert((CRC_SLICES == 1) || (CRC_SLICES == 2) || (CRC_SLICES == 4) ||
+              (CRC_SLICES == 8), "Unsupported number of CRC slices");
+
+/**
+ * \internal
+ * Lookup tables for a 16-bit CRC, MSB first. Entry i of table k is the CRC
+ * register after processing byte i followed by k zero bytes, starting from a
+ * zero register.
+ */
+template < uint16_t POLY, size_t N >
+struct CrcTables
+{
+    uint16_t t[N][256];
+};
+
+/**
+ * \internal
+ * Generate the lookup tables of a 16-bit CRC.
+ */
+template < uint16_t POLY, size_t N >
+static constexpr CrcTables< POLY, N > makeTables()
+{
+    CrcTables< POLY, N > tables{};
+
+    for(size_t i = 0; i < 256; i++)
+    {
+        uint16_t crc = i << 8;
+        for(size_t j = 0; j < 8; j++)
+            crc = (crc & 0x8000) ? ((crc << 1) ^ POLY) : (crc << 1);
+
+        tables.t[0][i] = crc;
+    }
+
+    for(size_t k = 1; k < N; k++)
+    {
+        for(size_t i = 0; i < 256; i++)
+        {
+            uint16_t prev  = tables.t[k - 1][i];
+            tables.t[k][i] = (prev << 8) ^ tables.t[0][prev >> 8];
+        }
+    }
+
+    return tables;
+}
+
+static constexpr CrcTables< 0x1021, CRC_SLICES > ccittTables
+    = makeTables< 0x1021, CRC_SLICES >();
+static constexpr CrcTables< 0x5935, CRC_SLICES > m17Tables
+    = makeTables< 0x5935, CRC_SLICES >();
+
+static_assert(ccittTables.t[0][1]   == 0x1021, "Wrong CCITT CRC table");
+static_assert(ccittTables.t[0][255] == 0x1EF0, "Wrong CCITT CRC table");
+static_assert(m17Tables.t[0][1]     == 0x5935, "Wrong M17 CRC table");
+
+/**
+ * \internal
+ * Update a 16-bit CRC, processing N bytes per iteration. The first two bytes
+ * of each group absorb the current CRC register, the contribution of each byte
+ * is then shifted by the number of bytes following it in the group.
+ */
+template < uint16_t POLY, size_t N >
+static inline uint16_t update(const CrcTables< POLY, N >& tab, uint16_t crc,
+                              const uint8_t *buf, size_t len)
+{
+    if(N >= 2)
+    {
+        for(; len >= N; len -= N, buf += N)
+        {
+            uint16_t val = tab.t[N - 1][buf[0] ^ (crc >> 8)]
+                         ^ tab.t[N - 2][buf[1] ^ (crc & 0xFF)];
+
+            for(size_t k = 2; k < N; k++)
+                val ^= tab.t[N - 1 - k][buf[k]];
+
+            crc = val;
+        }
+    }
+
+    for(; len > 0; len--, buf++)
+        crc = (crc << 8) ^ tab.t[0][(crc >> 8) ^ *buf];
+
+    return crc;
+}
+
+
+void crc_init(crc16_t *crc, const enum crcType type)
+{
+    crc->type  = type;
+    crc->value = (type == CRC_M17) ? 0xFFFF : 0x0000;
+}
+
+void crc_update(crc16_t *crc, const void *data, const size_t len)
+{
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    if(crc->type == CRC_M17)
+        crc->value = update(m17Tables, crc->value, buf, len);
+    else
+        crc->value = update(ccittTables, crc->value, buf, len);
+}
+
+uint16_t crc_final(const crc16_t *crc)
+{
+    // None of the supported algorithms has a final XOR value
+    return crc->value;
+}
+
+uint16_t crc_ccitt(const void *data, const size_t len)
+{
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    return update(ccittTables, 0x0000, buf, len);
+}
+
+uint16_t crc_m17(const void *data, const size_t len)
+{
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    return update(m17Tables, 0xFFFF, buf, len);
+}
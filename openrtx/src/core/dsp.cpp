@@ -19,6 +19,34 @@
  ***************************************************************************/
 
 #include <dsp.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+/*
+ * Saturation and packed arithmetic helpers. On Cortex-M cores with DSP
+ * extension the SSAT and QSUB16 instructions are used, elsewhere the plain
+ * C code is left to the compiler, which can vectorise the loops using them.
+ */
+static inline audio_sample_t saturate(const int32_t value)
+{
+    #if defined(__ARM_FEATURE_DSP)
+    int32_t result;
+    asm("ssat %0, #16, %1" : "=r"(result) : "r"(value));
+    return static_cast< audio_sample_t >(result);
+    #else
+    if(value > INT16_MAX) return INT16_MAX;
+    if(value < INT16_MIN) return INT16_MIN;
+    return static_cast< audio_sample_t >(value);
+    #endif
+}
+
+static inline audio_sample_t roundSaturate(float value)
+{
+    // Branchless rounding to the nearest integer, ties away from zero
+    value = std::min(std::max(value, -32768.0f), 32767.0f);
+    return static_cast< audio_sample_t >(value + std::copysign(0.5f, value));
+}
 
 void dsp_resetFilterState(filter_state_t *state)
 {
@@ -40,6 +68,8 @@ void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length)
      * transfer function G(z) = (z - 1)/(z - 0.999).
      * Recursive implementation of the filter is:
      * y(k) = u(k) - u(k-1) + 0.999*y(k-1)
+     *
+     * Filter state is kept in local variables while processing the block.
      */
 
     if(length < 2) return;
@@ -54,23 +84,107 @@ void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length)
         pos = 1;
     }
 
+    float u1 = state->u[1];
+    float y1 = state->y[1];
+    float u0 = state->u[0];
+
+    for(; pos < length; pos++)
+    {
+        u0 = static_cast< float >(buffer[pos]);
+        float y0 = u0 - u1 + alpha * y1;
+
+        u1 = u0;
+        y1 = y0;
+        buffer[pos] = static_cast< audio_sample_t >(y0 + 0.5f);
+    }
+
+    state->u[0] = u0;
+    state->u[1] = u1;
+    state->y[0] = y1;
+    state->y[1] = y1;
+}
+
+void dsp_dcRemovalGain(filter_state_t *state, audio_sample_t *buffer,
+                       size_t length, int16_t preGain, int16_t postGain)
+{
+    /*
+     * Same filter of dsp_dcRemoval(), with the pre-amplification stage applied
+     * to the filter input and the post-amplification one to its output. Since
+     * the filter is linear, the input gain is folded in the difference term.
+     */
+
+    if(length == 0) return;
+
+    static constexpr float alpha = 0.999f;
+    size_t pos = 0;
+
+    const float pre  = static_cast< float >(preGain);
+    const float post = static_cast< float >(postGain);
+
+    if(state->initialised == false)
+    {
+        state->u[1] = static_cast< float >(buffer[0]);
+        state->initialised = true;
+        buffer[0] = 0;
+        pos = 1;
+    }
+
+    float u1 = state->u[1];
+    float y1 = state->y[1];
+    float u0 = state->u[0];
+
     for(; pos < length; pos++)
     {
-        state->u[0] = static_cast< float >(buffer[pos]);
-        state->y[0] = (state->u[0])
-                    - (state->u[1])
-                    + alpha * (state->y[1]);
-
-        state->u[1] = state->u[0];
-        state->y[1] = state->y[0];
-        buffer[pos] = static_cast< audio_sample_t >(state->y[0] + 0.5f);
+        u0 = static_cast< float >(buffer[pos]);
+        float y0 = pre * (u0 - u1) + alpha * y1;
+
+        u1 = u0;
+        y1 = y0;
+
+        buffer[pos] = roundSaturate(post * y0);
+    }
+
+    state->u[0] = u0;
+    state->u[1] = u1;
+    state->y[0] = y1;
+    state->y[1] = y1;
+}
+
+void dsp_applyGain(audio_sample_t *buffer, size_t length, int16_t gain)
+{
+    for(size_t i = 0; i < length; i++)
+    {
+        int32_t value = static_cast< int32_t >(buffer[i]) * gain;
+        buffer[i]     = saturate(value);
+    }
+}
+
+void dsp_fromFloat(const float *in, audio_sample_t *out, size_t length,
+                   float scale)
+{
+    for(size_t i = 0; i < length; i++)
+    {
+        out[i] = roundSaturate(in[i] * scale);
     }
 }
 
 void dsp_invertPhase(audio_sample_t *buffer, uint16_t length)
 {
-    for(uint16_t i = 0; i < length; i++)
+    size_t i = 0;
+
+    #if defined(__ARM_FEATURE_DSP)
+    // Negate two samples at once with a saturating parallel subtraction
+    for(; (i + 2) <= length; i += 2)
+    {
+        uint32_t pair;
+        memcpy(&pair, buffer + i, sizeof(pair));
+        asm("qsub16 %0, %1, %2" : "=r"(pair) : "r"(0), "r"(pair));
+        memcpy(buffer + i, &pair, sizeof(pair));
+    }
+    #endif
+
+    for(; i < length; i++)
     {
-        buffer[i] = -buffer[i];
+        buffer[i] = saturate(-static_cast< int32_t >(buffer[i]));
     }
 }
@@ -0,0 +1,635 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <gps_parser.h>
+#include <minmea.h>
+#include <string.h>
+
+#define KNOTS2KMH 1.852f
+
+/**
+ * States of the framing state machine.
+ */
+enum parserState
+{
+    WAIT_START = 0,   // Waiting for the start of a new sentence or message
+    NMEA_DATA,        // Receiving the NMEA sentence body
+    NMEA_CK_HI,       // Receiving the high nibble of NMEA checksum
+    NMEA_CK_LO,       // Receiving the low nibble of NMEA checksum
+    UBX_SYNC,         // Waiting for the second UBX sync character
+    UBX_CLASS,        // Receiving UBX message class
+    UBX_ID,           // Receiving UBX message ID
+    UBX_LEN_LO,       // Receiving low byte of UBX payload length
+    UBX_LEN_HI,       // Receiving high byte of UBX payload length
+    UBX_PAYLOAD,      // Receiving UBX payload
+    UBX_CK_A,         // Receiving UBX checksum A
+    UBX_CK_B          // Receiving UBX checksum B
+};
+
+static const uint8_t UBX_SYNC_1    = 0xB5;
+static const uint8_t UBX_SYNC_2    = 0x62;
+static const uint8_t UBX_CLASS_NAV = 0x01;
+static const uint8_t UBX_NAV_PVT   = 0x07;
+static const uint8_t UBX_NAV_EOE   = 0x61;
+
+
+static int parseRMC(const char *sentence, gps_t *data)
+{
+    struct minmea_sentence_rmc frame;
+    if(minmea_parse_rmc(&frame, sentence) == false)
+        return -1;
+
+    if(frame.valid)
+    {
+        data->latitude  = minmea_tocoord(&frame.latitude);
+        data->longitude = minmea_tocoord(&frame.longitude);
+        data->tmg_true  = minmea_tofloat(&frame.course);
+        data->speed     = minmea_tofloat(&frame.speed) * KNOTS2KMH;
+    }
+
+    if(frame.time.hours >= 0)
+    {
+        data->timestamp.hour   = frame.time.hours;
+        data->timestamp.minute = frame.time.minutes;
+        data->timestamp.second = frame.time.seconds;
+    }
+
+    if(frame.date.year >= 0)
+    {
+        data->timestamp.day   = 0;
+        data->timestamp.date  = frame.date.day;
+        data->timestamp.month = frame.date.month;
+        data->timestamp.year  = frame.date.year;
+    }
+
+    return 1;
+}
+
+static int parseGGA(const char *sentence, gps_t *data)
+{
+    struct minmea_sentence_gga frame;
+    if(minmea_parse_gga(&frame, sentence) == false)
+        return -1;
+
+    data->fix_quality        = frame.fix_quality;
+    data->satellites_tracked = frame.satellites_tracked;
+    data->altitude           = minmea_tofloat(&frame.altitude);
+
+    return 1;
+}
+
+static int parseGSA(const char *sentence, gps_t *data)
+{
+    struct minmea_sentence_gsa frame;
+    if(minmea_parse_gsa(&frame, sentence) == false)
+        return -1;
+
+    data->fix_type    = frame.fix_type;
+    data->active_sats = 0;
+    for(int i = 0; i < 12; i++)
+    {
+        if((frame.sats[i] > 0) && (frame.sats[i] <= 32))
+            data->active_sats |= 1 << (frame.sats[i] - 1);
+    }
+
+    return 1;
+}
+
+static int parseGSV(const char *sentence, gps_t *data)
+{
+    struct minmea_sentence_gsv frame;
+    if(minmea_parse_gsv(&frame, sentence) == false)
+        return -1;
+
+    // When the first sentence arrives, clear all the old data
+    if(frame.msg_nr == 1)
+        memset(data->satellites, 0x00, sizeof(data->satellites));
+
+    // Sentences 1 to 3 carry the data of the first 12 satellites
+    data->satellites_in_view = frame.total_sats;
+    if((frame.msg_nr >= 1) && (frame.msg_nr <= 3))
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            gpssat_t *sat  = &data->satellites[4 * (frame.msg_nr - 1) + i];
+            sat->id        = frame.sats[i].nr;
+            sat->elevation = frame.sats[i].elevation;
+            sat->azimuth   = frame.sats[i].azimuth;
+            sat->snr       = frame.sats[i].snr;
+        }
+    }
+
+    return (frame.msg_nr >= frame.total_msgs) ? 1 : 0;
+}
+
+static int parseVTG(const char *sentence, gps_t *data)
+{
+    struct minmea_sentence_vtg frame;
+    if(minmea_parse_vtg(&frame, sentence) == false)
+        return -1;
+
+    data->speed    = minmea_tofloat(&frame.speed_kph);
+    data->tmg_mag  = minmea_tofloat(&frame.magnetic_track_degrees);
+    data->tmg_true = minmea_tofloat(&frame.true_track_degrees);
+
+    return 1;
+}
+
+static int parseZDA(const char *sentence, gps_t *data)
+{
+    struct minmea_sentence_zda frame;
+    if(minmea_parse_zda(&frame, sentence) == false)
+        return -1;
+
+    if((frame.time.hours < 0) || (frame.date.year < 0))
+        return 1;
+
+    data->timestamp.hour   = frame.time.hours;
+    data->timestamp.minute = frame.time.minutes;
+    data->timestamp.second = frame.time.seconds;
+    data->timestamp.day    = 0;
+    data->timestamp.date   = frame.date.day;
+    data->timestamp.month  = frame.date.month;
+    data->timestamp.year   = frame.date.year % 100;
+
+    return 1;
+}
+
+const gpsSentence_t gpsParser_defaultSentences[] =
+{
+    { "RMC", 1, false, parseRMC },
+    { "GGA", 1, false, parseGGA },
+    { "GSA", 0, true,  parseGSA },
+    { "GSV", 0, true,  parseGSV },
+    { "VTG", 0, false, parseVTG },
+    { "ZDA", 1, false, parseZDA }
+};
+
+const size_t gpsParser_numDefaultSentences = sizeof(gpsParser_defaultSentences)
+                                           / sizeof(gpsSentence_t);
+
+
+/**
+ * \internal
+ * Convert an hexadecimal character to its value.
+ *
+ * @param c: hexadecimal character.
+ * @return character value or -1 if the character is not a valid hex digit.
+ */
+static inline int hexValue(const char c)
+{
+    if((c >= '0') && (c <= '9')) return c - '0';
+    if((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+
+    return -1;
+}
+
+/**
+ * \internal
+ * Extract the UTC time from an NMEA sentence, without parsing the other
+ * sentence fields.
+ *
+ * @param sentence: NMEA sentence.
+ * @param field: index of the time field.
+ * @return time of day in milliseconds or -1 if the time field is empty.
+ */
+static int32_t sentenceTime(const char *sentence, uint8_t field)
+{
+    const char *ptr = sentence;
+    while(field > 0)
+    {
+        ptr = strchr(ptr, ',');
+        if(ptr == NULL)
+            return -1;
+
+        ptr++;
+        field--;
+    }
+
+    // Time format is hhmmss followed by optional decimals
+    int32_t digits[6];
+    for(int i = 0; i < 6; i++)
+    {
+        if((ptr[i] < '0') || (ptr[i] > '9'))
+            return -1;
+
+        digits[i] = ptr[i] - '0';
+    }
+
+    int32_t time = ((digits[0] * 10 + digits[1]) * 3600
+                 +  (digits[2] * 10 + digits[3]) * 60
+                 +  (digits[4] * 10 + digits[5])) * 1000;
+
+    // Milliseconds
+    if(ptr[6] == '.')
+    {
+        int32_t scale = 100;
+        for(ptr += 7; (*ptr >= '0') && (*ptr <= '9') && (scale > 0); ptr++)
+        {
+            time  += (*ptr - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    return time;
+}
+
+/**
+ * \internal
+ * Publish the data of the current epoch and start a new one.
+ */
+static inline void closeEpoch(gpsParser_t *p, gps_t *fix)
+{
+    *fix         = p->epoch;
+    p->epochOpen = false;
+    p->seen      = 0;
+    p->numEpochs++;
+}
+
+/**
+ * \internal
+ * Process a complete NMEA sentence.
+ *
+ * @return true if an epoch has been published.
+ */
+static bool processNmea(gpsParser_t *p, gps_t *fix)
+{
+    // Skip talker ID, proprietary sentences have none and are ignored.
+    if((p->buf[1] == 'P') || (p->pos < 7) || (p->buf[6] != ','))
+        return false;
+
+    int8_t index = -1;
+    for(uint8_t i = 0; i < p->numSentences; i++)
+    {
+        if(memcmp(&p->buf[3], p->sentences[i].type, 3) == 0)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    if(index < 0)
+        return false;
+
+    const gpsSentence_t *sentence = &p->sentences[index];
+    uint16_t mask      = 1 << index;
+    bool     published = false;
+    int32_t  time      = -1;
+
+    if(sentence->timeField > 0)
+        time = sentenceTime(p->buf, sentence->timeField);
+
+    // Detect the start of a new epoch: either the UTC time changed or the
+    // sentence has already been received in the current epoch. The last
+    // sentence received before the start of the new epoch is the one closing
+    // each epoch.
+    bool timeChanged = (time >= 0) && (time != p->epochTime);
+    bool repeated    = (sentence->multiple == false) && ((p->seen & mask) != 0);
+    if(timeChanged || repeated)
+    {
+        if(p->epochOpen)
+        {
+            closeEpoch(p, fix);
+            published = true;
+        }
+
+        p->seen        = 0;
+        p->endSentence = p->lastSentence;
+    }
+
+    if(time >= 0)
+        p->epochTime = time;
+
+    int ret = sentence->handler(p->buf, &p->epoch);
+    if(ret < 0)
+    {
+        p->numErrors++;
+        return published;
+    }
+
+    p->numParsed++;
+    p->epochOpen = true;
+
+    // Sentence groups are considered only when complete
+    if(ret > 0)
+    {
+        p->seen        |= mask;
+        p->lastSentence = index;
+
+        if(index == p->endSentence)
+        {
+            closeEpoch(p, fix);
+            published = true;
+        }
+    }
+
+    return published;
+}
+
+/**
+ * \internal
+ * Read a little-endian value from the UBX payload.
+ */
+static inline uint32_t ubxU32(const gpsParser_t *p, const size_t offset)
+{
+    const uint8_t *ptr = (const uint8_t *) &p->buf[offset];
+    return ((uint32_t) ptr[0])
+         | ((uint32_t) ptr[1] << 8)
+         | ((uint32_t) ptr[2] << 16)
+         | ((uint32_t) ptr[3] << 24);
+}
+
+static inline uint16_t ubxU16(const gpsParser_t *p, const size_t offset)
+{
+    const uint8_t *ptr = (const uint8_t *) &p->buf[offset];
+    return ((uint16_t) ptr[0]) | ((uint16_t) ptr[1] << 8);
+}
+
+static inline uint8_t ubxU8(const gpsParser_t *p, const size_t offset)
+{
+    return (uint8_t) p->buf[offset];
+}
+
+/**
+ * \internal
+ * Process a complete UBX message.
+ *
+ * @return true if an epoch has been published.
+ */
+static bool processUbx(gpsParser_t *p, gps_t *fix)
+{
+    if(p->ubxClass != UBX_CLASS_NAV)
+        return false;
+
+    // End of epoch message
+    if(p->ubxId == UBX_NAV_EOE)
+    {
+        p->numParsed++;
+        if(p->epochOpen == false)
+            return false;
+
+        closeEpoch(p, fix);
+        return true;
+    }
+
+    // NAV-PVT carries all the data of a navigation epoch
+    if((p->ubxId != UBX_NAV_PVT) || (p->ubxLen < 92))
+        return false;
+
+    gps_t  *data   = &p->epoch;
+    uint8_t valid  = ubxU8(p, 11);
+    uint8_t fixTyp = ubxU8(p, 20);
+    uint8_t flags  = ubxU8(p, 21);
+
+    // Date and time valid flags
+    if((valid & 0x03) == 0x03)
+    {
+        data->timestamp.hour   = ubxU8(p, 8);
+        data->timestamp.minute = ubxU8(p, 9);
+        data->timestamp.second = ubxU8(p, 10);
+        data->timestamp.day    = 0;
+        data->timestamp.date   = ubxU8(p, 7);
+        data->timestamp.month  = ubxU8(p, 6);
+        data->timestamp.year   = ubxU16(p, 4) % 100;
+    }
+
+    // Fix type is reported with the same encoding of NMEA GSA sentence, fix
+    // quality is reported as SPS or DGPS depending on the diffSoln flag.
+    data->fix_quality        = 0;
+    data->fix_type           = 1;
+    data->satellites_tracked = ubxU8(p, 23);
+
+    if((flags & 0x01) != 0)
+    {
+        data->fix_quality = ((flags & 0x02) != 0) ? 2 : 1;
+
+        if((fixTyp == 2) || (fixTyp == 3))
+            data->fix_type = fixTyp;
+
+        data->longitude = ((int32_t) ubxU32(p, 24)) * 1e-7f;
+        data->latitude  = ((int32_t) ubxU32(p, 28)) * 1e-7f;
+        data->altitude  = ((int32_t) ubxU32(p, 36)) / 1000.0f;
+        data->speed     = ((int32_t) ubxU32(p, 60)) * 0.0036f;
+        data->tmg_true  = ((int32_t) ubxU32(p, 64)) * 1e-5f;
+    }
+
+    p->numParsed++;
+    closeEpoch(p, fix);
+
+    return true;
+}
+
+
+void gpsParser_init(gpsParser_t *parser, const gpsSentence_t *sentences,
+                    const size_t numSentences)
+{
+    memset(parser, 0x00, sizeof(gpsParser_t));
+
+    if(sentences == NULL)
+    {
+        parser->sentences    = gpsParser_defaultSentences;
+        parser->numSentences = gpsParser_numDefaultSentences;
+    }
+    else
+    {
+        parser->sentences    = sentences;
+        parser->numSentences = numSentences;
+    }
+
+    if(parser->numSentences > GPS_PARSER_MAX_SENTENCES)
+        parser->numSentences = GPS_PARSER_MAX_SENTENCES;
+
+    parser->state        = WAIT_START;
+    parser->epochTime    = -1;
+    parser->lastSentence = -1;
+    parser->endSentence  = -1;
+}
+
+bool gpsParser_feed(gpsParser_t *parser, const uint8_t byte, gps_t *fix)
+{
+    gpsParser_t *p = parser;
+
+    // A '$' character always marks the beginning of a new NMEA sentence
+    if((byte == '$') && (p->state <= NMEA_CK_LO))
+    {
+        if(p->state != WAIT_START)
+            p->numErrors++;
+
+        p->buf[0] = '$';
+        p->pos    = 1;
+        p->ckA    = 0;
+        p->state  = NMEA_DATA;
+
+        return false;
+    }
+
+    switch(p->state)
+    {
+        case WAIT_START:
+            if(byte == UBX_SYNC_1)
+                p->state = UBX_SYNC;
+            break;
+
+        case NMEA_DATA:
+            if(byte == '*')
+            {
+                p->buf[p->pos++] = '*';
+                p->state = NMEA_CK_HI;
+            }
+            else if((byte < 0x20) || (byte > 0x7E) ||
+                    (p->pos >= (GPS_PARSER_BUF_SIZE - 4)))
+            {
+                // Non-printable character or sentence too long
+                p->numErrors++;
+                p->state = WAIT_START;
+            }
+            else
+            {
+                p->buf[p->pos++] = byte;
+                p->ckA ^= byte;
+            }
+            break;
+
+        case NMEA_CK_HI:
+        case NMEA_CK_LO:
+        {
+            int value = hexValue(byte);
+            if(value < 0)
+            {
+                p->numErrors++;
+                p->state = WAIT_START;
+                break;
+            }
+
+            p->buf[p->pos++] = byte;
+
+            if(p->state == NMEA_CK_HI)
+            {
+                p->ckB   = value << 4;
+                p->state = NMEA_CK_LO;
+                break;
+            }
+
+            p->ckB        |= value;
+            p->buf[p->pos] = '\0';
+            p->state       = WAIT_START;
+
+            if(p->ckA != p->ckB)
+            {
+                p->numErrors++;
+                break;
+            }
+
+            return processNmea(p, fix);
+        }
+            break;
+
+        case UBX_SYNC:
+            p->state = (byte == UBX_SYNC_2) ? UBX_CLASS : WAIT_START;
+            break;
+
+        case UBX_CLASS:
+            p->ubxClass = byte;
+            p->ckA      = byte;
+            p->ckB      = byte;
+            p->state    = UBX_ID;
+            break;
+
+        case UBX_ID:
+            p->ubxId  = byte;
+            p->ckA   += byte;
+            p->ckB   += p->ckA;
+            p->state  = UBX_LEN_LO;
+            break;
+
+        case UBX_LEN_LO:
+            p->ubxLen = byte;
+            p->ckA   += byte;
+            p->ckB   += p->ckA;
+            p->state  = UBX_LEN_HI;
+            break;
+
+        case UBX_LEN_HI:
+            p->ubxLen  |= ((uint16_t) byte) << 8;
+            p->ubxCount = 0;
+            p->ckA     += byte;
+            p->ckB     += p->ckA;
+            p->state    = (p->ubxLen > 0) ? UBX_PAYLOAD : UBX_CK_A;
+            break;
+
+        case UBX_PAYLOAD:
+            // Payloads longer than the buffer are checked but not stored
+            if(p->ubxCount < GPS_PARSER_BUF_SIZE)
+                p->buf[p->ubxCount] = byte;
+
+            p->ubxCount += 1;
+            p->ckA      += byte;
+            p->ckB      += p->ckA;
+
+            if(p->ubxCount == p->ubxLen)
+                p->state = UBX_CK_A;
+            break;
+
+        case UBX_CK_A:
+            if(byte == p->ckA)
+            {
+                p->state = UBX_CK_B;
+            }
+            else
+            {
+                p->numErrors++;
+                p->state = WAIT_START;
+            }
+            break;
+
+        case UBX_CK_B:
+            p->state = WAIT_START;
+            if(byte != p->ckB)
+            {
+                p->numErrors++;
+                break;
+            }
+
+            if(p->ubxLen <= GPS_PARSER_BUF_SIZE)
+                return processUbx(p, fix);
+            break;
+
+        default:
+            p->state = WAIT_START;
+            break;
+    }
+
+    return false;
+}
+
+bool gpsParser_feedBlock(gpsParser_t *parser, const uint8_t *data,
+                         const size_t length, gps_t *fix)
+{
+    bool newFix = false;
+
+    for(size_t i = 0; i < length; i++)
+    {
+        if(gpsParser_feed(parser, data[i], fix))
+            newFix = true;
+    }
+
+    return newFix;
+}
@@ -156,6 +156,76 @@ static PIXEL_T *buf;
 static uint16_t fbSize;
 static char text[32];
 
+/*
+ * Damage tracking: every primitive marks the framebuffer rows it touches and
+ * gfx_render() sends to the display only the rows whose content differs from
+ * the one flushed last time. Since the UI clears and redraws the whole screen
+ * on every update, being touched is not enough to consider a row as changed:
+ * a hash of each row content is kept to drop the rows redrawn identical.
+ */
+#define GFX_BAND_GAP 8      // Changed bands closer than this are merged
+
+static uint8_t  damage[(SCREEN_HEIGHT + 7) / 8];
+static uint32_t flushedHash[SCREEN_HEIGHT];
+static bool     fullRender;
+
+static inline void markRow(uint8_t row)
+{
+    damage[row >> 3] |= (1 << (row & 0x07));
+}
+
+static inline bool rowDamaged(uint8_t row)
+{
+    return (damage[row >> 3] & (1 << (row & 0x07))) != 0;
+}
+
+static void markRows(uint8_t startRow, uint8_t endRow)
+{
+    if(endRow > SCREEN_HEIGHT) endRow = SCREEN_HEIGHT;
+
+    for(uint8_t row = startRow; row < endRow; row++)
+        markRow(row);
+}
+
+/**
+ * Compute the first and one past the last framebuffer byte holding the pixels
+ * of a given set of rows.
+ */
+static inline void rowSpan(uint8_t startRow, uint8_t endRow, size_t *start,
+                           size_t *end)
+{
+#ifdef PIX_FMT_RGB565
+    *start = startRow * SCREEN_WIDTH * sizeof(PIXEL_T);
+    *end   = endRow   * SCREEN_WIDTH * sizeof(PIXEL_T);
+#elif defined PIX_FMT_BW
+    *start = (startRow * SCREEN_WIDTH) / 8;
+    *end   = ((endRow  * SCREEN_WIDTH) + 7) / 8;
+#endif
+}
+
+static uint32_t rowHash(uint8_t row)
+{
+    const uint8_t *ptr = (const uint8_t *) buf;
+    uint32_t hash = 2166136261u;
+    size_t start;
+    size_t end;
+
+    rowSpan(row, row + 1, &start, &end);
+
+    for(; (end - start) >= sizeof(uint32_t); start += sizeof(uint32_t))
+    {
+        uint32_t word;
+        memcpy(&word, &ptr[start], sizeof(uint32_t));
+        hash  = (hash ^ word) * 16777619u;
+        hash ^= hash >> 15;
+    }
+
+    for(; start < end; start++)
+        hash = (hash ^ ptr[start]) * 16777619u;
+
+    return hash;
+}
+
 void gfx_init()
 {
     display_init();
@@ -173,6 +243,10 @@ void gfx_init()
 #endif
     // Clear text buffer
     memset(text, 0x00, 32);
+
+    // Display content is unknown, first render has to send everything
+    memset(damage, 0x00, sizeof(damage));
+    fullRender = true;
 }
 
 void gfx_terminate()
@@ -183,12 +257,61 @@ void gfx_terminate()
 
 void gfx_renderRows(uint8_t startRow, uint8_t endRow)
 {
+    if(endRow > SCREEN_HEIGHT) endRow = SCREEN_HEIGHT;
+
+    for(uint8_t row = startRow; row < endRow; row++)
+    {
+        flushedHash[row] = rowHash(row);
+        damage[row >> 3] &= ~(1 << (row & 0x07));
+    }
+
     display_renderRows(startRow, endRow);
 }
 
 void gfx_render()
 {
-    display_render();
+    if(fullRender)
+    {
+        gfx_renderRows(0, SCREEN_HEIGHT);
+        fullRender = false;
+        return;
+    }
+
+    /*
+     * Scan the damaged rows, keeping only the ones actually changed, and send
+     * them to the display in bands. Bands separated by a small gap are merged
+     * together, as each transfer has its own setup cost.
+     */
+    int16_t bandStart = -1;
+    int16_t bandEnd   = -1;
+
+    for(uint8_t row = 0; row < SCREEN_HEIGHT; row++)
+    {
+        if(rowDamaged(row) == false)
+            continue;
+
+        damage[row >> 3] &= ~(1 << (row & 0x07));
+
+        uint32_t hash = rowHash(row);
+        if(hash == flushedHash[row])
+            continue;
+
+        flushedHash[row] = hash;
+
+        if((bandStart >= 0) && ((row - bandEnd) >= GFX_BAND_GAP))
+        {
+            display_renderRows(bandStart, bandEnd);
+            bandStart = -1;
+        }
+
+        if(bandStart < 0)
+            bandStart = row;
+
+        bandEnd = row + 1;
+    }
+
+    if(bandStart >= 0)
+        display_renderRows(bandStart, bandEnd);
 }
 
 bool gfx_renderingInProgress()
@@ -199,11 +322,15 @@ bool gfx_renderingInProgress()
 void gfx_clearRows(uint8_t startRow, uint8_t endRow)
 {
     if(!initialized) return;
-    if(endRow < startRow) return;
-    uint16_t start = startRow * SCREEN_WIDTH * sizeof(PIXEL_T);
-    uint16_t height = endRow - startRow * SCREEN_WIDTH * sizeof(PIXEL_T);
+    if(endRow > SCREEN_HEIGHT) endRow = SCREEN_HEIGHT;
+    if(endRow <= startRow) return;
+
+    size_t start;
+    size_t end;
+    rowSpan(startRow, endRow, &start, &end);
     // Set the specified rows to 0x00 = make the screen black
-    memset(buf + start, 0x00, height);
+    memset(((uint8_t *) buf) + start, 0x00, end - start);
+    markRows(startRow, endRow);
 }
 
 void gfx_clearScreen()
@@ -211,6 +338,7 @@ void gfx_clearScreen()
     if(!initialized) return;
     // Set the whole framebuffer to 0x00 = make the screen black
     memset(buf, 0x00, fbSize);
+    markRows(0, SCREEN_HEIGHT);
 }
 
 void gfx_fillScreen(color_t color)
@@ -232,6 +360,8 @@ inline void gfx_setPixel(point_t pos, color_t color)
             || pos.x < 0 || pos.y < 0)
         return; // off the screen
 
+    markRow(pos.y);
+
 #ifdef PIX_FMT_RGB565
     // Blend old pixel value and new one
     if (color.alpha < 255)
@@ -460,6 +590,188 @@ static inline uint16_t get_reset_x(textAlign_t alignment, uint16_t line_size,
     return 0;
 }
 
+/*
+ * Glyph cache: glyphs of the most used fonts are kept expanded one row per
+ * element, with bit zero being the leftmost pixel. This is the same order of
+ * the pixels in the 1bpp framebuffer, allowing to draw a whole glyph row with
+ * a couple of mask operations. Glyphs are expanded on first use.
+ */
+#ifndef GFX_GLYPH_CACHE_ROWS
+#define GFX_GLYPH_CACHE_ROWS 2112   // Enough for all the cached fonts
+#endif
+
+#define GLYPH_CACHE_WIDTH 16        // Max width of a cached glyph
+#define GLYPH_CACHE_CHARS 96        // Max number of cached glyphs per font
+
+static const uint8_t cachedFonts[] =
+{
+    FONT_SIZE_6PT,
+    FONT_SIZE_8PT,
+    FONT_SIZE_24PT + 1 + SYMBOLS_SIZE_5PT,
+    FONT_SIZE_24PT + 1 + SYMBOLS_SIZE_6PT,
+    FONT_SIZE_24PT + 1 + SYMBOLS_SIZE_8PT
+};
+
+#define NUM_CACHED_FONTS (sizeof(cachedFonts) / sizeof(cachedFonts[0]))
+
+static uint16_t glyphRows[GFX_GLYPH_CACHE_ROWS];
+static uint16_t glyphSlot[NUM_CACHED_FONTS][GLYPH_CACHE_CHARS];
+static uint16_t glyphRowsUsed;
+
+/**
+ * Reverse the bit order of a 32 bit word.
+ */
+static inline uint32_t reverseBits(uint32_t x)
+{
+    x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+    x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F) | ((x & 0x0F0F0F0F) << 4);
+    return __builtin_bswap32(x);
+}
+
+/**
+ * Extract a row of pixels from the bitmap of an Adafruit font, where pixels
+ * are packed MSB first and rows are not aligned to byte boundaries.
+ *
+ * @param bitmap: font bitmap.
+ * @param pos: bit position of the leftmost pixel of the row.
+ * @param width: number of pixels to extract, up to 32.
+ * @return row pixels, bit zero being the leftmost one.
+ */
+static uint32_t glyphRowBits(const uint8_t *bitmap, uint32_t pos, uint8_t width)
+{
+    const uint8_t *ptr    = &bitmap[pos / 8];
+    uint8_t        shift  = pos % 8;
+    uint8_t        nBytes = (shift + width + 7) / 8;
+    uint64_t       bits   = 0;
+
+    for(uint8_t i = 0; i < nBytes; i++)
+        bits = (bits << 8) | ptr[i];
+
+    // Left-align the row on bit 63 and keep only the requested pixels
+    bits <<= (64 - (8 * nBytes)) + shift;
+    uint32_t row = (uint32_t) (bits >> 32);
+    if(width < 32) row &= ~(0xFFFFFFFF >> width);
+
+    return reverseBits(row);
+}
+
+/**
+ * Get the expanded rows of a glyph from the cache, expanding it if needed.
+ *
+ * @param cache: index of the font in the cached font list.
+ * @param f: font.
+ * @param index: glyph index inside the font.
+ * @return pointer to the glyph rows or NULL if the glyph is not cached.
+ */
+static const uint16_t *cachedGlyph(int8_t cache, const GFXfont *f,
+                                   uint16_t index)
+{
+    if((cache < 0) || (index >= GLYPH_CACHE_CHARS))
+        return NULL;
+
+    uint16_t slot = glyphSlot[cache][index];
+    if(slot != 0)
+        return &glyphRows[slot - 1];
+
+    const GFXglyph *glyph = &f->glyph[index];
+    if(glyph->width > GLYPH_CACHE_WIDTH)
+        return NULL;
+
+    if((glyphRowsUsed + glyph->height) > GFX_GLYPH_CACHE_ROWS)
+        return NULL;
+
+    uint32_t pos = glyph->bitmapOffset * 8;
+    for(uint8_t row = 0; row < glyph->height; row++)
+    {
+        glyphRows[glyphRowsUsed + row] = glyphRowBits(f->bitmap, pos,
+                                                      glyph->width);
+        pos += glyph->width;
+    }
+
+    slot = glyphRowsUsed + 1;
+    glyphSlot[cache][index] = slot;
+    glyphRowsUsed += glyph->height;
+
+    return &glyphRows[slot - 1];
+}
+
+/**
+ * Draw a row of up to 32 pixels, bit zero of the mask being the leftmost one.
+ * Pixels outside the screen are discarded.
+ *
+ * @param x: horizontal position of the leftmost pixel.
+ * @param y: row coordinate.
+ * @param mask: pixels to be drawn.
+ * @param width: number of pixels in the mask.
+ * @param color: pixel color.
+ * @param pixel: pixel color, already converted to the framebuffer format.
+ */
+static void blitRow(int16_t x, int16_t y, uint32_t mask, uint8_t width,
+                    color_t color, PIXEL_T pixel)
+{
+    // Row and column zero are not drawn, as done by the original text renderer
+    if((y <= 0) || (y >= SCREEN_HEIGHT) || (x >= SCREEN_WIDTH))
+        return;
+
+    if(x <= 0)
+    {
+        int16_t skip = 1 - x;
+        if(skip >= width)
+            return;
+
+        mask  >>= skip;
+        width  -= skip;
+        x       = 1;
+    }
+
+    if((x + width) > SCREEN_WIDTH)
+    {
+        width = SCREEN_WIDTH - x;
+        mask &= (1UL << width) - 1;
+    }
+
+    if(mask == 0)
+        return;
+
+    markRow(y);
+
+#ifdef PIX_FMT_RGB565
+    if(color.alpha < 255)
+    {
+        while(mask != 0)
+        {
+            point_t pos = {(int16_t) (x + __builtin_ctz(mask)), y};
+            gfx_setPixel(pos, color);
+            mask &= mask - 1;
+        }
+
+        return;
+    }
+
+    PIXEL_T *row = &buf[x + (y * SCREEN_WIDTH)];
+    while(mask != 0)
+    {
+        row[__builtin_ctz(mask)] = pixel;
+        mask &= mask - 1;
+    }
+#elif defined PIX_FMT_BW
+    (void) color;
+
+    uint32_t pos  = x + (y * SCREEN_WIDTH);
+    uint8_t *cell = &buf[pos / 8];
+    uint64_t bits = ((uint64_t) mask) << (pos % 8);
+
+    for(; bits != 0; bits >>= 8, cell++)
+    {
+        if(pixel == BLACK)
+            *cell |= (uint8_t) bits;
+        else
+            *cell &= ~((uint8_t) bits);
+    }
+#endif
+}
+
 uint8_t gfx_getFontHeight(fontSize_t size)
 {
     GFXfont f = fonts[size];
@@ -482,18 +794,32 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
     uint16_t saved_start_y = start.y;
     uint16_t line_h = 0;
 
+    // Convert color and look up the glyph cache once for the whole string
+#ifdef PIX_FMT_RGB565
+    PIXEL_T pixel = _true2highColor(color);
+#elif defined PIX_FMT_BW
+    // Ignore more than half transparent pixels
+    if(color.alpha < 128) color.alpha = 0;
+    PIXEL_T pixel = _color2bw(color);
+#endif
+
+    int8_t cache = -1;
+    for(uint8_t i = 0; i < NUM_CACHED_FONTS; i++)
+    {
+        if(cachedFonts[i] == size)
+            cache = i;
+    }
+
     /* For each char in the string */
     for(unsigned i = 0; i < len; i++)
     {
         char c = buf[i];
         GFXglyph glyph = f.glyph[c - f.first];
-        uint8_t *bitmap = f.bitmap;
 
         uint16_t bo = glyph.bitmapOffset;
         uint8_t w = glyph.width, h = glyph.height;
         int8_t xo = glyph.xOffset,
                yo = glyph.yOffset;
-        uint8_t xx, yy, bits = 0, bit = 0;
         line_h = h;
 
         // Handle newline and carriage return
@@ -526,32 +852,32 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
             start.y += f.yAdvance;
         }
 
-        // Draw bitmap
-        for (yy = 0; yy < h; yy++)
+        // Draw bitmap, one row at a time
+        if(color.alpha != 0)
         {
-            for (xx = 0; xx < w; xx++)
-            {
-                if (!(bit++ & 7))
-                {
-                    bits = bitmap[bo++];
-                }
+            const uint16_t *rows = cachedGlyph(cache, &f, c - f.first);
+            int16_t x = start.x + xo;
+            int16_t y = start.y + yo;
 
-                if (bits & 0x80)
+            if(rows != NULL)
+            {
+                for(uint8_t yy = 0; yy < h; yy++)
+                    blitRow(x, y + yy, rows[yy], w, color, pixel);
+            }
+            else
+            {
+                uint32_t pos = bo * 8;
+                for(uint8_t yy = 0; yy < h; yy++)
                 {
-                    if (start.y + yo + yy < SCREEN_HEIGHT &&
-                        start.x + xo + xx < SCREEN_WIDTH &&
-                        start.y + yo + yy > 0 &&
-                        start.x + xo + xx > 0)
+                    for(uint8_t xx = 0; xx < w; xx += 32)
                     {
-                        point_t pos;
-                        pos.x = start.x + xo + xx;
-                        pos.y = start.y + yo + yy;
-                        gfx_setPixel(pos, color);
-
+                        uint8_t  n    = ((w - xx) > 32) ? 32 : (w - xx);
+                        uint32_t mask = glyphRowBits(f.bitmap, pos + xx, n);
+                        blitRow(x + xx, y + yy, mask, n, color, pixel);
                     }
-                }
 
-                bits <<= 1;
+                    pos += w;
+                }
             }
         }
 
@@ -564,16 +890,32 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
     return text_size;
 }
 
+/**
+ * Format a string into the shared text buffer. Format strings without any
+ * conversion specifier are returned as they are, skipping vsnprintf.
+ * @param fmt: format string
+ * @param ap: format arguments
+ * @return pointer to the formatted string
+ */
+static const char *formatText(const char *fmt, va_list ap)
+{
+    if((strchr(fmt, '%') == NULL) && (strlen(fmt) < (sizeof(text) - 1)))
+        return fmt;
+
+    vsnprintf(text, sizeof(text)-1, fmt, ap);
+    return text;
+}
+
 point_t gfx_print(point_t start, fontSize_t size, textAlign_t alignment,
                   color_t color, const char *fmt, ... )
 {
     // Get format string and arguments from var char
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(text, sizeof(text)-1, fmt, ap);
+    const char *str = formatText(fmt, ap);
     va_end(ap);
 
-    return gfx_printBuffer(start, size, alignment, color, text);
+    return gfx_printBuffer(start, size, alignment, color, str);
 }
 
 point_t gfx_printLine(uint8_t cur, uint8_t tot, int16_t startY, int16_t endY,
@@ -583,7 +925,7 @@ point_t gfx_printLine(uint8_t cur, uint8_t tot, int16_t startY, int16_t endY,
     // Get format string and arguments from var char
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(text, sizeof(text)-1, fmt, ap);
+    const char *str = formatText(fmt, ap);
     va_end(ap);
 
     // Estimate font height by reading the gliph | height
@@ -600,7 +942,7 @@ point_t gfx_printLine(uint8_t cur, uint8_t tot, int16_t startY, int16_t endY,
     int16_t printY = startY + (cur * (gap + fontH));
 
     point_t start = {startX, printY};
-    return gfx_printBuffer(start, size, alignment, color, text);
+    return gfx_printBuffer(start, size, alignment, color, str);
 }
 
 // Print an error message to the center of the screen, surronded by a red (when possible) box
@@ -81,6 +81,11 @@ bool input_scanKeyboard(kbd_msg_t *msg)
     return kbd_event;
 }
 
+bool input_keyHeld()
+{
+    return (prevKeys != 0);
+}
+
 bool input_isNumberPressed(kbd_msg_t msg)
 {
     return msg.keys & KBD_NUM_MASK;
@@ -0,0 +1,425 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <nvmem_journal.h>
+#include <nvmem_access.h>
+#include <string.h>
+#include <errno.h>
+#include <crc.h>
+
+/*
+ * Layout of a bank:
+ *
+ * - header: magic number, sequence number and CRC of both;
+ * - records, each one aligned to the device write size:
+ *     [key][~key][offset][length][data ...][CRC]
+ *
+ * Erased memory is assumed to read as 0xFF, a record starting with a key
+ * value of 0xFF marks the end of the log. Multi-byte fields are stored in
+ * little endian order.
+ */
+
+static const uint32_t JOURNAL_MAGIC = 0x4C4E4A4F;   // "OJNL"
+static const size_t   BANK_HDR_LEN  = 10;
+static const size_t   REC_HDR_LEN   = 6;
+static const size_t   REC_CRC_LEN   = 2;
+
+/**
+ * \internal
+ * Round a size up to the next multiple of the device write unit.
+ */
+static inline size_t align(const nvmJournal_t *j, const size_t size)
+{
+    return ((size + j->wrSize - 1) / j->wrSize) * j->wrSize;
+}
+
+static inline uint16_t getU16(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8);
+}
+
+static inline void putU16(uint8_t *buf, const uint16_t value)
+{
+    buf[0] = value & 0xFF;
+    buf[1] = value >> 8;
+}
+
+/**
+ * \internal
+ * Check if a region of a bank is erased. The record scratch buffer is used
+ * for reading.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param addr: start address.
+ * @param len: length of the region.
+ * @return true if all the bytes of the region are 0xFF.
+ */
+static bool isErased(nvmJournal_t *j, uint32_t addr, size_t len)
+{
+    while(len > 0)
+    {
+        size_t chunk = len;
+        if(chunk > sizeof(j->record))
+            chunk = sizeof(j->record);
+
+        if(nvmArea_read(j->area, addr, j->record, chunk) < 0)
+            return false;
+
+        for(size_t i = 0; i < chunk; i++)
+        {
+            if(j->record[i] != 0xFF)
+                return false;
+        }
+
+        addr += chunk;
+        len  -= chunk;
+    }
+
+    return true;
+}
+
+/**
+ * \internal
+ * Read and validate the header of a bank.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param bank: bank number.
+ * @param sequence: pointer to a variable where to store the sequence number.
+ * @return true if the bank header is valid.
+ */
+static bool readBankHeader(nvmJournal_t *j, const uint8_t bank,
+                           uint32_t *sequence)
+{
+    uint8_t hdr[BANK_HDR_LEN];
+    if(nvmArea_read(j->area, j->bankAddr[bank], hdr, sizeof(hdr)) < 0)
+        return false;
+
+    uint32_t magic;
+    memcpy(&magic, &hdr[0], sizeof(uint32_t));
+    memcpy(sequence, &hdr[4], sizeof(uint32_t));
+
+    if(magic != JOURNAL_MAGIC)
+        return false;
+
+    return getU16(&hdr[8]) == crc_ccitt(hdr, 8);
+}
+
+/**
+ * \internal
+ * Build a record in the scratch buffer.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param key: key index.
+ * @param data: value of the key.
+ * @param offset: offset of the first byte to be stored.
+ * @param length: number of bytes to be stored.
+ * @return size of the record.
+ */
+static size_t buildRecord(nvmJournal_t *j, const uint8_t key, const void *data,
+                          const uint16_t offset, const uint16_t length)
+{
+    const uint8_t *src = ((const uint8_t *) data) + offset;
+
+    j->record[0] = key;
+    j->record[1] = ~key;
+    putU16(&j->record[2], offset);
+    putU16(&j->record[4], length);
+    memcpy(&j->record[REC_HDR_LEN], src, length);
+
+    uint16_t crc = crc_ccitt(j->record, REC_HDR_LEN + length);
+    putU16(&j->record[REC_HDR_LEN + length], crc);
+
+    return REC_HDR_LEN + length + REC_CRC_LEN;
+}
+
+/**
+ * \internal
+ * Replay the records of the active bank into the RAM copies of the keys and
+ * find the first free byte of the bank.
+ *
+ * @param j: pointer to the journal data structure.
+ */
+static void replay(nvmJournal_t *j)
+{
+    const uint32_t base = j->bankAddr[j->bank];
+
+    j->head = align(j, BANK_HDR_LEN);
+
+    while((j->head + REC_HDR_LEN + REC_CRC_LEN) <= j->bankSize)
+    {
+        uint8_t *rec = j->record;
+        if(nvmArea_read(j->area, base + j->head, rec, REC_HDR_LEN) < 0)
+            break;
+
+        // End of the log
+        if(rec[0] == 0xFF)
+            break;
+
+        uint8_t  key    = rec[0];
+        uint8_t  keyChk = ~rec[1];
+        uint16_t offset = getU16(&rec[2]);
+        uint16_t length = getU16(&rec[4]);
+        size_t   recLen = REC_HDR_LEN + length + REC_CRC_LEN;
+
+        if((key >= j->numKeys) || (key != keyChk) ||
+           (length == 0) || ((offset + length) > j->keys[key].size) ||
+           ((j->head + recLen) > j->bankSize))
+            break;
+
+        if(nvmArea_read(j->area, base + j->head + REC_HDR_LEN,
+                        &rec[REC_HDR_LEN], length + REC_CRC_LEN) < 0)
+            break;
+
+        uint16_t crc = crc_ccitt(rec, REC_HDR_LEN + length);
+        if(crc != getU16(&rec[REC_HDR_LEN + length]))
+            break;
+
+        // A partial update is meaningful only if the key already has a value
+        uint8_t mask = 1 << key;
+        if(((j->valid & mask) != 0) || (length == j->keys[key].size))
+        {
+            uint8_t *dst = (uint8_t *) j->keys[key].data;
+            memcpy(dst + offset, &rec[REC_HDR_LEN], length);
+            j->valid |= mask;
+        }
+
+        j->head += align(j, recLen);
+    }
+
+    // Data after the last valid record comes from an interrupted write, new
+    // records cannot be appended to this bank.
+    if(j->head < j->bankSize)
+    {
+        if(isErased(j, base + j->head, j->bankSize - j->head) == false)
+            j->dirty = true;
+    }
+}
+
+/**
+ * \internal
+ * Get the bank which is going to be the target of the next compaction.
+ *
+ * @param j: pointer to the journal data structure.
+ * @return bank number.
+ */
+static inline uint8_t spareBank(const nvmJournal_t *j)
+{
+    return (j->mounted) ? (j->bank ^ 1) : 0;
+}
+
+/**
+ * \internal
+ * Erase a bank, unless it is already erased.
+ *
+ * @param j: pointer to the journal data structure.
+ * @param bank: bank number.
+ * @return 0 on success, a negative error code otherwise.
+ */
+static int eraseBank(nvmJournal_t *j, const uint8_t bank)
+{
+    const uint32_t base = j->bankAddr[bank];
+
+    if(isErased(j, base, j->bankSize))
+        return 0;
+
+    return nvmArea_erase(j->area, base, j->bankSize);
+}
+
+/**
+ * \internal
+ * Write the current value of all the keys to the inactive bank and make it
+ * the active one. The new bank becomes valid only when its header is written,
+ * after all the records.
+ *
+ * @param j: pointer to the journal data structure.
+ * @return 0 on success, a negative error code otherwise.
+ */
+static int compact(nvmJournal_t *j)
+{
+    const uint8_t  target = spareBank(j);
+    const uint32_t base   = j->bankAddr[target];
+
+    int ret = eraseBank(j, target);
+    if(ret < 0)
+        return ret;
+
+    uint32_t pos = align(j, BANK_HDR_LEN);
+    for(uint8_t key = 0; key < j->numKeys; key++)
+    {
+        if(nvmJournal_hasValue(j, key) == false)
+            continue;
+
+        const struct nvmJournalKey *k = &j->keys[key];
+        size_t len = buildRecord(j, key, k->data, 0, k->size);
+        if((pos + len) > j->bankSize)
+            return -ENOSPC;
+
+        ret = nvmArea_write(j->area, base + pos, j->record, len);
+        if(ret < 0)
+            return ret;
+
+        pos += align(j, len);
+    }
+
+    uint32_t sequence = j->sequence + 1;
+    uint8_t  hdr[BANK_HDR_LEN];
+    memcpy(&hdr[0], &JOURNAL_MAGIC, sizeof(uint32_t));
+    memcpy(&hdr[4], &sequence, sizeof(uint32_t));
+    putU16(&hdr[8], crc_ccitt(hdr, 8));
+
+    ret = nvmArea_write(j->area, base, hdr, sizeof(hdr));
+    if(ret < 0)
+        return ret;
+
+    j->bank     = target;
+    j->head     = pos;
+    j->sequence = sequence;
+    j->mounted  = true;
+    j->dirty    = false;
+    j->numCompactions++;
+
+    return 0;
+}
+
+
+int nvmJournal_open(nvmJournal_t *j, const struct nvmArea *area,
+                    const uint32_t bank0, const uint32_t bank1,
+                    const struct nvmJournalKey *keys, const size_t numKeys)
+{
+    memset(j, 0x00, sizeof(nvmJournal_t));
+
+    if(numKeys > NVM_JOURNAL_MAX_KEYS)
+        return -EINVAL;
+
+    for(size_t i = 0; i < numKeys; i++)
+    {
+        if(keys[i].size > NVM_JOURNAL_MAX_SIZE)
+            return -EINVAL;
+    }
+
+    const struct nvmPartition *p0 = &(area->partitions[bank0]);
+    const struct nvmPartition *p1 = &(area->partitions[bank1]);
+    if(p0->size != p1->size)
+        return -EINVAL;
+
+    j->area        = area;
+    j->keys        = keys;
+    j->numKeys     = numKeys;
+    j->bankAddr[0] = area->startAddr + p0->offset;
+    j->bankAddr[1] = area->startAddr + p1->offset;
+    j->bankSize    = p0->size;
+    j->wrSize      = nvmArea_params(area)->write_size;
+
+    if(j->wrSize == 0)
+        j->wrSize = 1;
+
+    uint32_t seq[2];
+    bool     ok[2];
+    ok[0] = readBankHeader(j, 0, &seq[0]);
+    ok[1] = readBankHeader(j, 1, &seq[1]);
+
+    if((ok[0] == false) && (ok[1] == false))
+        return -ENOENT;
+
+    // When both banks are valid, the active one is the most recent. The old
+    // one is erased only when it becomes the target of a compaction.
+    j->bank = (ok[0]) ? 0 : 1;
+    if(ok[0] && ok[1] && (((int32_t) (seq[1] - seq[0])) > 0))
+        j->bank = 1;
+
+    j->sequence = seq[j->bank];
+    j->mounted  = true;
+    replay(j);
+
+    return 0;
+}
+
+int nvmJournal_read(const nvmJournal_t *j, const uint8_t key, void *data)
+{
+    if((key >= j->numKeys) || (nvmJournal_hasValue(j, key) == false))
+        return -ENOENT;
+
+    memcpy(data, j->keys[key].data, j->keys[key].size);
+
+    return 0;
+}
+
+int nvmJournal_write(nvmJournal_t *j, const uint8_t key, const void *data)
+{
+    if((j->area == NULL) || (key >= j->numKeys))
+        return -EINVAL;
+
+    const struct nvmJournalKey *k = &j->keys[key];
+    const uint8_t *newVal = (const uint8_t *) data;
+    const uint8_t *curVal = (const uint8_t *) k->data;
+    size_t first = 0;
+    size_t last  = k->size - 1;
+
+    // Find the range of bytes which changed
+    if(nvmJournal_hasValue(j, key))
+    {
+        while((first < k->size) && (newVal[first] == curVal[first]))
+            first++;
+
+        if(first == k->size)
+            return 0;
+
+        while(newVal[last] == curVal[last])
+            last--;
+    }
+
+    size_t len    = last - first + 1;
+    size_t recLen = REC_HDR_LEN + len + REC_CRC_LEN;
+
+    if((j->mounted == false) || (j->dirty) ||
+       ((j->head + recLen) > j->bankSize))
+    {
+        memcpy(k->data, data, k->size);
+        j->valid |= (1 << key);
+        return compact(j);
+    }
+
+    buildRecord(j, key, data, first, len);
+    int ret = nvmArea_write(j->area, j->bankAddr[j->bank] + j->head,
+                            j->record, recLen);
+    if(ret < 0)
+    {
+        // Part of the record may have been written
+        j->dirty = true;
+        return ret;
+    }
+
+    memcpy(k->data, data, k->size);
+    j->valid |= (1 << key);
+    j->head  += align(j, recLen);
+    j->numRecords++;
+
+    return 0;
+}
+
+int nvmJournal_prepare(nvmJournal_t *j)
+{
+    if(j->area == NULL)
+        return -EINVAL;
+
+    // The spare bank holds an older copy of the data, superseded by the one
+    // in the active bank: losing it halfway through the erase is harmless.
+    return eraseBank(j, spareBank(j));
+}
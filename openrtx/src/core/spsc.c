@@ -0,0 +1,221 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <string.h>
+#include "spsc.h"
+
+/*
+ * Head and tail are free-running indices: their difference is the number of
+ * elements in the queue and the position inside the storage is obtained by
+ * masking them with the capacity minus one.
+ *
+ * The producer only writes head, the consumer only writes tail. The only
+ * exception is spsc_pushOverwrite(), which advances tail through a CAS to
+ * discard the oldest element: for this reason the consumer commits its pop
+ * with a CAS too and, if it fails, retries discarding the data just copied.
+ *
+ * Threads blocking on the queue register themselves in the waiters counter
+ * before checking again the queue state under the mutex. The other side checks
+ * the counter after having updated its index, with a full memory barrier in
+ * between, and takes the mutex only when someone is actually waiting.
+ */
+
+static inline uint8_t *slot(spscQueue_t *q, const size_t index)
+{
+    return q->data + ((index & q->mask) * q->elemSize);
+}
+
+static inline bool isFull(spscQueue_t *q)
+{
+    size_t head = atomic_load(&q->head);
+    size_t tail = atomic_load(&q->tail);
+
+    return (head - tail) > q->mask;
+}
+
+static inline bool isEmpty(spscQueue_t *q)
+{
+    size_t head = atomic_load(&q->head);
+    size_t tail = atomic_load(&q->tail);
+
+    return head == tail;
+}
+
+static void wakeWaiters(spscQueue_t *q)
+{
+    if(q->wakeup == false)
+        return;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if(atomic_load(&q->waiters) == 0)
+        return;
+
+    pthread_mutex_lock(&q->mutex);
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+
+bool spsc_init(spscQueue_t *q, void *storage, const size_t elemSize,
+               const size_t capacity, const bool wakeup)
+{
+    if((q == NULL) || (storage == NULL))
+        return false;
+
+    // Capacity must be a non-zero power of two
+    if((capacity == 0) || ((capacity & (capacity - 1)) != 0))
+        return false;
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->waiters, 0);
+    q->mask     = capacity - 1;
+    q->elemSize = elemSize;
+    q->data     = (uint8_t *) storage;
+    q->wakeup   = wakeup;
+
+    if(wakeup)
+    {
+        pthread_mutex_init(&q->mutex, NULL);
+        pthread_cond_init(&q->cond, NULL);
+    }
+
+    return true;
+}
+
+void spsc_terminate(spscQueue_t *q)
+{
+    if((q == NULL) || (q->wakeup == false))
+        return;
+
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->cond);
+    q->wakeup = false;
+}
+
+void spsc_reset(spscQueue_t *q)
+{
+    if(q == NULL)
+        return;
+
+    atomic_store(&q->head, 0);
+    atomic_store(&q->tail, 0);
+}
+
+bool spsc_push(spscQueue_t *q, const void *elem, const bool blocking)
+{
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    if((head - tail) > q->mask)
+    {
+        if((blocking == false) || (q->wakeup == false))
+            return false;
+
+        // The call is blocking: wait until there is some free space
+        pthread_mutex_lock(&q->mutex);
+        atomic_fetch_add(&q->waiters, 1);
+
+        while(isFull(q))
+            pthread_cond_wait(&q->cond, &q->mutex);
+
+        atomic_fetch_sub(&q->waiters, 1);
+        pthread_mutex_unlock(&q->mutex);
+    }
+
+    memcpy(slot(q, head), elem, q->elemSize);
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    wakeWaiters(q);
+
+    return true;
+}
+
+bool spsc_pushOverwrite(spscQueue_t *q, const void *elem)
+{
+    size_t head    = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t tail    = atomic_load_explicit(&q->tail, memory_order_acquire);
+    bool   dropped = false;
+
+    // Queue full, discard the oldest element. If the exchange fails the
+    // consumer has just popped it and there is free space anyway.
+    if((head - tail) > q->mask)
+    {
+        dropped = atomic_compare_exchange_strong_explicit(&q->tail, &tail,
+                                                          tail + 1,
+                                                          memory_order_acq_rel,
+                                                          memory_order_acquire);
+    }
+
+    memcpy(slot(q, head), elem, q->elemSize);
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    wakeWaiters(q);
+
+    return dropped;
+}
+
+bool spsc_pop(spscQueue_t *q, void *elem, const bool blocking)
+{
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    while(true)
+    {
+        size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+        if(head == tail)
+        {
+            if((blocking == false) || (q->wakeup == false))
+                return false;
+
+            // The call is blocking: wait until there is something in the queue
+            pthread_mutex_lock(&q->mutex);
+            atomic_fetch_add(&q->waiters, 1);
+
+            while(isEmpty(q))
+                pthread_cond_wait(&q->cond, &q->mutex);
+
+            atomic_fetch_sub(&q->waiters, 1);
+            pthread_mutex_unlock(&q->mutex);
+
+            tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+            continue;
+        }
+
+        memcpy(elem, slot(q, tail), q->elemSize);
+
+        // On failure the element has been overwritten by the producer and
+        // tail is updated with the index of the oldest valid element.
+        if(atomic_compare_exchange_strong_explicit(&q->tail, &tail, tail + 1,
+                                                   memory_order_acq_rel,
+                                                   memory_order_acquire))
+            break;
+    }
+
+    wakeWaiters(q);
+
+    return true;
+}
+
+size_t spsc_size(spscQueue_t *q)
+{
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    return head - tail;
+}
@@ -34,6 +34,29 @@ state_t state;
 pthread_mutex_t state_mutex;
 long long int lastUpdate = 0;
 
+/*
+ * Snapshot of the state fields shown by the UI, taken when the last status
+ * event has been sent. Status events are sent only when one of these fields
+ * changes or, at least, once every STATUS_EVENT_MAX_INTERVAL milliseconds to
+ * let the UI run its timeouts.
+ */
+#define STATUS_EVENT_MAX_INTERVAL 1000
+
+static long long lastEvent    = 0;
+static bool      eventPending = true;
+static uint16_t  lastVbat;
+static uint8_t   lastCharge;
+static int16_t   lastRssi;
+static uint8_t   lastOpStatus;
+static bool      lastSqlOpen;
+static bool      lastLsfOk;
+#ifdef RTC_PRESENT
+static uint8_t   lastSecond;
+#endif
+#ifdef GPS_PRESENT
+static gps_t     lastGps;
+#endif
+
 // Commonly used frequency steps, expressed in Hz
 uint32_t freq_steps[] = { 1000, 5000, 6250, 10000, 12500, 15000, 20000, 25000, 50000, 100000 };
 size_t n_freq_steps = sizeof(freq_steps) / sizeof(freq_steps[0]);
@@ -97,13 +120,72 @@ void state_terminate()
     pthread_mutex_destroy(&state_mutex);
 }
 
+/**
+ * \internal Check if some of the state fields shown by the UI has changed since
+ * the last status event and update the corresponding snapshot.
+ * Has to be called with the state mutex locked.
+ *
+ * @return true if the UI has to be notified about a status change.
+ */
+static bool _statusChanged()
+{
+    bool changed = false;
+
+    // Battery voltage is displayed with 100mV resolution
+    uint16_t vbat = state.v_bat / 100;
+    if((vbat != lastVbat) || (state.charge != lastCharge))
+    {
+        lastVbat   = vbat;
+        lastCharge = state.charge;
+        changed    = true;
+    }
+
+    int16_t rssi = (int16_t) state.rssi;
+    if(rssi != lastRssi)
+    {
+        lastRssi = rssi;
+        changed  = true;
+    }
+
+    #ifdef RTC_PRESENT
+    if(state.time.second != lastSecond)
+    {
+        lastSecond = state.time.second;
+        changed    = true;
+    }
+    #endif
+
+    #ifdef GPS_PRESENT
+    if(memcmp(&state.gps_data, &lastGps, sizeof(gps_t)) != 0)
+    {
+        lastGps = state.gps_data;
+        changed = true;
+    }
+    #endif
+
+    rtxStatus_t rtxStatus = rtx_getCurrentStatus();
+    bool        sqlOpen   = rtx_rxSquelchOpen();
+    if((rtxStatus.opStatus != lastOpStatus) ||
+       (rtxStatus.lsfOk    != lastLsfOk)    ||
+       (sqlOpen            != lastSqlOpen))
+    {
+        lastOpStatus = rtxStatus.opStatus;
+        lastLsfOk    = rtxStatus.lsfOk;
+        lastSqlOpen  = sqlOpen;
+        changed      = true;
+    }
+
+    return changed;
+}
+
 void state_task()
 {
     // Update radio state once every 100ms
-    if((getTick() - lastUpdate) < 100)
+    long long now = getTick();
+    if((now - lastUpdate) < 100)
         return;
 
-    lastUpdate = getTick();
+    lastUpdate = now;
 
     pthread_mutex_lock(&state_mutex);
 
@@ -131,9 +213,20 @@ void state_task()
     state.time = platform_getCurrentTime();
     #endif
 
+    if(_statusChanged())
+        eventPending = true;
+
     pthread_mutex_unlock(&state_mutex);
 
-    ui_pushEvent(EVENT_STATUS, 0);
+    // Notify the UI only when something changed, to avoid useless wakeups
+    if((now - lastEvent) >= STATUS_EVENT_MAX_INTERVAL)
+        eventPending = true;
+
+    if(eventPending && ui_pushEvent(EVENT_STATUS, 0))
+    {
+        eventPending = false;
+        lastEvent    = now;
+    }
 }
 
 void state_resetSettingsAndVfo()
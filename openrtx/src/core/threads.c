@@ -42,10 +42,72 @@
 #if defined(PLATFORM_TTWRPLUS)
 #include <pmu.h>
 #endif
+#if defined(PLATFORM_LINUX)
+#include <stdatomic.h>
+#endif
+
+/*
+ * Wakeup periods of the UI thread, in milliseconds. The keyboard is polled
+ * with the shorter period only while a key is held down, to detect long
+ * presses and keep the UI responsive; otherwise the idle period is used.
+ * The idle period is the longest one still catching short keypresses.
+ */
+#define UI_ACTIVE_PERIOD 25
+#define UI_IDLE_PERIOD   50
+
+/*
+ * Wakeup period of the device management thread, in milliseconds. GPS data is
+ * buffered by the driver, so the GPS task does not need a faster update rate.
+ */
+#define DEV_PERIOD       50
 
 /* Mutex for concurrent access to RTX state variable */
 pthread_mutex_t rtx_mutex;
 
+#if defined(PLATFORM_LINUX)
+static atomic_uint wakeups;         // Total wakeups of UI and device threads
+static unsigned int lastWakeups;    // Wakeup count at last rate computation
+static long long    lastRateTime;   // Timestamp of last rate computation
+
+float threads_getWakeupRate()
+{
+    long long    now   = getTick();
+    unsigned int count = atomic_load(&wakeups);
+    float        rate  = 0.0f;
+
+    if((lastRateTime > 0) && (now > lastRateTime))
+        rate = ((float) (count - lastWakeups) * 1000.0f) / (now - lastRateTime);
+
+    lastWakeups  = count;
+    lastRateTime = now;
+
+    return rate;
+}
+
+#define countWakeup() atomic_fetch_add(&wakeups, 1)
+#else
+#define countWakeup()
+#endif
+
+/**
+ * \internal Compute the time interval until the next wakeup of the UI thread.
+ *
+ * @return wakeup period, in milliseconds.
+ */
+static uint32_t ui_wakeupPeriod()
+{
+    uint32_t period = UI_IDLE_PERIOD;
+    if(input_keyHeld())
+        period = UI_ACTIVE_PERIOD;
+
+    // Voice prompts and beeps need to be updated at their own pace
+    uint32_t vpPeriod = vp_tickInterval();
+    if((vpPeriod > 0) && (vpPeriod < period))
+        period = vpPeriod;
+
+    return period;
+}
+
 /**
  * \internal Thread managing user input and UI
  */
@@ -69,16 +131,23 @@ void *ui_threadFunc(void *arg)
     while(state.devStatus != SHUTDOWN)
     {
         time = getTick();
+        countWakeup();
 
         if(input_scanKeyboard(&kbd_msg))
         {
             ui_pushEvent(EVENT_KBD, kbd_msg.value);
         }
 
-        pthread_mutex_lock(&state_mutex);   // Lock r/w access to radio state
-        ui_updateFSM(&sync_rtx);            // Update UI FSM
-        ui_saveState();                     // Save local state copy
-        pthread_mutex_unlock(&state_mutex); // Unlock r/w access to radio state
+        // Run the UI FSM and take a new state snapshot only when some event
+        // has to be processed.
+        if(ui_eventPending())
+        {
+            pthread_mutex_lock(&state_mutex);   // Lock r/w access to radio state
+            while(ui_eventPending())
+                ui_updateFSM(&sync_rtx);        // Update UI FSM
+            ui_saveState();                     // Save local state copy
+            pthread_mutex_unlock(&state_mutex); // Unlock r/w access to radio state
+        }
 
         vp_tick();                           // continue playing voice prompts in progress if any.
 
@@ -121,8 +190,8 @@ void *ui_threadFunc(void *arg)
             gfx_render();
         }
 
-        // 40Hz update rate for keyboard and UI
-        time += 25;
+        // Adaptive update rate for keyboard, voice prompts and UI
+        time += ui_wakeupPeriod();
         sleepUntil(time);
     }
 
@@ -144,6 +213,7 @@ void *main_thread(void *arg)
     while(state.devStatus != SHUTDOWN)
     {
         time = getTick();
+        countWakeup();
 
         #if defined(PLATFORM_TTWRPLUS)
         pmu_handleIRQ();
@@ -163,8 +233,8 @@ void *main_thread(void *arg)
         // Run state update task
         state_task();
 
-        // Run this loop once every 5ms
-        time += 5;
+        // Run this loop once every 50ms
+        time += DEV_PERIOD;
         sleepUntil(time);
     }
 
@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include <beeps.h>
 #include <errno.h>
 
@@ -42,6 +43,11 @@ static const uint32_t VOICE_PROMPTS_DATA_VERSION = 0x1000;  // v1000 OpenRTX
 #define CODEC2_HEADER_SIZE     7
 #define VP_SEQUENCE_BUF_SIZE   128
 #define BEEP_SEQ_BUF_SIZE      256
+#define VP_BEEP_TICK_INTERVAL  25    // Beep durations are counted in 25ms ticks
+#define VP_PLAY_TICK_INTERVAL  50    // Only checks for the end of the prompt
+#define VP_FRAME_SIZE          8     // Size of a CODEC2 3200 frame
+#define VP_PREFETCH_SIZE       256   // Must be a multiple of VP_FRAME_SIZE
+#define VP_TAIL_FRAMES         2     // Silence frames to play out the last one
 
 typedef struct
 {
@@ -59,12 +65,17 @@ userDictEntry_t;
 
 typedef struct
 {
-    uint16_t buffer[VP_SEQUENCE_BUF_SIZE];  // Buffer of individual prompt indices.
-    uint16_t pos;                           // Index into above buffer.
-    uint16_t length;                        // Number of entries in above buffer.
-    uint32_t c2DataStart;
-    uint32_t c2DataIndex;                   // Index into current codec2 data
-    uint32_t c2DataLength;                  // Length of codec2 data for current prompt.
+    uint32_t start;     // Offset of the codec2 data.
+    uint32_t length;    // Length of the codec2 data, multiple of the frame size.
+}
+vpRange_t;
+
+typedef struct
+{
+    vpRange_t ranges[VP_SEQUENCE_BUF_SIZE]; // Codec2 data of the queued prompts.
+    uint16_t  pos;                          // Index into above buffer.
+    uint16_t  length;                       // Number of entries in above buffer.
+    uint32_t  c2DataIndex;                  // Index into current codec2 data
 }
 vpSequence_t;
 
@@ -95,14 +106,16 @@ static vpSequence_t vpCurrentSequence =
 {
     .pos          = 0,
     .length       = 0,
-    .c2DataStart  = 0,
-    .c2DataIndex  = 0,
-    .c2DataLength = 0
+    .c2DataIndex  = 0
 };
 
 static uint32_t tableOfContents[VOICE_PROMPTS_TOC_SIZE];
 static bool     vpDataLoaded      = false;
 static bool     voicePromptActive = false;
+static uint32_t vpDataSize        = 0;
+
+static atomic_bool vpDataEnd    = false;   // Set by the codec thread
+static uint8_t     vpTailFrames = 0;
 
 static beepData_t beepSeriesBuffer[BEEP_SEQ_BUF_SIZE];
 static uint16_t   currentBeepDuration = 0;
@@ -113,7 +126,15 @@ static pathId     vpAudioPath;
 static long long  vpStartTime;
 
 #ifdef VP_USE_FILESYSTEM
-static FILE *vpFile = NULL;
+static FILE    *vpFile = NULL;
+static uint32_t vpFilePos;      // Current read position, relative to data start
+
+// Double buffered read-ahead of the codec2 data: the decoder consumes one half
+// while the other one holds the next chunk of the sequence, already loaded.
+static uint8_t  prefetchBuf[2][VP_PREFETCH_SIZE];
+static uint16_t prefetchLen[2];
+static uint16_t prefetchPos;
+static uint8_t  prefetchHalf;
 #else
 extern unsigned char _vpdata_start;
 extern unsigned char _vpdata_end;
@@ -146,50 +167,179 @@ static void loadVpToC()
     fread(&tableOfContents, sizeof(tableOfContents), 1, vpFile);
     size_t vpDataOffset = ftell(vpFile);
 
-    if(vpDataOffset == (sizeof(vpHeader_t) + sizeof(tableOfContents)))
-        vpDataLoaded = true;
+    if(vpDataOffset != (sizeof(vpHeader_t) + sizeof(tableOfContents)))
+        return;
+
+    fseek(vpFile, 0L, SEEK_END);
+    size_t fileSize = ftell(vpFile);
+    vpFilePos       = UINT32_MAX;
     #else
     uint8_t *tocPtr = vpData + sizeof(vpHeader_t);
     memcpy(&tableOfContents, tocPtr, sizeof(tableOfContents));
-    vpDataLoaded = true;
+    size_t fileSize = &_vpdata_end - &_vpdata_start;
     #endif
+
+    size_t start = sizeof(vpHeader_t)
+                 + sizeof(tableOfContents)
+                 + CODEC2_HEADER_SIZE;
+
+    if(fileSize <= start)
+        return;
+
+    vpDataSize   = fileSize - start;
+    vpDataLoaded = true;
 }
 
 /**
  * \internal
- * Load Codec2 data for a voice prompt.
+ * Load Codec2 data for a voice prompt. Offset and length have to be inside the
+ * voice prompt data, as ensured by the ranges built when queueing a prompt.
  *
+ * @param data: destination buffer.
  * @param offset: offset relative to the start of the voice prompt data.
  * @param length: data length in bytes.
+ * @return number of bytes loaded.
  */
-static void fetchCodec2Data(uint8_t *data, const size_t offset)
+static size_t fetchCodec2Data(uint8_t *data, const uint32_t offset,
+                              const size_t length)
 {
-    if (vpDataLoaded == false)
-        return;
-
     #ifdef VP_USE_FILESYSTEM
     if (vpFile == NULL)
-        return;
-
-    size_t start = sizeof(vpHeader_t)
-                 + sizeof(tableOfContents)
-                 + CODEC2_HEADER_SIZE;
+        return 0;
 
-    fseek(vpFile, start + offset, SEEK_SET);
-    fread(data, 8, 1, vpFile);
-    #else
-    uint8_t *dataPtr = vpData
-                     + sizeof(vpHeader_t)
+    // Seek only when jumping to a non contiguous prompt
+    if(offset != vpFilePos)
+    {
+        size_t start = sizeof(vpHeader_t)
                      + sizeof(tableOfContents)
                      + CODEC2_HEADER_SIZE;
 
-    if((dataPtr + 8) >= &_vpdata_end)
+        fseek(vpFile, start + offset, SEEK_SET);
+    }
+
+    size_t ret = fread(data, 1, length, vpFile);
+    vpFilePos  = offset + ret;
+
+    return ret;
+    #else
+    const uint8_t *dataPtr = vpData
+                           + sizeof(vpHeader_t)
+                           + sizeof(tableOfContents)
+                           + CODEC2_HEADER_SIZE;
+
+    memcpy(data, dataPtr + offset, length);
+
+    return length;
+    #endif
+}
+
+/**
+ * \internal
+ * Read the next chunk of codec2 data of the queued sequence, advancing the
+ * read position. Data belonging to consecutive prompts is read in a single
+ * pass.
+ *
+ * @param data: destination buffer.
+ * @param size: maximum number of bytes to be read.
+ * @return number of bytes read, zero at the end of the sequence.
+ */
+static size_t readSequence(uint8_t *data, const size_t size)
+{
+    size_t total = 0;
+
+    while((total < size) && (vpCurrentSequence.pos < vpCurrentSequence.length))
     {
-        memset(data, 0x00, 8);
-        return;
+        const vpRange_t *range = &vpCurrentSequence.ranges[vpCurrentSequence.pos];
+        size_t chunk = range->length - vpCurrentSequence.c2DataIndex;
+
+        if(chunk > (size - total))
+            chunk = size - total;
+
+        size_t ret = fetchCodec2Data(data + total,
+                                     range->start + vpCurrentSequence.c2DataIndex,
+                                     chunk);
+
+        total                         += ret;
+        vpCurrentSequence.c2DataIndex += ret;
+
+        // Read error, give up with the rest of the sequence
+        if(ret < chunk)
+        {
+            vpCurrentSequence.pos = vpCurrentSequence.length;
+            break;
+        }
+
+        if(vpCurrentSequence.c2DataIndex >= range->length)
+        {
+            vpCurrentSequence.pos++;
+            vpCurrentSequence.c2DataIndex = 0;
+        }
     }
 
-    memcpy(data, dataPtr + offset, 8);
+    return total;
+}
+
+/**
+ * \internal
+ * Frame source for the codec, called from the codec thread each time a new
+ * frame has to be decoded.
+ *
+ * @param frame: destination buffer for the frame.
+ * @param arg: unused.
+ * @return 1 if a frame has been provided, -1 at the end of the sequence.
+ */
+static int fetchFrame(uint8_t *frame, void *arg)
+{
+    (void) arg;
+
+    #ifdef VP_USE_FILESYSTEM
+    // Current half consumed: reload it with the data following the one in the
+    // other half and switch to the latter.
+    if(prefetchPos >= prefetchLen[prefetchHalf])
+    {
+        prefetchLen[prefetchHalf] = readSequence(prefetchBuf[prefetchHalf],
+                                                 VP_PREFETCH_SIZE);
+        prefetchHalf ^= 1;
+        prefetchPos   = 0;
+    }
+
+    if((prefetchLen[prefetchHalf] - prefetchPos) >= VP_FRAME_SIZE)
+    {
+        memcpy(frame, &prefetchBuf[prefetchHalf][prefetchPos], VP_FRAME_SIZE);
+        prefetchPos += VP_FRAME_SIZE;
+        return 1;
+    }
+    #else
+    if(readSequence(frame, VP_FRAME_SIZE) == VP_FRAME_SIZE)
+        return 1;
+    #endif
+
+    // End of the sequence: let the codec play out the last frames before
+    // signalling the end of the prompt.
+    vpTailFrames++;
+    if(vpTailFrames >= VP_TAIL_FRAMES)
+        atomic_store(&vpDataEnd, true);
+
+    return -1;
+}
+
+/**
+ * \internal
+ * Rewind the read position to the beginning of the queued sequence and, when
+ * reading from a file, load the first chunks of data.
+ */
+static void rewindSequence()
+{
+    vpCurrentSequence.pos         = 0;
+    vpCurrentSequence.c2DataIndex = 0;
+    vpTailFrames                  = 0;
+    atomic_store(&vpDataEnd, false);
+
+    #ifdef VP_USE_FILESYSTEM
+    prefetchLen[0] = readSequence(prefetchBuf[0], VP_PREFETCH_SIZE);
+    prefetchLen[1] = readSequence(prefetchBuf[1], VP_PREFETCH_SIZE);
+    prefetchHalf   = 0;
+    prefetchPos    = 0;
     #endif
 }
 
@@ -277,7 +427,8 @@ static inline void enableSpkOutput()
     // avoid overwriting the path ID with a -1, locking everything.
     if(audioPath_getStatus(vpAudioPath) == PATH_CLOSED)
     {
-        vpAudioPath = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_PROMPT);
+        vpAudioPath = audioPath_requestMixed(SOURCE_MCU, SINK_SPK,
+                                             PRIO_PROMPT, AUDIO_GAIN_UNITY);
     }
 }
 
@@ -410,9 +561,8 @@ void vp_stop()
     disableSpkOutput();
 
     // Clear voice prompt sequence data
-    vpCurrentSequence.pos          = 0;
-    vpCurrentSequence.c2DataIndex  = 0;
-    vpCurrentSequence.c2DataLength = 0;
+    vpCurrentSequence.pos         = 0;
+    vpCurrentSequence.c2DataIndex = 0;
 
     // If any beep is playing, immediately stop it.
     beep_flush();
@@ -433,9 +583,39 @@ void vp_queuePrompt(const uint16_t prompt)
     if (voicePromptActive)
         vp_flush();
 
+    if ((vpDataLoaded == false) || (prompt >= (VOICE_PROMPTS_TOC_SIZE - 1)))
+        return;
+
+    // Resolve the prompt into its codec2 data range, so that playback has
+    // only to read the data sequentially.
+    uint32_t start  = tableOfContents[prompt];
+    uint32_t end    = tableOfContents[prompt + 1];
+
+    if((end <= start) || (start >= vpDataSize))
+        return;
+
+    if(end > vpDataSize)
+        end = vpDataSize;
+
+    uint32_t length = ((end - start) / VP_FRAME_SIZE) * VP_FRAME_SIZE;
+    if(length == 0)
+        return;
+
+    // Merge with the previous range, if contiguous
+    if (vpCurrentSequence.length > 0)
+    {
+        vpRange_t *last = &vpCurrentSequence.ranges[vpCurrentSequence.length - 1];
+        if ((last->start + last->length) == start)
+        {
+            last->length += length;
+            return;
+        }
+    }
+
     if (vpCurrentSequence.length < VP_SEQUENCE_BUF_SIZE)
     {
-        vpCurrentSequence.buffer[vpCurrentSequence.length] = prompt;
+        vpCurrentSequence.ranges[vpCurrentSequence.length].start  = start;
+        vpCurrentSequence.ranges[vpCurrentSequence.length].length = length;
         vpCurrentSequence.length++;
     }
 }
@@ -584,61 +764,42 @@ void vp_tick()
         vpStartTime       = 0;
         voicePromptActive = true;
         enableSpkOutput();
-        codec_startDecode(vpAudioPath);
+        rewindSequence();
+
+        // Codec2 data is pulled directly by the codec thread, playback does
+        // not depend on how often this function gets called.
+        codec_startDecodeFrom(vpAudioPath, CODEC_MODE_3200, 1, fetchFrame,
+                              NULL);
     }
 
     if (voicePromptActive == false)
         return;
 
-    while(vpCurrentSequence.pos < vpCurrentSequence.length)
+    // see if we've finished, either because the whole sequence has been
+    // played or because the codec stopped due to a closed audio path.
+    if((atomic_load(&vpDataEnd) == true) || (codec_running() == false))
     {
-        // get the codec2 data for the current prompt if needed.
-        if (vpCurrentSequence.c2DataLength == 0)
-        {
-            // obtain the data for the prompt.
-            int promptNumber = vpCurrentSequence.buffer[vpCurrentSequence.pos];
-
-            vpCurrentSequence.c2DataIndex  = 0;
-            vpCurrentSequence.c2DataStart  = tableOfContents[promptNumber];
-            vpCurrentSequence.c2DataLength = ((tableOfContents[promptNumber + 1]
-                                           - tableOfContents[promptNumber])/8 * 8);
-        }
-
-        while (vpCurrentSequence.c2DataIndex < vpCurrentSequence.c2DataLength)
-        {
-            // push the codec2 data in lots of 8 byte frames.
-            uint8_t c2Frame[8] = {0};
-
-            fetchCodec2Data(c2Frame, vpCurrentSequence.c2DataStart +
-                                     vpCurrentSequence.c2DataIndex);
-
-            // Do not push codec2 data if audio path is closed or suspended
-            if(audioPath_getStatus(vpAudioPath) != PATH_OPEN)
-                return;
-
-            if(codec_pushFrame(c2Frame, false) < 0)
-                return;
-
-            vpCurrentSequence.c2DataIndex += 8;
-        }
-
-        vpCurrentSequence.pos++;            // ready for next prompt in sequence.
-        vpCurrentSequence.c2DataLength = 0; // flag that we need to get more data.
-        vpCurrentSequence.c2DataIndex  = 0;
-    }
-
-    // see if we've finished.
-    if(vpCurrentSequence.pos == vpCurrentSequence.length)
-    {
-        voicePromptActive              = false;
-        vpCurrentSequence.pos          = 0;
-        vpCurrentSequence.c2DataIndex  = 0;
-        vpCurrentSequence.c2DataLength = 0;
+        // Stop the codec thread first: it keeps pulling frames until then and
+        // would read the sequence again from the start.
+        voicePromptActive             = false;
         codec_stop(vpAudioPath);
+        vpCurrentSequence.pos         = 0;
+        vpCurrentSequence.c2DataIndex = 0;
         disableSpkOutput();
     }
 }
 
+uint32_t vp_tickInterval()
+{
+    if((currentBeepDuration > 0) || (vpStartTime > 0))
+        return VP_BEEP_TICK_INTERVAL;
+
+    if(voicePromptActive)
+        return VP_PLAY_TICK_INTERVAL;
+
+    return 0;
+}
+
 bool vp_isPlaying()
 {
     return voicePromptActive;
@@ -0,0 +1,123 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17Bert.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace M17;
+
+void M17BertGenerator::nextFrame(bert_t& data)
+{
+    data.fill(0x00);
+
+    for(size_t i = 0; i < M17_BERT_BITS; i++)
+        setBit(data, i, prbs.generateBit());
+}
+
+
+M17BertReceiver::M17BertReceiver()
+{
+    reset();
+}
+
+void M17BertReceiver::reset()
+{
+    prbs.reset();
+    locked    = false;
+    totBits   = 0;
+    totErrors = 0;
+    totFrames = 0;
+    totLost   = 0;
+}
+
+bool M17BertReceiver::process(const bert_t& data)
+{
+    totFrames++;
+
+    if(locked)
+    {
+        PRBS9   start  = prbs;
+        uint8_t errors = countErrors(data, prbs);
+
+        // Too many errors: the frame may come after a sequence of missed
+        // frames, search it further ahead in the PRBS9 sequence.
+        if(errors > M17_BERT_MAX_ERRORS)
+        {
+            PRBS9 skip = start;
+            for(uint8_t lost = 1; lost <= M17_BERT_MAX_LOST; lost++)
+            {
+                for(size_t i = 0; i < M17_BERT_BITS; i++)
+                    skip.generateBit();
+
+                PRBS9   gen = skip;
+                uint8_t err = countErrors(data, gen);
+                if(err <= M17_BERT_MAX_ERRORS)
+                {
+                    prbs     = gen;
+                    errors   = err;
+                    totLost += lost;
+                    break;
+                }
+            }
+        }
+
+        if(errors <= M17_BERT_MAX_ERRORS)
+        {
+            totBits   += M17_BERT_BITS;
+            totErrors += errors;
+            return true;
+        }
+
+        // Syncronisation lost, start over from this frame
+        prbs.reset();
+        locked = false;
+    }
+
+    // Feed the validator, checking the bits following the point where
+    // syncronisation is reached.
+    for(size_t i = 0; i < M17_BERT_BITS; i++)
+    {
+        bool bit = getBit(data, i);
+        if(locked)
+        {
+            totBits++;
+            if(prbs.validateBit(bit) == false) totErrors++;
+        }
+        else
+        {
+            locked = prbs.syncronize(bit);
+        }
+    }
+
+    return locked;
+}
+
+uint8_t M17BertReceiver::countErrors(const bert_t& data, PRBS9& gen)
+{
+    uint8_t errors = 0;
+
+    for(size_t i = 0; i < M17_BERT_BITS; i++)
+    {
+        if(gen.validateBit(getBit(data, i)) == false)
+            errors++;
+    }
+
+    return errors;
+}
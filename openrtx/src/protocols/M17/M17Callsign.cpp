@@ -20,90 +20,88 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
-#include <string>
+#include <cstring>
 #include <M17/M17Callsign.hpp>
 
-bool M17::encode_callsign(const std::string& callsign, call_t& encodedCall,
+using namespace M17;
+
+void Callsign::copyTo(char *dest, const size_t size) const
+{
+    if(size == 0)
+        return;
+
+    size_t n = (len < size) ? len : (size - 1);
+    memcpy(dest, text, n);
+    dest[n] = '\0';
+}
+
+bool Callsign::operator==(const Callsign& other) const
+{
+    return (len == other.len) && (memcmp(text, other.text, len) == 0);
+}
+
+bool M17::encode_callsign(const Callsign& callsign, call_t& encodedCall,
                           bool strict)
 {
     encodedCall.fill(0x00);
-    if(callsign.size() > 9) return false;
-
-    // Encode the characters to base-40 digits.
-    uint64_t encoded = 0;
 
-    for(auto it = callsign.rbegin(); it != callsign.rend(); ++it)
+    if(strict)
     {
-        encoded *= 40;
-        if (*it >= 'A' and *it <= 'Z')
-        {
-            encoded += (*it - 'A') + 1;
-        }
-        else if (*it >= '0' and *it <= '9')
-        {
-            encoded += (*it - '0') + 27;
-        }
-        else if (*it == '-')
-        {
-            encoded += 37;
-        }
-        else if (*it == '/')
-        {
-            encoded += 38;
-        }
-        else if (*it == '.')
+        for(size_t i = 0; i < callsign.size(); i++)
         {
-            encoded += 39;
-        }
-        else if (strict)
-        {
-            return false;
+            if(base40Digit(callsign.c_str()[i]) < 0)
+                return false;
         }
     }
 
-    auto *ptr = reinterpret_cast< uint8_t *>(&encoded);
-    std::copy(ptr, ptr + 6, encodedCall.rbegin());
+    // Write out the base-40 value in big-endian form
+    uint64_t encoded = callsign.value();
+    for(size_t i = encodedCall.size(); i > 0; i--)
+    {
+        encodedCall[i - 1] = encoded & 0xFF;
+        encoded >>= 8;
+    }
 
     return true;
 }
 
-std::string M17::decode_callsign(const call_t& encodedCall)
+Callsign M17::decode_callsign(const call_t& encodedCall)
 {
-    // First of all, check if encoded address is a broadcast one
-    bool isBroadcast = true;
-    for(auto& elem : encodedCall)
-    {
-        if(elem != 0xFF)
-        {
-            isBroadcast = false;
-            break;
-        }
-    }
+    return Callsign(encodedCall);
+}
 
-    if(isBroadcast) return "ALL";
+/**
+ * \internal
+ * Strip the country prefix from a base-40 encoded callsign, that is a '/'
+ * within the first three characters and whatever is in front of it. Being the
+ * first character the least significant digit, this amounts to a division.
+ *
+ * @param value: base-40 value of the callsign.
+ * @return base-40 value of the callsign without prefix.
+ */
+static uint64_t stripPrefix(uint64_t value)
+{
+    uint64_t rest = value;
 
-    /*
-     * Address is not broadcast, decode it.
-     * TODO: current implementation works only on little endian architectures.
-     */
-    static const char charMap[] = " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-/.";
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        uint64_t next = rest / 40;
+        if((rest - (next * 40)) == 38)
+            return next;
 
-    uint64_t encoded = 0;
-    auto p = reinterpret_cast<uint8_t*>(&encoded);
-    std::copy(encodedCall.rbegin(), encodedCall.rend(), p);
+        rest = next;
+    }
 
-    // Decode each base-40 digit and map them to the appriate character.
-    std::string result;
-    size_t index = 0;
+    return value;
+}
 
-    while(encoded)
-    {
-        result.push_back(charMap[encoded % 40]);
-        index++;
-        encoded /= 40;
-    }
+bool M17::compare_callsign(const Callsign& local, const call_t& encodedCall)
+{
+    static constexpr uint64_t ALL = base40Encode("ALL", 3);
 
-    result[index] = '\0';
+    uint64_t incoming = callValue(encodedCall);
+    if((incoming == CALLSIGN_BROADCAST) || (incoming == ALL))
+        return true;
 
-    return result;
+    return stripPrefix(local.value()) == stripPrefix(incoming);
 }
@@ -25,6 +25,7 @@
 #include <M17/M17Utils.hpp>
 #include <audio_stream.h>
 #include <math.h>
+#include <algorithm>
 #include <cstring>
 #include <stdio.h>
 
@@ -161,20 +162,27 @@ M17Demodulator::~M17Demodulator()
 void M17Demodulator::init()
 {
     /*
-     * Allocate a chunk of memory to contain two complete buffers for baseband
-     * audio. Split this chunk in two separate blocks for double buffering using
-     * placement new.
+     * Allocate a chunk of memory to contain the bridge samples followed by two
+     * complete buffers for baseband audio, used for double buffering by the
+     * input stream.
      */
 
-    baseband_buffer = std::make_unique< int16_t[] >(2 * M17_SAMPLE_BUF_SIZE);
+    baseband_buffer = std::make_unique< int16_t[] >(M17_BRIDGE_SIZE
+                                                    + 2 * M17_SAMPLE_BUF_SIZE);
     demodFrame      = std::make_unique< frame_t >();
     readyFrame      = std::make_unique< frame_t >();
+    demodSoftFrame  = std::make_unique< sframe_t >();
+    readySoftFrame  = std::make_unique< sframe_t >();
     baseband        = { nullptr, 0 };
     frame_index     = 0;
     phase           = 0;
     syncDetected    = false;
     locked          = false;
+    frameSync       = SyncType::NONE;
     newFrame        = false;
+    extendedSync    = false;
+
+    syncDetector.enableMultiHypothesis(false);
 
     #ifdef ENABLE_DEMOD_LOG
     logRunning = true;
@@ -196,6 +204,8 @@ void M17Demodulator::terminate()
     baseband_buffer.reset();
     demodFrame.reset();
     readyFrame.reset();
+    demodSoftFrame.reset();
+    readySoftFrame.reset();
 
     #ifdef ENABLE_DEMOD_LOG
     logRunning = false;
@@ -205,12 +215,12 @@ void M17Demodulator::terminate()
 void M17Demodulator::startBasebandSampling()
 {
     basebandPath = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_RX);
-    basebandId = audioStream_start(basebandPath, baseband_buffer.get(),
-                                   2 * M17_SAMPLE_BUF_SIZE, M17_RX_SAMPLE_RATE,
-                                   STREAM_INPUT | BUF_CIRC_DOUBLE);
+    basebandId = inputStream_startShared(basebandPath, baseband_buffer.get(),
+                                         M17_BRIDGE_SIZE + 2 * M17_SAMPLE_BUF_SIZE,
+                                         M17_BRIDGE_SIZE, M17_RX_SAMPLE_RATE, 1);
 
     // Clean start of the demodulation statistics
-    resetCorrelationStats();
+    syncDetector.reset();
     resetQuantizationStats();
     // DC removal filter reset
     dsp_resetFilterState(&dsp_state);
@@ -225,26 +235,6 @@ void M17Demodulator::stopBasebandSampling()
     locked = false;
 }
 
-void M17Demodulator::resetCorrelationStats()
-{
-    conv_emvar = 40000000.0f;
-}
-
-/**
- * Algorithms taken from
- * https://fanf2.user.srcf.net/hermes/doc/antiforgery/stats.pdf
- */
-void M17Demodulator::updateCorrelationStats(int32_t value)
-{
-    float incr  = CONV_STATS_ALPHA * static_cast<float>(value);
-    conv_emvar  = (1.0f - CONV_STATS_ALPHA) * (conv_emvar + static_cast<float>(value) * incr);
-}
-
-float M17Demodulator::getCorrelationStddev()
-{
-    return sqrt(conv_emvar);
-}
-
 void M17Demodulator::resetQuantizationStats()
 {
     qnt_pos_avg = 0.0f;
@@ -254,12 +244,8 @@ void M17Demodulator::resetQuantizationStats()
 void M17Demodulator::updateQuantizationStats(int32_t frame_index,
                                              int32_t symbol_index)
 {
-    int16_t sample = 0;
-    // When we are at negative indices use bridge buffer
-    if (symbol_index < 0)
-        sample = basebandBridge[M17_BRIDGE_SIZE + symbol_index];
-    else
-        sample = baseband.data[symbol_index];
+    // Negative indices fall in the bridge area before the baseband block
+    int16_t sample = baseband.data[symbol_index];
     if (sample > 0)
     {
         qnt_pos_acc += sample;
@@ -282,45 +268,26 @@ void M17Demodulator::updateQuantizationStats(int32_t frame_index,
     }
 }
 
-int32_t M17Demodulator::convolution(int32_t offset,
-                                    int8_t *target,
-                                    size_t target_size)
-{
-    // Compute convolution
-    int32_t conv = 0;
-    for(uint32_t i = 0; i < target_size; i++)
-    {
-        int32_t sample_index = offset + i * M17_SAMPLES_PER_SYMBOL;
-        int16_t sample = 0;
-        // When we are at negative indices use bridge buffer
-        if (sample_index < 0)
-            sample = basebandBridge[M17_BRIDGE_SIZE + sample_index];
-        else
-            sample = baseband.data[sample_index];
-        conv += (int32_t) target[i] * (int32_t) sample;
-    }
-    return conv;
-}
-
 sync_t M17Demodulator::nextFrameSync(int32_t offset)
 {
-
-    sync_t syncword = { -1, false };
-    // Find peaks in the correlation between the baseband and the frame syncword
-    // Leverage the fact LSF syncword is the opposite of the frame syncword
-    // to detect both syncwords at once. Stop early because convolution needs
-    // access samples ahead of the starting offset.
+    // Stop early because correlation needs access samples ahead of the
+    // starting offset.
     int32_t maxLen = static_cast < int32_t >(baseband.len - M17_SYNCWORD_SAMPLES);
+
+    #ifndef ENABLE_DEMOD_LOG
+    return syncDetector.search(baseband.data, offset, maxLen);
+    #else
+    sync_t syncword = { -1, SyncType::NONE };
     for(int32_t i = offset; (syncword.index == -1) && (i < maxLen); i++)
     {
-        int32_t conv = convolution(i, stream_syncword, M17_SYNCWORD_SYMBOLS);
-        updateCorrelationStats(conv);
+        int32_t conv, bert;
+        syncDetector.correlate(baseband.data + i, conv, bert);
+        syncword = syncDetector.search(baseband.data, i, i + 1);
 
-        #ifdef ENABLE_DEMOD_LOG
         log_entry_t log;
-        log.sample       = (i < 0) ? basebandBridge[M17_BRIDGE_SIZE + i] : baseband.data[i];
+        log.sample       = baseband.data[i];
         log.conv         = conv;
-        log.conv_th      = CONV_THRESHOLD_FACTOR * getCorrelationStddev();
+        log.conv_th      = syncDetector.getThreshold();
         log.sample_index = i;
         log.qnt_pos_avg  = 0.0;
         log.qnt_neg_avg  = 0.0;
@@ -329,32 +296,16 @@ sync_t M17Demodulator::nextFrameSync(int32_t offset)
         log.flags        = 1;
 
         pushLog(log);
-        #endif
-
-        // Positive correlation peak -> frame syncword
-        if (conv > (getCorrelationStddev() * CONV_THRESHOLD_FACTOR))
-        {
-            syncword.lsf = false;
-            syncword.index = i;
-        }
-        // Negative correlation peak -> LSF syncword
-        else if (conv < -(getCorrelationStddev() * CONV_THRESHOLD_FACTOR))
-        {
-            syncword.lsf = true;
-            syncword.index = i;
-        }
     }
 
     return syncword;
+    #endif
 }
 
 int8_t M17Demodulator::quantize(int32_t offset)
 {
-    int16_t sample = 0;
-    if (offset < 0) // When we are at negative offsets use bridge buffer
-        sample = basebandBridge[M17_BRIDGE_SIZE + offset];
-    else            // Otherwise use regular data buffer
-        sample = baseband.data[offset];
+    // Negative offsets fall in the bridge area before the baseband block
+    int16_t sample = baseband.data[offset];
     if (sample > static_cast< int16_t >(qnt_pos_avg / 1.5f))
         return +3;
     else if (sample < static_cast< int16_t >(qnt_neg_avg / 1.5f))
@@ -365,6 +316,21 @@ int8_t M17Demodulator::quantize(int32_t offset)
         return -1;
 }
 
+void M17Demodulator::softQuantize(int32_t offset, size_t symbol)
+{
+    int16_t sample = baseband.data[offset];
+
+    // Normalise the sample so that outer symbols are at +3 and -3, the
+    // quantization averages are computed over the syncword outer symbols.
+    float value = 0.0f;
+    if ((sample > 0) && (qnt_pos_avg > 0.0f))
+        value = 3.0f * static_cast< float >(sample) / qnt_pos_avg;
+    else if ((sample < 0) && (qnt_neg_avg < 0.0f))
+        value = -3.0f * static_cast< float >(sample) / qnt_neg_avg;
+
+    setSoftSymbol(*demodSoftFrame, symbol, value);
+}
+
 const frame_t& M17Demodulator::getFrame()
 {
     // When a frame is read is not new anymore
@@ -372,6 +338,12 @@ const frame_t& M17Demodulator::getFrame()
     return *readyFrame;
 }
 
+const sframe_t& M17Demodulator::getSoftFrame()
+{
+    newFrame = false;
+    return *readySoftFrame;
+}
+
 bool M17Demodulator::isLocked()
 {
     return locked;
@@ -383,19 +355,23 @@ int32_t M17Demodulator::syncwordSweep(int32_t offset)
     // Start from 5 samples behind, end 5 samples after
     for(int i = -SYNC_SWEEP_WIDTH; i <= SYNC_SWEEP_WIDTH; i++)
     {
-        // TODO: Extend for LSF and BER syncwords
-        int32_t conv = convolution(offset + i,
-                                   stream_syncword,
-                                   M17_SYNCWORD_SYMBOLS);
-        #ifdef ENABLE_DEMOD_LOG
-        int16_t sample;
-        if (offset + i < 0)
-            sample = basebandBridge[M17_BRIDGE_SIZE + offset + i];
-        else
-            sample = baseband.data[offset + i];
+        // Correlate with the syncword of the current frame: the LSF and
+        // packet syncwords are the opposite of the stream and BERT ones.
+        int32_t stream, bert;
+        syncDetector.correlate(baseband.data + offset + i, stream, bert);
 
+        int32_t conv;
+        switch(frameSync)
+        {
+            case SyncType::LSF:    conv = -stream; break;
+            case SyncType::BERT:   conv =  bert;   break;
+            case SyncType::PACKET: conv = -bert;   break;
+            default:               conv =  stream; break;
+        }
+
+        #ifdef ENABLE_DEMOD_LOG
         log_entry_t log;
-        log.sample       = sample;
+        log.sample       = baseband.data[offset + i];
         log.conv         = conv;
         log.conv_th      = 0.0;
         log.sample_index = offset + i;
@@ -420,26 +396,27 @@ int32_t M17Demodulator::syncwordSweep(int32_t offset)
 
 bool M17Demodulator::update()
 {
-    sync_t syncword = { 0, false };
+    sync_t syncword = { 0, SyncType::NONE };
     phase = (syncDetected) ? phase % M17_SAMPLES_PER_SYMBOL : -M17_BRIDGE_SIZE;
     uint16_t decoded_syms = 0;
 
     // Read samples from the ADC
     if(audioPath_getStatus(basebandPath) != PATH_OPEN) return false;
-    baseband = inputStream_getData(basebandId);
+    streamLease_t lease = inputStream_acquire(basebandId, 0);
+    baseband.data = lease.data;
+    baseband.len  = lease.len;
 
     if(baseband.data != NULL)
     {
         // Apply DC removal filter
         dsp_dcRemoval(&dsp_state, baseband.data, baseband.len);
 
-        // Apply RRC on the baseband buffer
-        for(size_t i = 0; i < baseband.len; i++)
-        {
-            float elem = static_cast< float >(baseband.data[i]);
-            if(invPhase) elem = 0.0f - elem;
-            baseband.data[i]  = static_cast< int16_t >(M17::rrc_24k(elem));
-        }
+        // Apply RRC on the baseband buffer, inverting the phase if required.
+        // The stream provides the tail of the previous filtered block right
+        // before the current one, thus negative indices access the bridge
+        // samples without any check.
+        M17::rrc_24k.process(baseband.data, baseband.data, baseband.len,
+                             invPhase);
 
         // Process the buffer
         while(syncword.index != -1)
@@ -496,6 +473,7 @@ bool M17Demodulator::update()
                 #endif
 
                 setSymbol(*demodFrame, frame_index, symbol);
+                softQuantize(symbol_index, frame_index);
                 decoded_syms++;
                 frame_index++;
 
@@ -520,7 +498,41 @@ bool M17Demodulator::update()
                                        + hammingDistance((*demodFrame)[1],
                                                          LSF_SYNC_WORD[1]);
 
-                    if ((hammingSync > maxHamming) && (hammingLsf > maxHamming))
+                    uint8_t hamming = hammingSync;
+                    frameSync       = SyncType::STREAM;
+
+                    if(hammingLsf < hamming)
+                    {
+                        hamming   = hammingLsf;
+                        frameSync = SyncType::LSF;
+                    }
+
+                    if(extendedSync)
+                    {
+                        uint8_t hammingBert = hammingDistance((*demodFrame)[0],
+                                                              BERT_SYNC_WORD[0])
+                                            + hammingDistance((*demodFrame)[1],
+                                                              BERT_SYNC_WORD[1]);
+
+                        uint8_t hammingPkt = hammingDistance((*demodFrame)[0],
+                                                             PACKET_SYNC_WORD[0])
+                                           + hammingDistance((*demodFrame)[1],
+                                                             PACKET_SYNC_WORD[1]);
+
+                        if(hammingBert < hamming)
+                        {
+                            hamming   = hammingBert;
+                            frameSync = SyncType::BERT;
+                        }
+
+                        if(hammingPkt < hamming)
+                        {
+                            hamming   = hammingPkt;
+                            frameSync = SyncType::PACKET;
+                        }
+                    }
+
+                    if (hamming > maxHamming)
                     {
                         // Lock lost, reset demodulator alignment (phase) only
                         // if we were locked on a valid signal.
@@ -570,16 +582,15 @@ bool M17Demodulator::update()
                 if (frame_index == M17_FRAME_SYMBOLS)
                 {
                     demodFrame.swap(readyFrame);
+                    demodSoftFrame.swap(readySoftFrame);
                     frame_index = 0;
                     newFrame    = true;
                 }
             }
         }
 
-        // Copy last N samples to bridge buffer
-        memcpy(basebandBridge,
-               baseband.data + (baseband.len - M17_BRIDGE_SIZE),
-               sizeof(int16_t) * M17_BRIDGE_SIZE);
+        // Release the block, its tail becomes the bridge for the next one
+        inputStream_release(basebandId, &lease);
     }
 
     #if defined(PLATFORM_LINUX) && defined(ENABLE_DEMOD_LOG)
@@ -594,3 +605,9 @@ void M17Demodulator::invertPhase(const bool status)
 {
     invPhase = status;
 }
+
+void M17Demodulator::enableExtendedSync(const bool status)
+{
+    extendedSync = status;
+    syncDetector.enableMultiHypothesis(status);
+}
@@ -29,7 +29,7 @@
 
 using namespace M17;
 
-M17FrameDecoder::M17FrameDecoder() { }
+M17FrameDecoder::M17FrameDecoder() : viterbiCost(0) { }
 
 M17FrameDecoder::~M17FrameDecoder() { }
 
@@ -39,6 +39,9 @@ void M17FrameDecoder::reset()
     lsf.clear();
     lsfFromLich.clear();
     streamFrame.clear();
+    packetFrame.clear();
+    bertFrame.fill(0x00);
+    viterbiCost = 0;
 }
 
 M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
@@ -53,7 +56,8 @@ M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
     decorrelate(data);
     deinterleave(data);
 
-    auto type = getFrameType(syncWord);
+    auto type   = getFrameType(syncWord);
+    viterbiCost = 0;
 
     switch(type)
     {
@@ -65,6 +69,58 @@ M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
             decodeStream(data);
             break;
 
+        case M17FrameType::PACKET:
+            decodePacket(data);
+            break;
+
+        case M17FrameType::BERT:
+            decodeBert(data);
+            break;
+
+        default:
+            break;
+    }
+
+    return type;
+}
+
+M17FrameType M17FrameDecoder::decodeFrame(const sframe_t& frame)
+{
+    std::array< uint8_t, 2 >    syncWord;
+    std::array< uint16_t, 368 > data;
+
+    // Sync word is always evaluated on hard decisions
+    for(size_t i = 0; i < 16; i++)
+    {
+        setBit(syncWord, i, frame[i] > 0x7FFF);
+    }
+
+    std::copy(frame.begin() + 16, frame.end(), data.begin());
+
+    decorrelate(data);
+    deinterleave(data);
+
+    auto type   = getFrameType(syncWord);
+    viterbiCost = 0;
+
+    switch(type)
+    {
+        case M17FrameType::LINK_SETUP:
+            decodeLSF(data);
+            break;
+
+        case M17FrameType::STREAM:
+            decodeStream(data);
+            break;
+
+        case M17FrameType::PACKET:
+            decodePacket(data);
+            break;
+
+        case M17FrameType::BERT:
+            decodeBert(data);
+            break;
+
         default:
             break;
     }
@@ -97,6 +153,24 @@ M17FrameType M17FrameDecoder::getFrameType(const std::array< uint8_t, 2 >& syncW
         minDistance = hammDistance;
     }
 
+    // Packet frame
+    hammDistance = hammingDistance(syncWord[0], PACKET_SYNC_WORD[0])
+                 + hammingDistance(syncWord[1], PACKET_SYNC_WORD[1]);
+    if(hammDistance < minDistance)
+    {
+        type = M17FrameType::PACKET;
+        minDistance = hammDistance;
+    }
+
+    // BERT frame
+    hammDistance = hammingDistance(syncWord[0], BERT_SYNC_WORD[0])
+                 + hammingDistance(syncWord[1], BERT_SYNC_WORD[1]);
+    if(hammDistance < minDistance)
+    {
+        type = M17FrameType::BERT;
+        minDistance = hammDistance;
+    }
+
     // Check value of minimum hamming distance found, if exceeds the allowed
     // limit consider the frame as of unknown type.
     if(minDistance > MAX_SYNC_HAMM_DISTANCE)
@@ -111,17 +185,127 @@ void M17FrameDecoder::decodeLSF(const std::array< uint8_t, 46 >& data)
 {
     std::array< uint8_t, sizeof(M17LinkSetupFrame) > tmp;
 
-    viterbi.decodePunctured(data, tmp, LSF_PUNCTURE);
+    viterbiCost = viterbi.decodePunctured(data, tmp, LSF_PUNCTURE) * 0xFFFF;
+    memcpy(&lsf.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::decodeLSF(const std::array< uint16_t, 368 >& data)
+{
+    std::array< uint8_t, sizeof(M17LinkSetupFrame) > tmp;
+
+    viterbiCost = softViterbi.decodePunctured(data, tmp, LSF_PUNCTURE);
     memcpy(&lsf.data, tmp.data(), tmp.size());
 }
 
 void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
 {
-    // Extract and unpack the LICH segment contained at beginning of frame
+    // Extract and process the LICH segment contained at beginning of frame
     lich_t lich;
-    std::array < uint8_t, 6 > lsfSegment;
-
     std::copy_n(data.begin(), lich.size(), lich.begin());
+    processLich(lich);
+
+    // Extract and decode stream data
+    std::array< uint8_t, 34 > punctured;
+    std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
+
+    auto begin = data.begin();
+    begin     += lich.size();
+    std::copy(begin, data.end(), punctured.begin());
+
+    viterbiCost = viterbi.decodePunctured(punctured, tmp, DATA_PUNCTURE) * 0xFFFF;
+    memcpy(&streamFrame.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::decodeStream(const std::array< uint16_t, 368 >& data)
+{
+    // LICH is Golay encoded: slice its soft bits to hard decisions
+    lich_t lich;
+    for(size_t i = 0; i < lich.size() * 8; i++)
+    {
+        setBit(lich, i, data[i] > 0x7FFF);
+    }
+
+    processLich(lich);
+
+    // Extract and decode stream data
+    std::array< uint16_t, 272 > punctured;
+    std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
+
+    auto begin = data.begin();
+    begin     += lich.size() * 8;
+    std::copy(begin, data.end(), punctured.begin());
+
+    viterbiCost = softViterbi.decodePunctured(punctured, tmp, DATA_PUNCTURE);
+    memcpy(&streamFrame.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::decodePacket(const std::array< uint8_t, 46 >& data)
+{
+    std::array< uint8_t, sizeof(M17PacketFrame) > tmp;
+
+    viterbiCost = viterbi.decodePunctured(data, tmp, PACKET_PUNCTURE) * 0xFFFF;
+    unpackPacket(tmp);
+}
+
+void M17FrameDecoder::decodePacket(const std::array< uint16_t, 368 >& data)
+{
+    std::array< uint8_t, sizeof(M17PacketFrame) > tmp;
+
+    viterbiCost = softViterbi.decodePunctured(data, tmp, PACKET_PUNCTURE);
+    unpackPacket(tmp);
+}
+
+void M17FrameDecoder::decodeBert(const std::array< uint8_t, 46 >& data)
+{
+    // The truncated last bit prevents using the hard-decision decoder, which
+    // has no way to mark it as an erasure: run the soft-decision one on
+    // full confidence values.
+    std::array< uint16_t, 368 > soft;
+    for(size_t i = 0; i < soft.size(); i++)
+    {
+        soft[i] = getBit(data, i) ? 0xFFFF : 0x0000;
+    }
+
+    decodeBert(soft);
+}
+
+void M17FrameDecoder::decodeBert(const std::array< uint16_t, 368 >& data)
+{
+    // BERT data is encoded to 402 bits, punctured to 369 and then truncated to
+    // 368. Append the missing bit as an erasure.
+    std::array< uint16_t, 369 > punctured;
+    std::array< uint8_t, 25 >   tmp;
+
+    std::copy(data.begin(), data.end(), punctured.begin());
+    punctured.back() = 0x7FFF;
+
+    viterbiCost = softViterbi.decodePunctured(punctured, tmp, DATA_PUNCTURE)
+                - 0x7FFF;
+
+    // The 197 bits of PRBS9 are preceded by three spurious bits
+    for(size_t i = 0; i < tmp.size() - 1; i++)
+    {
+        bertFrame[i] = (tmp[i] << 3) | (tmp[i + 1] >> 5);
+    }
+
+    bertFrame.back() = tmp.back() << 3;
+}
+
+void M17FrameDecoder::unpackPacket(const std::array< uint8_t, sizeof(M17PacketFrame) >& decoded)
+{
+    uint8_t *ptr = reinterpret_cast < uint8_t * >(&packetFrame.data);
+
+    for(size_t i = 0; i < decoded.size() - 1; i++)
+    {
+        ptr[i] = (decoded[i] << 2) | (decoded[i + 1] >> 6);
+    }
+
+    ptr[decoded.size() - 1] = decoded.back() << 2;
+}
+
+void M17FrameDecoder::processLich(const lich_t& lich)
+{
+    std::array < uint8_t, 6 > lsfSegment;
     bool decodeOk = decodeLich(lsfSegment, lich);
 
     if(decodeOk)
@@ -144,17 +328,6 @@ void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
             lsfFromLich.clear();
         }
     }
-
-    // Extract and decode stream data
-    std::array< uint8_t, 34 > punctured;
-    std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
-
-    auto begin = data.begin();
-    begin     += lich.size();
-    std::copy(begin, data.end(), punctured.begin());
-
-    viterbi.decodePunctured(punctured, tmp, DATA_PUNCTURE);
-    memcpy(&streamFrame.data, tmp.data(), tmp.size());
 }
 
 bool M17FrameDecoder::decodeLich(std::array < uint8_t, 6 >& segment,
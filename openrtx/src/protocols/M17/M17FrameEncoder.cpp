@@ -26,6 +26,105 @@
 
 using namespace M17;
 
+/**
+ * \internal
+ * Gather table of the TX channel coding pipeline. Element i is the position,
+ * inside the source bit buffer, of the bit placed at position i of the
+ * interleaved frame payload.
+ */
+template < size_t NB >
+struct TxTable
+{
+    uint16_t src[NB];
+};
+
+/**
+ * \internal
+ * Generate the gather table folding together puncturing and interleaving of a
+ * frame payload. The source bit buffer is made by an uncoded prefix of a given
+ * length, placed as is at the beginning of the payload, followed by the
+ * convolutionally encoded data, which is punctured with the given scheme.
+ *
+ * @param punct: puncturing matrix.
+ * @param prefix: length of the uncoded prefix, in bits.
+ * @return gather table of the pipeline.
+ */
+template < size_t NB, size_t P >
+static constexpr TxTable< NB > makeTxTable(const std::array< uint8_t, P >& punct,
+                                           const size_t prefix)
+{
+    TxTable< NB > table{};
+
+    // Position in the source buffer of each bit before interleaving: the
+    // prefix bits, then the encoded bits surviving the puncturing.
+    uint16_t punctured[NB] = {};
+    size_t   encIndex      = 0;
+
+    for(size_t i = 0; i < NB; i++)
+    {
+        if(i < prefix)
+        {
+            punctured[i] = i;
+            continue;
+        }
+
+        while(punct[encIndex % P] == 0)
+            encIndex++;
+
+        punctured[i] = prefix + encIndex;
+        encIndex++;
+    }
+
+    for(size_t i = 0; i < NB; i++)
+        table.src[i] = punctured[QppTables< NB >::interleave.idx[i]];
+
+    return table;
+}
+
+// LSF: 240 bits encoded to 488 bits, punctured to 368
+static constexpr TxTable< 368 > lsfTable    = makeTxTable< 368 >(LSF_PUNCTURE, 0);
+
+// Stream frame: 96 bits of LICH and 144 bits encoded to 296 bits, punctured to 272
+static constexpr TxTable< 368 > streamTable = makeTxTable< 368 >(DATA_PUNCTURE, 96);
+
+// Packet frame: 206 bits encoded to 420 bits, punctured to 368
+static constexpr TxTable< 368 > packetTable = makeTxTable< 368 >(PACKET_PUNCTURE, 0);
+
+// BERT frame: 197 bits encoded to 402 bits, punctured to 368 dropping the last one
+static constexpr TxTable< 368 > bertTable   = makeTxTable< 368 >(DATA_PUNCTURE, 0);
+
+/**
+ * \internal
+ * Build the frame payload gathering the source bits according to the pipeline
+ * table and apply the decorrelation sequence, writing the result directly to
+ * the output frame.
+ *
+ * @param table: pipeline gather table.
+ * @param source: source bit buffer.
+ * @param output: output frame, the payload is written after the sync word.
+ */
+static inline void gatherPayload(const TxTable< 368 >& table,
+                                 const uint8_t *source, frame_t& output)
+{
+    const uint16_t *idx = table.src;
+    uint8_t        *out = output.data() + 2;
+
+    for(size_t i = 0; i < 46; i++)
+    {
+        uint32_t byte = 0;
+
+        for(size_t j = 0; j < 8; j++)
+        {
+            uint16_t pos = idx[j];
+            uint32_t bit = (source[pos >> 3] >> (7 - (pos & 0x07))) & 0x01;
+            byte |= bit << (7 - j);
+        }
+
+        out[i] = byte ^ sequence[i];
+        idx   += 8;
+    }
+}
+
 M17FrameEncoder::M17FrameEncoder() : currentLich(0), streamFrameNumber(0)
 {
     reset();
@@ -60,21 +159,15 @@ void M17FrameEncoder::encodeLsf(M17LinkSetupFrame& lsf, frame_t& output)
         lichSegments[i] = lsf.generateLichSegment(i);
     }
 
-    // Encode the LSF, then puncture and decorrelate its data
+    // Encode the LSF, then puncture, interleave and decorrelate its data in a
+    // single pass.
     std::array<uint8_t, 61> encoded;
     encoder.reset();
     encoder.encode(lsf.getData(), encoded.data(), sizeof(M17LinkSetupFrame));
     encoded[60] = encoder.flush();
 
-    std::array<uint8_t, 46> punctured;
-    puncture(encoded, punctured, LSF_PUNCTURE);
-    interleave(punctured);
-    decorrelate(punctured);
-
-    // Copy data to output buffer, prepended with sync word.
-    auto it = std::copy(LSF_SYNC_WORD.begin(), LSF_SYNC_WORD.end(),
-                        output.begin());
-    std::copy(punctured.begin(), punctured.end(), it);
+    std::copy(LSF_SYNC_WORD.begin(), LSF_SYNC_WORD.end(), output.begin());
+    gatherPayload(lsfTable, encoded.data(), output);
 }
 
 uint16_t M17FrameEncoder::encodeStreamFrame(const payload_t& payload,
@@ -87,36 +180,55 @@ uint16_t M17FrameEncoder::encodeStreamFrame(const payload_t& payload,
     if(isLast) streamFrame.lastFrame();
     std::copy(payload.begin(), payload.end(), streamFrame.payload().begin());
 
-    // Encode frame
-    std::array<uint8_t, 37> encoded;
-    encoder.reset();
-    encoder.encode(streamFrame.getData(), encoded.data(), sizeof(M17StreamFrame));
-    encoded[36] = encoder.flush();
-
-    std::array<uint8_t, 34> punctured;
-    puncture(encoded, punctured, DATA_PUNCTURE);
+    // Source buffer: LICH segment followed by the encoded frame
+    std::array<uint8_t, 12 + 37> source;
+    std::copy(lichSegments[currentLich].begin(),
+              lichSegments[currentLich].end(),
+              source.begin());
 
-    // Add LICH segment to coded data
-    std::array<uint8_t, 46> frame;
-    auto it = std::copy(lichSegments[currentLich].begin(),
-                        lichSegments[currentLich].end(),
-                        frame.begin());
-    std::copy(punctured.begin(), punctured.end(), it);
+    encoder.reset();
+    encoder.encode(streamFrame.getData(), source.data() + 12,
+                   sizeof(M17StreamFrame));
+    source[48] = encoder.flush();
 
     // Increment LICH counter after copy
     currentLich = (currentLich + 1) % lichSegments.size();
 
-    interleave(frame);
-    decorrelate(frame);
-
-    // Copy data to output buffer, prepended with sync word.
-    auto oIt = std::copy(STREAM_SYNC_WORD.begin(), STREAM_SYNC_WORD.end(),
-                         output.begin());
-    std::copy(frame.begin(), frame.end(), oIt);
+    // Puncture, interleave and decorrelate in a single pass, prepending the
+    // sync word.
+    std::copy(STREAM_SYNC_WORD.begin(), STREAM_SYNC_WORD.end(), output.begin());
+    gatherPayload(streamTable, source.data(), output);
 
     return streamFrame.getFrameNumber();
 }
 
+void M17FrameEncoder::encodePacketFrame(const M17PacketFrame& frame,
+                                        frame_t& output)
+{
+    // The two padding bits at the end of the frame data are zero, thus they
+    // act as the first half of the four flush bits.
+    std::array<uint8_t, 53> encoded;
+    encoder.reset();
+    encoder.encode(frame.getData(), encoded.data(), sizeof(M17PacketFrame));
+    encoded[52] = encoder.flush();
+
+    std::copy(PACKET_SYNC_WORD.begin(), PACKET_SYNC_WORD.end(), output.begin());
+    gatherPayload(packetTable, encoded.data(), output);
+}
+
+void M17FrameEncoder::encodeBertFrame(const bert_t& data, frame_t& output)
+{
+    // The three padding bits at the end of the BERT data are zero, thus they
+    // act as the first flush bits.
+    std::array<uint8_t, 51> encoded;
+    encoder.reset();
+    encoder.encode(data.data(), encoded.data(), data.size());
+    encoded[50] = encoder.flush();
+
+    std::copy(BERT_SYNC_WORD.begin(), BERT_SYNC_WORD.end(), output.begin());
+    gatherPayload(bertTable, encoded.data(), output);
+}
+
 void M17::M17FrameEncoder::encodeEotFrame(M17::frame_t& output)
 {
     for(size_t i = 0; i < output.size(); i += 2)
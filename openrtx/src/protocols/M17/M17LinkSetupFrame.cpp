@@ -22,6 +22,7 @@
 #include <M17/M17Golay.hpp>
 #include <M17/M17Callsign.hpp>
 #include <M17/M17LinkSetupFrame.hpp>
+#include <crc.h>
 
 using namespace M17;
 
@@ -41,27 +42,32 @@ void M17LinkSetupFrame::clear()
     data.dst.fill(0xFF);
 }
 
-void M17LinkSetupFrame::setSource(const std::string& callsign)
+void M17LinkSetupFrame::setSource(const Callsign& callsign)
 {
     encode_callsign(callsign, data.src);
 }
 
-std::string M17LinkSetupFrame::getSource()
+Callsign M17LinkSetupFrame::getSource() const
 {
     return decode_callsign(data.src);
 }
 
-void M17LinkSetupFrame::setDestination(const std::string& callsign)
+void M17LinkSetupFrame::setDestination(const Callsign& callsign)
 {
     encode_callsign(callsign, data.dst);
 }
 
-std::string M17LinkSetupFrame::getDestination()
+Callsign M17LinkSetupFrame::getDestination() const
 {
     return decode_callsign(data.dst);
 }
 
-streamType_t M17LinkSetupFrame::getType()
+const call_t& M17LinkSetupFrame::getEncodedDestination() const
+{
+    return data.dst;
+}
+
+streamType_t M17LinkSetupFrame::getType() const
 {
     // NOTE: M17 fields are big-endian, we need to swap bytes
     streamType_t type = data.type;
@@ -81,16 +87,26 @@ meta_t& M17LinkSetupFrame::metadata()
     return data.meta;
 }
 
+const meta_t& M17LinkSetupFrame::metadata() const
+{
+    return data.meta;
+}
+
+uint16_t M17LinkSetupFrame::getCrc() const
+{
+    return __builtin_bswap16(data.crc);
+}
+
 void M17LinkSetupFrame::updateCrc()
 {
     // Compute CRC over the first 28 bytes, then store it in big endian format.
-    uint16_t crc = crc16(&data, 28);
+    uint16_t crc = crc_m17(&data, 28);
     data.crc     = __builtin_bswap16(crc);
 }
 
 bool M17LinkSetupFrame::valid() const
 {
-    uint16_t crc = crc16(&data, 28);
+    uint16_t crc = crc_m17(&data, 28);
     if(data.crc == __builtin_bswap16(crc)) return true;
 
     return false;
@@ -137,24 +153,3 @@ lich_t M17LinkSetupFrame::generateLichSegment(const uint8_t segmentNum)
 
     return result;
 }
-
-uint16_t M17LinkSetupFrame::crc16(const void *data, const size_t len) const
-{
-    const uint8_t *ptr = reinterpret_cast< const uint8_t *>(data);
-    uint16_t crc = 0xFFFF;
-
-    for(size_t i = 0; i < len; i++)
-    {
-        crc ^= (ptr[i] << 8);
-
-        for(uint8_t j = 0; j < 8; j++)
-        {
-            if(crc & 0x8000)
-                crc = (crc << 1) ^ 0x5935;
-            else
-                crc = (crc << 1);
-        }
-    }
-
-    return crc;
-}
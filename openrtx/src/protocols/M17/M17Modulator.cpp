@@ -25,6 +25,7 @@
 #include <M17/M17Modulator.hpp>
 #include <M17/M17Utils.hpp>
 #include <M17/M17DSP.hpp>
+#include <dsp.h>
 
 #if defined(PLATFORM_LINUX)
 #include <stdio.h>
@@ -33,7 +34,7 @@
 using namespace M17;
 
 
-M17Modulator::M17Modulator()
+M17Modulator::M17Modulator() : rrcShaper(rrc_taps_48k)
 {
 
 }
@@ -79,6 +80,7 @@ void M17Modulator::start()
     if(txRunning) return;
 
     txRunning = true;
+    rrcShaper.reset();
 
     // Fill symbol buffer with preamble, made of alternated +3 and -3 symbols
     for(size_t i = 0; i < symbols.size(); i += 2)
@@ -148,22 +150,37 @@ void M17Modulator::invertPhase(const bool status)
 
 void M17Modulator::symbolsToBaseband()
 {
-    memset(idleBuffer, 0x00, M17_FRAME_SAMPLES * sizeof(stream_sample_t));
+    // Symbols are shaped in blocks, each symbol produces a full symbol period
+    // of baseband.
+    static constexpr size_t BLOCK_SYMBOLS = 8;
+    static_assert((M17_FRAME_SYMBOLS % BLOCK_SYMBOLS) == 0,
+                  "Frame must be made of whole blocks of symbols");
 
-    for(size_t i = 0; i < symbols.size(); i++)
-    {
-        idleBuffer[i * 10] = symbols[i];
-    }
+    std::array< float, BLOCK_SYMBOLS > block;
+    std::array< float, BLOCK_SYMBOLS * M17_SAMPLES_PER_SYMBOL > chunk;
 
-    for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
+    // Signal phase inversion is folded in the output conversion
+    const float scale = invPhase ? -1.0f : 1.0f;
+
+    for(size_t i = 0; i < symbols.size(); i += BLOCK_SYMBOLS)
     {
-        float elem    = static_cast< float >(idleBuffer[i]);
-        elem          = M17::rrc_48k(elem * M17_RRC_GAIN) - M17_RRC_OFFSET;
-        #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
-        elem          = pwmComp(elem);
-        #endif
-        if(invPhase) elem = 0.0f - elem;    // Invert signal phase
-        idleBuffer[i] = static_cast< int16_t >(elem);
+        for(size_t j = 0; j < BLOCK_SYMBOLS; j++)
+        {
+            block[j] = static_cast< float >(symbols[i + j]) * M17_RRC_GAIN;
+        }
+
+        rrcShaper.process(block.data(), chunk.data(), BLOCK_SYMBOLS);
+
+        for(size_t j = 0; j < chunk.size(); j++)
+        {
+            chunk[j] -= M17_RRC_OFFSET;
+            #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
+            chunk[j]  = pwmComp(chunk[j]);
+            #endif
+        }
+
+        stream_sample_t *out = idleBuffer + (i * M17_SAMPLES_PER_SYMBOL);
+        dsp_fromFloat(chunk.data(), out, chunk.size(), scale);
     }
 }
 
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstring>
+#include <algorithm>
+#include <M17/M17Packet.hpp>
+
+using namespace M17;
+
+M17Packet::M17Packet()
+{
+    reset();
+}
+
+M17Packet::~M17Packet()
+{
+
+}
+
+void M17Packet::reset()
+{
+    length    = 0;
+    nextFrame = 0;
+    done      = false;
+    crc_init(&crc, CRC_M17);
+}
+
+bool M17Packet::set(const void *data, const size_t len)
+{
+    if((len == 0) || (len > M17_PACKET_MAX_SIZE))
+        return false;
+
+    memcpy(buffer.data(), data, len);
+    return setSize(len);
+}
+
+bool M17Packet::setSize(const size_t len)
+{
+    if((len == 0) || (len > M17_PACKET_MAX_SIZE))
+    {
+        reset();
+        return false;
+    }
+
+    // NOTE: M17 fields are big-endian
+    uint16_t value = crc_m17(buffer.data(), len);
+    buffer[len]     = value >> 8;
+    buffer[len + 1] = value & 0xFF;
+    length          = len + 2;
+    done            = true;
+
+    return true;
+}
+
+void M17Packet::getFrame(const size_t index, M17PacketFrame& frame) const
+{
+    size_t offset = index * M17_PACKET_FRAME_BYTES;
+    size_t count  = std::min(M17_PACKET_FRAME_BYTES,
+                             static_cast< size_t >(length) - offset);
+
+    frame.clear();
+    std::copy_n(buffer.begin() + offset, count, frame.payload().begin());
+
+    if((offset + count) >= length)
+        frame.lastFrame(count);
+    else
+        frame.setFrameNumber(index);
+}
+
+PacketStatus M17Packet::append(const M17PacketFrame& frame)
+{
+    if(done)
+        reset();
+
+    // A frame numbered zero always starts a new packet, resynchronising the
+    // reassembly when the end of the previous one has been lost.
+    if((frame.isLastFrame() == false) && (frame.getFrameNumber() == 0))
+        reset();
+
+    size_t count = M17_PACKET_FRAME_BYTES;
+    if(frame.isLastFrame())
+    {
+        count = frame.getFrameNumber();
+        if((count == 0) || (count > M17_PACKET_FRAME_BYTES))
+        {
+            done = true;
+            return PacketStatus::ERROR;
+        }
+    }
+    else if((frame.getFrameNumber() != nextFrame) ||
+            (nextFrame >= (M17_PACKET_MAX_FRAMES - 1)))
+    {
+        done = true;
+        return PacketStatus::ERROR;
+    }
+
+    // As the CRC is transmitted big-endian, running it over the whole packet
+    // leaves a zero remainder for error-free data.
+    std::copy_n(frame.payload().begin(), count, buffer.begin() + length);
+    crc_update(&crc, frame.payload().data(), count);
+    length += count;
+    nextFrame++;
+
+    if(frame.isLastFrame() == false)
+        return PacketStatus::INCOMPLETE;
+
+    // The packet must carry at least one byte of data besides the CRC
+    done = true;
+    if((length > 2) && (crc_final(&crc) == 0))
+        return PacketStatus::COMPLETE;
+
+    return PacketStatus::ERROR;
+}
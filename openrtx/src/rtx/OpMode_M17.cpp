@@ -40,7 +40,10 @@ using namespace M17;
 
 OpMode_M17::OpMode_M17() : startRx(false), startTx(false), locked(false),
                            dataValid(false), extendedCall(false),
-                           invertTxPhase(false), invertRxPhase(false)
+                           invertTxPhase(false), invertRxPhase(false),
+                           lsfCached(false), lsfCrc(0), txPacket(false),
+                           txFrame(0), bertMode(false), txBert(false),
+                           viterbiCost(0.0f), bertReq(false)
 {
 
 }
@@ -55,11 +58,19 @@ void OpMode_M17::enable()
     codec_init();
     modulator.init();
     demodulator.init();
+    demodulator.enableExtendedSync(true);
+    rxData.reset();
+    bertTx.reset();
+    bertRx.reset();
     locked       = false;
     dataValid    = false;
     extendedCall = false;
+    lsfCached    = false;
     startRx      = true;
     startTx      = false;
+    txPacket     = false;
+    txBert       = false;
+    viterbiCost  = 0.0f;
 }
 
 void OpMode_M17::disable()
@@ -97,6 +108,18 @@ void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
     invertRxPhase = (mod17CalData.rx_invert == 1) ? true : false;
     #endif
 
+    // Apply BERT mode change requests, clearing the statistics on enable
+    bool bert = bertReq;
+    if(bert != bertMode)
+    {
+        bertMode = bert;
+        if(bertMode)
+        {
+            bertTx.reset();
+            bertRx.reset();
+        }
+    }
+
     // Main FSM logic
     switch(status->opStatus)
     {
@@ -137,6 +160,17 @@ void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
             platform_ledOff(RED);
             break;
     }
+
+    // Link quality statistics are kept here and refreshed at each update, as
+    // the RTX status is overwritten when a new configuration is applied.
+    status->M17_bertEn      = bertMode;
+    status->M17_bertSync    = bertRx.synced();
+    status->M17_bertBits    = bertRx.bits();
+    status->M17_bertErrors  = bertRx.errors();
+    status->M17_bertFrames  = bertRx.frames();
+    status->M17_bertLost    = bertRx.lostFrames();
+    status->M17_bertBer     = bertRx.ber();
+    status->M17_viterbiCost = viterbiCost;
 }
 
 void OpMode_M17::offState(rtxStatus_t *const status)
@@ -152,7 +186,8 @@ void OpMode_M17::offState(rtxStatus_t *const status)
         return;
     }
 
-    if(platform_getPttStatus() && (status->txDisable == 0))
+    if((platform_getPttStatus() || packetTxReady(status)) &&
+       (status->txDisable == 0))
     {
         startTx = true;
         status->opStatus = TX;
@@ -183,6 +218,7 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
     if((lock == true) && (locked == false))
     {
         decoder.reset();
+        rxData.reset();
         locked = lock;
     }
 
@@ -191,53 +227,37 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         // Process new data
         if(newData)
         {
-            auto& frame   = demodulator.getFrame();
+            auto& frame   = demodulator.getSoftFrame();
             auto  type    = decoder.decodeFrame(frame);
-            auto  lsf     = decoder.getLsf();
+            auto& lsf     = decoder.getLsf();
             status->lsfOk = lsf.valid();
+            viterbiCost   = static_cast< float >(decoder.getViterbiCost())
+                          / 65535.0f;
 
-            if(status->lsfOk)
+            // BERT frames are not preceded by an LSF
+            if((type == M17FrameType::BERT) && (bertMode == true))
             {
                 dataValid = true;
+                bertRx.process(decoder.getBertFrame());
+            }
 
-                // Retrieve stream source and destination data
-                std::string dst = lsf.getDestination();
-                std::string src = lsf.getSource();
+            if(status->lsfOk)
+            {
+                dataValid = true;
 
-                // Retrieve extended callsign data
                 streamType_t streamType = lsf.getType();
+                bool         isStream   = (streamType.fields.dataMode
+                                           == M17_DATAMODE_STREAM);
 
-                if((streamType.fields.encType    == M17_ENCRYPTION_NONE) &&
-                   (streamType.fields.encSubType == M17_META_EXTD_CALLSIGN))
+                // Decode the callsigns only when a new LSF is received, the
+                // same LSF is carried by all the frames of a transmission.
+                if((lsfCached == false) || (lsf.getCrc() != lsfCrc))
                 {
-                    extendedCall = true;
-
-                    meta_t& meta = lsf.metadata();
-                    std::string exCall1 = decode_callsign(meta.extended_call_sign.call1);
-                    std::string exCall2 = decode_callsign(meta.extended_call_sign.call2);
-
-                    //
-                    // The source callsign only contains the last link when
-                    // receiving extended callsign data: in order to always store
-                    // the true source of a transmission, we need to store the first
-                    // extended callsign in M17_src.
-                    //
-                    strncpy(status->M17_src,  exCall1.c_str(), 10);
-                    strncpy(status->M17_refl, exCall2.c_str(), 10);
-
-                    extendedCall = true;
+                    lsfCached = true;
+                    lsfCrc    = lsf.getCrc();
+                    decodeLsf(lsf, status);
                 }
 
-                // Set source and destination fields.
-                // If we have received an extended callsign the src will be the RF link address
-                // The M17_src will already be stored from the extended callsign
-                strncpy(status->M17_dst, dst.c_str(), 10);
-
-                if(extendedCall)
-                    strncpy(status->M17_link, src.c_str(), 10);
-                else
-                    strncpy(status->M17_src, src.c_str(), 10);
-
                 // Check CAN on RX, if enabled.
                 // If check is disabled, force match to true.
                 bool canMatch =  (streamType.fields.CAN == status->can)
@@ -245,26 +265,46 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
 
                 // Check if the destination callsign of the incoming transmission
                 // matches with ours
-                bool callMatch = compareCallsigns(std::string(status->source_address), dst);
+                bool callMatch = compare_callsign(Callsign(status->source_address),
+                                                  lsf.getEncodedDestination());
 
                 // Open audio path only if CAN and callsign match
                 uint8_t pthSts = audioPath_getStatus(rxAudioPath);
-                if((pthSts == PATH_CLOSED) && (canMatch == true) && (callMatch == true))
+                if((pthSts == PATH_CLOSED) && (isStream == true) &&
+                   (canMatch == true) && (callMatch == true))
                 {
-                    rxAudioPath = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_RX);
+                    // Mixed path: voice prompts play over the received voice,
+                    // which gets ducked in the meantime.
+                    rxAudioPath = audioPath_requestMixed(SOURCE_MCU, SINK_SPK,
+                                                         PRIO_RX,
+                                                         AUDIO_GAIN_UNITY);
                     pthSts = audioPath_getStatus(rxAudioPath);
                 }
 
                 // Extract audio data and sent it to codec
                 if((type == M17FrameType::STREAM) && (pthSts == PATH_OPEN))
                 {
-                    // (re)start codec2 module if not already up
-                    if(codec_running() == false)
-                        codec_startDecode(rxAudioPath);
+                    // (re)start codec2 module if not already decoding on
+                    // this path. Each stream frame carries two codec2 frames,
+                    // decode them together.
+                    codec_startDecode(rxAudioPath, CODEC_MODE_3200, 2);
+
+                    auto& sf = decoder.getStreamFrame();
+                    codec_pushFrame(sf.payload().data(), sf.payload().size(),
+                                    false);
+                }
 
-                    M17StreamFrame sf = decoder.getStreamFrame();
-                    codec_pushFrame(sf.payload().data(),     false);
-                    codec_pushFrame(sf.payload().data() + 8, false);
+                // Reassemble packets addressed to us, a new LSF marks the
+                // beginning of a new packet.
+                if(type == M17FrameType::LINK_SETUP)
+                    rxData.reset();
+
+                if((type == M17FrameType::PACKET) && (isStream == false) &&
+                   (canMatch == true) && (callMatch == true))
+                {
+                    auto result = rxData.append(decoder.getPacketFrame());
+                    if(result == PacketStatus::COMPLETE)
+                        rxQueue.push(rxData.data(), rxData.size());
                 }
             }
         }
@@ -272,7 +312,7 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
 
     locked = lock;
 
-    if(platform_getPttStatus())
+    if(platform_getPttStatus() || packetTxReady(status))
     {
         demodulator.stopBasebandSampling();
         locked = false;
@@ -285,6 +325,7 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         status->lsfOk = false;
         dataValid     = false;
         extendedCall  = false;
+        lsfCached     = false;
         status->M17_link[0] = '\0';
         status->M17_refl[0] = '\0';
 
@@ -301,8 +342,34 @@ void OpMode_M17::txState(rtxStatus_t *const status)
     {
         startTx = false;
 
-        std::string src(status->source_address);
-        std::string dst(status->destination_address);
+        // Voice has the priority over queued packets, in BERT mode the PTT
+        // starts a BERT transmission instead of a voice one.
+        txPacket = false;
+        txBert   = false;
+        if(platform_getPttStatus() == false)
+        {
+            size_t len = txQueue.pop(txData.data(), M17_PACKET_MAX_SIZE);
+            txPacket   = txData.setSize(len);
+            txFrame    = 0;
+        }
+        else
+        {
+            txBert = bertMode;
+        }
+
+        // BERT transmissions carry no LSF, send just the preamble
+        if(txBert)
+        {
+            radio_enableTx();
+
+            modulator.invertPhase(invertTxPhase);
+            modulator.start();
+            txBertState(status);
+            return;
+        }
+
+        Callsign src(status->source_address);
+        Callsign dst(status->destination_address);
         M17LinkSetupFrame lsf;
 
         lsf.clear();
@@ -310,18 +377,29 @@ void OpMode_M17::txState(rtxStatus_t *const status)
         if(!dst.empty()) lsf.setDestination(dst);
 
         streamType_t type;
+        type.value           = 0;
         type.fields.dataMode = M17_DATAMODE_STREAM;     // Stream
         type.fields.dataType = M17_DATATYPE_VOICE;      // Voice data
         type.fields.CAN      = status->can;             // Channel access number
 
+        if(txPacket)
+        {
+            type.fields.dataMode = M17_DATAMODE_PACKET; // Packet
+            type.fields.dataType = M17_DATATYPE_DATA;   // Data
+        }
+
         lsf.setType(type);
         lsf.updateCrc();
 
         encoder.reset();
         encoder.encodeLsf(lsf, m17Frame);
 
-        txAudioPath = audioPath_request(SOURCE_MIC, SINK_MCU, PRIO_TX);
-        codec_startEncode(txAudioPath);
+        if(txPacket == false)
+        {
+            txAudioPath = audioPath_request(SOURCE_MIC, SINK_MCU, PRIO_TX);
+            codec_startEncode(txAudioPath, CODEC_MODE_3200, 2);
+        }
+
         radio_enableTx();
 
         modulator.invertPhase(invertTxPhase);
@@ -329,12 +407,23 @@ void OpMode_M17::txState(rtxStatus_t *const status)
         modulator.send(m17Frame);
     }
 
+    if(txPacket)
+    {
+        txPacketState(status);
+        return;
+    }
+
+    if(txBert)
+    {
+        txBertState(status);
+        return;
+    }
+
     payload_t dataFrame;
     bool      lastFrame = false;
 
     // Wait until there are 16 bytes of compressed speech, then send them
-    codec_popFrame(dataFrame.data(),     true);
-    codec_popFrame(dataFrame.data() + 8, true);
+    codec_popFrame(dataFrame.data(), dataFrame.size(), true);
 
     if(platform_getPttStatus() == false)
     {
@@ -354,25 +443,87 @@ void OpMode_M17::txState(rtxStatus_t *const status)
     }
 }
 
-bool OpMode_M17::compareCallsigns(const std::string& localCs,
-                                  const std::string& incomingCs)
+void OpMode_M17::txPacketState(rtxStatus_t *const status)
+{
+    frame_t        m17Frame;
+    M17PacketFrame packetFrame;
+
+    txData.getFrame(txFrame, packetFrame);
+    txFrame++;
+
+    encoder.encodePacketFrame(packetFrame, m17Frame);
+    modulator.send(m17Frame);
+
+    if(packetFrame.isLastFrame())
+    {
+        encoder.encodeEotFrame(m17Frame);
+        modulator.send(m17Frame);
+        modulator.stop();
+
+        txPacket = false;
+        startRx  = true;
+        status->opStatus = OFF;
+    }
+}
+
+void OpMode_M17::txBertState(rtxStatus_t *const status)
 {
-    if(incomingCs == "ALL")
-        return true;
+    frame_t m17Frame;
+    bert_t  bertFrame;
 
-    std::string truncatedLocal(localCs);
-    std::string truncatedIncoming(incomingCs);
+    bertTx.nextFrame(bertFrame);
+    encoder.encodeBertFrame(bertFrame, m17Frame);
+    modulator.send(m17Frame);
+
+    if(platform_getPttStatus() == false)
+    {
+        encoder.encodeEotFrame(m17Frame);
+        modulator.send(m17Frame);
+        modulator.stop();
+
+        txBert  = false;
+        startRx = true;
+        status->opStatus = OFF;
+    }
+}
 
-    int slashPos = localCs.find_first_of('/');
-    if(slashPos <= 2)
-        truncatedLocal = localCs.substr(slashPos + 1);
+bool OpMode_M17::packetTxReady(rtxStatus_t *const status)
+{
+    return (txQueue.empty() == false) && (locked == false) &&
+           (status->txDisable == 0);
+}
 
-    slashPos = incomingCs.find_first_of('/');
-    if(slashPos <= 2)
-        truncatedIncoming = incomingCs.substr(slashPos + 1);
+void OpMode_M17::decodeLsf(const M17LinkSetupFrame& lsf,
+                           rtxStatus_t *const status)
+{
+    streamType_t streamType = lsf.getType();
 
-    if(truncatedLocal == truncatedIncoming)
-        return true;
+    if((streamType.fields.encType    == M17_ENCRYPTION_NONE) &&
+       (streamType.fields.encSubType == M17_META_EXTD_CALLSIGN))
+    {
+        const meta_t& meta = lsf.metadata();
+
+        //
+        // The source callsign only contains the last link when
+        // receiving extended callsign data: in order to always store
+        // the true source of a transmission, we need to store the first
+        // extended callsign in M17_src.
+        //
+        decode_callsign(meta.extended_call_sign.call1)
+            .copyTo(status->M17_src, sizeof(status->M17_src));
+        decode_callsign(meta.extended_call_sign.call2)
+            .copyTo(status->M17_refl, sizeof(status->M17_refl));
+
+        extendedCall = true;
+    }
 
-    return false;
+    // Set source and destination fields.
+    // If we have received an extended callsign the src will be the RF link address
+    // The M17_src will already be stored from the extended callsign
+    lsf.getDestination().copyTo(status->M17_dst, sizeof(status->M17_dst));
+
+    if(extendedCall)
+        lsf.getSource().copyTo(status->M17_link, sizeof(status->M17_link));
+    else
+        lsf.getSource().copyTo(status->M17_src, sizeof(status->M17_src));
 }
@@ -21,6 +21,7 @@
 #include <interfaces/radio.h>
 #include <string.h>
 #include <rtx.h>
+#include <scan.h>
 #include <OpMode_FM.hpp>
 #include <OpMode_M17.hpp>
 
@@ -37,6 +38,49 @@ OpMode     noMode;              // Empty opMode handler for opmode::NONE
 OpMode_FM  fmMode;              // FM mode handler
 OpMode_M17 m17Mode;             // M17 mode handler
 
+/**
+ * \internal Apply the current RTX status to the radio driver and to the opMode
+ * handlers.
+ */
+static void _applyConfiguration()
+{
+    // Force TX and RX tone squelch to off for OpModes different from FM.
+    if(rtxStatus.opMode != OPMODE_FM)
+    {
+        rtxStatus.txToneEn = 0;
+        rtxStatus.rxToneEn = 0;
+    }
+
+    /*
+     * Handle change of opMode:
+     * - deactivate current opMode and switch operating status to "OFF";
+     * - update pointer to current mode handler to the OpMode object for the
+     *   selected mode;
+     * - enable the new mode handler
+     */
+    if(currMode->getID() != rtxStatus.opMode)
+    {
+        // Forward opMode change also to radio driver
+        radio_setOpmode(static_cast< enum opmode >(rtxStatus.opMode));
+
+        currMode->disable();
+        rtxStatus.opStatus = OFF;
+
+        switch(rtxStatus.opMode)
+        {
+            case OPMODE_NONE: currMode = &noMode;  break;
+            case OPMODE_FM:   currMode = &fmMode;  break;
+            case OPMODE_M17:  currMode = &m17Mode; break;
+            default:   currMode = &noMode;
+        }
+
+        currMode->enable();
+    }
+
+    // Tell radio driver that there was a change in its configuration.
+    radio_updateConfiguration();
+}
+
 void rtx_init(pthread_mutex_t *m)
 {
     // Initialise mutex for configuration access
@@ -64,6 +108,14 @@ void rtx_init(pthread_mutex_t *m)
     rtxStatus.M17_dst[0]    = '\0';
     rtxStatus.M17_link[0]   = '\0';
     rtxStatus.M17_refl[0]   = '\0';
+    rtxStatus.M17_bertEn      = false;
+    rtxStatus.M17_bertSync    = false;
+    rtxStatus.M17_bertBits    = 0;
+    rtxStatus.M17_bertErrors  = 0;
+    rtxStatus.M17_bertFrames  = 0;
+    rtxStatus.M17_bertLost    = 0;
+    rtxStatus.M17_bertBer     = 0.0f;
+    rtxStatus.M17_viterbiCost = 0.0f;
     currMode = &noMode;
 
     /*
@@ -127,41 +179,11 @@ void rtx_task()
 
     if(reconfigure)
     {
-        // Force TX and RX tone squelch to off for OpModes different from FM.
-        if(rtxStatus.opMode != OPMODE_FM)
-        {
-            rtxStatus.txToneEn = 0;
-            rtxStatus.rxToneEn = 0;
-        }
-
-        /*
-         * Handle change of opMode:
-         * - deactivate current opMode and switch operating status to "OFF";
-         * - update pointer to current mode handler to the OpMode object for the
-         *   selected mode;
-         * - enable the new mode handler
-         */
-        if(currMode->getID() != rtxStatus.opMode)
-        {
-            // Forward opMode change also to radio driver
-            radio_setOpmode(static_cast< enum opmode >(rtxStatus.opMode));
-
-            currMode->disable();
-            rtxStatus.opStatus = OFF;
-
-            switch(rtxStatus.opMode)
-            {
-                case OPMODE_NONE: currMode = &noMode;  break;
-                case OPMODE_FM:   currMode = &fmMode;  break;
-                case OPMODE_M17:  currMode = &m17Mode; break;
-                default:   currMode = &noMode;
-            }
-
-            currMode->enable();
-        }
+        // When scanning, stay tuned on the current scan list entry
+        if(scan_reapply(&rtxStatus))
+            reinitFilter = true;
 
-        // Tell radio driver that there was a change in its configuration.
-        radio_updateConfiguration();
+        _applyConfiguration();
     }
 
     /*
@@ -201,6 +223,29 @@ void rtx_task()
         reinitFilter = true;
     }
 
+    /*
+     * Scan engine update block, placed after the RSSI update to allow the
+     * engine to skip the channels below the squelch threshold.
+     *
+     * After each hop, the RSSI filter is re-initialised to get the level of
+     * the new channel on the next update. As long as the RF stage settles,
+     * the opMode handler is not run: its squelch cannot open and this keeps
+     * the hop rate bound only by the settling time.
+     */
+    enum scanAction scan = scan_update(&rtxStatus, currMode->rxSquelchOpen());
+    if(scan == SCAN_RETUNE)
+    {
+        _applyConfiguration();
+        reinitFilter = true;
+        reconfigure  = true;
+    }
+
+    if((scan != SCAN_NONE) && (rtxStatus.opStatus == RX))
+    {
+        sleepFor(0u, scan_settleTime());
+        return;
+    }
+
     /*
      * Forward the periodic update step to the currently active opMode handler.
      * Call is placed after RSSI update to allow handler's code have a fresh
@@ -218,3 +263,18 @@ bool rtx_rxSquelchOpen()
 {
     return currMode->rxSquelchOpen();
 }
+
+bool rtx_m17SendPacket(const void *data, const size_t len)
+{
+    return m17Mode.queuePacket(data, len);
+}
+
+size_t rtx_m17ReceivePacket(void *data, const size_t size)
+{
+    return m17Mode.popPacket(data, size);
+}
+
+void rtx_m17SetBertMode(const bool enable)
+{
+    m17Mode.setBertMode(enable);
+}
@@ -0,0 +1,387 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <interfaces/delays.h>
+#include <pthread.h>
+#include <string.h>
+#include <atomic>
+#include <utils.h>
+#include <scan.h>
+
+/**
+ * \internal Internal states of the scan engine.
+ */
+enum ScanState
+{
+    HOP    = 0,     ///< Move to the next entry of the scan list
+    PROBE  = 1,     ///< Wait for the RF stage to settle and sample the RSSI
+    LISTEN = 2,     ///< Signal above squelch threshold, dwell on the channel
+    HOLD   = 3      ///< Squelch open, stay on the channel
+};
+
+static const scanTiming_t defaultTiming = { 20, 500, 2000 };
+
+static scanEntry_t entries[SCAN_MAX_ENTRIES];   // Compiled scan list
+static uint16_t    numEntries = 0;              // Number of scan list entries
+static bool        rangeScan  = false;          // Scan list is a frequency range
+static freq_t      rangeStep  = 0;              // Frequency step of range scan
+
+static std::atomic_bool startReq(false);        // Scan start requested
+static std::atomic_bool stopReq(false);         // Scan stop requested
+static std::atomic_bool running(false);         // Scan running in RTX task
+
+static scanTiming_t timing;                     // Timing of current scan
+static rtxStatus_t  savedStatus;                // RTX status before scan start
+static ScanState    state;                      // Scan engine state
+static uint16_t     current;                    // Current scan list position
+static long long    deadline;                   // End of current wait, in ms
+static long long    startTime;                  // Scan start time, in ms
+
+static pthread_mutex_t statsMutex = PTHREAD_MUTEX_INITIALIZER;
+static scanStats_t     stats;
+
+
+/**
+ * \internal Compile a codeplug channel into a tuning record.
+ */
+static void _compile(scanEntry_t *entry, const channel_t *channel,
+                     const uint16_t index)
+{
+    memset(entry, 0x00, sizeof(scanEntry_t));
+
+    entry->rxFrequency = channel->rx_frequency;
+    entry->txFrequency = channel->tx_frequency;
+    entry->txPower     = dBmToWatt(channel->power);
+    entry->index       = index;
+    entry->opMode      = channel->mode;
+    entry->bandwidth   = channel->bandwidth;
+    entry->rxOnly      = channel->rx_only;
+
+    if(channel->mode == OPMODE_FM)
+    {
+        entry->rxToneEn = channel->fm.rxToneEn;
+        entry->rxTone   = ctcss_tone[channel->fm.rxTone];
+        entry->txToneEn = channel->fm.txToneEn;
+        entry->txTone   = ctcss_tone[channel->fm.txTone];
+    }
+}
+
+/**
+ * \internal Retrieve a tuning record from the scan list, range scans share a
+ * single record with the frequencies of the first step.
+ */
+static void _entry(scanEntry_t *entry, const uint16_t pos)
+{
+    if(rangeScan == false)
+    {
+        *entry = entries[pos];
+        return;
+    }
+
+    *entry = entries[0];
+    entry->rxFrequency += pos * rangeStep;
+    entry->txFrequency += pos * rangeStep;
+}
+
+/**
+ * \internal Apply a tuning record to the RTX status.
+ */
+static void _apply(rtxStatus_t *status, const scanEntry_t *entry)
+{
+    status->opMode      = entry->opMode;
+    status->bandwidth   = entry->bandwidth;
+    status->rxFrequency = entry->rxFrequency;
+    status->txFrequency = entry->txFrequency;
+    status->txPower     = entry->txPower;
+    status->rxToneEn    = entry->rxToneEn;
+    status->rxTone      = entry->rxTone;
+    status->txToneEn    = entry->txToneEn;
+    status->txTone      = entry->txTone;
+    status->txDisable   = savedStatus.txDisable | entry->rxOnly;
+    status->scan        = 1;
+}
+
+/**
+ * \internal Restore the RTX status saved at scan start.
+ */
+static void _restore(rtxStatus_t *status)
+{
+    status->opMode      = savedStatus.opMode;
+    status->bandwidth   = savedStatus.bandwidth;
+    status->rxFrequency = savedStatus.rxFrequency;
+    status->txFrequency = savedStatus.txFrequency;
+    status->txPower     = savedStatus.txPower;
+    status->rxToneEn    = savedStatus.rxToneEn;
+    status->rxTone      = savedStatus.rxTone;
+    status->txToneEn    = savedStatus.txToneEn;
+    status->txTone      = savedStatus.txTone;
+    status->txDisable   = savedStatus.txDisable;
+    status->scan        = 0;
+}
+
+/**
+ * \internal Move to the next entry of the scan list.
+ */
+static enum scanAction _hop(rtxStatus_t *status, const long long now,
+                            const bool first)
+{
+    scanEntry_t entry;
+
+    current = first ? 0 : (current + 1) % numEntries;
+    _entry(&entry, current);
+    _apply(status, &entry);
+
+    state    = PROBE;
+    deadline = now + timing.settleTime;
+
+    pthread_mutex_lock(&statsMutex);
+    stats.hops   += 1;
+    stats.current = current;
+    pthread_mutex_unlock(&statsMutex);
+
+    return SCAN_RETUNE;
+}
+
+/**
+ * \internal RSSI threshold for the channel to be considered active, same
+ * mapping of the RF squelch of the FM mode.
+ */
+static inline float _threshold(const rtxStatus_t *status)
+{
+    return -127.0f + status->sqlLevel * 66.0f / 15.0f;
+}
+
+
+int scan_loadBank(const int16_t bank)
+{
+    if(scan_running())
+        return -1;
+
+    rangeScan  = false;
+    rangeStep  = 0;
+    numEntries = 0;
+
+    for(uint32_t i = 0; (i <= UINT16_MAX) && (numEntries < SCAN_MAX_ENTRIES); i++)
+    {
+        int index = i;
+        if(bank >= 0)
+        {
+            index = cps_readBankData(bank, i);
+            if(index < 0)
+                break;
+        }
+
+        channel_t channel;
+        if(cps_readChannel(&channel, index) < 0)
+            break;
+
+        // Skip the channels of modes not handled by the RTX stage
+        if((channel.mode != OPMODE_FM) && (channel.mode != OPMODE_M17))
+            continue;
+
+        _compile(&entries[numEntries], &channel, index);
+        numEntries += 1;
+    }
+
+    return numEntries;
+}
+
+int scan_loadRange(const channel_t *channel, const freq_t start,
+                   const freq_t stop, const freq_t step)
+{
+    if(scan_running() || (step == 0) || (stop < start))
+        return -1;
+
+    uint32_t steps = ((stop - start) / step) + 1;
+    if(steps > UINT16_MAX)
+        steps = UINT16_MAX;
+
+    // Range scans keep only the first record, the others are derived from it
+    _compile(&entries[0], channel, 0);
+    entries[0].txFrequency = start + (channel->tx_frequency - channel->rx_frequency);
+    entries[0].rxFrequency = start;
+
+    rangeScan  = true;
+    rangeStep  = step;
+    numEntries = steps;
+
+    return numEntries;
+}
+
+int scan_getEntry(scanEntry_t *entry, const uint16_t pos)
+{
+    if(pos >= numEntries)
+        return -1;
+
+    _entry(entry, pos);
+    return 0;
+}
+
+int scan_start(const scanTiming_t *timingCfg)
+{
+    if((numEntries == 0) || scan_running())
+        return -1;
+
+    timing = (timingCfg != NULL) ? *timingCfg : defaultTiming;
+    stopReq  = false;
+    startReq = true;
+
+    return 0;
+}
+
+void scan_stop()
+{
+    // A start request not yet served is simply withdrawn
+    startReq = false;
+    stopReq  = true;
+}
+
+bool scan_running()
+{
+    return startReq || running;
+}
+
+void scan_getStats(scanStats_t *statsOut)
+{
+    pthread_mutex_lock(&statsMutex);
+    *statsOut = stats;
+    pthread_mutex_unlock(&statsMutex);
+}
+
+enum scanAction scan_update(rtxStatus_t *status, const bool sqlOpen)
+{
+    long long now = getTick();
+
+    if(running == false)
+    {
+        if(startReq == false)
+            return SCAN_NONE;
+
+        pthread_mutex_lock(&statsMutex);
+        memset(&stats, 0x00, sizeof(scanStats_t));
+        pthread_mutex_unlock(&statsMutex);
+
+        savedStatus = *status;
+        startTime   = now;
+        running     = true;
+        startReq    = false;
+
+        return _hop(status, now, true);
+    }
+
+    if(stopReq)
+    {
+        _restore(status);
+        running = false;
+        stopReq = false;
+
+        return SCAN_RETUNE;
+    }
+
+    pthread_mutex_lock(&statsMutex);
+    stats.elapsed = now - startTime;
+    pthread_mutex_unlock(&statsMutex);
+
+    // Scan is paused during transmission, dwell on the channel afterwards
+    if(status->opStatus == TX)
+    {
+        state    = LISTEN;
+        deadline = now + timing.dwellTime;
+        return SCAN_NONE;
+    }
+
+    switch(state)
+    {
+        case PROBE:
+            // Let the opMode handler bring the radio in RX, if necessary
+            if(status->opStatus != RX)
+                return SCAN_NONE;
+
+            if(now < deadline)
+                return SCAN_SETTLE;
+
+            // Early exit on dead channels
+            if(rtx_getRssi() < _threshold(status))
+            {
+                pthread_mutex_lock(&statsMutex);
+                stats.skipped += 1;
+                pthread_mutex_unlock(&statsMutex);
+
+                return _hop(status, now, false);
+            }
+
+            state    = LISTEN;
+            deadline = now + timing.dwellTime;
+            break;
+
+        case LISTEN:
+            if(sqlOpen)
+            {
+                pthread_mutex_lock(&statsMutex);
+                stats.stops += 1;
+                pthread_mutex_unlock(&statsMutex);
+
+                state    = HOLD;
+                deadline = now + timing.holdTime;
+                break;
+            }
+
+            if(now >= deadline)
+                return _hop(status, now, false);
+
+            break;
+
+        case HOLD:
+            if(sqlOpen)
+                deadline = now + timing.holdTime;
+            else if(now >= deadline)
+                return _hop(status, now, false);
+
+            break;
+
+        default:
+            return _hop(status, now, false);
+    }
+
+    return SCAN_NONE;
+}
+
+bool scan_reapply(rtxStatus_t *status)
+{
+    if(running == false)
+        return false;
+
+    scanEntry_t entry;
+    savedStatus = *status;
+    _entry(&entry, current);
+    _apply(status, &entry);
+
+    // Parameters like the squelch level may have changed, probe again
+    state    = PROBE;
+    deadline = getTick() + timing.settleTime;
+
+    return true;
+}
+
+uint16_t scan_settleTime()
+{
+    return timing.settleTime;
+}
@@ -2578,6 +2578,11 @@ bool ui_updateGUI()
     return true;
 }
 
+bool ui_eventPending()
+{
+    return (evQueue_wrPos != evQueue_rdPos);
+}
+
 bool ui_pushEvent(const uint8_t type, const uint32_t data)
 {
     uint8_t newHead = (evQueue_wrPos + 1) % MAX_NUM_EVENTS;
@@ -187,6 +187,21 @@ void _ui_drawMenuList(uint8_t selected, int (*getCurrentEntry)(char *buf, uint8_
     }
 }
 
+/**
+ * Prefetch from the codeplug the entries which are going to be drawn by
+ * _ui_drawMenuList(), following its same scrolling rule.
+ */
+static void _ui_prefetchMenuList(uint8_t selected,
+                                 int (*prefetch)(uint16_t pos, uint16_t count))
+{
+    // Number of menu entries that fit in the screen height
+    uint8_t entries_in_screen = (SCREEN_HEIGHT - 1 - layout.line1_pos.y) / layout.menu_h + 1;
+    uint8_t scroll = 0;
+    if(selected >= entries_in_screen)
+        scroll = selected - entries_in_screen + 1;
+    (*prefetch)(scroll, entries_in_screen);
+}
+
 void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
                            int (*getCurrentEntry)(char *buf, uint8_t max_len, uint8_t index),
                            int (*getCurrentValue)(char *buf, uint8_t max_len, uint8_t index))
@@ -581,6 +596,7 @@ void _ui_drawMenuChannel(ui_state_t* ui_state)
     gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
               color_white, currentLanguage->channels);
     // Print channel entries
+    _ui_prefetchMenuList(ui_state->menu_selected, cps_prefetchChannels);
     _ui_drawMenuList(ui_state->menu_selected, _ui_getChannelName);
 }
 
@@ -591,6 +607,7 @@ void _ui_drawMenuContacts(ui_state_t* ui_state)
     gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
               color_white, currentLanguage->contacts);
     // Print contact entries
+    _ui_prefetchMenuList(ui_state->menu_selected, cps_prefetchContacts);
     _ui_drawMenuList(ui_state->menu_selected, _ui_getContactName);
 }
 
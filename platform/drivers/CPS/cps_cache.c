@@ -0,0 +1,195 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <string.h>
+#include "cps_cache.h"
+
+/**
+ * \internal Tag of a cache entry.
+ */
+typedef struct
+{
+    uint32_t lastUse;   ///< Value of the access counter on last use
+    uint16_t pos;       ///< Position of the entry inside the codeplug
+    int8_t   result;    ///< Result of the read, 0 on success
+    bool     valid;     ///< Entry holds valid data
+}
+cacheTag_t;
+
+/**
+ * \internal CTCSS tones encoded in BCD, as stored in the native codeplugs. The
+ * table has the same ordering of ctcss_tone and, being BCD encoding monotonic,
+ * it is sorted in ascending order.
+ */
+static const uint16_t bcdTones[MAX_TONE_INDEX] =
+{
+    0x0670, 0x0693, 0x0719, 0x0744, 0x0770, 0x0797, 0x0825, 0x0854, 0x0885, 0x0915,
+    0x0948, 0x0974, 0x1000, 0x1034, 0x1072, 0x1109, 0x1148, 0x1188, 0x1230, 0x1273,
+    0x1318, 0x1365, 0x1413, 0x1462, 0x1514, 0x1567, 0x1598, 0x1622, 0x1655, 0x1679,
+    0x1713, 0x1738, 0x1773, 0x1799, 0x1835, 0x1862, 0x1899, 0x1928, 0x1966, 0x1995,
+    0x2035, 0x2065, 0x2107, 0x2181, 0x2257, 0x2291, 0x2336, 0x2418, 0x2503, 0x2541
+};
+
+static cacheTag_t channelTags[CPS_CACHE_CHANNELS];
+static channel_t  channels[CPS_CACHE_CHANNELS];
+static cacheTag_t contactTags[CPS_CACHE_CONTACTS];
+static contact_t  contacts[CPS_CACHE_CONTACTS];
+static uint32_t   accessCount = 0;
+
+
+/**
+ * \internal Search an entry in the cache.
+ *
+ * @param tags: cache tags.
+ * @param size: number of cache entries.
+ * @param pos: position of the entry inside the codeplug.
+ * @return index of the cache entry or -1 if not found.
+ */
+static int _lookup(const cacheTag_t *tags, const size_t size, const uint16_t pos)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        if(tags[i].valid && (tags[i].pos == pos))
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+ * \internal Select the cache entry where to store a new element: the entry
+ * already holding it, a free one or the least recently used one.
+ *
+ * @param tags: cache tags.
+ * @param size: number of cache entries.
+ * @param pos: position of the entry inside the codeplug.
+ * @return index of the cache entry.
+ */
+static size_t _allocate(const cacheTag_t *tags, const size_t size,
+                        const uint16_t pos)
+{
+    int entry = _lookup(tags, size, pos);
+    if(entry >= 0)
+        return entry;
+
+    size_t victim = 0;
+    for(size_t i = 0; i < size; i++)
+    {
+        if(tags[i].valid == false)
+            return i;
+
+        if((accessCount - tags[i].lastUse) > (accessCount - tags[victim].lastUse))
+            victim = i;
+    }
+
+    return victim;
+}
+
+
+void cpsCache_flush()
+{
+    memset(channelTags, 0x00, sizeof(channelTags));
+    memset(contactTags, 0x00, sizeof(contactTags));
+}
+
+bool cpsCache_hasChannel(uint16_t pos)
+{
+    return _lookup(channelTags, CPS_CACHE_CHANNELS, pos) >= 0;
+}
+
+bool cpsCache_getChannel(channel_t *channel, uint16_t pos, int *result)
+{
+    int entry = _lookup(channelTags, CPS_CACHE_CHANNELS, pos);
+    if(entry < 0)
+        return false;
+
+    channelTags[entry].lastUse = ++accessCount;
+    *result = channelTags[entry].result;
+    if(*result == 0)
+        memcpy(channel, &channels[entry], sizeof(channel_t));
+
+    return true;
+}
+
+void cpsCache_putChannel(const channel_t *channel, uint16_t pos, int result)
+{
+    size_t entry = _allocate(channelTags, CPS_CACHE_CHANNELS, pos);
+
+    channelTags[entry].lastUse = ++accessCount;
+    channelTags[entry].pos     = pos;
+    channelTags[entry].result  = (result == 0) ? 0 : -1;
+    channelTags[entry].valid   = true;
+    if(result == 0)
+        memcpy(&channels[entry], channel, sizeof(channel_t));
+}
+
+bool cpsCache_hasContact(uint16_t pos)
+{
+    return _lookup(contactTags, CPS_CACHE_CONTACTS, pos) >= 0;
+}
+
+bool cpsCache_getContact(contact_t *contact, uint16_t pos, int *result)
+{
+    int entry = _lookup(contactTags, CPS_CACHE_CONTACTS, pos);
+    if(entry < 0)
+        return false;
+
+    contactTags[entry].lastUse = ++accessCount;
+    *result = contactTags[entry].result;
+    if(*result == 0)
+        memcpy(contact, &contacts[entry], sizeof(contact_t));
+
+    return true;
+}
+
+void cpsCache_putContact(const contact_t *contact, uint16_t pos, int result)
+{
+    size_t entry = _allocate(contactTags, CPS_CACHE_CONTACTS, pos);
+
+    contactTags[entry].lastUse = ++accessCount;
+    contactTags[entry].pos     = pos;
+    contactTags[entry].result  = (result == 0) ? 0 : -1;
+    contactTags[entry].valid   = true;
+    if(result == 0)
+        memcpy(&contacts[entry], contact, sizeof(contact_t));
+}
+
+int cps_toneIndex(uint16_t code)
+{
+    // Empty slot or DCS code, the latter is not supported yet
+    if((code == 0) || (code == 0xFFFF) || ((code & 0x8000) != 0))
+        return -1;
+
+    int low  = 0;
+    int high = MAX_TONE_INDEX - 1;
+    while(low <= high)
+    {
+        int mid = (low + high) / 2;
+        if(bcdTones[mid] == code)
+            return mid;
+
+        if(bcdTones[mid] < code)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    return -1;
+}
@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CPS_CACHE_H
+#define CPS_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <cps.h>
+
+/**
+ * \internal Read-through cache of decoded codeplug entries, shared by all the
+ * native CPS drivers.
+ *
+ * Native codeplugs live in external nonvolatile memories, thus each read costs
+ * a wakeup of the memory, an SPI or I2C transfer and the conversion of the raw
+ * entry into the OpenRTX format. The UI reads the same few entries over and
+ * over while drawing the menus, so the drivers keep the most recently decoded
+ * channels and contacts in a small LRU cache. Failed reads are cached as well,
+ * in this way also the empty entry terminating a list costs a single access.
+ */
+
+#define CPS_CACHE_CHANNELS 16   /**< Number of channels kept in cache         */
+#define CPS_CACHE_CONTACTS 8    /**< Number of contacts kept in cache         */
+#define CPS_PREFETCH_MAX   8    /**< Maximum number of entries in a prefetch  */
+
+/**
+ * Drop all the entries from the cache.
+ */
+void cpsCache_flush();
+
+/**
+ * Check if a channel is present in the cache.
+ *
+ * @param pos: position of the channel inside the codeplug.
+ * @return true if the channel is present in the cache.
+ */
+bool cpsCache_hasChannel(uint16_t pos);
+
+/**
+ * Retrieve a channel from the cache. On hit, the channel data is copied only
+ * if the cached read was successful.
+ *
+ * @param channel: pointer to the channel_t data structure to be populated.
+ * @param pos: position of the channel inside the codeplug.
+ * @param result: pointer to the result of the cached read.
+ * @return true on cache hit, false otherwise.
+ */
+bool cpsCache_getChannel(channel_t *channel, uint16_t pos, int *result);
+
+/**
+ * Store a decoded channel in the cache, evicting the least recently used entry
+ * if the cache is full.
+ *
+ * @param channel: decoded channel data.
+ * @param pos: position of the channel inside the codeplug.
+ * @param result: result of the read, 0 on success and -1 on failure.
+ */
+void cpsCache_putChannel(const channel_t *channel, uint16_t pos, int result);
+
+/**
+ * Check if a contact is present in the cache.
+ *
+ * @param pos: position of the contact inside the codeplug.
+ * @return true if the contact is present in the cache.
+ */
+bool cpsCache_hasContact(uint16_t pos);
+
+/**
+ * Retrieve a contact from the cache. On hit, the contact data is copied only
+ * if the cached read was successful.
+ *
+ * @param contact: pointer to the contact_t data structure to be populated.
+ * @param pos: position of the contact inside the codeplug.
+ * @param result: pointer to the result of the cached read.
+ * @return true on cache hit, false otherwise.
+ */
+bool cpsCache_getContact(contact_t *contact, uint16_t pos, int *result);
+
+/**
+ * Store a decoded contact in the cache, evicting the least recently used entry
+ * if the cache is full.
+ *
+ * @param contact: decoded contact data.
+ * @param pos: position of the contact inside the codeplug.
+ * @param result: result of the read, 0 on success and -1 on failure.
+ */
+void cpsCache_putContact(const contact_t *contact, uint16_t pos, int result);
+
+/**
+ * Convert a CTCSS/DCS code, as stored in the native codeplugs, to the index of
+ * the corresponding entry of the ctcss_tone table. CTCSS tones are stored as
+ * BCD-encoded frequency in tenths of Hz, DCS codes have the two most
+ * significant bits set to 0b10 or 0b11.
+ *
+ * @param code: CTCSS/DCS code in codeplug format.
+ * @return index of the tone in ctcss_tone or -1 if the code is empty, is a DCS
+ * code or does not correspond to any supported tone.
+ */
+int cps_toneIndex(uint16_t code);
+
+#endif /* CPS_CACHE_H */
@@ -19,26 +19,61 @@
  ***************************************************************************/
 
 #include <interfaces/cps_io.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <time.h>
 
-#define CPS_CHUNK_SIZE 1024
+/*
+ * The codeplug content is loaded in memory when opened, reading the file
+ * through a read-only memory mapping, and all the accesses are served from
+ * there. In-place modifications are also written through to the file, while
+ * insertions only update the in-memory tables and the file is rewritten in
+ * its compact form, in a single sequential pass, when the codeplug is synced
+ * or closed. This avoids shifting the file tail at each insertion.
+ */
+
+#define CPS_INITIAL_CAPACITY 16
+
+typedef struct
+{
+    bankHdr_t header;      // Bank header, ch_count is the number of entries
+    uint32_t  offset;      // Bank offset in the file, valid only when clean
+    uint32_t *channels;    // Channel indices
+    size_t    capacity;    // Allocated size of the channel index table
+}
+bank_t;
+
+static struct
+{
+    char         *name;        // Codeplug file name
+    int           fd;          // Codeplug file descriptor, -1 when closed
+    bool          dirty;       // File layout is out of date
+    cps_header_t  header;
+    contact_t    *contacts;
+    channel_t    *channels;
+    bank_t       *banks;
+    size_t        ctCapacity;
+    size_t        chCapacity;
+    size_t        bCapacity;
+}
+cps = { .fd = -1 };
 
-static FILE *cps_file = NULL;
 const char *default_author = "Codeplug author.";
 const char *default_descr = "Codeplug description.";
 
 /**
- * Internal: read and validate codeplug header
+ * Internal: validate codeplug header
  *
- * @param header: pointer to the header struct to be populated
+ * @param header: header to be validated
  * @return 0 on success, -1 on failure
  */
-int _readHeader(cps_header_t *header)
+static int _checkHeader(const cps_header_t *header)
 {
-    fseek(cps_file, 0L, SEEK_SET);
-    fread(header, sizeof(cps_header_t), 1, cps_file);
     // Validate magic number
     if(header->magic != CPS_MAGIC)
         return -1;
@@ -50,179 +85,334 @@ int _readHeader(cps_header_t *header)
 }
 
 /**
- * Internal: write codeplug header
+ * Internal: make room for one more element in a dynamically allocated table
  *
- * @param header: header struct to be written
+ * @param table: pointer to the table
+ * @param capacity: pointer to the current table capacity, in elements
+ * @param count: current number of elements in the table
+ * @param size: size of a table element
  * @return 0 on success, -1 on failure
  */
-int _writeHeader(cps_header_t header)
+static int _reserve(void **table, size_t *capacity, size_t count, size_t size)
 {
-    fseek(cps_file, 0L, SEEK_SET);
-    fwrite(&header, sizeof(cps_header_t), 1, cps_file);
+    if(count < *capacity)
+        return 0;
+
+    size_t newCapacity = (*capacity == 0) ? CPS_INITIAL_CAPACITY
+                                          : (*capacity * 2);
+    void  *newTable    = realloc(*table, newCapacity * size);
+    if(newTable == NULL)
+        return -1;
+
+    *table    = newTable;
+    *capacity = newCapacity;
     return 0;
 }
 
 /**
- * Internal: push down data at a given offset by a given amount
+ * Internal: free all the in-memory codeplug data
+ */
+static void _freeCodeplug()
+{
+    for(size_t i = 0; (cps.banks != NULL) && (i < cps.header.b_count); i++)
+        free(cps.banks[i].channels);
+
+    free(cps.banks);
+    free(cps.channels);
+    free(cps.contacts);
+    free(cps.name);
+    memset(&cps, 0x00, sizeof(cps));
+    cps.fd = -1;
+}
+
+/**
+ * Internal: offset of the channel table in the codeplug file
+ */
+static inline long _channelsOffset()
+{
+    return sizeof(cps_header_t) + cps.header.ct_count * sizeof(contact_t);
+}
+
+/**
+ * Internal: offset of the bank data area in the codeplug file
+ */
+static inline long _bankDataOffset()
+{
+    return _channelsOffset() + cps.header.ch_count * sizeof(channel_t)
+                             + cps.header.b_count  * sizeof(uint32_t);
+}
+
+/**
+ * Internal: write a modified element back to its place in the file. Nothing
+ * is done when the file layout is out of date, as the whole file is going to
+ * be rewritten anyway.
  *
- * @param offset: offset at which to start to push down data
- * @param amount: amount of free space to be created
+ * @param offset: offset of the element in the file
+ * @param data: pointer to the element
+ * @param size: size of the element
  * @return 0 on success, -1 on failure
  */
-
-int _pushDown(uint32_t offset, uint32_t amount)
+static int _writeThrough(long offset, const void *data, size_t size)
 {
-    // Get end of file
-    fseek(cps_file, 0, SEEK_END);
-    long end = ftell(cps_file);
-    // If offset equals end, just return
-    if (offset == end)
+    if(cps.dirty)
         return 0;
-    // Move data downwards in chunks of fixed size
-    char buffer[CPS_CHUNK_SIZE] = { 0 };
-    for(int i = 1; i <= ((end - offset) / CPS_CHUNK_SIZE); i++)
-    {
-        fseek(cps_file, end - i * CPS_CHUNK_SIZE, SEEK_SET);
-        fread(buffer, CPS_CHUNK_SIZE, 1, cps_file);
-        fseek(cps_file, end - i * CPS_CHUNK_SIZE + amount, SEEK_SET);
-        fwrite(buffer, CPS_CHUNK_SIZE, 1, cps_file);
-    }
-    // Once initial offset is reached, move the last incomplete block
-    fseek(cps_file, offset, SEEK_SET);
-    fread(buffer, (end - offset) % CPS_CHUNK_SIZE, 1, cps_file);
-    fseek(cps_file, offset + amount, SEEK_SET);
-    fwrite(buffer, (end - offset) % CPS_CHUNK_SIZE, 1, cps_file);
-    fseek(cps_file, offset, SEEK_SET);
+
+    if(pwrite(cps.fd, data, size, offset) != (ssize_t) size)
+        return -1;
+
     return 0;
 }
 
 /**
- * Internal: updates the contact numbering after a contact addition or removal
+ * Internal: load the codeplug content from a memory mapping of its file
  *
- * @param pos: position at which the new contact was inserted or removed
- * @param add: if true a contact was inserted, otherwise it was removed
+ * @param map: pointer to the file mapping
+ * @param size: size of the file
  * @return 0 on success, -1 on failure
  */
-int _updateCtNumbering(uint16_t pos, bool add)
+static int _loadCodeplug(const uint8_t *map, size_t size)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    memcpy(&cps.header, map, sizeof(cps_header_t));
+    if(_checkHeader(&cps.header))
+        return -1;
+
+    cps_header_t *hdr = &cps.header;
+    size_t ctSize = hdr->ct_count * sizeof(contact_t);
+    size_t chSize = hdr->ch_count * sizeof(channel_t);
+    size_t bOffs  = _channelsOffset() + chSize;
+    size_t bData  = _bankDataOffset();
+    if(bData > size)
         return -1;
-    for(int i = 0; i < header.ch_count; i++)
+
+    // Banks are allocated first, so that cleanup on error is always safe
+    uint16_t numBanks = hdr->b_count;
+    hdr->b_count = 0;
+
+    cps.contacts = malloc(ctSize);
+    cps.channels = malloc(chSize);
+    cps.banks    = calloc(numBanks, sizeof(bank_t));
+    if(((ctSize != 0) && (cps.contacts == NULL)) ||
+       ((chSize != 0) && (cps.channels == NULL)) ||
+       ((numBanks != 0) && (cps.banks == NULL)))
+        return -1;
+
+    if(ctSize != 0)
+        memcpy(cps.contacts, map + sizeof(cps_header_t), ctSize);
+    if(chSize != 0)
+        memcpy(cps.channels, map + _channelsOffset(), chSize);
+    cps.ctCapacity = hdr->ct_count;
+    cps.chCapacity = hdr->ch_count;
+    cps.bCapacity  = numBanks;
+
+    for(uint16_t i = 0; i < numBanks; i++)
     {
-        channel_t c = { 0 };
-        cps_readChannel(&c, i);
-        if (c.mode == OPMODE_M17 && c.m17.contact_index >= pos)
-        {
-            if (add)
-                c.m17.contact_index++;
-            else
-                c.m17.contact_index--;
-            cps_writeChannel(c, i);
-        }
-        if (c.mode == OPMODE_DMR && c.dmr.contact_index >= pos)
-        {
-            if (add)
-                c.dmr.contact_index++;
-            else
-                c.dmr.contact_index--;
-            cps_writeChannel(c, i);
-        }
+        bank_t  *bank = &cps.banks[i];
+        uint32_t offset;
+
+        memcpy(&offset, map + bOffs + (i * sizeof(uint32_t)), sizeof(uint32_t));
+        if((bData + offset + sizeof(bankHdr_t)) > size)
+            return -1;
+
+        memcpy(&bank->header, map + bData + offset, sizeof(bankHdr_t));
+        size_t entries = bank->header.ch_count * sizeof(uint32_t);
+        if((bData + offset + sizeof(bankHdr_t) + entries) > size)
+            return -1;
+
+        bank->offset   = offset;
+        bank->capacity = bank->header.ch_count;
+        bank->channels = malloc(entries);
+        hdr->b_count++;
+
+        if(entries == 0)
+            continue;
+        if(bank->channels == NULL)
+            return -1;
+
+        memcpy(bank->channels, map + bData + offset + sizeof(bankHdr_t),
+               entries);
     }
+
     return 0;
 }
 
 /**
- * Internal: updates the channel numbering after a channel addition or removal
+ * Internal: flush to storage the directory containing the codeplug file, making
+ * persistent the renaming of a file inside it.
  *
- * @param pos: position at which the new channel was inserted or removed
- * @param add: if true a channel was inserted, otherwise it was removed
  * @return 0 on success, -1 on failure
  */
-int _updateChNumbering(uint16_t pos, bool add)
+static int _syncDirectory()
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    char *dirName = strdup(cps.name);
+    if(dirName == NULL)
         return -1;
-    for(int i = 0; i < header.b_count; i++)
-    {
-        bankHdr_t b_header = { 0 };
-        cps_readBankHeader(&b_header, i);
-        for(int j = 0; j < b_header.ch_count; j++)
-        {
-            int32_t ch = cps_readBankData(i, j);
-            if (ch >= pos)
-            {
-                if (add)
-                    ch++;
-                else
-                    ch--;
-                cps_writeBankData(ch, i, j);
-            }
-        }
-    }
-    return 0;
+
+    char *sep = strrchr(dirName, '/');
+    if(sep == dirName)
+        sep[1] = '\0';
+    else if(sep != NULL)
+        sep[0] = '\0';
+
+    int fd = open((sep != NULL) ? dirName : ".", O_RDONLY);
+    free(dirName);
+    if(fd < 0)
+        return -1;
+
+    int ret = fsync(fd);
+    close(fd);
+    return ret;
 }
 
 /**
- * Internal: get bank data offset
+ * Internal: write the whole codeplug to a new file, which then replaces the
+ * current one. The new file is flushed to storage before being renamed, so
+ * that after a power loss either the old or the new codeplug is found.
  *
- * @param pos: position of the bank to be read
- * @return the offset in the file where the bank data is stored, -1 if error
+ * @return 0 on success, -1 on failure
  */
-long _getBankDataOffset(uint16_t pos)
+static int _writeCodeplug()
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count + 1)
+    size_t nameLen = strlen(cps.name);
+    char  *tmpName = malloc(nameLen + 5);
+    if(tmpName == NULL)
         return -1;
-    if (pos == header.b_count)
+
+    memcpy(tmpName, cps.name, nameLen);
+    memcpy(tmpName + nameLen, ".tmp", 5);
+
+    FILE *file = fopen(tmpName, "w");
+    if(file == NULL)
     {
-        // No bank is present, no offset to read
-        if (header.b_count == 0)
-            return ftell(cps_file) +
-                   header.ct_count * sizeof(contact_t) +
-                   header.ch_count * sizeof(channel_t) +
-                   sizeof(uint32_t);
-        // Read last bank offset
-        fseek(cps_file,
-              header.ct_count * sizeof(contact_t) +
-              header.ch_count * sizeof(channel_t) +
-              (header.b_count - 1) * sizeof(uint32_t),
-              SEEK_CUR);
-        uint32_t offset = 0;
-        fread(&offset, sizeof(uint32_t), 1, cps_file);
-        long bdata_pos = ftell(cps_file);
-        bankHdr_t last_bank = { 0 };
-        cps_readBankHeader(&last_bank, header.b_count - 1);
-        return bdata_pos + offset + sizeof(bankHdr_t) + last_bank.ch_count * sizeof(uint32_t);
+        free(tmpName);
+        return -1;
     }
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
+
+    cps_header_t *hdr = &cps.header;
+    fwrite(hdr, sizeof(cps_header_t), 1, file);
+    fwrite(cps.contacts, sizeof(contact_t), hdr->ct_count, file);
+    fwrite(cps.channels, sizeof(channel_t), hdr->ch_count, file);
+
+    // Banks are stored densely, one after the other
     uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    return ftell(cps_file) +
-           (header.b_count - pos - 1) * sizeof(uint32_t) +
-           offset;
+    for(size_t i = 0; i < hdr->b_count; i++)
+    {
+        cps.banks[i].offset = offset;
+        fwrite(&offset, sizeof(uint32_t), 1, file);
+        offset += sizeof(bankHdr_t)
+                + cps.banks[i].header.ch_count * sizeof(uint32_t);
+    }
+
+    for(size_t i = 0; i < hdr->b_count; i++)
+    {
+        fwrite(&cps.banks[i].header, sizeof(bankHdr_t), 1, file);
+        fwrite(cps.banks[i].channels, sizeof(uint32_t),
+               cps.banks[i].header.ch_count, file);
+    }
+
+    int ret = ferror(file) ? -1 : 0;
+    if((fflush(file) != 0) || (fsync(fileno(file)) != 0))
+        ret = -1;
+    if(fclose(file) != 0)
+        ret = -1;
+
+    if(ret == 0)
+        ret = rename(tmpName, cps.name);
+
+    if(ret == 0)
+        ret = _syncDirectory();
+
+    if(ret == 0)
+        cps.dirty = false;
+    else
+        remove(tmpName);
+
+    free(tmpName);
+    return ret;
 }
 
 int cps_open(char *cps_name)
 {
+    if(cps.fd >= 0)
+        cps_close();
+    // Previous codeplug could not be saved and is still open
+    if(cps.fd >= 0)
+        return -1;
     if (!cps_name)
         cps_name = "default.rtxc";
-    cps_file = fopen(cps_name, "r+");
-    if (!cps_file)
+
+    int fd = open(cps_name, O_RDWR);
+    if(fd < 0)
         return -1;
+
+    struct stat info;
+    if((fstat(fd, &info) < 0) || (info.st_size < (off_t) sizeof(cps_header_t)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    int ret = _loadCodeplug((const uint8_t *) map, info.st_size);
+    munmap(map, info.st_size);
+
+    cps.fd   = fd;
+    cps.name = strdup(cps_name);
+    if((ret < 0) || (cps.name == NULL))
+    {
+        close(fd);
+        _freeCodeplug();
+        return -1;
+    }
+
+    return 0;
+}
+
+int cps_sync()
+{
+    if(cps.fd < 0)
+        return -1;
+
+    if(cps.dirty == false)
+        return fsync(cps.fd);
+
+    // On failure the in-memory tables stay dirty, a later call retries
+    if(_writeCodeplug() < 0)
+        return -1;
+
+    // The file descriptor still refers to the replaced file, further
+    // write-throughs have to go to the new one.
+    int fd = open(cps.name, O_RDWR);
+    if(fd < 0)
+    {
+        cps.dirty = true;
+        return -1;
+    }
+
+    close(cps.fd);
+    cps.fd = fd;
     return 0;
 }
 
 void cps_close()
 {
-    fclose(cps_file);
+    if(cps.fd < 0)
+        return;
+
+    if(cps_sync() < 0)
+    {
+        fprintf(stderr, "Failed to save codeplug %s, keeping it open\n",
+                cps.name);
+        return;
+    }
+
+    close(cps.fd);
+    _freeCodeplug();
 }
 
 int cps_create(char *cps_name)
@@ -252,251 +442,185 @@ int cps_create(char *cps_name)
 
 int cps_readContact(contact_t *contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if ((cps.fd < 0) || (pos >= cps.header.ct_count))
         return -1;
-    if (pos >= header.ct_count)
-        return -1;
-    fseek(cps_file, pos * sizeof(contact_t), SEEK_CUR);
-    fread(contact, sizeof(contact_t), 1, cps_file);
+    *contact = cps.contacts[pos];
     return 0;
 }
 
 int cps_readChannel(channel_t *channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if ((cps.fd < 0) || (pos >= cps.header.ch_count))
         return -1;
-    if (pos >= header.ch_count)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          pos * sizeof(channel_t),
-          SEEK_CUR);
-    fread(channel, sizeof(channel_t), 1, cps_file);
+    *channel = cps.channels[pos];
     return 0;
 }
 
 int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count)
+    if ((cps.fd < 0) || (pos >= cps.header.b_count))
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, (header.b_count - pos - 1) * sizeof(uint32_t) + offset, SEEK_CUR);
-    fread(b_header, sizeof(bankHdr_t), 1, cps_file);
+    *b_header = cps.banks[pos].header;
     return 0;
 }
 
 int cps_readBankData(uint16_t bank_pos, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if ((cps.fd < 0) || (bank_pos >= cps.header.b_count))
         return -1;
-    if (bank_pos >= header.b_count)
+    bank_t *bank = &cps.banks[bank_pos];
+    if (pos >= bank->header.ch_count)
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          bank_pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, (header.b_count - bank_pos - 1) * sizeof(uint32_t) + offset, SEEK_CUR);
-    bankHdr_t b_header = { 0 };
-    fread(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    if (pos >= b_header.ch_count)
-        return -1;
-    fseek(cps_file, pos * sizeof(uint32_t), SEEK_CUR);
-    uint32_t ch_index = 0;
-    fread(&ch_index, sizeof(uint32_t), 1, cps_file);
-    return ch_index;
+    return bank->channels[pos];
+}
+
+/**
+ * The whole codeplug is already kept in RAM, nothing to prefetch
+ */
+int cps_prefetchContacts(uint16_t pos, uint16_t count)
+{
+    (void) pos;
+    (void) count;
+    return 0;
+}
+
+/**
+ * The whole codeplug is already kept in RAM, nothing to prefetch
+ */
+int cps_prefetchChannels(uint16_t pos, uint16_t count)
+{
+    (void) pos;
+    (void) count;
+    return 0;
 }
 
 int cps_writeContact(contact_t contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if ((cps.fd < 0) || (pos >= cps.header.ct_count))
         return -1;
-    if (pos >= header.ct_count)
-        return -1;
-    fseek(cps_file, pos * sizeof(contact_t), SEEK_CUR);
-    fwrite(&contact, sizeof(contact_t), 1, cps_file);
-    return 0;
+    cps.contacts[pos] = contact;
+    return _writeThrough(sizeof(cps_header_t) + pos * sizeof(contact_t),
+                         &contact, sizeof(contact_t));
 }
 
 int cps_writeChannel(channel_t channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ch_count)
+    if ((cps.fd < 0) || (pos >= cps.header.ch_count))
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          pos * sizeof(channel_t),
-          SEEK_CUR);
-    fwrite(&channel, sizeof(channel_t), 1, cps_file);
-    return 0;
+    cps.channels[pos] = channel;
+    return _writeThrough(_channelsOffset() + pos * sizeof(channel_t),
+                         &channel, sizeof(channel_t));
 }
 
 int cps_writeBankHeader(bankHdr_t b_header, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, header.b_count - pos * sizeof(uint32_t) + offset, SEEK_CUR);
-    fwrite(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    return 0;
+    if ((cps.fd < 0) || (pos >= cps.header.b_count))
+        return -1;
+    // The channel count is determined by the bank content
+    bank_t *bank = &cps.banks[pos];
+    b_header.ch_count = bank->header.ch_count;
+    bank->header = b_header;
+    return _writeThrough(_bankDataOffset() + bank->offset,
+                         &b_header, sizeof(bankHdr_t));
 }
 
 int cps_writeBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if ((cps.fd < 0) || (bank_pos >= cps.header.b_count))
         return -1;
-    if (pos >= header.b_count + 1)
+    bank_t *bank = &cps.banks[bank_pos];
+    if (pos >= bank->header.ch_count)
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          bank_pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, (header.b_count - bank_pos - 1) * sizeof(uint32_t) + offset, SEEK_CUR);
-    bankHdr_t b_header = { 0 };
-    fread(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    if (pos >= b_header.ch_count)
-        return -1;
-    fseek(cps_file, pos * sizeof(uint32_t), SEEK_CUR);
-    fwrite(&ch, sizeof(uint32_t), 1, cps_file);
-    return 0;
+    bank->channels[pos] = ch;
+    return _writeThrough(_bankDataOffset() + bank->offset + sizeof(bankHdr_t)
+                         + pos * sizeof(uint32_t), &ch, sizeof(uint32_t));
 }
 
 int cps_insertContact(contact_t contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ct_count + 1)
-        return -1;
-    long ct_pos = ftell(cps_file) + pos * sizeof(contact_t);
-    _pushDown(ct_pos, sizeof(contact_t));
-    fwrite(&contact, sizeof(contact_t), 1, cps_file);
-    header.ct_count++;
-    _writeHeader(header);
-    if (_updateCtNumbering(pos, true))
-        return -1;
+    cps_header_t *hdr = &cps.header;
+    if ((cps.fd < 0) || (pos > hdr->ct_count) || (hdr->ct_count == UINT16_MAX))
+        return -1;
+    if (_reserve((void **) &cps.contacts, &cps.ctCapacity, hdr->ct_count,
+                 sizeof(contact_t)))
+        return -1;
+    memmove(&cps.contacts[pos + 1], &cps.contacts[pos],
+            (hdr->ct_count - pos) * sizeof(contact_t));
+    cps.contacts[pos] = contact;
+    hdr->ct_count++;
+    cps.dirty = true;
+    // Update the contact numbering of the channels
+    for(size_t i = 0; i < hdr->ch_count; i++)
+    {
+        channel_t *c = &cps.channels[i];
+        if (c->mode == OPMODE_M17 && c->m17.contact_index >= pos)
+            c->m17.contact_index++;
+        if (c->mode == OPMODE_DMR && c->dmr.contact_index >= pos)
+            c->dmr.contact_index++;
+    }
     return 0;
 }
 
 int cps_insertChannel(channel_t channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ch_count + 1)
-        return -1;
-    long ch_pos = ftell(cps_file) +
-                  header.ct_count * sizeof(contact_t) +
-                  pos * sizeof(channel_t);
-    _pushDown(ch_pos, sizeof(channel_t));
-    fwrite(&channel, sizeof(channel_t), 1, cps_file);
-    header.ch_count++;
-    _writeHeader(header);
-    _updateChNumbering(pos, true);
+    cps_header_t *hdr = &cps.header;
+    if ((cps.fd < 0) || (pos > hdr->ch_count) || (hdr->ch_count == UINT16_MAX))
+        return -1;
+    if (_reserve((void **) &cps.channels, &cps.chCapacity, hdr->ch_count,
+                 sizeof(channel_t)))
+        return -1;
+    memmove(&cps.channels[pos + 1], &cps.channels[pos],
+            (hdr->ch_count - pos) * sizeof(channel_t));
+    cps.channels[pos] = channel;
+    hdr->ch_count++;
+    cps.dirty = true;
+    // Update the channel numbering of the banks
+    for(size_t i = 0; i < hdr->b_count; i++)
+    {
+        bank_t *bank = &cps.banks[i];
+        for(size_t j = 0; j < bank->header.ch_count; j++)
+        {
+            if (bank->channels[j] >= pos)
+                bank->channels[j]++;
+        }
+    }
     return 0;
 }
 
 int cps_insertBankHeader(bankHdr_t b_header, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count + 1)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    long b_offset_pos = ftell(cps_file);
-    uint32_t b_offset = _getBankDataOffset(pos) - _getBankDataOffset(0);
-    // Read position of the new offset
-    _pushDown(b_offset_pos, sizeof(uint32_t));
-    fwrite(&b_offset, sizeof(uint32_t), 1, cps_file);
-    // Update all the offsets following the moved bank
-    for(int i = 0; i < header.b_count - pos; i++)
-    {
-        long p = ftell(cps_file);
-        uint32_t o = 0;
-        fread(&o, sizeof(uint32_t), 1, cps_file);
-        fseek(cps_file, p, SEEK_SET);
-        o += sizeof(bankHdr_t);
-        fwrite(&o, sizeof(uint32_t), 1, cps_file);
-    }
-    header.b_count++;
-    _writeHeader(header);
-    _pushDown(_getBankDataOffset(pos), sizeof(bankHdr_t));
-    fwrite(&b_header, sizeof(bankHdr_t), 1, cps_file);
+    cps_header_t *hdr = &cps.header;
+    if ((cps.fd < 0) || (pos > hdr->b_count) || (hdr->b_count == UINT16_MAX))
+        return -1;
+    if (_reserve((void **) &cps.banks, &cps.bCapacity, hdr->b_count,
+                 sizeof(bank_t)))
+        return -1;
+    memmove(&cps.banks[pos + 1], &cps.banks[pos],
+            (hdr->b_count - pos) * sizeof(bank_t));
+    // New banks are empty, channels are added with cps_insertBankData
+    bank_t *bank = &cps.banks[pos];
+    memset(bank, 0x00, sizeof(bank_t));
+    bank->header = b_header;
+    bank->header.ch_count = 0;
+    hdr->b_count++;
+    cps.dirty = true;
     return 0;
 }
 
 int cps_insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if ((cps.fd < 0) || (bank_pos >= cps.header.b_count))
         return -1;
-    if (bank_pos >= header.b_count)
+    bank_t *bank = &cps.banks[bank_pos];
+    if ((pos > bank->header.ch_count) || (bank->header.ch_count == UINT16_MAX))
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          bank_pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    // Update all the offsets following the moved bank
-    for(int i = 0; i < header.b_count - bank_pos - 1; i++)
-    {
-        long p = ftell(cps_file);
-        uint32_t o = 0;
-        fread(&o, sizeof(uint32_t), 1, cps_file);
-        fseek(cps_file, p, SEEK_SET);
-        o += sizeof(uint32_t);
-        fwrite(&o, sizeof(uint32_t), 1, cps_file);
-    }
-    // Update bank header
-    fseek(cps_file, offset, SEEK_CUR);
-    bankHdr_t b_header = { 0 };
-    long h_pos = ftell(cps_file);
-    fread(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    if (pos >= b_header.ch_count + 1)
-        return -1;
-    b_header.ch_count++;
-    fseek(cps_file, h_pos, SEEK_SET);
-    fwrite(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    fseek(cps_file, pos * sizeof(uint32_t), SEEK_CUR);
-    long p = ftell(cps_file);
-    _pushDown(p, sizeof(uint32_t));
-    fwrite(&ch, sizeof(uint32_t), 1, cps_file);
+    if (_reserve((void **) &bank->channels, &bank->capacity,
+                 bank->header.ch_count, sizeof(uint32_t)))
+        return -1;
+    memmove(&bank->channels[pos + 1], &bank->channels[pos],
+            (bank->header.ch_count - pos) * sizeof(uint32_t));
+    bank->channels[pos] = ch;
+    bank->header.ch_count++;
+    cps.dirty = true;
     return 0;
 }
@@ -26,6 +26,7 @@
 #include "AT24Cx.h"
 #include "W25Qx.h"
 #include "cps_data_GDx.h"
+#include "cps_cache.h"
 
 //static const uint32_t zoneBaseAddr        = 0x149e0;  /**< Base address of zones                */
 //static const uint32_t vfoChannelBaseAddr  = 0x7590;   /**< Base address of VFO channel          */
@@ -37,6 +38,9 @@ static const uint32_t maxNumChannels        = 1024;     /**< Maximum number of c
 static const uint32_t maxNumZones           = 68;       /**< Maximum number of zones in memory    */
 static const uint32_t maxNumContacts        = 1024;     /**< Maximum number of contacts in memory */
 
+static gdxChannel_t rawChannels[CPS_PREFETCH_MAX]; /**< Buffer for channel prefetch */
+static gdxContact_t rawContacts[CPS_PREFETCH_MAX]; /**< Buffer for contact prefetch */
+
 // Strings in GD-77 codeplug are terminated with 0xFF,
 // replace 0xFF terminator with 0x00 to be compatible with C strings
 static void _addStringTerminator(char *buf, uint8_t max_len)
@@ -52,6 +56,130 @@ static void _addStringTerminator(char *buf, uint8_t max_len)
 }
 
 
+/**
+ * Used to read a run of consecutive channels, all belonging to the same
+ * 128-channel bank, together with the validity bitmap of the bank
+ */
+static void _readChannels(uint8_t *bitmap, gdxChannel_t *chData, uint16_t pos,
+                          uint16_t count)
+{
+    // Channels are organized in 128-channel banks
+    uint8_t  bank_num      = pos / 128;
+    uint32_t channelOffset = 16 + pos * sizeof(gdxChannel_t);
+
+    // First channel bank (128 channels) is saved in EEPROM
+    if(pos < 128)
+    {
+        uint32_t bankAddr = channelBaseAddrEEPROM + bank_num * sizeof(gdxChannelBank_t);
+        AT24Cx_readData(bankAddr, bitmap, 16);
+        AT24Cx_readData(bankAddr + channelOffset, ((uint8_t *) chData),
+                        count * sizeof(gdxChannel_t));
+    }
+    // Remaining 7 channel banks (896 channels) are saved in SPI Flash
+    else
+    {
+        W25Qx_wakeup();
+        delayUs(5);
+        uint32_t bitmapAddr = channelBaseAddrFlash + (bank_num - 1) * sizeof(gdxChannelBank_t);
+        uint32_t bankAddr   = channelBaseAddrFlash + bank_num * sizeof(gdxChannelBank_t);
+        W25Qx_readData(bitmapAddr, bitmap, 16);
+        W25Qx_readData(bankAddr + channelOffset, ((uint8_t *) chData),
+                       count * sizeof(gdxChannel_t));
+        W25Qx_sleep();
+    }
+}
+
+/**
+ * Used to convert channel data from the codeplug format into a channel_t struct
+ */
+static int _decodeChannel(channel_t *channel, const uint8_t *bitmap,
+                          const gdxChannel_t *chData, uint16_t pos)
+{
+    memset(channel, 0x00, sizeof(channel_t));
+
+    uint8_t bank_channel = pos % 128;
+    uint8_t bitmap_byte  = bank_channel / 8;
+    uint8_t bitmap_bit   = bank_channel % 8;
+    // The channel is marked not valid in the bitmap
+    if(!(bitmap[bitmap_byte] & (1 << bitmap_bit)))
+        return -1;
+
+    // Copy data to OpenRTX channel_t
+    channel->mode            = chData->channel_mode + 1;
+    channel->bandwidth       = chData->bandwidth;
+    channel->rx_only         = chData->rx_only;
+    channel->power           = ((chData->power == 1) ? 135 : 100);
+    channel->rx_frequency    = bcdToBin(chData->rx_frequency) * 10;
+    channel->tx_frequency    = bcdToBin(chData->tx_frequency) * 10;
+    channel->scanList_index  = chData->scan_list_index;
+    channel->groupList_index = chData->group_list_index;
+    memcpy(channel->name, chData->name, sizeof(chData->name));
+    // Terminate string with 0x00 instead of 0xFF
+    _addStringTerminator(channel->name, sizeof(chData->name));
+
+    /* Load mode-specific parameters */
+    if(channel->mode == OPMODE_FM)
+    {
+        int rxTone = cps_toneIndex(chData->ctcss_dcs_receive);
+        int txTone = cps_toneIndex(chData->ctcss_dcs_transmit);
+
+        channel->fm.txToneEn = 0;
+        channel->fm.rxToneEn = 0;
+
+        if(rxTone >= 0)
+        {
+            channel->fm.rxTone   = rxTone;
+            channel->fm.rxToneEn = 1;
+        }
+
+        if(txTone >= 0)
+        {
+            channel->fm.txTone   = txTone;
+            channel->fm.txToneEn = 1;
+        }
+
+        // TODO: Implement warning screen if tone was not found
+    }
+    else if(channel->mode == OPMODE_DMR)
+    {
+        channel->dmr.contact_index = chData->contact_name_index;
+        channel->dmr.dmr_timeslot      = chData->repeater_slot;
+        channel->dmr.rxColorCode       = chData->colorcode_rx;
+        channel->dmr.txColorCode       = chData->colorcode_tx;
+    }
+
+    return 0;
+}
+
+/**
+ * Used to convert contact data from the codeplug format into a contact_t struct
+ */
+static int _decodeContact(contact_t *contact, const gdxContact_t *contactData)
+{
+    // Check if contact is empty
+    if(wcslen((wchar_t *) contactData->name) == 0) return -1;
+
+    memset(contact, 0x00, sizeof(contact_t));
+
+    // Copy contact name
+    memcpy(contact->name, contactData->name, sizeof(contactData->name));
+    // Terminate string with 0x00 instead of 0xFF
+    _addStringTerminator(contact->name, sizeof(contactData->name));
+
+    contact->mode = OPMODE_DMR;
+
+    // Copy contact DMR ID
+    contact->info.dmr.id = contactData->id[0]
+                         | (contactData->id[1] << 8)
+                         | (contactData->id[2] << 16);
+
+    // Copy contact details
+    contact->info.dmr.contactType = contactData->type;
+    contact->info.dmr.rx_tone     = contactData->receive_tone ? true : false;
+
+    return 0;
+}
+
 /**
  * This function does not apply to address-based codeplugs
  */
@@ -59,6 +187,15 @@ int cps_open(char *cps_name)
 {
 
     (void) cps_name;
+    cpsCache_flush();
+    return 0;
+}
+
+/**
+ * This function does not apply to address-based codeplugs
+ */
+int cps_sync()
+{
     return 0;
 }
 
@@ -67,6 +204,7 @@ int cps_open(char *cps_name)
  */
 void cps_close()
 {
+    cpsCache_flush();
 }
 
 /**
@@ -83,113 +221,49 @@ int cps_readChannel(channel_t *channel, uint16_t pos)
     if(pos >= maxNumChannels)
         return -1;
 
-    memset(channel, 0x00, sizeof(channel_t));
-
-    // Channels are organized in 128-channel banks
-    uint8_t bank_num = pos / 128;
-    uint8_t bank_channel = pos % 128;
+    int ret;
+    if(cpsCache_getChannel(channel, pos, &ret))
+        return ret;
 
-    // ### Read channel bank bitmap ###
     uint8_t bitmap[16];
-    // First channel bank (128 channels) is saved in EEPROM
-    if(pos < 128)
-    {
-        uint32_t readAddr = channelBaseAddrEEPROM + bank_num * sizeof(gdxChannelBank_t);
-        AT24Cx_readData(readAddr, ((uint8_t *) &bitmap), sizeof(bitmap));
-    }
-    // Remaining 7 channel banks (896 channels) are saved in SPI Flash
-    else
-    {
-        W25Qx_wakeup();
-        delayUs(5);
-        uint32_t readAddr = channelBaseAddrFlash + (bank_num - 1) * sizeof(gdxChannelBank_t);
-        W25Qx_readData(readAddr, ((uint8_t *) &bitmap), sizeof(bitmap));
-        W25Qx_sleep();
-    }
-    uint8_t bitmap_byte = bank_channel / 8;
-    uint8_t bitmap_bit = bank_channel % 8;
     gdxChannel_t chData;
-    // The channel is marked not valid in the bitmap
-    if(!(bitmap[bitmap_byte] & (1 << bitmap_bit)))
+    _readChannels(bitmap, &chData, pos, 1);
+
+    ret = _decodeChannel(channel, bitmap, &chData, pos);
+    cpsCache_putChannel(channel, pos, ret);
+
+    return ret;
+}
+
+int cps_prefetchChannels(uint16_t pos, uint16_t count)
+{
+    if(pos >= maxNumChannels)
         return -1;
-    // The channel is marked valid in the bitmap
-    // ### Read desired channel from the correct bank ###
-    else
-    {
-        uint32_t channelOffset = sizeof(bitmap) + pos * sizeof(gdxChannel_t);
-        // First channel bank (128 channels) is saved in EEPROM
-        if(pos < 128)
-        {
-            uint32_t bankAddr = channelBaseAddrEEPROM + bank_num * sizeof(gdxChannelBank_t);
-            AT24Cx_readData(bankAddr + channelOffset, ((uint8_t *) &chData), sizeof(gdxChannel_t));
-        }
-        // Remaining 7 channel banks (896 channels) are saved in SPI Flash
-        else
-        {
-            W25Qx_wakeup();
-            delayUs(5);
-            uint32_t bankAddr = channelBaseAddrFlash + bank_num * sizeof(gdxChannelBank_t);
-            W25Qx_readData(bankAddr + channelOffset, ((uint8_t *) &chData), sizeof(gdxChannel_t));
-            W25Qx_sleep();
-        }
-    }
-    // Copy data to OpenRTX channel_t
-    channel->mode            = chData.channel_mode + 1;
-    channel->bandwidth       = chData.bandwidth;
-    channel->rx_only         = chData.rx_only;
-    channel->power           = ((chData.power == 1) ? 135 : 100);
-    channel->rx_frequency    = bcdToBin(chData.rx_frequency) * 10;
-    channel->tx_frequency    = bcdToBin(chData.tx_frequency) * 10;
-    channel->scanList_index  = chData.scan_list_index;
-    channel->groupList_index = chData.group_list_index;
-    memcpy(channel->name, chData.name, sizeof(chData.name));
-    // Terminate string with 0x00 instead of 0xFF
-    _addStringTerminator(channel->name, sizeof(chData.name));
 
-    /* Load mode-specific parameters */
-    if(channel->mode == OPMODE_FM)
+    // Skip the entries already in cache
+    while((count > 0) && cpsCache_hasChannel(pos))
     {
-        channel->fm.txToneEn = 0;
-        channel->fm.rxToneEn = 0;
-        uint16_t rx_css = chData.ctcss_dcs_receive;
-        uint16_t tx_css = chData.ctcss_dcs_transmit;
+        pos++;
+        count--;
+    }
 
-        // TODO: Implement binary search to speed up this lookup
-        if((rx_css != 0) && (rx_css != 0xFFFF))
-        {
-            for(int i = 0; i < MAX_TONE_INDEX; i++)
-            {
-                if(ctcss_tone[i] == ((uint16_t) bcdToBin(rx_css)))
-                {
-                    channel->fm.rxTone = i;
-                    channel->fm.rxToneEn = 1;
-                    break;
-                }
-            }
-        }
+    // Prefetch is limited to the bank the first channel belongs to
+    uint16_t bankLeft = 128 - (pos % 128);
+    if(count > CPS_PREFETCH_MAX)        count = CPS_PREFETCH_MAX;
+    if(count > bankLeft)                count = bankLeft;
+    if((pos + count) > maxNumChannels)  count = maxNumChannels - pos;
+    if(count == 0) return 0;
 
-        if((tx_css != 0) && (tx_css != 0xFFFF))
-        {
-            for(int i = 0; i < MAX_TONE_INDEX; i++)
-            {
-                if(ctcss_tone[i] == ((uint16_t) bcdToBin(tx_css)))
-                {
-                    channel->fm.txTone = i;
-                    channel->fm.txToneEn = 1;
-                    break;
-                }
-            }
-        }
+    uint8_t bitmap[16];
+    _readChannels(bitmap, rawChannels, pos, count);
 
-        // TODO: Implement warning screen if tone was not found
-    }
-    else if(channel->mode == OPMODE_DMR)
+    for(uint16_t i = 0; i < count; i++)
     {
-        channel->dmr.contact_index = chData.contact_name_index;
-        channel->dmr.dmr_timeslot      = chData.repeater_slot;
-        channel->dmr.rxColorCode       = chData.colorcode_rx;
-        channel->dmr.txColorCode       = chData.colorcode_tx;
+        channel_t channel;
+        int ret = _decodeChannel(&channel, bitmap, &rawChannels[i], pos + i);
+        cpsCache_putChannel(&channel, pos + i, ret);
     }
+
     return 0;
 }
 
@@ -245,6 +319,10 @@ int cps_readContact(contact_t *contact, uint16_t pos)
 {
     if(pos >= maxNumContacts) return -1;
 
+    int ret;
+    if(cpsCache_getContact(contact, pos, &ret))
+        return ret;
+
     W25Qx_wakeup();
     delayUs(5);
 
@@ -253,24 +331,41 @@ int cps_readContact(contact_t *contact, uint16_t pos)
     W25Qx_readData(contactAddr, ((uint8_t *) &contactData), sizeof(gdxContact_t));
     W25Qx_sleep();
 
-    // Check if contact is empty
-    if(wcslen((wchar_t *) contactData.name) == 0) return -1;
+    ret = _decodeContact(contact, &contactData);
+    cpsCache_putContact(contact, pos, ret);
 
-    // Copy contact name
-    memcpy(contact->name, contactData.name, sizeof(contactData.name));
-    // Terminate string with 0x00 instead of 0xFF
-    _addStringTerminator(contact->name, sizeof(contactData.name));
+    return ret;
+}
 
-    contact->mode = OPMODE_DMR;
+int cps_prefetchContacts(uint16_t pos, uint16_t count)
+{
+    if(pos >= maxNumContacts) return -1;
 
-    // Copy contact DMR ID
-    contact->info.dmr.id = contactData.id[0]
-                         | (contactData.id[1] << 8)
-                         | (contactData.id[2] << 16);
+    // Skip the entries already in cache
+    while((count > 0) && cpsCache_hasContact(pos))
+    {
+        pos++;
+        count--;
+    }
 
-    // Copy contact details
-    contact->info.dmr.contactType = contactData.type;
-    contact->info.dmr.rx_tone     = contactData.receive_tone ? true : false;
+    if(count > CPS_PREFETCH_MAX)        count = CPS_PREFETCH_MAX;
+    if((pos + count) > maxNumContacts)  count = maxNumContacts - pos;
+    if(count == 0) return 0;
+
+    W25Qx_wakeup();
+    delayUs(5);
+
+    uint32_t contactAddr = contactBaseAddr + pos * sizeof(gdxContact_t);
+    W25Qx_readData(contactAddr, ((uint8_t *) rawContacts),
+                   count * sizeof(gdxContact_t));
+    W25Qx_sleep();
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        contact_t contact;
+        int ret = _decodeContact(&contact, &rawContacts[i]);
+        cpsCache_putContact(&contact, pos + i, ret);
+    }
 
     return 0;
 }
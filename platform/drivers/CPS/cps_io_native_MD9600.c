@@ -22,9 +22,11 @@
 #include <string.h>
 #include <interfaces/nvmem.h>
 #include <interfaces/delays.h>
+#include <interfaces/cps_io.h>
 #include <calibInfo_MDx.h>
 #include <utils.h>
 #include "cps_data_MDUV3x0.h"
+#include "cps_cache.h"
 #include "W25Qx.h"
 
 //static const uint32_t vfoChannelBaseAddr = 0x2EF00; /**< Base address of VFO channel                           */
@@ -36,35 +38,34 @@ static const uint32_t maxNumChannels     = 3000;      /**< Maximum number of cha
 static const uint32_t maxNumZones        = 250;       /**< Maximum number of zones and zone extensions in memory */
 static const uint32_t maxNumContacts     = 10000;     /**< Maximum number of contacts in memory                  */
 
+static mduv3x0Channel_t rawChannels[CPS_PREFETCH_MAX]; /**< Buffer for channel prefetch */
+static mduv3x0Contact_t rawContacts[CPS_PREFETCH_MAX]; /**< Buffer for contact prefetch */
+
 
 /**
- * Used to read channel data from SPI flash into a channel_t struct
+ * Used to convert channel data from the codeplug format into a channel_t struct
  */
-static int _readChannelAtAddress(channel_t *channel, uint32_t addr)
+static int _decodeChannel(channel_t *channel, const mduv3x0Channel_t *chData)
 {
-    W25Qx_wakeup();
-    delayUs(5);
-    mduv3x0Channel_t chData;
-    W25Qx_readData(addr, ((uint8_t *) &chData), sizeof(mduv3x0Channel_t));
-    W25Qx_sleep();
+    memset(channel, 0x00, sizeof(channel_t));
 
     // Check if the channel is empty
     #pragma GCC diagnostic ignored "-Waddress-of-packed-member"
-    if(wcslen((wchar_t *) chData.name) == 0) return -1;
+    if(wcslen((wchar_t *) chData->name) == 0) return -1;
 
-    channel->mode            = chData.channel_mode;
-    channel->bandwidth       = chData.bandwidth;
-    channel->rx_only         = chData.rx_only;
-    channel->rx_frequency    = bcdToBin(chData.rx_frequency) * 10;
-    channel->tx_frequency    = bcdToBin(chData.tx_frequency) * 10;
-    channel->scanList_index  = chData.scan_list_index;
-    channel->groupList_index = chData.group_list_index;
+    channel->mode            = chData->channel_mode;
+    channel->bandwidth       = chData->bandwidth;
+    channel->rx_only         = chData->rx_only;
+    channel->rx_frequency    = bcdToBin(chData->rx_frequency) * 10;
+    channel->tx_frequency    = bcdToBin(chData->tx_frequency) * 10;
+    channel->scanList_index  = chData->scan_list_index;
+    channel->groupList_index = chData->group_list_index;
 
-    if(chData.power == 3)
+    if(chData->power == 3)
     {
         channel->power = 135;  /* High power -> 5W = 37dBm */
     }
-    else if(chData.power == 2)
+    else if(chData->power == 2)
     {
         channel->power = 120;  /* Mid power -> 2.5W = 34dBm */
     }
@@ -79,57 +80,75 @@ static int _readChannelAtAddress(channel_t *channel, uint32_t addr)
      */
     for(uint16_t i = 0; i < 16; i++)
     {
-        channel->name[i] = ((char) (chData.name[i] & 0x00FF));
+        channel->name[i] = ((char) (chData->name[i] & 0x00FF));
     }
 
     /* Load mode-specific parameters */
     if(channel->mode == OPMODE_FM)
     {
+        int rxTone = cps_toneIndex(chData->ctcss_dcs_receive);
+        int txTone = cps_toneIndex(chData->ctcss_dcs_transmit);
+
         channel->fm.txToneEn = 0;
         channel->fm.rxToneEn = 0;
-        uint16_t rx_css = chData.ctcss_dcs_receive;
-        uint16_t tx_css = chData.ctcss_dcs_transmit;
 
-        // TODO: Implement binary search to speed up this lookup
-        if((rx_css != 0) && (rx_css != 0xFFFF))
+        if(rxTone >= 0)
         {
-            for(int i = 0; i < MAX_TONE_INDEX; i++)
-            {
-                if(ctcss_tone[i] == ((uint16_t) bcdToBin(rx_css)))
-                {
-                    channel->fm.rxTone = i;
-                    channel->fm.rxToneEn = 1;
-                    break;
-                }
-            }
+            channel->fm.rxTone   = rxTone;
+            channel->fm.rxToneEn = 1;
         }
 
-        if((tx_css != 0) && (tx_css != 0xFFFF))
+        if(txTone >= 0)
         {
-            for(int i = 0; i < MAX_TONE_INDEX; i++)
-            {
-                if(ctcss_tone[i] == ((uint16_t) bcdToBin(tx_css)))
-                {
-                    channel->fm.txTone = i;
-                    channel->fm.txToneEn = 1;
-                    break;
-                }
-            }
+            channel->fm.txTone   = txTone;
+            channel->fm.txToneEn = 1;
         }
 
         // TODO: Implement warning screen if tone was not found
     }
     else if(channel->mode == OPMODE_DMR)
     {
-        channel->dmr.contact_index = chData.contact_name_index;
-        channel->dmr.dmr_timeslot      = chData.repeater_slot;
-        channel->dmr.rxColorCode       = chData.colorcode;
-        channel->dmr.txColorCode       = chData.colorcode;
+        channel->dmr.contact_index = chData->contact_name_index;
+        channel->dmr.dmr_timeslot      = chData->repeater_slot;
+        channel->dmr.rxColorCode       = chData->colorcode;
+        channel->dmr.txColorCode       = chData->colorcode;
     }
 
     return 0;
 }
 
+/**
+ * Used to convert contact data from the codeplug format into a contact_t struct
+ */
+static int _decodeContact(contact_t *contact, const mduv3x0Contact_t *contactData)
+{
+    // Check if contact is empty
+    if(wcslen((wchar_t *) contactData->name) == 0) return -1;
+
+    memset(contact, 0x00, sizeof(contact_t));
+
+    /*
+     * Brutally convert channel name from unicode to char by truncating the most
+     * significant byte
+     */
+    for(uint16_t i = 0; i < 16; i++)
+    {
+        contact->name[i] = ((char) (contactData->name[i] & 0x00FF));
+    }
+
+    contact->mode = OPMODE_DMR;
+
+    // Copy contact DMR ID
+    contact->info.dmr.id = contactData->id[0]
+                         | (contactData->id[1] << 8)
+                         | (contactData->id[2] << 16);
+
+    // Copy contact details
+    contact->info.dmr.contactType = contactData->type;
+    contact->info.dmr.rx_tone     = contactData->receive_tone ? true : false;
+
+    return 0;
+}
 
 
 /**
@@ -138,6 +157,15 @@ static int _readChannelAtAddress(channel_t *channel, uint32_t addr)
 int cps_open(char *cps_name)
 {
     (void) cps_name;
+    cpsCache_flush();
+    return 0;
+}
+
+/**
+ * This function does not apply to address-based codeplugs
+ */
+int cps_sync()
+{
     return 0;
 }
 
@@ -146,6 +174,7 @@ int cps_open(char *cps_name)
  */
 void cps_close()
 {
+    cpsCache_flush();
 }
 
 /**
@@ -161,10 +190,55 @@ int cps_readChannel(channel_t *channel, uint16_t pos)
 {
     if(pos >= maxNumChannels) return -1;
 
-    memset(channel, 0x00, sizeof(channel_t));
+    int ret;
+    if(cpsCache_getChannel(channel, pos, &ret))
+        return ret;
+
+    W25Qx_wakeup();
+    delayUs(5);
+
+    mduv3x0Channel_t chData;
+    uint32_t readAddr = chDataBaseAddr + pos * sizeof(mduv3x0Channel_t);
+    W25Qx_readData(readAddr, ((uint8_t *) &chData), sizeof(mduv3x0Channel_t));
+    W25Qx_sleep();
+
+    ret = _decodeChannel(channel, &chData);
+    cpsCache_putChannel(channel, pos, ret);
+
+    return ret;
+}
+
+int cps_prefetchChannels(uint16_t pos, uint16_t count)
+{
+    if(pos >= maxNumChannels) return -1;
+
+    // Skip the entries already in cache
+    while((count > 0) && cpsCache_hasChannel(pos))
+    {
+        pos++;
+        count--;
+    }
+
+    if(count > CPS_PREFETCH_MAX)        count = CPS_PREFETCH_MAX;
+    if((pos + count) > maxNumChannels)  count = maxNumChannels - pos;
+    if(count == 0) return 0;
+
+    W25Qx_wakeup();
+    delayUs(5);
 
     uint32_t readAddr = chDataBaseAddr + pos * sizeof(mduv3x0Channel_t);
-    return _readChannelAtAddress(channel, readAddr);
+    W25Qx_readData(readAddr, ((uint8_t *) rawChannels),
+                   count * sizeof(mduv3x0Channel_t));
+    W25Qx_sleep();
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        channel_t channel;
+        int ret = _decodeChannel(&channel, &rawChannels[i]);
+        cpsCache_putChannel(&channel, pos + i, ret);
+    }
+
+    return 0;
 }
 
 int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos)
@@ -226,6 +300,10 @@ int cps_readContact(contact_t *contact, uint16_t pos)
 {
     if(pos >= maxNumContacts) return -1;
 
+    int ret;
+    if(cpsCache_getContact(contact, pos, &ret))
+        return ret;
+
     W25Qx_wakeup();
     delayUs(5);
 
@@ -234,27 +312,41 @@ int cps_readContact(contact_t *contact, uint16_t pos)
     W25Qx_readData(contactAddr, ((uint8_t *) &contactData), sizeof(mduv3x0Contact_t));
     W25Qx_sleep();
 
-    // Check if contact is empty
-    if(wcslen((wchar_t *) contactData.name) == 0) return -1;
-    /*
-     * Brutally convert channel name from unicode to char by truncating the most
-     * significant byte
-     */
-    for(uint16_t i = 0; i < 16; i++)
+    ret = _decodeContact(contact, &contactData);
+    cpsCache_putContact(contact, pos, ret);
+
+    return ret;
+}
+
+int cps_prefetchContacts(uint16_t pos, uint16_t count)
+{
+    if(pos >= maxNumContacts) return -1;
+
+    // Skip the entries already in cache
+    while((count > 0) && cpsCache_hasContact(pos))
     {
-        contact->name[i] = ((char) (contactData.name[i] & 0x00FF));
+        pos++;
+        count--;
     }
 
-    contact->mode = OPMODE_DMR;
+    if(count > CPS_PREFETCH_MAX)        count = CPS_PREFETCH_MAX;
+    if((pos + count) > maxNumContacts)  count = maxNumContacts - pos;
+    if(count == 0) return 0;
 
-    // Copy contact DMR ID
-    contact->info.dmr.id = contactData.id[0]
-                         | (contactData.id[1] << 8)
-                         | (contactData.id[2] << 16);
+    W25Qx_wakeup();
+    delayUs(5);
 
-    // Copy contact details
-    contact->info.dmr.contactType = contactData.type;
-    contact->info.dmr.rx_tone     = contactData.receive_tone ? true : false;
+    uint32_t contactAddr = contactBaseAddr + pos * sizeof(mduv3x0Contact_t);
+    W25Qx_readData(contactAddr, ((uint8_t *) rawContacts),
+                   count * sizeof(mduv3x0Contact_t));
+    W25Qx_sleep();
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        contact_t contact;
+        int ret = _decodeContact(&contact, &rawContacts[i]);
+        cpsCache_putContact(&contact, pos + i, ret);
+    }
 
     return 0;
 }
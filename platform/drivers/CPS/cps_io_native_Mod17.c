@@ -30,6 +30,14 @@ int cps_open(char *cps_name)
     return 0;
 }
 
+/**
+ * This function does not apply to address-based codeplugs
+ */
+int cps_sync()
+{
+    return 0;
+}
+
 /**
  * This function does not apply to address-based codeplugs
  */
@@ -73,3 +81,17 @@ int cps_readContact(contact_t *contact, uint16_t pos)
     (void) pos;
     return -1;
 }
+
+int cps_prefetchChannels(uint16_t pos, uint16_t count)
+{
+    (void) pos;
+    (void) count;
+    return 0;
+}
+
+int cps_prefetchContacts(uint16_t pos, uint16_t count)
+{
+    (void) pos;
+    (void) count;
+    return 0;
+}
@@ -24,16 +24,19 @@
 #include <hwconfig.h>
 #include <string.h>
 #include <miosix.h>
-#include <kernel/scheduler/scheduler.h>
 
-static int8_t detectStatus = -1;
-static size_t bufPos = 0;
-static size_t maxPos = 0;
-static char   *dataBuf;
-static bool   receiving = false;
+/*
+ * Receive ring buffer, filled by the USART interrupt handler. Its size allows
+ * to hold more than 250ms of data at 9600 baud.
+ */
+#define RX_BUF_SIZE 256
+
+static int8_t            detectStatus = -1;
+static uint8_t           rxBuf[RX_BUF_SIZE];
+static volatile uint16_t rxHead = 0;    // Written only by the IRQ handler
+static volatile uint16_t rxTail = 0;    // Written only by gps_readData()
 
 using namespace miosix;
-static Thread *gpsWaiting = 0;
 
 #ifdef PLATFORM_MD3x0
 #define PORT USART3
@@ -46,44 +49,14 @@ void __attribute__((used)) GpsUsartImpl()
 {
     if(PORT->SR & USART_SR_RXNE)
     {
-        char value = PORT->DR;
-
-        if((receiving == false) && (value == '$') && (bufPos == 0))
-        {
-            receiving = true;
-        }
+        uint8_t  value = PORT->DR;
+        uint16_t next  = (rxHead + 1) % RX_BUF_SIZE;
 
-        if(receiving)
+        // If the buffer is full, new data is dropped
+        if(next != rxTail)
         {
-            if(bufPos == maxPos)
-            {
-                receiving = false;
-            }
-
-            char prevChar   = dataBuf[bufPos - 1];
-            dataBuf[bufPos] = value;
-            bufPos += 1;
-
-            if((prevChar == '\r') && (value == '\n'))
-            {
-                receiving = false;
-                bufPos -= 1;
-            }
-        }
-
-        if((receiving == false) && (bufPos != 0))
-        {
-            // NMEA sentence received, turn off serial port
-            PORT->CR1 &= ~USART_CR1_UE;
-
-            if(gpsWaiting)
-            {
-                gpsWaiting->IRQwakeup();
-                if(gpsWaiting->IRQgetPriority()>
-                    Thread::IRQgetCurrentThread()->IRQgetPriority())
-                        Scheduler::IRQfindNextThread();
-                gpsWaiting = 0;
-            }
+            rxBuf[rxHead] = value;
+            rxHead        = next;
         }
     }
 
@@ -148,6 +121,10 @@ void gps_enable()
 {
     gpio_setPin(GPS_EN);
 
+    rxHead = 0;
+    rxTail = 0;
+    PORT->CR1 |= USART_CR1_UE;
+
     // Enable IRQ
     #ifdef PLATFORM_MD3x0
     NVIC_ClearPendingIRQ(USART3_IRQn);
@@ -168,9 +145,6 @@ void gps_disable()
     #else
     NVIC_DisableIRQ(USART1_IRQn);
     #endif
-
-    receiving = false;
-    bufPos    = 0;
 }
 
 bool gps_detect(uint16_t timeout)
@@ -203,42 +177,17 @@ bool gps_detect(uint16_t timeout)
     return (detectStatus == 1) ? true : false;
 }
 
-int gps_getNmeaSentence(char *buf, const size_t maxLength)
-{
-    if(detectStatus != 1) return -1;
-
-    memset(buf, 0x00, maxLength);
-    bufPos  = 0;
-    maxPos  = maxLength;
-    dataBuf = buf;
-
-    // Enable serial port
-    PORT->CR1 |= USART_CR1_UE;
-
-    return 0;
-}
-
-bool gps_nmeaSentenceReady()
+size_t gps_readData(uint8_t *buf, const size_t maxLength)
 {
-    return (receiving == false) && (bufPos > 0);
-}
+    size_t   count = 0;
+    uint16_t head  = rxHead;
 
-void gps_waitForNmeaSentence()
-{
-    /*
-     * Put the calling thread in waiting status until a complete sentence is ready.
-     */
+    while((rxTail != head) && (count < maxLength))
     {
-        FastInterruptDisableLock dLock;
-        gpsWaiting = Thread::IRQgetCurrentThread();
-        do
-        {
-            Thread::IRQwait();
-            {
-                FastInterruptEnableLock eLock(dLock);
-                Thread::yield();
-            }
-        }
-        while(gpsWaiting);
+        buf[count] = rxBuf[rxTail];
+        rxTail     = (rxTail + 1) % RX_BUF_SIZE;
+        count     += 1;
     }
+
+    return count;
 }
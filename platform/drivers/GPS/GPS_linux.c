@@ -20,45 +20,88 @@
 
 #include <peripherals/gps.h>
 #include <interfaces/delays.h>
-#include <sys/time.h>
 #include <hwconfig.h>
 #include <string.h>
+#include <stdio.h>
+#include <time.h>
 
-#define MAX_NMEA_LEN 80
-#define NMEA_SAMPLES 8
+/*
+ * Emulated GPS receiver: once per second a new navigation epoch is generated,
+ * carrying the current UTC time, and its sentences are sent at the pace of a
+ * serial line at the baud rate set in gps_init().
+ */
 
-static long long startTime;
+#define MAX_NMEA_LEN   83
+#define NMEA_SAMPLES   7
+#define EPOCH_BUF_SIZE (NMEA_SAMPLES * (MAX_NMEA_LEN + 2))
 
-char test_nmea_sentences [NMEA_SAMPLES][MAX_NMEA_LEN] =
+static const char *nmeaTemplates[NMEA_SAMPLES] =
 {
-    "$GPGGA,223659.522,5333.735,N,00959.130,E,1,12,1.0,0.0,M,0.0,M,,*62",
-    "$GPGSA,A,3,01,02,03,04,05,06,07,08,09,10,11,12,1.0,1.0,1.0*30",
-    "$GPGSV,3,1,12,30,79,066,27,05,63,275,21,07,42,056,,13,40,289,13*76",
-    "$GPGSV,3,2,12,14,36,147,20,28,30,151,,09,13,100,,02,08,226,30*72",
-    "$GPGSV,3,3,12,18,05,333,,15,04,289,22,08,03,066,,27,02,030,*79",
-    "$GPRMC,223659.522,A,5333.735,N,00959.130,E,,,160221,000.0,W*70",
-    "$GPVTG,92.15,T,,M,0.15,N,0.28,K,A*0C"
+    "GPGGA,%02d%02d%02d.000,5333.735,N,00959.130,E,1,12,1.0,0.0,M,0.0,M,,",
+    "GPGSA,A,3,01,02,03,04,05,06,07,08,09,10,11,12,1.0,1.0,1.0",
+    "GPGSV,3,1,12,30,79,066,27,05,63,275,21,07,42,056,,13,40,289,13",
+    "GPGSV,3,2,12,14,36,147,20,28,30,151,,09,13,100,,02,08,226,30",
+    "GPGSV,3,3,12,18,05,333,,15,04,289,22,08,03,066,,27,02,030,",
+    "GPRMC,%02d%02d%02d.000,A,5333.735,N,00959.130,E,0.15,92.15,160221,000.0,W",
+    "GPVTG,92.15,T,,M,0.15,N,0.28,K,A"
 };
 
+static uint32_t  baudRate = 9600;
+static bool      enabled  = false;
+static char      epochBuf[EPOCH_BUF_SIZE];
+static size_t    epochLen = 0;
+static size_t    epochPos = 0;
+static long long epochStart;
+
+/**
+ * \internal
+ * Build the NMEA sentences of a new epoch.
+ */
+static void buildEpoch()
+{
+    time_t    now = time(NULL);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+
+    epochLen = 0;
+    epochPos = 0;
+
+    for(int i = 0; i < NMEA_SAMPLES; i++)
+    {
+        char body[MAX_NMEA_LEN];
+        snprintf(body, sizeof(body), nmeaTemplates[i], utc.tm_hour,
+                 utc.tm_min, utc.tm_sec);
+
+        uint8_t checksum = 0;
+        for(char *c = body; *c != '\0'; c++)
+            checksum ^= *c;
+
+        epochLen += snprintf(&epochBuf[epochLen], EPOCH_BUF_SIZE - epochLen,
+                             "$%s*%02X\r\n", body, checksum);
+    }
+}
+
 void gps_init(const uint16_t baud)
 {
-    (void) baud;
-    return;
+    baudRate = baud;
 }
 
 void gps_terminate()
 {
-    return;
+    gps_disable();
 }
 
 void gps_enable()
 {
-    return;
+    enabled    = true;
+    epochLen   = 0;
+    epochPos   = 0;
+    epochStart = getTick() - 1000;
 }
 
 void gps_disable()
 {
-    return;
+    enabled = false;
 }
 
 bool gps_detect(uint16_t timeout)
@@ -67,45 +110,30 @@ bool gps_detect(uint16_t timeout)
     return true;
 }
 
-int gps_getNmeaSentence(char *buf, const size_t maxLength)
-{
-    static int i = 0;
-
-    // Emulate GPS device by sending NMEA sentences every 1s
-    if(i == 0)
-        sleepFor(1u, 0u);
-
-    size_t len = strnlen(test_nmea_sentences[i], MAX_NMEA_LEN);
-
-    if (len > maxLength)
-        return -1;
-
-    strncpy(buf, test_nmea_sentences[i], maxLength);
-    i++;
-    i %= NMEA_SAMPLES;
-
-    // Save the current timestamp for sentence ready emulation
-    struct timeval te;
-    gettimeofday(&te, NULL);
-    startTime = te.tv_sec*1000LL + te.tv_usec/1000;
-
-    return 0;
-}
-
-bool gps_nmeaSentenceReady()
+size_t gps_readData(uint8_t *buf, const size_t maxLength)
 {
-    // Return new sentence ready only after 1s from start
-    struct timeval te;
-    gettimeofday(&te, NULL);
-    long long currTime = te.tv_sec*1000LL + te.tv_usec/1000;
-
-    if((currTime -  startTime) > 1000) return true;
-
-    return false;
+    if(enabled == false)
+        return 0;
+
+    // The emulated receiver starts sending a new epoch every second
+    long long now = getTick();
+    if((epochPos == epochLen) && ((now - epochStart) >= 1000))
+    {
+        epochStart += 1000 * ((now - epochStart) / 1000);
+        buildEpoch();
+    }
+
+    // Data is released at the pace of the serial line, 10 bits per character
+    size_t sent = ((now - epochStart) * baudRate) / 10000;
+    if(sent > epochLen)
+        sent = epochLen;
+
+    size_t count = sent - epochPos;
+    if(count > maxLength)
+        count = maxLength;
+
+    memcpy(buf, &epochBuf[epochPos], count);
+    epochPos += count;
+
+    return count;
 }
-
-void gps_waitForNmeaSentence()
-{
-    return;
-}
-
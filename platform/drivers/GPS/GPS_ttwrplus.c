@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include <zephyr/drivers/uart.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <zephyr/kernel.h>
 #include <interfaces/delays.h>
 #include <peripherals/gps.h>
@@ -33,20 +34,21 @@
 #error "Please select the correct gps UART device"
 #endif
 
-#define NMEA_MSG_SIZE 82
+/*
+ * Receive ring buffer, filled by the UART interrupt callback. Its size allows
+ * to hold more than 250ms of data at 9600 baud.
+ */
+#define RX_BUF_SIZE 256
 
-K_MSGQ_DEFINE(gps_uart_msgq, NMEA_MSG_SIZE, 10, 4);
+RING_BUF_DECLARE(gps_rx_ringbuf, RX_BUF_SIZE);
 
 static const struct device *const gps_dev = DEVICE_DT_GET(UART_GPS_DEV_NODE);
 
-// receive buffer used in UART ISR callback
-static char rx_buf[NMEA_MSG_SIZE];
-static uint16_t rx_buf_pos;
-
 
 static void gps_serialCb(const struct device *dev, void *user_data)
 {
-    uint8_t c;
+    uint8_t buf[16];
+    int     len;
 
     if (uart_irq_update(gps_dev) == false)
         return;
@@ -54,25 +56,10 @@ static void gps_serialCb(const struct device *dev, void *user_data)
     if (uart_irq_rx_ready(gps_dev) == false)
         return;
 
-    // read until FIFO empty
-    while (uart_fifo_read(gps_dev, &c, 1) == 1)
+    // read until FIFO empty, if the ring buffer is full data is dropped
+    while ((len = uart_fifo_read(gps_dev, buf, sizeof(buf))) > 0)
     {
-        if (c == '$' && rx_buf_pos > 0)
-        {
-            // terminate string
-            rx_buf[rx_buf_pos] = '\0';
-
-            // if queue is full, message is silently dropped
-            k_msgq_put(&gps_uart_msgq, &rx_buf, K_NO_WAIT);
-
-            // reset the buffer (it was copied to the msgq)
-            rx_buf_pos = 0;
-            rx_buf[rx_buf_pos++] = '$';
-        }
-        else if (rx_buf_pos < (sizeof(rx_buf) - 1))
-        {
-            rx_buf[rx_buf_pos++] = c;
-        }
+        ring_buf_put(&gps_rx_ringbuf, buf, len);
     }
 }
 
@@ -117,6 +104,7 @@ void gps_terminate()
 
 void gps_enable()
 {
+    ring_buf_reset(&gps_rx_ringbuf);
     pmu_setGPSPower(true);
 }
 
@@ -130,21 +118,7 @@ bool gps_detect(uint16_t timeout)
     return true;
 }
 
-int gps_getNmeaSentence(char *buf, const size_t maxLength)
+size_t gps_readData(uint8_t *buf, const size_t maxLength)
 {
-    k_msgq_get(&gps_uart_msgq, buf, K_FOREVER);
-    return 0;
-}
-
-bool gps_nmeaSentenceReady()
-{
-    return k_msgq_num_used_get(&gps_uart_msgq) != 0;
-}
-
-void gps_waitForNmeaSentence()
-{
-    while (k_msgq_num_used_get(&gps_uart_msgq) != 0)
-    {
-        sleepFor(0, 100);
-    }
+    return ring_buf_get(&gps_rx_ringbuf, buf, maxLength);
 }
@@ -24,6 +24,7 @@
 #include <interfaces/delays.h>
 #include <calibInfo_MDx.h>
 #include <utils.h>
+#include "nvmem_settings_MDx.h"
 #include "W25Qx.h"
 
 W25Qx_DEVICE_DEFINE(W25Q128_main, W25Qx_api)
@@ -62,6 +63,7 @@ void nvm_init()
 
 void nvm_terminate()
 {
+    nvmSettings_terminate();
     W25Qx_terminate();
 }
 
@@ -19,14 +19,61 @@
  ***************************************************************************/
 
 #include <interfaces/nvmem.h>
+#include <nvmem_journal.h>
 #include <calibInfo_Mod17.h>
 #include <string.h>
+#include <errno.h>
 #include <crc.h>
 #include "flash.h"
 
 /*
- * Data structures defining the memory layout used for saving and restore
- * of user settings and VFO configuration.
+ * Settings and calibration data are stored in a journal spanning sectors 10
+ * and 11 of the MCU flash, each one used as a journal bank.
+ */
+STM32_FLASH_DEVICE_DEFINE(mcuFlash)
+
+static const struct nvmPartition settingsPartitions[] =
+{
+    {
+        .offset = 0x00000,  // First bank, sector 10
+        .size   = 0x20000
+    },
+    {
+        .offset = 0x20000,  // Second bank, sector 11
+        .size   = 0x20000
+    }
+};
+
+static const struct nvmArea settingsArea =
+{
+    .name       = "Settings",
+    .dev        = &mcuFlash,
+    .startAddr  = 0x080C0000,
+    .size       = 0x40000,
+    .partitions = settingsPartitions
+};
+
+enum journalKeys
+{
+    KEY_SETTINGS = 0,
+    KEY_CALIBRATION
+};
+
+static settings_t   settingsData;
+static mod17Calib_t calibData;
+
+static const struct nvmJournalKey journalKeys[] =
+{
+    { &settingsData, sizeof(settings_t)   },
+    { &calibData,    sizeof(mod17Calib_t) }
+};
+
+static nvmJournal_t journal;
+static bool         journalOpen = false;
+
+/*
+ * Data structures defining the memory layout used by the previous versions of
+ * the firmware for saving and restore of user settings and calibration data.
  */
 typedef struct
 {
@@ -46,19 +93,18 @@ __attribute__((packed)) memory_t;
 
 static const uint32_t MEM_MAGIC   = 0x584E504F;    // "OPNX"
 static const uint32_t baseAddress = 0x080E0000;
-memory_t *memory = ((memory_t *) baseAddress);
+static const memory_t *memory     = ((const memory_t *) baseAddress);
 
 mod17Calib_t mod17CalData;   // Calibration data, to be saved and loaded
 
 /**
  * \internal
- * Utility function to find the currently active data block inside memory, that
- * is the one containing the last saved settings. Blocks containing legacy data
- * are marked with numbers starting from 4096.
+ * Utility function to find the active data block of the legacy settings
+ * storage, that is the one containing the last saved settings.
  *
  * @return number currently active data block or -1 if memory data is invalid.
  */
-static int findActiveBlock()
+static int findLegacyBlock()
 {
     // Check for invalid memory data
     if(memory->magic != MEM_MAGIC)
@@ -97,6 +143,34 @@ static int findActiveBlock()
     return block;
 }
 
+/**
+ * \internal
+ * Open the settings journal on first access. If the journal is empty, data
+ * saved in the legacy format is imported.
+ */
+static void openJournal()
+{
+    if(journalOpen)
+        return;
+
+    journalOpen = true;
+
+    int ret = nvmJournal_open(&journal, &settingsArea, 0, 1, journalKeys, 2);
+    if(ret != -ENOENT)
+        return;
+
+    int block = findLegacyBlock();
+    if(block < 0)
+        return;
+
+    settings_t   settings;
+    mod17Calib_t calib;
+    memcpy(&settings, &(memory->data[block].settings),    sizeof(settings_t));
+    memcpy(&calib,    &(memory->data[block].calibration), sizeof(mod17Calib_t));
+    nvmJournal_write(&journal, KEY_SETTINGS, &settings);
+    nvmJournal_write(&journal, KEY_CALIBRATION, &calib);
+}
+
 void nvm_init()
 {
 
@@ -104,7 +178,10 @@ void nvm_init()
 
 void nvm_terminate()
 {
-
+    // Prepare the flash sector for the next journal compaction, the system
+    // stall caused by the erase is harmless during the shutdown sequence.
+    if(journalOpen)
+        nvmJournal_prepare(&journal);
 }
 
 size_t nvm_getMemoryAreas(const struct nvmArea **list)
@@ -142,60 +219,25 @@ int nvm_readVfoChannelData(channel_t *channel)
 
 int nvm_readSettings(settings_t *settings)
 {
-    int block = findActiveBlock();
+    openJournal();
 
-    // Invalid data found
-    if(block < 0) return -1;
+    if(nvmJournal_read(&journal, KEY_SETTINGS, settings) < 0)
+        return -1;
 
-    memcpy(settings,      &(memory->data[block].settings),    sizeof(settings_t));
-    memcpy(&mod17CalData, &(memory->data[block].calibration), sizeof(mod17Calib_t));
+    nvmJournal_read(&journal, KEY_CALIBRATION, &mod17CalData);
 
     return 0;
 }
 
 int nvm_writeSettings(const settings_t *settings)
 {
-    uint32_t addr    = 0;
-    int      block   = findActiveBlock();
-    uint16_t prevCrc = 0;
+    openJournal();
 
-    /*
-     * Memory never initialised or save space finished: erase all the sector.
-     * On STM32F405 the settings are saved in sector 11, starting at address
-     * 0x08060000.
-     */
-    if((block < 0) || (block >= 2047))
-    {
-        flash_eraseSector(11);
-        addr = ((uint32_t) &(memory->magic));
-        flash_write(addr, &MEM_MAGIC, sizeof(MEM_MAGIC));
-        block = 0;
-    }
-    else
-    {
-        prevCrc = memory->data[block].crc;
-        block += 1;
-    }
-
-    dataBlock_t tmpBlock;
-    memcpy((&tmpBlock.settings),    settings,      sizeof(settings_t));
-    memcpy((&tmpBlock.calibration), &mod17CalData, sizeof(mod17Calib_t));
-
-    const size_t crcLen = sizeof(settings_t) + sizeof(mod17Calib_t);
-    tmpBlock.crc = crc_ccitt(&(tmpBlock.settings), crcLen);
-
-    // New data is equal to the old one, avoid saving
-    if((block != 0) && (tmpBlock.crc == prevCrc))
-        return 0;
-
-    // Save data
-    addr = ((uint32_t) &(memory->data[block]));
-    flash_write(addr, &tmpBlock, sizeof(dataBlock_t));
+    if(nvmJournal_write(&journal, KEY_SETTINGS, settings) < 0)
+        return -1;
 
-    // Update the flags marking used data blocks
-    uint32_t flag = ~(1 << (block % 32));
-    addr = ((uint32_t) &(memory->flags[block / 32]));
-    flash_write(addr, &flag, sizeof(uint32_t));
+    if(nvmJournal_write(&journal, KEY_CALIBRATION, &mod17CalData) < 0)
+        return -1;
 
     return 0;
 }
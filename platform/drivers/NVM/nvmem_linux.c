@@ -25,21 +25,22 @@
 #include <sys/errno.h>
 #include <posix_file.h>
 #include <nvmem_access.h>
+#include <nvmem_journal.h>
 #include <interfaces/nvmem.h>
 
 #define NVM_MAX_PATHLEN 256
 
-POSIX_FILE_DEVICE_DEFINE(stateDevice, NULL, 1024)
+POSIX_FILE_DEVICE_DEFINE(stateDevice, NULL, 8192)
 
 const struct nvmPartition statePartitions[] =
 {
     {
-        .offset = 0x0000,   // First partition, radio state
-        .size   = 512
+        .offset = 0x0000,   // First partition, settings journal bank 0
+        .size   = 4096
     },
     {
-        .offset = 0x0200,   // Second partition, settings
-        .size   = 512
+        .offset = 0x1000,   // Second partition, settings journal bank 1
+        .size   = 4096
     }
 };
 
@@ -49,11 +50,28 @@ const struct nvmArea areas[] =
         .name       = "Device state NVM area",
         .dev        = &stateDevice,
         .startAddr  = 0x0000,
-        .size       = 1024,
+        .size       = 8192,
         .partitions = statePartitions
     }
 };
 
+enum journalKeys
+{
+    KEY_SETTINGS = 0,
+    KEY_VFO
+};
+
+static settings_t settingsData;
+static channel_t  vfoData;
+
+static const struct nvmJournalKey journalKeys[] =
+{
+    { &settingsData, sizeof(settings_t) },
+    { &vfoData,      sizeof(channel_t)  }
+};
+
+static nvmJournal_t journal;
+
 
 /**
  * Creates a directory if it does not exist.
@@ -139,8 +157,12 @@ void nvm_init()
 
     int ret = posixFile_init(&stateDevice, memory_path);
     if(ret < 0)
+    {
         printf("Opening of state file failed with status %d\n", ret);
+        return;
+    }
 
+    nvmJournal_open(&journal, &areas[0], 0, 1, journalKeys, 2);
     return;
 
 toolong:
@@ -150,6 +172,7 @@ toolong:
 
 void nvm_terminate()
 {
+    nvmJournal_prepare(&journal);
     posixFile_terminate(&stateDevice);
 }
 
@@ -168,48 +191,24 @@ void nvm_readHwInfo(hwInfo_t *info)
 
 int nvm_readVfoChannelData(channel_t *channel)
 {
-    int ret = nvmArea_readPartition(&areas[0], 0, 0, channel, sizeof(channel_t));
-    if(ret < 0)
-        return ret;
-
-    // TODO: implement a more serious integrity check
-    for(size_t i = 0; i < sizeof(channel_t); i++)
-    {
-        const uint8_t *p = (const uint8_t *) channel;
-        if(p[i] != 0x00)
-            return 0;
-    }
-
-    return -1;
+    return nvmJournal_read(&journal, KEY_VFO, channel);
 }
 
 int nvm_readSettings(settings_t *settings)
 {
-    int ret = nvmArea_readPartition(&areas[0], 1, 0, settings, sizeof(settings_t));
-    if(ret < 0)
-        return ret;
-
-    // TODO: implement a more serious integrity check
-    for(size_t i = 0; i < sizeof(settings_t); i++)
-    {
-        const uint8_t *p = (const uint8_t *) settings;
-        if(p[i] != 0x00)
-            return 0;
-    }
-
-    return -1;
+    return nvmJournal_read(&journal, KEY_SETTINGS, settings);
 }
 
 int nvm_writeSettings(const settings_t *settings)
 {
-    return nvmArea_writePartition(&areas[0], 1, 0, settings, sizeof(settings_t));
+    return nvmJournal_write(&journal, KEY_SETTINGS, settings);
 }
 
 int nvm_writeSettingsAndVfo(const settings_t *settings, const channel_t *vfo)
 {
-    int ret = nvmArea_writePartition(&areas[0], 1, 0, settings, sizeof(settings_t));
+    int ret = nvmJournal_write(&journal, KEY_SETTINGS, settings);
     if(ret < 0)
         return ret;
 
-    return nvmArea_writePartition(&areas[0], 0, 0, vfo, sizeof(channel_t));
+    return nvmJournal_write(&journal, KEY_VFO, vfo);
 }
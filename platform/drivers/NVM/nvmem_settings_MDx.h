@@ -0,0 +1,40 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef NVMEM_SETTINGS_MDX_H
+#define NVMEM_SETTINGS_MDX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Shut down the settings storage of the MDx devices, preparing the flash sector
+ * for the next journal compaction. Erasing a sector of the MCU flash stalls the
+ * whole system for up to a couple of seconds, so this function must be called
+ * only during the shutdown sequence, after the last settings save.
+ */
+void nvmSettings_terminate();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVMEM_SETTINGS_MDX_H */
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include "posix_file.h"
 
 static const struct nvmParams posix_file_params =
@@ -87,7 +88,7 @@ static int nvm_api_read(const struct nvmDevice *dev, uint32_t offset,
     if(fd < 0)
         return -EBADF;
 
-    if((offset + len) >= cfg->fileSize)
+    if((offset + len) > cfg->fileSize)
         return -EINVAL;
 
     lseek(fd, offset, SEEK_SET);
@@ -103,13 +104,43 @@ static int nvm_api_write(const struct nvmDevice *dev, uint32_t offset,
     if(fd < 0)
         return -EBADF;
 
-    if((offset + len) >= cfg->fileSize)
+    if((offset + len) > cfg->fileSize)
         return -EINVAL;
 
     lseek(fd, offset, SEEK_SET);
     return write(fd, data, len);
 }
 
+static int nvm_api_erase(const struct nvmDevice *dev, uint32_t offset,
+                         size_t size)
+{
+    const struct posixFileCfg *cfg = (const struct posixFileCfg *)(dev->config);
+    const int fd = *(int *)(dev->priv);
+
+    if(fd < 0)
+        return -EBADF;
+
+    if((offset + size) > cfg->fileSize)
+        return -EINVAL;
+
+    // Erased area reads as 0xFF, like on flash memories
+    uint8_t buf[64];
+    memset(buf, 0xFF, sizeof(buf));
+
+    lseek(fd, offset, SEEK_SET);
+    while(size > 0)
+    {
+        size_t len = (size > sizeof(buf)) ? sizeof(buf) : size;
+        ssize_t ret = write(fd, buf, len);
+        if(ret < 0)
+            return -errno;
+
+        size -= ret;
+    }
+
+    return 0;
+}
+
 static const struct nvmParams *nvm_api_params(const struct nvmDevice *dev)
 {
     (void) dev;
@@ -121,7 +152,7 @@ const struct nvmApi posix_file_api =
 {
     .read   = nvm_api_read,
     .write  = nvm_api_write,
-    .erase  = NULL,
+    .erase  = nvm_api_erase,
     .sync   = NULL,
     .params = nvm_api_params
 };
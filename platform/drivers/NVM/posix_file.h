@@ -26,6 +26,8 @@
 /**
  * Device driver for file-based nonvolatile memory storage. The driver
  * implementation is based on the POSIX syscalls for file management.
+ * Erase operations fill the target area with 0xFF, as it happens on flash
+ * memories.
  */
 
 
@@ -22,6 +22,7 @@
 #include <peripherals/gpio.h>
 #include <hwconfig.h>
 #include "file_source.h"
+#include "file_sink.h"
 
 
 static const uint8_t pathCompatibilityMatrix[9][9] =
@@ -40,9 +41,9 @@ static const uint8_t pathCompatibilityMatrix[9][9] =
 
 const struct audioDevice outputDevices[] =
 {
-    {NULL, 0, 0, SINK_MCU},
-    {NULL, 0, 0, SINK_RTX},
-    {NULL, 0, 0, SINK_SPK},
+    {NULL,                    0,                   0, SINK_MCU},
+    {NULL,                    0,                   0, SINK_RTX},
+    {&file_sink_audio_driver, "/tmp/speaker.raw",  0, SINK_SPK},
 };
 
 const struct audioDevice inputDevices[] =
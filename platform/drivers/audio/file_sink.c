@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include "file_sink.h"
+
+struct fileSinkState
+{
+    FILE            *fp;          ///< Destination file.
+    uint8_t          half;        ///< Half of the buffer being "played".
+    struct timespec  deadline;    ///< End of the current playback period.
+};
+
+/**
+ * \internal
+ * Advance the playback deadline by a given number of samples.
+ */
+static void advanceDeadline(struct fileSinkState *state, const size_t samples,
+                            const uint32_t sampleRate)
+{
+    uint64_t ns = ((uint64_t) samples * 1000000000ULL) / sampleRate;
+
+    state->deadline.tv_sec  += ns / 1000000000ULL;
+    state->deadline.tv_nsec += ns % 1000000000ULL;
+    if(state->deadline.tv_nsec >= 1000000000L)
+    {
+        state->deadline.tv_sec  += 1;
+        state->deadline.tv_nsec -= 1000000000L;
+    }
+}
+
+static int fileSink_start(const uint8_t instance, const void *config, struct streamCtx *ctx)
+{
+    (void) instance;
+
+    if(ctx == NULL)
+        return -EINVAL;
+
+    if(ctx->running != 0)
+        return -EBUSY;
+
+    struct fileSinkState *state = malloc(sizeof(struct fileSinkState));
+    if(state == NULL)
+        return -ENOMEM;
+
+    state->fp = fopen(config, "wb");
+    if(state->fp == NULL)
+    {
+        free(state);
+        return -EINVAL;
+    }
+
+    state->half = 0;
+    clock_gettime(CLOCK_MONOTONIC, &state->deadline);
+    ctx->priv    = state;
+    ctx->running = 1;
+
+    return 0;
+}
+
+static int fileSink_data(struct streamCtx *ctx, stream_sample_t **buf)
+{
+    if(ctx->running == 0)
+        return -1;
+
+    struct fileSinkState *state = (struct fileSinkState *) ctx->priv;
+    size_t size = ctx->bufSize;
+
+    // In double buffered mode the free section is the one not being played
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        size /= 2;
+        *buf  = ctx->buffer + ((state->half ^ 1) * size);
+    }
+    else
+    {
+        *buf = ctx->buffer;
+    }
+
+    return size;
+}
+
+static int fileSink_sync(struct streamCtx *ctx, uint8_t dirty)
+{
+    (void) dirty;
+
+    if(ctx->running == 0)
+        return -1;
+
+    struct fileSinkState *state = (struct fileSinkState *) ctx->priv;
+    size_t size = ctx->bufSize;
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+        size /= 2;
+
+    // Wait for the end of the current period using absolute deadlines, so
+    // that the time spent by the caller does not accumulate as drift.
+    advanceDeadline(state, size, ctx->sampleRate);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &state->deadline, NULL);
+
+    // Write out the section just "played" and move to the other one
+    stream_sample_t *played = ctx->buffer;
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        played      += state->half * size;
+        state->half ^= 1;
+    }
+
+    fwrite(played, sizeof(stream_sample_t), size, state->fp);
+
+    return 0;
+}
+
+static void fileSink_stop(struct streamCtx *ctx)
+{
+    if(ctx->running == 0)
+        return;
+
+    struct fileSinkState *state = (struct fileSinkState *) ctx->priv;
+    fclose(state->fp);
+    free(state);
+    ctx->running = 0;
+}
+
+static void fileSink_halt(struct streamCtx *ctx)
+{
+    fileSink_stop(ctx);
+}
+
+#pragma GCC diagnostic ignored "-Wpedantic"
+const struct audioDriver file_sink_audio_driver =
+{
+    .start     = fileSink_start,
+    .data      = fileSink_data,
+    .sync      = fileSink_sync,
+    .stop      = fileSink_stop,
+    .terminate = fileSink_halt
+};
+#pragma GCC diagnostic pop
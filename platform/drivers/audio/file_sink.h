@@ -1,8 +1,8 @@
 /***************************************************************************
- *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
- *                                Niccolò Izzo IU2KIN                      *
- *                                Frederik Saraci IU2NRO                   *
- *                                Silvano Seva IU2KWO                      *
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
  *                                                                         *
  *   This program is free software; you can redistribute it and/or modify  *
  *   it under the terms of the GNU General Public License as published by  *
@@ -18,20 +18,27 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
-#include <crc.h>
+#ifndef FILE_SINK_H
+#define FILE_SINK_H
 
-uint16_t crc_ccitt(const void *data, const size_t len)
-{
-    uint16_t x   = 0;
-    uint16_t crc = 0;
-    const uint8_t *buf = ((const uint8_t *) data);
+#include <interfaces/audio.h>
 
-    for(size_t i = 0; i < len; i++)
-    {
-        x   = (crc >> 8) ^ buf[i];
-        x  ^= x >> 4;
-        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
-    }
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-    return crc;
+/**
+ * Driver providing an audio output stream to a file. The samples are written
+ * in raw format, 16 bit, little endian, at the same pace of an equivalent
+ * hardware peripheral. The configuration parameter is the file name with the
+ * full path.
+ */
+
+extern const struct audioDriver file_sink_audio_driver;
+
+
+#ifdef __cplusplus
 }
+#endif
+
+#endif /* FILE_SINK_H */
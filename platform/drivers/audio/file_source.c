@@ -24,6 +24,12 @@
 #include <errno.h>
 #include "file_source.h"
 
+struct fileSourceState
+{
+    FILE    *fp;      ///< Source file.
+    uint8_t  half;    ///< Half of the buffer to be filled, for double buffering.
+};
+
 static int fileSource_start(const uint8_t instance, const void *config, struct streamCtx *ctx)
 {
     (void) instance;
@@ -34,16 +40,20 @@ static int fileSource_start(const uint8_t instance, const void *config, struct s
     if(ctx->running != 0)
         return -EBUSY;
 
-    ctx->running = 1;
+    struct fileSourceState *state = malloc(sizeof(struct fileSourceState));
+    if(state == NULL)
+        return -ENOMEM;
 
-    FILE *fp = fopen(config, "rb");
-    if(fp == NULL)
+    state->fp = fopen(config, "rb");
+    if(state->fp == NULL)
     {
-        ctx->running = 0;
+        free(state);
         return -EINVAL;
     }
 
-    ctx->priv = fp;
+    state->half  = 0;
+    ctx->priv    = state;
+    ctx->running = 1;
 
     return 0;
 }
@@ -53,24 +63,30 @@ static int fileSource_data(struct streamCtx *ctx, stream_sample_t **buf)
     if(ctx->running == 0)
         return -1;
 
-    FILE *fp  = (FILE *) ctx->priv;
-    stream_sample_t *dest = *buf;
+    struct fileSourceState *state = (struct fileSourceState *) ctx->priv;
+    stream_sample_t *dest = ctx->buffer;
     size_t size = ctx->bufSize;
-    size_t i;
+    size_t i    = 0;
 
+    // In double buffered mode fill the two halves alternately
     if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
         size /= 2;
+        dest += state->half * size;
+        state->half ^= 1;
+    }
 
     // Read data from the file, rollover when end is reached
     while (i < size)
     {
-        size_t n = fread(dest + i, sizeof(stream_sample_t), size - i, fp);
+        size_t n = fread(dest + i, sizeof(stream_sample_t), size - i, state->fp);
         if (n < (size - i))
-            fseek(fp, 0, SEEK_SET);
+            fseek(state->fp, 0, SEEK_SET);
 
         i += n;
     }
 
+    *buf = dest;
     return size;
 }
 
@@ -78,6 +94,9 @@ static int fileSource_sync(struct streamCtx *ctx, uint8_t dirty)
 {
     (void) dirty;
 
+    if(ctx->running == 0)
+        return -1;
+
     size_t size = ctx->bufSize;
     if(ctx->bufMode == BUF_CIRC_DOUBLE)
         size /= 2;
@@ -95,17 +114,15 @@ static void fileSource_stop(struct streamCtx *ctx)
     if(ctx->running == 0)
         return;
 
-    FILE *fp = (FILE *) ctx->priv;
-    fclose(fp);
+    struct fileSourceState *state = (struct fileSourceState *) ctx->priv;
+    fclose(state->fp);
+    free(state);
+    ctx->running = 0;
 }
 
 static void fileSource_halt(struct streamCtx *ctx)
 {
-    if(ctx->running == 0)
-        return;
-
-    FILE *fp = (FILE *) ctx->priv;
-    fclose(fp);
+    fileSource_stop(ctx);
 }
 
 #pragma GCC diagnostic ignored "-Wpedantic"
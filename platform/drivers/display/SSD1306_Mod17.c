@@ -40,18 +40,22 @@ static uint8_t __attribute__((section(".bss2"))) frameBuffer[FB_SIZE];
 
 /**
  * \internal
- * Send one row of pixels to the display.
- * Pixels in framebuffer are stored "by rows", while display needs data to be
- * sent "by columns": this function performs the needed conversion.
+ * Send one page of the display to the controller.
+ * The display is mounted rotated: each page covers eight framebuffer columns
+ * and each of its columns corresponds to a framebuffer row. Pixels in
+ * framebuffer are stored "by rows", while display needs data to be sent "by
+ * columns": this function performs the needed conversion.
  *
- * @param row: pixel row to be be sent.
+ * @param page: display page to be be sent.
+ * @param startRow: first framebuffer row to be sent.
+ * @param endRow: one past the last framebuffer row to be sent.
  */
-void display_renderRow(uint8_t row)
+void display_renderRow(uint8_t page, uint8_t startRow, uint8_t endRow)
 {
-    for(uint16_t i = 0; i < 64; i++)
+    for(uint16_t i = startRow; i < endRow; i++)
     {
         uint8_t out = 0;
-        uint8_t tmp = frameBuffer[(i * 16) + (15 - row)];
+        uint8_t tmp = frameBuffer[(i * 16) + (15 - page)];
 
         for(uint8_t j = 0; j < 8; j++)
         {
@@ -132,14 +136,18 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
 {
     gpio_clearPin(LCD_CS);
 
-    for(uint8_t row = startRow; row <= endRow; row++)
+    /*
+     * Framebuffer rows are mapped to display columns: update the requested
+     * column range of every page.
+     */
+    for(uint8_t page = 0; page < (SCREEN_WIDTH / 8); page++)
     {
-        gpio_clearPin(LCD_RS);            /* RS low -> command mode */
-        (void) spi2_sendRecv(0xB0 | row); /* Set Y position         */
-        (void) spi2_sendRecv(0x00);       /* Set X position         */
-        (void) spi2_sendRecv(0x10);
-        gpio_setPin(LCD_RS);              /* RS high -> data mode   */
-        display_renderRow(row);
+        gpio_clearPin(LCD_RS);             /* RS low -> command mode */
+        (void) spi2_sendRecv(0xB0 | page); /* Set Y position         */
+        (void) spi2_sendRecv(0x00 | (startRow & 0x0F)); /* Set X position */
+        (void) spi2_sendRecv(0x10 | (startRow >> 4));
+        gpio_setPin(LCD_RS);               /* RS high -> data mode   */
+        display_renderRow(page, startRow, endRow);
     }
 
     gpio_setPin(LCD_CS);
@@ -147,7 +155,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
 
 void display_render()
 {
-    display_renderRows(0, (SCREEN_WIDTH / 8) - 1);
+    display_renderRows(0, SCREEN_HEIGHT);
 }
 
 bool display_renderingInProgress()
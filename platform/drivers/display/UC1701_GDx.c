@@ -143,7 +143,14 @@ void display_terminate()
 
 void display_renderRows(uint8_t startRow, uint8_t endRow)
 {
-    for(uint8_t row = startRow; row < endRow; row++)
+    /*
+     * Controller memory is organised in pages of eight pixel rows: send all
+     * the pages overlapping the requested rows.
+     */
+    uint8_t startPage = startRow / 8;
+    uint8_t endPage   = (endRow + 7) / 8;
+
+    for(uint8_t row = startPage; row < endPage; row++)
     {
         gpio_clearPin(LCD_RS);            /* RS low -> command mode */
         sendByteToController(0xB0 | row); /* Set Y position         */
@@ -157,7 +164,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
 
 void display_render()
 {
-    display_renderRows(0, SCREEN_HEIGHT / 8);
+    display_renderRows(0, SCREEN_HEIGHT);
 }
 
 bool display_renderingInProgress()
@@ -35,6 +35,13 @@
 void *frameBuffer = NULL;    /* Pointer to framebuffer */
 bool inProgress;             /* Flag to signal when rendering is in progress */
 
+/*
+ * Emulated display memory: SDL texture content is not preserved between two
+ * updates, the pixels of the rows not being rendered are taken from here.
+ */
+static PIXEL_SIZE panel[SCREEN_WIDTH * SCREEN_HEIGHT];
+static size_t bytesPushed;   /* Framebuffer bytes sent to the display */
+
 /*
  * SDL main loop syncronization
  */
@@ -127,9 +134,35 @@ void display_terminate()
 
 void display_renderRows(uint8_t startRow, uint8_t endRow)
 {
-    (void) startRow;
-    (void) endRow;
     inProgress = true;
+    if(endRow > SCREEN_HEIGHT) endRow = SCREEN_HEIGHT;
+    if(startRow > endRow) startRow = endRow;
+
+    /*
+     * Update the emulated display memory and account for the amount of data a
+     * real display controller would have received.
+     */
+    #ifdef PIX_FMT_RGB565
+    size_t rowOffset = startRow * SCREEN_WIDTH;
+    size_t rowsSize  = (endRow - startRow) * SCREEN_WIDTH * sizeof(PIXEL_SIZE);
+    memcpy(&panel[rowOffset], ((PIXEL_SIZE *) frameBuffer) + rowOffset, rowsSize);
+    bytesPushed += rowsSize;
+    #else
+    for (unsigned int y = startRow; y < endRow; y++)
+    {
+        for (unsigned int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            panel[x + y * SCREEN_WIDTH] = fetchPixelFromFb(x, y);
+        }
+    }
+
+    #ifdef PIX_FMT_BW
+    bytesPushed += ((endRow - startRow) * SCREEN_WIDTH) / 8;
+    #else
+    bytesPushed += (endRow - startRow) * SCREEN_WIDTH;
+    #endif
+    #endif
+
     if(!sdl_ready)
     {
         sdl_ready = sdlEngine_ready();
@@ -140,18 +173,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
         // receive a texture pixel map
         void *fb;
         chan_recv(&fb_sync, &fb);
-        #ifdef PIX_FMT_RGB565
-        memcpy(fb, frameBuffer, sizeof(PIXEL_SIZE) * SCREEN_HEIGHT * SCREEN_WIDTH);
-        #else
-        uint32_t *pixels = (uint32_t *) fb;
-        for (unsigned int x = 0; x < SCREEN_WIDTH; x++)
-        {
-            for (unsigned int y = startRow; y < endRow; y++)
-            {
-                pixels[x + y * SCREEN_WIDTH] = fetchPixelFromFb(x, y);
-            }
-        }
-        #endif
+        memcpy(fb, panel, sizeof(panel));
         // signal the SDL main loop to proceed with rendering
         void *done = {0};
         chan_send(&fb_sync, done);
@@ -170,6 +192,11 @@ bool display_renderingInProgress()
     return inProgress;
 }
 
+size_t display_bytesPushed()
+{
+    return bytesPushed;
+}
+
 void *display_getFrameBuffer()
 {
     return (void *) (frameBuffer);
@@ -32,6 +32,11 @@ int cps_open(char *cps_name)
     return 0;
 }
 
+int cps_sync()
+{
+    return 0;
+}
+
 void cps_close()
 {
 
@@ -76,6 +81,22 @@ int cps_readBankData(uint16_t bank_pos, uint16_t pos)
     return -1;
 }
 
+int cps_prefetchContacts(uint16_t pos, uint16_t count)
+{
+    (void) pos;
+    (void) count;
+
+    return -1;
+}
+
+int cps_prefetchChannels(uint16_t pos, uint16_t count)
+{
+    (void) pos;
+    (void) count;
+
+    return -1;
+}
+
 int cps_writeContact(contact_t contact, uint16_t pos)
 {
     (void) contact;
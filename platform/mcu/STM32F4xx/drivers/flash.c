@@ -20,6 +20,8 @@
 
 #include <stm32f4xx.h>
 #include <stddef.h>
+#include <string.h>
+#include <errno.h>
 #include "flash.h"
 
 /**
@@ -91,3 +93,84 @@ void flash_write(const uint32_t address, const void *data, const size_t len)
         FLASH->CR &= ~FLASH_CR_PG;
     }
 }
+
+
+/*
+ * NVM device driver for the MCU flash memory. Only sectors from 5 to 11, all
+ * 128kB wide, can be erased through this interface.
+ */
+
+static const uint32_t SECTOR5_ADDR = 0x08020000;
+static const uint32_t SECTOR_SIZE  = 0x20000;
+
+static const struct nvmParams stm32Flash_params =
+{
+    .write_size   = 1,
+    .erase_size   = 0x20000,
+    .erase_cycles = 10000,
+    .type         = NVM_FLASH
+};
+
+static int nvm_api_read(const struct nvmDevice *dev, uint32_t offset,
+                        void *data, size_t len)
+{
+    (void) dev;
+
+    if((offset < FLASH_BASE) || ((offset + len) > (FLASH_END + 1)))
+        return -EINVAL;
+
+    memcpy(data, (const void *) offset, len);
+
+    return 0;
+}
+
+static int nvm_api_write(const struct nvmDevice *dev, uint32_t offset,
+                         const void *data, size_t len)
+{
+    (void) dev;
+
+    if((offset < FLASH_BASE) || ((offset + len) > (FLASH_END + 1)))
+        return -EINVAL;
+
+    flash_write(offset, data, len);
+
+    return 0;
+}
+
+static int nvm_api_erase(const struct nvmDevice *dev, uint32_t offset,
+                         size_t size)
+{
+    (void) dev;
+
+    if((offset < SECTOR5_ADDR) || ((offset + size) > (FLASH_END + 1)))
+        return -EINVAL;
+
+    if((((offset - SECTOR5_ADDR) % SECTOR_SIZE) != 0) ||
+       ((size % SECTOR_SIZE) != 0))
+        return -EINVAL;
+
+    for(uint32_t addr = offset; addr < (offset + size); addr += SECTOR_SIZE)
+    {
+        uint8_t sector = 5 + ((addr - SECTOR5_ADDR) / SECTOR_SIZE);
+        if(flash_eraseSector(sector) == false)
+            return -EIO;
+    }
+
+    return 0;
+}
+
+static const struct nvmParams *nvm_api_params(const struct nvmDevice *dev)
+{
+    (void) dev;
+
+    return &stm32Flash_params;
+}
+
+const struct nvmApi stm32Flash_api =
+{
+    .read   = nvm_api_read,
+    .write  = nvm_api_write,
+    .erase  = nvm_api_erase,
+    .sync   = NULL,
+    .params = nvm_api_params
+};
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <interfaces/nvmem.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,25 @@ bool flash_eraseSector(const uint8_t secNum);
  */
 void flash_write(const uint32_t address, const void *data, const size_t len);
 
+/**
+ * NVM device API for the 128kB sectors of the MCU flash memory. Addresses are
+ * the absolute ones of the MCU memory map.
+ */
+extern const struct nvmApi stm32Flash_api;
+
+/**
+ * Instantiate an NVM device for the MCU flash memory.
+ *
+ * @param name: device name.
+ */
+#define STM32_FLASH_DEVICE_DEFINE(name) \
+static const struct nvmDevice name =    \
+{                                       \
+    .config = NULL,                     \
+    .priv   = NULL,                     \
+    .api    = &stm32Flash_api           \
+};
+
 #ifdef __cplusplus
 }
 #endif
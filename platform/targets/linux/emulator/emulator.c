@@ -28,6 +28,7 @@
 #include <readline/readline.h>
 #include <readline/history.h>
 
+#include <threads.h>
 #include "emulator.h"
 #include "sdl_engine.h"
 
@@ -335,7 +336,8 @@ static int printState( void *_self, int _argc, char **_argv)
     printf("Mic    : %f\n",   emulator_state.micLevel);
     printf("Volume : %f\n",   emulator_state.volumeLevel);
     printf("Channel: %f\n",   emulator_state.chSelector);
-    printf("PTT    : %s\n\n", emulator_state.PTTstatus ? "true" : "false");
+    printf("PTT    : %s\n",   emulator_state.PTTstatus ? "true" : "false");
+    printf("Wakeups: %.1f/s\n\n", threads_getWakeupRate());
     return SH_CONTINUE;
 }
 
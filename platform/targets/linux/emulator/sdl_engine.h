@@ -20,6 +20,7 @@
 #include <interfaces/keyboard.h>
 #include <SDL2/SDL.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <chan.h>
 
 /*
@@ -66,4 +67,13 @@ bool sdlEngine_ready();
  */
 keyboard_t sdlEngine_getKeys();
 
+/**
+ * Get the total number of framebuffer bytes sent to the emulated display by
+ * display_renderRows() since startup, as a real display controller would have
+ * received them. Used to measure the cost of screen updates.
+ *
+ * @return number of bytes sent to the display.
+ */
+size_t display_bytesPushed();
+
 #endif /* SDL_ENGINE_H */
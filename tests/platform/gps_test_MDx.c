@@ -20,14 +20,13 @@
 
 #include <interfaces/platform.h>
 #include <interfaces/delays.h>
-#include <interfaces/gpio.h>
+#include <peripherals/gps.h>
+#include <gps_parser.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <hwconfig.h>
-#include <minmea.h>
-#include <interfaces/gps.h>
 
-char line[MINMEA_MAX_LENGTH*10];
+static gpsParser_t parser;
 
 int main()
 {
@@ -39,84 +38,44 @@ int main()
 
     gps_init(9600);
     gps_enable();
+    gpsParser_init(&parser, NULL, 0);
 
     while(1)
     {
-        int len = gps_getNmeaSentence(line, MINMEA_MAX_LENGTH*10);
-        if(len != -1)
-        {
-            printf("Got sentence with length %d:\r\n", len);
-            printf("%s\r\n", line);
-            switch (minmea_sentence_id(line, false)) {
-                case MINMEA_SENTENCE_RMC:
-                {
-                    struct minmea_sentence_rmc frame;
-                    if (minmea_parse_rmc(&frame, line)) {
-                        printf("$RMC: raw coordinates and speed: (%d/%d,%d/%d) %d/%d\n\r",
-                                frame.latitude.value, frame.latitude.scale,
-                                frame.longitude.value, frame.longitude.scale,
-                                frame.speed.value, frame.speed.scale);
-                        printf("$RMC fixed-point coordinates and speed scaled to three decimal places: (%d,%d) %d\n\r",
-                                minmea_rescale(&frame.latitude, 1000),
-                                minmea_rescale(&frame.longitude, 1000),
-                                minmea_rescale(&frame.speed, 1000));
-                        printf("$RMC floating point degree coordinates and speed: (%f,%f) %f\n\r",
-                                minmea_tocoord(&frame.latitude),
-                                minmea_tocoord(&frame.longitude),
-                                minmea_tofloat(&frame.speed));
-                    }
-                } break;
-
-                case MINMEA_SENTENCE_GGA:
-                {
-                    struct minmea_sentence_gga frame;
-                    if (minmea_parse_gga(&frame, line)) {
-                        printf("$GGA: fix quality: %d\n\r", frame.fix_quality);
-                    }
-                } break;
-
-                case MINMEA_SENTENCE_GSV:
-                {
-                    struct minmea_sentence_gsv frame;
-                    if (minmea_parse_gsv(&frame, line)) {
-                        printf("$GSV: message %d of %d\n\r", frame.msg_nr, frame.total_msgs);
-                        printf("$GSV: satellites in view: %d\n\r", frame.total_sats);
-                        for (int i = 0; i < 4; i++)
-                            printf("$GSV: sat nr %d, elevation: %d, azimuth: %d, snr: %d dbm\n\r",
-                                frame.sats[i].nr,
-                                frame.sats[i].elevation,
-                                frame.sats[i].azimuth,
-                                frame.sats[i].snr);
-                    }
-                } break;
-
-                case MINMEA_SENTENCE_VTG:
-                {
+        uint8_t data[32];
+        size_t  len;
+        gps_t   fix;
 
-                } break;
-
-                // Ignore this message as we take data from RMC
-                case MINMEA_SENTENCE_GLL:
-                    ;
-                break;
+        while((len = gps_readData(data, sizeof(data))) > 0)
+        {
+            // Echo raw data
+            printf("%.*s", (int) len, (char *) data);
 
-                // These messages are never sent by the Jumpstar JS-M710 Module
-                case MINMEA_SENTENCE_GSA: break;
-                case MINMEA_SENTENCE_GST: break;
-                case MINMEA_SENTENCE_ZDA: break;
+            if(gpsParser_feedBlock(&parser, data, len, &fix) == false)
+                continue;
 
-                // Error handling
-                case MINMEA_INVALID:
-                {
-                    printf("Error: Invalid NMEA sentence!\n\r");
-                } break;
+            printf("\r\nEpoch %lu: %02d:%02d:%02d, fix %d/%d, %d sats in view\r\n",
+                   (unsigned long) parser.numEpochs, fix.timestamp.hour,
+                   fix.timestamp.minute, fix.timestamp.second, fix.fix_quality,
+                   fix.fix_type, fix.satellites_in_view);
+            printf("Position: %f, %f, altitude %.1fm, speed %.1fkm/h\r\n",
+                   fix.latitude, fix.longitude, fix.altitude, fix.speed);
+            for(int i = 0; i < 12; i++)
+            {
+                if(fix.satellites[i].id == 0)
+                    continue;
 
-                case MINMEA_UNKNOWN:
-                {
-                    printf("Error: Unsupported NMEA sentence!\n\r");
-                } break;
+                printf("Sat %d: elevation %d, azimuth %d, snr %d\r\n",
+                       fix.satellites[i].id, fix.satellites[i].elevation,
+                       fix.satellites[i].azimuth, fix.satellites[i].snr);
             }
+
+            printf("Sentences: %lu, errors: %lu\r\n",
+                   (unsigned long) parser.numParsed,
+                   (unsigned long) parser.numErrors);
         }
+
+        sleepFor(0u, 100u);
     }
 
     return 0;
@@ -0,0 +1,312 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Decorrelator.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17Constants.hpp>
+#include <M17/M17Utils.hpp>
+#include <M17/M17Prbs.hpp>
+#include <M17/M17Bert.hpp>
+
+using namespace std;
+using namespace M17;
+
+static constexpr size_t NUM_FRAMES = 200;
+
+default_random_engine rng;
+
+/**
+ * Reference BERT frame encoding, step by step: 197 bits of PRBS9 and four
+ * flush bits are convolutionally encoded one by one, then punctured and
+ * truncated to 368 bits, interleaved and decorrelated.
+ */
+static frame_t ref_encodeBert(const bert_t& data)
+{
+    array< uint8_t, 51 > encoded = {0};
+    array< uint8_t, 46 > punctured;
+    array< uint8_t, 46 > interleaved;
+    uint8_t memory = 0;
+    frame_t frame;
+
+    for(size_t i = 0; i < 201; i++)
+    {
+        bool bit = (i < 197) ? getBit(data, i) : 0;
+        memory   = ((memory << 1) | bit) & 0x1F;
+        setBit(encoded, 2 * i,     __builtin_popcount(memory & 0x19) & 0x01);
+        setBit(encoded, 2 * i + 1, __builtin_popcount(memory & 0x17) & 0x01);
+    }
+
+    puncture(encoded, punctured, DATA_PUNCTURE);
+
+    for(size_t i = 0; i < 368; i++)
+        setBit(interleaved, ((45 * i) + (92 * i * i)) % 368, getBit(punctured, i));
+
+    decorrelate(interleaved);
+
+    auto it = copy(BERT_SYNC_WORD.begin(), BERT_SYNC_WORD.end(), frame.begin());
+    copy(interleaved.begin(), interleaved.end(), it);
+
+    return frame;
+}
+
+/**
+ * Convert a frame to soft-decision form, with maximum confidence on each bit.
+ */
+static sframe_t toSoft(const frame_t& frame)
+{
+    sframe_t soft;
+
+    for(size_t i = 0; i < soft.size(); i++)
+        soft[i] = getBit(frame, i) ? 0xFFFF : 0x0000;
+
+    return soft;
+}
+
+/**
+ * Check the generator output against the bare PRBS9 sequence.
+ */
+static bool checkGenerator()
+{
+    M17BertGenerator gen;
+    PRBS9 prbs;
+
+    for(size_t i = 0; i < 4; i++)
+    {
+        bert_t data;
+        gen.nextFrame(data);
+
+        for(size_t j = 0; j < M17_BERT_BITS; j++)
+        {
+            if(getBit(data, j) != prbs.generateBit())
+                return false;
+        }
+
+        // Padding bits
+        if((data.back() & 0x07) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Send BERT frames through the encoder and the decoder, measuring the bit
+ * error rate of the received stream. Channel errors, if any, are injected on
+ * the encoded frames and have to be corrected by the Viterbi decoder.
+ */
+static bool roundTrip(const bool soft, const size_t numErrors)
+{
+    M17FrameEncoder  encoder;
+    M17FrameDecoder  decoder;
+    M17BertGenerator gen;
+    M17BertReceiver  meter;
+
+    uniform_int_distribution< uint16_t > rndBit(16, 383);
+    decoder.reset();
+
+    for(size_t i = 0; i < NUM_FRAMES; i++)
+    {
+        bert_t  data;
+        frame_t frame;
+
+        gen.nextFrame(data);
+        encoder.encodeBertFrame(data, frame);
+
+        if(frame != ref_encodeBert(data))
+        {
+            printf("Error: BERT frame encoding mismatch\n");
+            return false;
+        }
+
+        for(size_t j = 0; j < numErrors; j++)
+        {
+            size_t pos = rndBit(rng);
+            setBit(frame, pos, !getBit(frame, pos));
+        }
+
+        M17FrameType type;
+        if(soft)
+            type = decoder.decodeFrame(toSoft(frame));
+        else
+            type = decoder.decodeFrame(frame);
+
+        if(type != M17FrameType::BERT)
+        {
+            printf("Error: BERT sync word not recognised\n");
+            return false;
+        }
+
+        if(decoder.getBertFrame() != data)
+        {
+            printf("Error: BERT frame %ld mismatch\n", i);
+            return false;
+        }
+
+        // Each channel error costs 0xFFFF, unless it hits the sync word, and
+        // each of the 34 punctured bits may leave one unit.
+        if(decoder.getViterbiCost() > (numErrors * 0xFFFF) + 34)
+        {
+            printf("Error: Viterbi cost %u, %ld channel errors\n",
+                   decoder.getViterbiCost(), numErrors);
+            return false;
+        }
+
+        meter.process(decoder.getBertFrame());
+    }
+
+    if((meter.synced() == false) || (meter.errors() != 0) ||
+       (meter.frames() != NUM_FRAMES) || (meter.lostFrames() != 0))
+    {
+        printf("Error: BERT receiver not in sync or with errors\n");
+        return false;
+    }
+
+    // Syncronisation takes less than one frame, all the other ones are checked
+    if(meter.bits() <= (NUM_FRAMES - 1) * M17_BERT_BITS)
+    {
+        printf("Error: %u bits checked\n", meter.bits());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Check the error counting and the detection of lost frames of the receiver.
+ */
+static bool checkReceiver()
+{
+    M17BertGenerator gen;
+    M17BertReceiver  meter;
+    bert_t data;
+
+    // Syncronise on a clean frame
+    gen.nextFrame(data);
+    if(meter.process(data) == false)
+        return false;
+
+    uint32_t bits = meter.bits();
+
+    // Ten frames with three errors each, in distinct positions
+    for(size_t i = 0; i < 10; i++)
+    {
+        gen.nextFrame(data);
+        for(size_t j = 0; j < 3; j++)
+        {
+            size_t pos = ((i * 17) + (j * 61)) % M17_BERT_BITS;
+            setBit(data, pos, !getBit(data, pos));
+        }
+
+        meter.process(data);
+    }
+
+    bits += 10 * M17_BERT_BITS;
+    if((meter.errors() != 30) || (meter.bits() != bits))
+    {
+        printf("Error: %u errors on %u bits, expected 30 on %u\n",
+               meter.errors(), meter.bits(), bits);
+        return false;
+    }
+
+    // Missed frames, with errors on the one following them
+    for(size_t i = 0; i < 5; i++)
+        gen.nextFrame(data);
+
+    gen.nextFrame(data);
+    setBit(data, 100, !getBit(data, 100));
+    meter.process(data);
+
+    if((meter.synced() == false) || (meter.lostFrames() != 5) ||
+       (meter.errors() != 31))
+    {
+        printf("Error: %u lost frames, expected 5\n", meter.lostFrames());
+        return false;
+    }
+
+    // Garbage: syncronisation is lost and recovered on the next frames
+    for(auto& b : data)
+        b = rng() & 0xFF;
+
+    meter.process(data);
+    if(meter.synced() == true)
+    {
+        printf("Error: BERT receiver in sync on random data\n");
+        return false;
+    }
+
+    bits = meter.bits();
+    gen.nextFrame(data);
+    meter.process(data);
+    gen.nextFrame(data);
+    meter.process(data);
+
+    if((meter.synced() == false) || (meter.errors() != 31) ||
+       (meter.lostFrames() != 5) || (meter.frames() != 15))
+    {
+        printf("Error: BERT receiver resyncronisation failed\n");
+        return false;
+    }
+
+    if(meter.ber() != (31.0f / static_cast< float >(meter.bits())))
+        return false;
+
+    meter.reset();
+    if((meter.bits() != 0) || (meter.ber() != 0.0f) || meter.synced())
+        return false;
+
+    return true;
+}
+
+int main()
+{
+    if(checkGenerator() == false)
+    {
+        printf("Error: BERT generator output mismatch\n");
+        return -1;
+    }
+
+    for(size_t soft = 0; soft < 2; soft++)
+    {
+        for(size_t errors = 0; errors < 2; errors++)
+        {
+            if(roundTrip(soft != 0, errors) == false)
+            {
+                printf("Error: %s round trip with %ld errors failed\n",
+                       soft ? "soft" : "hard", errors);
+                return -1;
+            }
+        }
+    }
+
+    if(checkReceiver() == false)
+    {
+        printf("Error: BERT receiver check failed\n");
+        return -1;
+    }
+
+    printf("BERT OK\n");
+    return 0;
+}
@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <emulator/emulator.h>
+#include <OpMode_M17.hpp>
+#include <rtx.h>
+
+using namespace std;
+
+static constexpr size_t NUM_FRAMES  = 50;
+static constexpr size_t MAX_UPDATES = 400;
+
+/**
+ * Convert the baseband written by the modulator, sampled at 48kHz, to the
+ * 24kHz one read by the demodulator. The signal is band limited by the RRC
+ * filter, thus decimation does not need further filtering.
+ */
+static bool loopback()
+{
+    FILE *in  = fopen("/tmp/m17_output.raw", "rb");
+    FILE *out = fopen("/tmp/baseband.raw", "wb");
+    if((in == NULL) || (out == NULL))
+        return false;
+
+    int16_t samples[2];
+    while(fread(samples, sizeof(int16_t), 2, in) == 2)
+        fwrite(&samples[0], sizeof(int16_t), 1, out);
+
+    fclose(in);
+    fclose(out);
+
+    return true;
+}
+
+/**
+ * End to end test of the M17 BERT mode: BERT frames are transmitted while the
+ * PTT is pressed, the resulting baseband is looped back to the receiver and
+ * the link quality statistics reported in the RTX status are checked.
+ */
+int main()
+{
+    // Receiver starts on a silent channel
+    remove("/tmp/m17_output.raw");
+    FILE *silence = fopen("/tmp/baseband.raw", "wb");
+    for(size_t i = 0; i < 4800; i++)
+        fputc(0, silence);
+    fclose(silence);
+
+    rtxStatus_t status;
+    memset(&status, 0x00, sizeof(rtxStatus_t));
+    strcpy(status.source_address, "N0CALL");
+    status.opMode   = OPMODE_M17;
+    status.opStatus = OFF;
+
+    // Transmit
+    OpMode_M17 m17;
+    m17.setBertMode(true);
+    m17.enable();
+
+    emulator_state.PTTstatus = true;
+
+    size_t txFrames = 0;
+    for(size_t i = 0; (i < MAX_UPDATES) && (txFrames < NUM_FRAMES); i++)
+    {
+        m17.update(&status, false);
+        if(status.opStatus == TX) txFrames++;
+    }
+
+    emulator_state.PTTstatus = false;
+
+    for(size_t i = 0; (i < MAX_UPDATES) && (status.opStatus == TX); i++)
+        m17.update(&status, false);
+
+    m17.disable();
+
+    if((txFrames != NUM_FRAMES) || (status.M17_bertEn == false))
+    {
+        printf("Error: BERT transmission failed\n");
+        return -1;
+    }
+
+    if(loopback() == false)
+    {
+        perror("Error in baseband loopback");
+        return -1;
+    }
+
+    // Receive
+    status.opStatus = OFF;
+    m17.enable();
+
+    // Stop at the end of the transmission, the baseband source restarts from
+    // the beginning of the file when its end is reached.
+    for(size_t i = 0; (i < MAX_UPDATES) && (status.M17_bertFrames < NUM_FRAMES); i++)
+        m17.update(&status, false);
+
+    m17.disable();
+
+    printf("%u frames, %u lost, %u bits, %u errors, BER %g, Viterbi cost %g\n",
+           status.M17_bertFrames, status.M17_bertLost, status.M17_bertBits,
+           status.M17_bertErrors, status.M17_bertBer, status.M17_viterbiCost);
+
+    // The first frame may be missed while the demodulator acquires the
+    // signal, all the other ones must be received without errors.
+    if((status.M17_bertSync == false) ||
+       (status.M17_bertFrames < NUM_FRAMES - 1) ||
+       (status.M17_bertBits < (NUM_FRAMES - 2) * M17::M17_BERT_BITS) ||
+       (status.M17_bertErrors != 0) || (status.M17_bertLost != 0) ||
+       (status.M17_bertBer != 0.0f))
+    {
+        printf("Error: BERT statistics mismatch\n");
+        return -1;
+    }
+
+    // Statistics are cleared when the BERT mode is enabled again
+    m17.setBertMode(false);
+    m17.update(&status, false);
+    m17.setBertMode(true);
+    m17.update(&status, false);
+    m17.disable();
+
+    if((status.M17_bertFrames != 0) || (status.M17_bertBits != 0))
+    {
+        printf("Error: BERT statistics not cleared\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,267 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <M17/M17Callsign.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17FrameEncoder.hpp>
+
+using namespace std;
+using namespace M17;
+
+/*
+ * Counting allocator: all the dynamic allocations made through operator new
+ * are counted, allowing to check that a code path does not use the heap.
+ */
+static size_t numAllocs = 0;
+
+void *operator new(size_t size)
+{
+    numAllocs++;
+    void *ptr = malloc(size);
+    if(ptr == nullptr)
+        throw bad_alloc();
+
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+// Compile-time encoding and decoding
+static_assert(Callsign("ALL").value() == 19681, "Wrong base-40 encoding");
+static_assert(Callsign(Callsign("IU2KWO-7").value()).size() == 8,
+              "Wrong base-40 decoding");
+static_assert(Callsign(CALLSIGN_BROADCAST).size() == 3,
+              "Wrong broadcast decoding");
+
+default_random_engine rng;
+
+/**
+ * Callsign decoding through std::string, as previously implemented.
+ */
+static string ref_decode(const call_t& encodedCall)
+{
+    static const char charMap[] = " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-/.";
+
+    uint64_t encoded = 0;
+    for(auto b : encodedCall)
+        encoded = (encoded << 8) | b;
+
+    if(encoded == 0xFFFFFFFFFFFF)
+        return "ALL";
+
+    string result;
+    while(encoded)
+    {
+        result.push_back(charMap[encoded % 40]);
+        encoded /= 40;
+    }
+
+    return result;
+}
+
+/**
+ * Callsign comparison on plain text, as previously implemented.
+ */
+static bool ref_compare(const string& localCs, const string& incomingCs)
+{
+    if(incomingCs == "ALL")
+        return true;
+
+    string truncatedLocal(localCs);
+    string truncatedIncoming(incomingCs);
+
+    int slashPos = localCs.find_first_of('/');
+    if(slashPos <= 2)
+        truncatedLocal = localCs.substr(slashPos + 1);
+
+    slashPos = incomingCs.find_first_of('/');
+    if(slashPos <= 2)
+        truncatedIncoming = incomingCs.substr(slashPos + 1);
+
+    return truncatedLocal == truncatedIncoming;
+}
+
+static string randomCallsign()
+{
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-/.";
+    uniform_int_distribution< size_t > rndLen(1, CALLSIGN_MAX_LEN);
+    uniform_int_distribution< size_t > rndChar(0, sizeof(chars) - 2);
+
+    string call;
+    size_t len = rndLen(rng);
+    for(size_t i = 0; i < len; i++)
+        call.push_back(chars[rndChar(rng)]);
+
+    return call;
+}
+
+/**
+ * Check encoding, decoding and comparison against the reference
+ * implementations.
+ */
+static bool checkCallsigns()
+{
+    for(size_t i = 0; i < 100000; i++)
+    {
+        string text = randomCallsign();
+        call_t encoded;
+
+        if(encode_callsign(Callsign(text.c_str()), encoded, true) == false)
+            return false;
+
+        Callsign decoded = decode_callsign(encoded);
+        if(string(decoded.c_str()) != ref_decode(encoded))
+        {
+            printf("Decoding mismatch for %s\n", text.c_str());
+            return false;
+        }
+
+        // Compare with itself, with a random callsign and with variations
+        // of the country prefix.
+        string others[] = { text, randomCallsign(), "EA/" + text.substr(0, 6),
+                            "I/" + text.substr(0, 7) };
+
+        for(auto& other : others)
+        {
+            bool ref = ref_compare(other, ref_decode(encoded));
+            if(compare_callsign(Callsign(other.c_str()), encoded) != ref)
+            {
+                printf("Comparison mismatch for %s, %s\n", other.c_str(),
+                       text.c_str());
+                return false;
+            }
+        }
+    }
+
+    call_t broadcast;
+    broadcast.fill(0xFF);
+    if(compare_callsign(Callsign("N0CALL"), broadcast) == false)
+        return false;
+
+    return true;
+}
+
+/**
+ * Run the LSF and callsign handling of the RX path on a sequence of frames,
+ * checking that no dynamic allocation takes place.
+ */
+static bool checkNoAlloc()
+{
+    M17FrameEncoder   encoder;
+    M17FrameDecoder   decoder;
+    M17LinkSetupFrame lsf;
+    frame_t           frame;
+    payload_t         payload;
+
+    lsf.clear();
+    lsf.setSource(Callsign("IU2KWO"));
+    lsf.setDestination(Callsign("EA/IU2KIN"));
+    encoder.encodeLsf(lsf, frame);
+    payload.fill(0xAA);
+
+    char     src[10];
+    char     dst[10];
+    char     local[10] = "IU2KIN";
+    size_t   matches   = 0;
+    uint16_t lastCrc   = 0;
+
+    numAllocs = 0;
+
+    decoder.reset();
+    decoder.decodeFrame(frame);
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        encoder.encodeStreamFrame(payload, frame);
+        decoder.decodeFrame(frame);
+
+        auto& rxLsf = decoder.getLsf();
+        if(rxLsf.valid() == false)
+            continue;
+
+        if(rxLsf.getCrc() != lastCrc)
+        {
+            lastCrc = rxLsf.getCrc();
+            rxLsf.getSource().copyTo(src, sizeof(src));
+            rxLsf.getDestination().copyTo(dst, sizeof(dst));
+        }
+
+        if(compare_callsign(Callsign(local), rxLsf.getEncodedDestination()))
+            matches++;
+    }
+
+    size_t allocs = numAllocs;
+    printf("%zu matching frames, %zu allocations\n", matches, allocs);
+
+    if((strcmp(src, "IU2KWO") != 0) || (strcmp(dst, "EA/IU2KIN") != 0))
+    {
+        printf("Wrong LSF callsigns: %s, %s\n", src, dst);
+        return false;
+    }
+
+    return (matches == 1000) && (allocs == 0);
+}
+
+int main()
+{
+    if(checkCallsigns() == false)
+    {
+        printf("Error: callsign handling mismatch\n");
+        return -1;
+    }
+
+    if(checkNoAlloc() == false)
+    {
+        printf("Error: allocations in the RX path\n");
+        return -1;
+    }
+
+    return 0;
+}
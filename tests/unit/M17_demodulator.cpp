@@ -91,25 +91,21 @@ int main()
     FILE *output_csv_1 = fopen("M17_demodulator_output_1.csv", "w");
     fprintf(output_csv_1, "Input,RRCSignal,LSFConvolution,FrameConvolution,Stddev\n");
     // Test convolution
-    m17Demodulator.resetCorrelationStats();
+    m17Demodulator.syncDetector.reset();
     for(unsigned i = 0; i < baseband_samples - m17Demodulator.M17_SYNCWORD_SYMBOLS * m17Demodulator.M17_SAMPLES_PER_SYMBOL; i++)
     {
-        int32_t lsf_conv =
-            m17Demodulator.convolution(i,
-                                       m17Demodulator.lsf_syncword,
-                                       m17Demodulator.M17_SYNCWORD_SYMBOLS);
-        int32_t stream_conv =
-            m17Demodulator.convolution(i,
-                                       m17Demodulator.stream_syncword,
-                                       m17Demodulator.M17_SYNCWORD_SYMBOLS);
-        m17Demodulator.updateCorrelationStats(stream_conv);
+        int32_t stream_conv = 0;
+        int32_t bert_conv   = 0;
+        m17Demodulator.syncDetector.correlate(baseband.data + i, stream_conv,
+                                              bert_conv);
+        // Update the detector statistics evaluating a single position
+        m17Demodulator.syncDetector.search(baseband.data, i, i + 1);
         fprintf(output_csv_1, "%" PRId16 ",%" PRId16 ",%d,%d,%f\n",
                 baseband_buffer[i],
                 baseband.data[i],
-                lsf_conv + (int32_t) m17Demodulator.getCorrelationEma(),
-                stream_conv - (int32_t) m17Demodulator.getCorrelationEma(),
-                m17Demodulator.conv_threshold_factor *
-                m17Demodulator.getCorrelationStddev());
+                -stream_conv,
+                stream_conv,
+                m17Demodulator.syncDetector.getThreshold());
     }
     fclose(output_csv_1);
 
@@ -117,8 +113,8 @@ int main()
     printf("Testing syncword detection!\n");
     FILE *syncword_ref = fopen("../tests/unit/assets/M17_test_baseband_dc_syncwords.txt", "r");
     int32_t offset = 0;
-    M17::sync_t syncword = { -1, false };
-    m17Demodulator.resetCorrelationStats();
+    M17::sync_t syncword = { -1, M17::SyncType::NONE };
+    m17Demodulator.syncDetector.reset();
     int i = 0;
     do
     {
@@ -144,13 +140,13 @@ int main()
     fprintf(output_csv_2, "RRCSignal,SyncDetect,QntMax,QntMin,Symbol\n");
     uint32_t detect = 0, symbol = 0;
     offset = 0;
-    syncword = { -1, false };
-    m17Demodulator.resetCorrelationStats();
+    syncword = { -1, M17::SyncType::NONE };
+    m17Demodulator.syncDetector.reset();
     syncword = m17Demodulator.nextFrameSync(offset);
     for(unsigned i = 0; i < baseband_samples - m17Demodulator.M17_SYNCWORD_SYMBOLS * m17Demodulator.M17_SAMPLES_PER_SYMBOL; i++)
     {
         if ((int) i == (syncword.index + 1)) {
-            if (syncword.lsf)
+            if (syncword.type == M17::SyncType::LSF)
                 detect = -4000;
             else
                 detect = 4000;
@@ -178,7 +174,7 @@ int main()
     // Skip preamble
     fseek(symbols_ref, 0x30, SEEK_SET);
     uint32_t failed_bytes = 0, total_bytes = 0;
-    syncword = { -1, false };
+    syncword = { -1, M17::SyncType::NONE };
     offset = 0;
     syncword = m17Demodulator.nextFrameSync(offset);
     std::array< uint8_t, m17Demodulator.M17_FRAME_BYTES > frame;
@@ -0,0 +1,206 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+// Test private methods
+#define private public
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Decorrelator.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17Constants.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace std;
+using namespace M17;
+
+default_random_engine rng;
+uniform_int_distribution< uint16_t > rndByte(0, 255);
+
+/**
+ * Bit-serial convolutional encoder, as previously implemented.
+ */
+template < size_t N >
+void ref_convolve(const uint8_t *data, array< uint8_t, N >& encoded,
+                  const size_t offset, const size_t len)
+{
+    uint8_t memory = 0;
+
+    for(size_t i = 0; i <= len; i++)
+    {
+        // Flush the encoder after the last byte
+        uint8_t  value  = (i < len) ? data[i] : 0x00;
+        uint16_t result = 0;
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            memory  = ((memory << 1) | ((value & 0x80) >> 7)) & 0x1F;
+            result  = (result << 1) | (__builtin_popcount(memory & 0x19) & 0x01);
+            result  = (result << 1) | (__builtin_popcount(memory & 0x17) & 0x01);
+            value <<= 1;
+        }
+
+        encoded[offset + 2 * i] = result >> 8;
+        if(i < len)
+            encoded[offset + 2 * i + 1] = result & 0xFF;
+    }
+}
+
+/**
+ * Interleaver evaluating the permutation polynomial, as previously
+ * implemented.
+ */
+static void ref_interleave(array< uint8_t, 46 >& data)
+{
+    array< uint8_t, 46 > interleaved;
+
+    for(size_t i = 0; i < 368; i++)
+        setBit(interleaved, ((45 * i) + (92 * i * i)) % 368, getBit(data, i));
+
+    data = interleaved;
+}
+
+/**
+ * Reference LSF encoding, step by step.
+ */
+static frame_t ref_encodeLsf(M17LinkSetupFrame& lsf)
+{
+    array< uint8_t, 61 > encoded;
+    array< uint8_t, 46 > punctured;
+    frame_t frame;
+
+    ref_convolve(lsf.getData(), encoded, 0, sizeof(M17LinkSetupFrame));
+    puncture(encoded, punctured, LSF_PUNCTURE);
+    ref_interleave(punctured);
+    decorrelate(punctured);
+
+    auto it = copy(LSF_SYNC_WORD.begin(), LSF_SYNC_WORD.end(), frame.begin());
+    copy(punctured.begin(), punctured.end(), it);
+
+    return frame;
+}
+
+/**
+ * Reference stream frame encoding, step by step.
+ */
+static frame_t ref_encodeStream(const lich_t& lich, M17StreamFrame& sf)
+{
+    array< uint8_t, 37 > encoded;
+    array< uint8_t, 34 > punctured;
+    array< uint8_t, 46 > payload;
+    frame_t frame;
+
+    ref_convolve(sf.getData(), encoded, 0, sizeof(M17StreamFrame));
+    puncture(encoded, punctured, DATA_PUNCTURE);
+
+    auto it = copy(lich.begin(), lich.end(), payload.begin());
+    copy(punctured.begin(), punctured.end(), it);
+    ref_interleave(payload);
+    decorrelate(payload);
+
+    auto oIt = copy(STREAM_SYNC_WORD.begin(), STREAM_SYNC_WORD.end(), frame.begin());
+    copy(payload.begin(), payload.end(), oIt);
+
+    return frame;
+}
+
+/**
+ * Check the table driven convolutional encoder against the bit-serial one.
+ */
+static bool checkConvolution()
+{
+    M17ConvolutionalEncoder encoder;
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        array< uint8_t, 30 > data;
+        array< uint8_t, 61 > encoded;
+        array< uint8_t, 61 > expected;
+
+        for(auto& b : data)
+            b = rndByte(rng);
+
+        encoder.reset();
+        encoder.encode(data.data(), encoded.data(), data.size());
+        encoded[60] = encoder.flush();
+        ref_convolve(data.data(), expected, 0, data.size());
+
+        if(encoded != expected)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if(checkConvolution() == false)
+    {
+        printf("Error: convolutional encoder output mismatch\n");
+        return -1;
+    }
+
+    M17FrameEncoder encoder;
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        // Random LSF content, CRC gets updated by the encoder
+        M17LinkSetupFrame lsf;
+        uint8_t *lsfData = reinterpret_cast< uint8_t * >(&lsf.data);
+        for(size_t j = 0; j < sizeof(lsf.data); j++)
+            lsfData[j] = rndByte(rng);
+
+        frame_t frame;
+        encoder.reset();
+        encoder.encodeLsf(lsf, frame);
+
+        if(frame != ref_encodeLsf(lsf))
+        {
+            printf("Error: LSF encoding mismatch\n");
+            return -1;
+        }
+
+        // A full superframe of stream frames with random payload
+        for(uint16_t fn = 0; fn < 12; fn++)
+        {
+            payload_t payload;
+            for(auto& b : payload)
+                b = rndByte(rng);
+
+            bool isLast = (fn == 11);
+            encoder.encodeStreamFrame(payload, frame, isLast);
+
+            M17StreamFrame sf;
+            sf.setFrameNumber(fn);
+            if(isLast) sf.lastFrame();
+            copy(payload.begin(), payload.end(), sf.payload().begin());
+
+            if(frame != ref_encodeStream(lsf.generateLichSegment(fn % 6), sf))
+            {
+                printf("Error: stream frame encoding mismatch\n");
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include "M17/M17Interleaver.hpp"
+
+using namespace std;
+using namespace M17;
+
+default_random_engine rng;
+
+/**
+ * Bit-serial interleaver evaluating the permutation polynomial, as previously
+ * implemented, used as reference.
+ */
+template < size_t N >
+void ref_interleave(array< uint8_t, N >& data)
+{
+    array< uint8_t, N > interleaved;
+
+    for(size_t i = 0; i < N * 8; i++)
+        setBit(interleaved, ((45 * i) + (92 * i * i)) % (N * 8), getBit(data, i));
+
+    data = interleaved;
+}
+
+template < size_t N >
+array< uint8_t, N > randomBlock()
+{
+    uniform_int_distribution< uint16_t > rndByte(0, 255);
+    array< uint8_t, N > block;
+
+    for(auto& b : block)
+        b = rndByte(rng);
+
+    return block;
+}
+
+/**
+ * Check that the tables are inverse permutations of each other and that they
+ * match the permutation polynomial.
+ */
+template < size_t NB >
+bool checkTables()
+{
+    const auto& il = QppTables< NB >::interleave.idx;
+    const auto& dl = QppTables< NB >::deinterleave.idx;
+
+    for(size_t i = 0; i < NB; i++)
+    {
+        if((il[dl[i]] != i) || (dl[il[i]] != i))
+            return false;
+
+        if(dl[i] != (((45 * i) + (92 * i * i)) % NB))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Check interleaving of hard bits against the reference implementation and
+ * that interleaving and deinterleaving are one the inverse of the other.
+ */
+template < size_t N >
+bool checkHard(const size_t iterations)
+{
+    for(size_t i = 0; i < iterations; i++)
+    {
+        auto data = randomBlock< N >();
+        auto ref  = data;
+        auto tmp  = data;
+
+        interleave(tmp);
+        ref_interleave(ref);
+        if(tmp != ref)
+        {
+            printf("Interleaved block differs from reference\n");
+            return false;
+        }
+
+        deinterleave(tmp);
+        if(tmp != data)
+        {
+            printf("deinterleave(interleave(x)) != x\n");
+            return false;
+        }
+
+        deinterleave(tmp);
+        interleave(tmp);
+        if(tmp != data)
+        {
+            printf("interleave(deinterleave(x)) != x\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Check that soft bit deinterleaving moves the soft values as the hard bit
+ * one does with bits.
+ */
+template < size_t N >
+bool checkSoft(const size_t iterations)
+{
+    uniform_int_distribution< uint16_t > rndSoft(0, 0x7FFF);
+
+    for(size_t i = 0; i < iterations; i++)
+    {
+        auto data = randomBlock< N >();
+        auto interleaved = data;
+        interleave(interleaved);
+
+        // Soft values carry the bit in the MSB and random confidence bits, so
+        // that a mismatch in the permutation is detected also on equal bits.
+        array< uint16_t, N * 8 > soft;
+        array< uint16_t, N * 8 > expected;
+        for(size_t j = 0; j < N * 8; j++)
+        {
+            uint16_t value = rndSoft(rng) | (getBit(interleaved, j) ? 0x8000 : 0);
+            soft[j] = value;
+        }
+
+        for(size_t j = 0; j < N * 8; j++)
+            expected[j] = soft[((45 * j) + (92 * j * j)) % (N * 8)];
+
+        deinterleave(soft);
+        if(soft != expected)
+        {
+            printf("Soft deinterleaving differs from reference\n");
+            return false;
+        }
+
+        for(size_t j = 0; j < N * 8; j++)
+        {
+            if((soft[j] > 0x7FFF) != getBit(data, j))
+            {
+                printf("Soft and hard deinterleaving mismatch\n");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    if(checkTables< 368 >() == false)
+    {
+        printf("Error: inconsistent permutation tables\n");
+        return -1;
+    }
+
+    if(checkHard< 46 >(10000) == false)
+        return -1;
+
+    if(checkSoft< 46 >(10000) == false)
+        return -1;
+
+    return 0;
+}
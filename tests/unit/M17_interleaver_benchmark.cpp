@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include "M17/M17Interleaver.hpp"
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace M17;
+
+static constexpr size_t NUM_ITER = 100000;
+
+/**
+ * Bit-serial interleaver evaluating the permutation polynomial for each bit,
+ * as previously implemented.
+ */
+template < size_t N >
+void ref_interleave(array< uint8_t, N >& data)
+{
+    array< uint8_t, N > interleaved;
+
+    for(size_t i = 0; i < N * 8; i++)
+        setBit(interleaved, ((45 * i) + (92 * i * i)) % (N * 8), getBit(data, i));
+
+    data = interleaved;
+}
+
+template < size_t N >
+void ref_deinterleave(array< uint8_t, N >& data)
+{
+    array< uint8_t, N > deinterleaved;
+
+    for(size_t i = 0; i < N * 8; i++)
+        setBit(deinterleaved, i, getBit(data, ((45 * i) + (92 * i * i)) % (N * 8)));
+
+    data = deinterleaved;
+}
+
+template < size_t N >
+void ref_deinterleave(array< uint16_t, N >& data)
+{
+    array< uint16_t, N > deinterleaved;
+
+    for(size_t i = 0; i < N; i++)
+        deinterleaved[i] = data[((45 * i) + (92 * i * i)) % N];
+
+    data = deinterleaved;
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< uint16_t > rndValue(0, 0xFFFF);
+
+    array< uint8_t, 46 >   frame;
+    array< uint16_t, 368 > soft;
+
+    for(auto& b : frame)
+        b = rndValue(rng) & 0xFF;
+
+    for(auto& s : soft)
+        s = rndValue(rng);
+
+    // Functions work in place, chaining the iterations prevents the compiler
+    // from optimising away the calls.
+    double ilRef   = measure([&]() { ref_interleave(frame);   }, NUM_ITER);
+    double ilTab   = measure([&]() { interleave(frame);       }, NUM_ITER);
+    double dlRef   = measure([&]() { ref_deinterleave(frame); }, NUM_ITER);
+    double dlTab   = measure([&]() { deinterleave(frame);     }, NUM_ITER);
+    double softRef = measure([&]() { ref_deinterleave(soft);  }, NUM_ITER);
+    double softTab = measure([&]() { deinterleave(soft);      }, NUM_ITER);
+
+    volatile uint16_t sink = frame[0] + soft[0];
+    (void) sink;
+
+    #if defined(__x86_64__) || defined(__i386__)
+    printf("Interleaver cost, cycles per frame\n");
+    #else
+    printf("Interleaver cost, nanoseconds per frame\n");
+    #endif
+
+    printf("Interleave, hard:   reference %8.1f, table %8.1f\n", ilRef, ilTab);
+    printf("Deinterleave, hard: reference %8.1f, table %8.1f\n", dlRef, dlTab);
+    printf("Deinterleave, soft: reference %8.1f, table %8.1f\n", softRef, softTab);
+
+    return 0;
+}
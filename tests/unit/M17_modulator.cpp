@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+// Access modulator constants
+#define private public
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <array>
+#include <M17/M17Modulator.hpp>
+#include <M17/M17Utils.hpp>
+#include <M17/M17DSP.hpp>
+
+using namespace std;
+
+static constexpr size_t NUM_FRAMES = 20;
+
+default_random_engine rng;
+
+/**
+ * Check that the baseband generated by the modulator matches the one obtained
+ * by zero-stuffing the symbol stream and filtering it with the 81-tap RRC
+ * filter. On Linux the modulator writes the baseband to /tmp/m17_output.raw.
+ */
+int main()
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+    vector< M17::frame_t > frames(NUM_FRAMES);
+
+    remove("/tmp/m17_output.raw");
+
+    M17::M17Modulator modulator;
+    modulator.init();
+    modulator.invertPhase(false);
+    modulator.start();
+
+    for(auto& frame : frames)
+    {
+        for(auto& byte : frame)
+        {
+            byte = rndValue(rng);
+        }
+
+        modulator.send(frame);
+    }
+
+    // Reconstruct the transmitted symbol stream: two frames of preamble
+    // followed by the data frames.
+    vector< int8_t > symbols;
+    for(size_t i = 0; i < 2 * M17::M17_FRAME_SYMBOLS; i += 2)
+    {
+        symbols.push_back(+3);
+        symbols.push_back(-3);
+    }
+
+    for(auto& frame : frames)
+    {
+        for(auto& byte : frame)
+        {
+            auto sym = M17::byteToSymbols(byte);
+            symbols.insert(symbols.end(), sym.begin(), sym.end());
+        }
+    }
+
+    FILE *baseband = fopen("/tmp/m17_output.raw", "rb");
+    if(baseband == NULL)
+    {
+        perror("Error in opening modulator output");
+        return -1;
+    }
+
+    Fir< std::tuple_size< decltype(M17::rrc_taps_48k) >::value > rrc(M17::rrc_taps_48k);
+    const size_t samplesPerSymbol = modulator.M17_SAMPLES_PER_SYMBOL;
+    size_t numSamples = 0;
+
+    for(size_t i = 0; i < symbols.size() * samplesPerSymbol; i++)
+    {
+        int16_t sample;
+        if(fread(&sample, sizeof(sample), 1, baseband) != 1)
+        {
+            printf("Modulator output too short: %ld samples\n", i);
+            return -1;
+        }
+
+        float elem = 0.0f;
+        if((i % samplesPerSymbol) == 0)
+            elem = static_cast< float >(symbols[i / samplesPerSymbol]);
+
+        elem = rrc(elem * modulator.M17_RRC_GAIN) - modulator.M17_RRC_OFFSET;
+        int16_t expected = static_cast< int16_t >(elem);
+
+        if(abs(expected - sample) > 1)
+        {
+            printf("Mismatch at sample %ld: got %d, expected %d\n", i, sample,
+                   expected);
+            return -1;
+        }
+
+        numSamples++;
+    }
+
+    fclose(baseband);
+    printf("%ld samples OK\n", numSamples);
+
+    return 0;
+}
@@ -0,0 +1,301 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Decorrelator.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17PacketQueue.hpp>
+#include <M17/M17Packet.hpp>
+#include <M17/M17Constants.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace std;
+using namespace M17;
+
+default_random_engine rng;
+uniform_int_distribution< uint16_t > rndByte(0, 255);
+
+/**
+ * Reference packet frame encoding, step by step: 206 bits of frame data and
+ * four flush bits are convolutionally encoded one by one, then punctured,
+ * interleaved and decorrelated.
+ */
+static frame_t ref_encodePacket(const M17PacketFrame& pf)
+{
+    array< uint8_t, 53 > encoded = {0};
+    array< uint8_t, 46 > punctured;
+    array< uint8_t, 46 > interleaved;
+    array< uint8_t, 26 > data;
+    uint8_t memory = 0;
+    frame_t frame;
+
+    memcpy(data.data(), pf.getData(), data.size());
+
+    for(size_t i = 0; i < 210; i++)
+    {
+        bool bit = (i < 206) ? getBit(data, i) : 0;
+        memory   = ((memory << 1) | bit) & 0x1F;
+        setBit(encoded, 2 * i,     __builtin_popcount(memory & 0x19) & 0x01);
+        setBit(encoded, 2 * i + 1, __builtin_popcount(memory & 0x17) & 0x01);
+    }
+
+    puncture(encoded, punctured, PACKET_PUNCTURE);
+
+    for(size_t i = 0; i < 368; i++)
+        setBit(interleaved, ((45 * i) + (92 * i * i)) % 368, getBit(punctured, i));
+
+    decorrelate(interleaved);
+
+    auto it = copy(PACKET_SYNC_WORD.begin(), PACKET_SYNC_WORD.end(), frame.begin());
+    copy(interleaved.begin(), interleaved.end(), it);
+
+    return frame;
+}
+
+/**
+ * Convert a frame to soft-decision form, with maximum confidence on each bit.
+ */
+static sframe_t toSoft(const frame_t& frame)
+{
+    sframe_t soft;
+
+    for(size_t i = 0; i < soft.size(); i++)
+        soft[i] = getBit(frame, i) ? 0xFFFF : 0x0000;
+
+    return soft;
+}
+
+/**
+ * Send a packet through the encoder and the decoder, reassembling it.
+ */
+static bool roundTrip(const vector< uint8_t >& data, const bool soft,
+                      const size_t numErrors)
+{
+    M17FrameEncoder encoder;
+    M17FrameDecoder decoder;
+    M17Packet txPacket;
+    M17Packet rxPacket;
+
+    if(txPacket.set(data.data(), data.size()) == false)
+        return false;
+
+    uniform_int_distribution< uint16_t > rndBit(16, 383);
+    PacketStatus status = PacketStatus::ERROR;
+    decoder.reset();
+
+    for(size_t i = 0; i < txPacket.numFrames(); i++)
+    {
+        M17PacketFrame pf;
+        frame_t frame;
+
+        txPacket.getFrame(i, pf);
+        encoder.encodePacketFrame(pf, frame);
+
+        if(frame != ref_encodePacket(pf))
+        {
+            printf("Error: packet frame encoding mismatch\n");
+            return false;
+        }
+
+        for(size_t j = 0; j < numErrors; j++)
+        {
+            size_t pos = rndBit(rng);
+            setBit(frame, pos, !getBit(frame, pos));
+        }
+
+        M17FrameType type;
+        if(soft)
+            type = decoder.decodeFrame(toSoft(frame));
+        else
+            type = decoder.decodeFrame(frame);
+
+        if(type != M17FrameType::PACKET)
+        {
+            printf("Error: packet sync word not recognised\n");
+            return false;
+        }
+
+        auto& decoded = decoder.getPacketFrame();
+        if(memcmp(decoded.getData(), pf.getData(), sizeof(M17PacketFrame)) != 0)
+        {
+            printf("Error: packet frame %ld decoding mismatch\n", i);
+            return false;
+        }
+
+        status = rxPacket.append(decoded);
+        bool last = (i == txPacket.numFrames() - 1);
+        if((last && (status != PacketStatus::COMPLETE)) ||
+           (!last && (status != PacketStatus::INCOMPLETE)))
+        {
+            printf("Error: packet reassembly failed at frame %ld\n", i);
+            return false;
+        }
+    }
+
+    if((rxPacket.size() != data.size()) ||
+       (memcmp(rxPacket.data(), data.data(), data.size()) != 0))
+    {
+        printf("Error: reassembled packet mismatch\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Check the handling of frames out of sequence and of corrupted packets.
+ */
+static bool checkReassembly()
+{
+    vector< uint8_t > data(100);
+    for(auto& b : data)
+        b = rndByte(rng);
+
+    M17Packet txPacket;
+    M17Packet rxPacket;
+    M17PacketFrame pf;
+
+    txPacket.set(data.data(), data.size());
+
+    // Missing frame
+    txPacket.getFrame(0, pf);
+    rxPacket.append(pf);
+    txPacket.getFrame(2, pf);
+    if(rxPacket.append(pf) != PacketStatus::ERROR)
+        return false;
+
+    // Corrupted data, restarting from the first frame
+    for(size_t i = 0; i < txPacket.numFrames(); i++)
+    {
+        txPacket.getFrame(i, pf);
+        if(i == 1) pf.payload()[3] ^= 0x10;
+        auto status = rxPacket.append(pf);
+        if((i == txPacket.numFrames() - 1) && (status != PacketStatus::ERROR))
+            return false;
+    }
+
+    // Packets too long or empty
+    vector< uint8_t > big(M17_PACKET_MAX_SIZE + 1);
+    if(txPacket.set(big.data(), big.size()) || txPacket.set(data.data(), 0))
+        return false;
+
+    // Largest packet: 33 frames, the last one full
+    if(txPacket.set(big.data(), M17_PACKET_MAX_SIZE) == false)
+        return false;
+
+    txPacket.getFrame(M17_PACKET_MAX_FRAMES - 1, pf);
+    if((txPacket.numFrames() != M17_PACKET_MAX_FRAMES) ||
+       (pf.isLastFrame() == false) || (pf.getFrameNumber() != 25))
+        return false;
+
+    return true;
+}
+
+/**
+ * Check packet queue ordering, wrap around and overflow.
+ */
+static bool checkQueue()
+{
+    M17PacketQueue<> queue;
+    uniform_int_distribution< uint16_t > rndLen(1, M17_PACKET_MAX_SIZE);
+    vector< vector< uint8_t > > pending;
+    uint8_t buf[M17_PACKET_MAX_SIZE];
+    size_t  queued = 0;
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        vector< uint8_t > pkt(rndLen(rng));
+        for(auto& b : pkt)
+            b = rndByte(rng);
+
+        // Push until the queue is full, then check a failed push left the
+        // content untouched
+        bool fits = (queued + pkt.size() + 2) <= M17_PACKET_QUEUE_SIZE;
+        if(queue.push(pkt.data(), pkt.size()) != fits)
+            return false;
+
+        if(fits)
+        {
+            queued += pkt.size() + 2;
+            pending.push_back(pkt);
+            continue;
+        }
+
+        size_t len = queue.pop(buf, sizeof(buf));
+        if((len != pending.front().size()) ||
+           (memcmp(buf, pending.front().data(), len) != 0))
+            return false;
+
+        queued -= len + 2;
+        pending.erase(pending.begin());
+    }
+
+    // Packet larger than the destination buffer gets discarded
+    while(queue.empty() == false)
+        queue.pop(buf, sizeof(buf));
+
+    queue.push(buf, 10);
+    queue.push(buf, 5);
+    if((queue.pop(buf, 8) != 0) || (queue.pop(buf, 8) != 5) || !queue.empty())
+        return false;
+
+    return (queue.push(buf, 0) == false) &&
+           (queue.push(buf, M17_PACKET_MAX_SIZE + 1) == false);
+}
+
+int main()
+{
+    static constexpr size_t sizes[] = {1, 23, 24, 25, 26, 48, 100, 799,
+                                       M17_PACKET_MAX_SIZE};
+
+    for(size_t i = 0; i < 50; i++)
+    {
+        for(auto size : sizes)
+        {
+            vector< uint8_t > data(size);
+            for(auto& b : data)
+                b = rndByte(rng);
+
+            if(roundTrip(data, false, 0) == false) return -1;
+            if(roundTrip(data, true,  0) == false) return -1;
+            if(roundTrip(data, false, 1) == false) return -1;
+        }
+    }
+
+    if(checkReassembly() == false)
+    {
+        printf("Error: packet reassembly\n");
+        return -1;
+    }
+
+    if(checkQueue() == false)
+    {
+        printf("Error: packet queue\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <OpMode_M17.hpp>
+#include <rtx.h>
+
+using namespace std;
+
+static constexpr size_t NUM_PACKETS = 3;
+static constexpr size_t MAX_UPDATES = 400;
+
+default_random_engine rng;
+
+/**
+ * Convert the baseband written by the modulator, sampled at 48kHz, to the
+ * 24kHz one read by the demodulator. The signal is band limited by the RRC
+ * filter, thus decimation does not need further filtering.
+ */
+static bool loopback()
+{
+    FILE *in  = fopen("/tmp/m17_output.raw", "rb");
+    FILE *out = fopen("/tmp/baseband.raw", "wb");
+    if((in == NULL) || (out == NULL))
+        return false;
+
+    int16_t samples[2];
+    while(fread(samples, sizeof(int16_t), 2, in) == 2)
+        fwrite(&samples[0], sizeof(int16_t), 1, out);
+
+    fclose(in);
+    fclose(out);
+
+    return true;
+}
+
+/**
+ * End to end test of the M17 packet data path: the packets queued to the M17
+ * operating mode are transmitted, the resulting baseband is looped back to the
+ * receiver and the packets received are compared with the original ones.
+ */
+int main()
+{
+    uniform_int_distribution< uint16_t > rndByte(0, 255);
+    uniform_int_distribution< uint16_t > rndLen(1, 200);
+    vector< vector< uint8_t > > packets(NUM_PACKETS);
+
+    for(auto& packet : packets)
+    {
+        packet.resize(rndLen(rng));
+        for(auto& b : packet)
+            b = rndByte(rng);
+    }
+
+    // Receiver starts on a silent channel
+    remove("/tmp/m17_output.raw");
+    FILE *silence = fopen("/tmp/baseband.raw", "wb");
+    for(size_t i = 0; i < 4800; i++)
+        fputc(0, silence);
+    fclose(silence);
+
+    rtxStatus_t status;
+    memset(&status, 0x00, sizeof(rtxStatus_t));
+    strcpy(status.source_address, "N0CALL");
+    status.opMode   = OPMODE_M17;
+    status.opStatus = OFF;
+
+    // Transmit
+    OpMode_M17 m17;
+    m17.enable();
+
+    for(auto& packet : packets)
+    {
+        if(m17.queuePacket(packet.data(), packet.size()) == false)
+        {
+            printf("Error: packet queue full\n");
+            return -1;
+        }
+    }
+
+    size_t txCount = 0;
+    bool   wasTx   = false;
+    for(size_t i = 0; (i < MAX_UPDATES) && (txCount < NUM_PACKETS); i++)
+    {
+        m17.update(&status, false);
+
+        bool isTx = (status.opStatus == TX);
+        if(wasTx && (isTx == false)) txCount++;
+        wasTx = isTx;
+    }
+
+    m17.disable();
+
+    if(txCount != NUM_PACKETS)
+    {
+        printf("Error: %ld packets transmitted, expected %ld\n", txCount,
+               NUM_PACKETS);
+        return -1;
+    }
+
+    if(loopback() == false)
+    {
+        perror("Error in baseband loopback");
+        return -1;
+    }
+
+    // Receive
+    status.opStatus = OFF;
+    m17.enable();
+
+    size_t rxCount = 0;
+    for(size_t i = 0; (i < MAX_UPDATES) && (rxCount < NUM_PACKETS); i++)
+    {
+        m17.update(&status, false);
+
+        uint8_t data[M17::M17_PACKET_MAX_SIZE];
+        size_t  len = m17.popPacket(data, sizeof(data));
+        if(len == 0)
+            continue;
+
+        auto& expected = packets[rxCount];
+        if((len != expected.size()) ||
+           (memcmp(data, expected.data(), len) != 0))
+        {
+            printf("Error: packet %ld mismatch\n", rxCount);
+            return -1;
+        }
+
+        rxCount++;
+    }
+
+    m17.disable();
+
+    if(rxCount != NUM_PACKETS)
+    {
+        printf("Error: %ld packets received, expected %ld\n", rxCount,
+               NUM_PACKETS);
+        return -1;
+    }
+
+    printf("%ld packets OK\n", rxCount);
+    return 0;
+}
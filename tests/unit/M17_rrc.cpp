@@ -47,11 +47,12 @@ int main()
     impulse[0] = SHRT_MAX;
 
     // Apply RRC on impulse signal
+    Fir< std::tuple_size< decltype(M17::rrc_taps_48k) >::value > rrc_48k(M17::rrc_taps_48k);
     int16_t filtered_impulse[IMPULSE_SIZE] = { 0 };
     for(size_t i = 0; i < IMPULSE_SIZE; i++)
     {
         float elem = static_cast< float >(impulse[i]);
-        filtered_impulse[i] = static_cast< int16_t >(M17::rrc_48k(0.10 * elem));
+        filtered_impulse[i] = static_cast< int16_t >(rrc_48k(0.10 * elem));
     }
     fwrite(filtered_impulse, IMPULSE_SIZE, 1, baseband_out);
     fclose(baseband_out);
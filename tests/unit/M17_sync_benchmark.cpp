@@ -0,0 +1,233 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <array>
+#include "M17/M17SyncDetector.hpp"
+#include "M17/M17DSP.hpp"
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace M17;
+
+static constexpr size_t SPS         = 5;     // Samples per symbol at 24kHz
+static constexpr size_t BLOCK_SIZE  = 960;   // Samples per demodulator update
+static constexpr size_t SYNC_SPAN   = SPS * M17_SYNCWORD_SYMBOLS;
+static constexpr size_t BRIDGE_SIZE = SYNC_SPAN + 2 * SPS;
+static constexpr size_t NUM_RUNS    = 50;
+
+/**
+ * Former syncword detector, computing one convolution per position with
+ * a bridge buffer accessed through a conditional branch and comparing the
+ * correlation against the square root of the moving variance. Used as a
+ * baseline for the measurements.
+ */
+class LegacyDetector
+{
+public:
+
+    LegacyDetector() : emvar(40000000.0f)
+    {
+        bridge.fill(0);
+    }
+
+    size_t run(const int16_t *block, const size_t len)
+    {
+        size_t found = 0;
+        int32_t maxLen = static_cast< int32_t >(len - SYNC_SPAN);
+
+        for(int32_t i = -static_cast< int32_t >(BRIDGE_SIZE - SYNC_SPAN);
+            i < maxLen; i++)
+        {
+            int32_t conv = 0;
+            for(size_t j = 0; j < M17_SYNCWORD_SYMBOLS; j++)
+            {
+                int32_t index  = i + j * SPS;
+                int16_t sample = 0;
+                if(index < 0)
+                    sample = bridge[BRIDGE_SIZE + index];
+                else
+                    sample = block[index];
+
+                conv += static_cast< int32_t >(streamSync[j]) * sample;
+            }
+
+            float incr = 0.005f * static_cast< float >(conv);
+            emvar = 0.995f * (emvar + static_cast< float >(conv) * incr);
+
+            if(conv > (sqrt(emvar) * 3.40f))
+                found++;
+            else if(conv < -(sqrt(emvar) * 3.40f))
+                found++;
+        }
+
+        for(size_t i = 0; i < BRIDGE_SIZE; i++)
+            bridge[i] = block[len - BRIDGE_SIZE + i];
+
+        return found;
+    }
+
+private:
+
+    static constexpr int8_t streamSync[] = {-3, -3, -3, -3, +3, +3, -3, +3};
+
+    array< int16_t, BRIDGE_SIZE > bridge;
+    float emvar;
+};
+
+constexpr int8_t LegacyDetector::streamSync[];
+
+/**
+ * Block detector, scanning the same positions of the legacy one over a
+ * contiguous bridge + block buffer.
+ */
+class BlockDetector
+{
+public:
+
+    BlockDetector(const bool extended) : work(BRIDGE_SIZE + BLOCK_SIZE, 0)
+    {
+        detector.enableMultiHypothesis(extended);
+    }
+
+    size_t run(const int16_t *block, const size_t len)
+    {
+        size_t   found   = 0;
+        int16_t *samples = work.data() + BRIDGE_SIZE;
+        int32_t  maxLen  = static_cast< int32_t >(len - SYNC_SPAN);
+        int32_t  offset  = -static_cast< int32_t >(BRIDGE_SIZE - SYNC_SPAN);
+
+        copy(block, block + len, samples);
+
+        while(offset < maxLen)
+        {
+            sync_t sync = detector.search(samples, offset, maxLen);
+            if(sync.index < 0)
+                break;
+
+            found++;
+            offset = sync.index + 1;
+        }
+
+        copy(samples + len - BRIDGE_SIZE, samples + len, work.data());
+
+        return found;
+    }
+
+private:
+
+    M17SyncDetector< SPS > detector;
+    vector< int16_t >      work;
+};
+
+/**
+ * Run a detector over the whole baseband, block by block, returning the
+ * average cost per sample and the number of correlation peaks found in the
+ * last run.
+ */
+template < typename D, typename... Args >
+double measureDetector(const vector< int16_t >& baseband, size_t& found, Args... args)
+{
+    size_t   numBlocks = baseband.size() / BLOCK_SIZE;
+    uint64_t total     = 0;
+
+    for(size_t run = 0; run < NUM_RUNS; run++)
+    {
+        D detector(args...);
+        found = 0;
+
+        uint64_t start = cycleCount();
+        for(size_t i = 0; i < numBlocks; i++)
+        {
+            found += detector.run(baseband.data() + i * BLOCK_SIZE, BLOCK_SIZE);
+        }
+
+        // Discard the first run, used to warm up caches and CPU clock
+        if(run > 0)
+            total += cycleCount() - start;
+    }
+
+    return static_cast< double >(total)
+         / ((NUM_RUNS - 1) * numBlocks * BLOCK_SIZE);
+}
+
+int main()
+{
+    FILE *fp = fopen("../tests/unit/assets/M17_test_baseband_dc.raw", "rb");
+    if(fp == NULL)
+    {
+        perror("Error opening baseband file");
+        return -1;
+    }
+
+    // Input file is sampled at 48kHz, decimate to the 24kHz used by the
+    // demodulator, remove the DC offset and apply the RRC filter.
+    vector< int16_t > baseband;
+    int64_t dcOffset = 0;
+    int16_t pair[2];
+    while(fread(pair, sizeof(int16_t), 2, fp) == 2)
+    {
+        baseband.push_back(pair[0]);
+        dcOffset += pair[0];
+    }
+
+    fclose(fp);
+
+    dcOffset /= static_cast< int64_t >(baseband.size());
+    for(auto& sample : baseband)
+    {
+        sample -= dcOffset;
+    }
+
+    rrc_24k.reset();
+    rrc_24k.process(baseband.data(), baseband.data(), baseband.size());
+
+    size_t legacyFound   = 0;
+    size_t blockFound    = 0;
+    size_t extendedFound = 0;
+
+    double legacy   = measureDetector< LegacyDetector >(baseband, legacyFound);
+    double block    = measureDetector< BlockDetector  >(baseband, blockFound, false);
+    double extended = measureDetector< BlockDetector  >(baseband, extendedFound, true);
+
+    #if defined(__x86_64__) || defined(__i386__)
+    printf("Syncword search cost, cycles per sample\n");
+    #else
+    printf("Syncword search cost, nanoseconds per sample\n");
+    #endif
+
+    printf("legacy            %7.2f (%zu peaks)\n", legacy,   legacyFound);
+    printf("block             %7.2f (%zu peaks)\n", block,    blockFound);
+    printf("block, extended   %7.2f (%zu peaks)\n", extended, extendedFound);
+
+    // Both detectors evaluate the same positions with the same statistics,
+    // the number of correlation peaks found has to be the same.
+    if(legacyFound != blockFound)
+    {
+        printf("Error: detection mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -85,5 +85,26 @@ int main()
         }
     }
 
+    // Soft-decision decoding of the same data, with full confidence soft bits
+    array< uint16_t, 34 * 8 > softPunctured;
+    for(size_t i = 0; i < softPunctured.size(); i++)
+    {
+        softPunctured[i] = M17::getBit(punctured, i) ? 0xFFFF : 0x0000;
+    }
+
+    array< uint8_t, 18 > softResult;
+    M17::M17SoftViterbi softDecoder;
+    softDecoder.decodePunctured(softPunctured, softResult, M17::DATA_PUNCTURE);
+
+    for(size_t i = 0; i < softResult.size(); i++)
+    {
+        if(source[i] != softResult[i])
+        {
+            printf("Soft decoding error at pos %ld: got %02x, expected %02x\n",
+                   i, softResult[i], source[i]);
+            return -1;
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2021 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include <cmath>
+#include "M17/M17ConvolutionalEncoder.hpp"
+#include "M17/M17CodePuncturing.hpp"
+#include "M17/M17Viterbi.hpp"
+#include "M17/M17Utils.hpp"
+
+using namespace std;
+
+static constexpr size_t NUM_FRAMES = 2000;    // Stream frames per SNR step
+static constexpr float  SYMBOL_ENERGY = 5.0f; // Average energy of 4FSK symbols
+
+default_random_engine rng;
+
+/**
+ * Hard slicing of a received 4FSK symbol.
+ */
+int8_t slice(const float value)
+{
+    if(value > 2.0f)  return +3;
+    if(value < -2.0f) return -3;
+    if(value > 0.0f)  return +1;
+
+    return -1;
+}
+
+/**
+ * Count the number of different bits between two byte arrays.
+ */
+template < size_t N >
+uint32_t bitErrors(const array< uint8_t, N >& a, const array< uint8_t, N >& b)
+{
+    uint32_t errors = 0;
+    for(size_t i = 0; i < N; i++)
+    {
+        errors += __builtin_popcount(a[i] ^ b[i]);
+    }
+
+    return errors;
+}
+
+/**
+ * Compare the bit error rate of the hard and soft decision Viterbi decoders
+ * on punctured stream frames transmitted as 4FSK symbols over an AWGN
+ * channel, for different values of Es/N0.
+ */
+int main()
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+
+    M17::M17ConvolutionalEncoder encoder;
+    M17::M17HardViterbi hardDecoder;
+    M17::M17SoftViterbi softDecoder;
+
+    printf("Es/N0 [dB], Hard BER, Soft BER\n");
+
+    for(int snr = 0; snr <= 12; snr++)
+    {
+        float sigma = sqrt(SYMBOL_ENERGY / (2.0f * pow(10.0f, snr / 10.0f)));
+        normal_distribution< float > noise(0.0f, sigma);
+
+        uint32_t hardErrors = 0;
+        uint32_t softErrors = 0;
+        uint32_t totalBits  = 0;
+
+        for(size_t frame = 0; frame < NUM_FRAMES; frame++)
+        {
+            array< uint8_t, 18 > source;
+            for(auto& byte : source)
+            {
+                byte = rndValue(rng);
+            }
+
+            array< uint8_t, 37 > encoded;
+            encoder.reset();
+            encoder.encode(source.data(), encoded.data(), source.size());
+            encoded[36] = encoder.flush();
+
+            array< uint8_t, 34 > punctured;
+            M17::puncture(encoded, punctured, M17::DATA_PUNCTURE);
+
+            // Modulate, add noise and demodulate
+            array< uint8_t, 34 >      hardBits;
+            array< uint16_t, 34 * 8 > softBits;
+            for(size_t i = 0; i < punctured.size(); i++)
+            {
+                auto symbols = M17::byteToSymbols(punctured[i]);
+                for(size_t j = 0; j < symbols.size(); j++)
+                {
+                    float value = static_cast< float >(symbols[j]) + noise(rng);
+                    M17::setSymbol(hardBits, 4*i + j, slice(value));
+                    M17::setSoftSymbol(softBits, 4*i + j, value);
+                }
+            }
+
+            array< uint8_t, 18 > hardResult;
+            array< uint8_t, 18 > softResult;
+            hardDecoder.decodePunctured(hardBits, hardResult, M17::DATA_PUNCTURE);
+            softDecoder.decodePunctured(softBits, softResult, M17::DATA_PUNCTURE);
+
+            hardErrors += bitErrors(source, hardResult);
+            softErrors += bitErrors(source, softResult);
+            totalBits  += source.size() * 8;
+        }
+
+        printf("%d, %e, %e\n", snr,
+               static_cast< double >(hardErrors) / totalBits,
+               static_cast< double >(softErrors) / totalBits);
+    }
+
+    return 0;
+}
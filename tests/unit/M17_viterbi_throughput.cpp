@@ -0,0 +1,134 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <array>
+#include "M17/M17ConvolutionalEncoder.hpp"
+#include "M17/M17CodePuncturing.hpp"
+#include "M17/M17Viterbi.hpp"
+#include "M17/M17Utils.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t NUM_FRAMES = 256;      // Different frames decoded
+static constexpr size_t NUM_ROUNDS = 100;      // Decoding rounds per frame
+
+default_random_engine rng;
+
+/**
+ * Measure the number of frames per second decoded by a given function.
+ */
+template < typename F >
+double measure(F&& func)
+{
+    // Warm up caches and CPU clock before measuring
+    for(size_t i = 0; i < NUM_FRAMES; i++)
+    {
+        func(i);
+    }
+
+    auto start = steady_clock::now();
+    for(size_t r = 0; r < NUM_ROUNDS; r++)
+    {
+        for(size_t i = 0; i < NUM_FRAMES; i++)
+        {
+            func(i);
+        }
+    }
+
+    auto stop    = steady_clock::now();
+    double secs  = duration_cast< duration< double > >(stop - start).count();
+    return static_cast< double >(NUM_FRAMES * NUM_ROUNDS) / secs;
+}
+
+/**
+ * Measure the decoding throughput, in frames per second, of the hard and soft
+ * decision Viterbi decoders on punctured stream frames with noise. One stream
+ * frame is received every 40ms on each channel, thus the throughput divided by
+ * 25 gives the number of channels which can be decoded in real time.
+ */
+int main()
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+    normal_distribution< float > noise(0.0f, 0.5f);
+
+    M17::M17ConvolutionalEncoder encoder;
+    M17::M17HardViterbi hardDecoder;
+    M17::M17SoftViterbi softDecoder;
+
+    static array< array< uint8_t,  34 >,     NUM_FRAMES > hardFrames;
+    static array< array< uint16_t, 34 * 8 >, NUM_FRAMES > softFrames;
+
+    for(size_t frame = 0; frame < NUM_FRAMES; frame++)
+    {
+        array< uint8_t, 18 > source;
+        for(auto& byte : source)
+        {
+            byte = rndValue(rng);
+        }
+
+        array< uint8_t, 37 > encoded;
+        encoder.reset();
+        encoder.encode(source.data(), encoded.data(), source.size());
+        encoded[36] = encoder.flush();
+
+        array< uint8_t, 34 > punctured;
+        M17::puncture(encoded, punctured, M17::DATA_PUNCTURE);
+
+        for(size_t i = 0; i < punctured.size(); i++)
+        {
+            auto symbols = M17::byteToSymbols(punctured[i]);
+            for(size_t j = 0; j < symbols.size(); j++)
+            {
+                float value = static_cast< float >(symbols[j]) + noise(rng);
+                M17::setSoftSymbol(softFrames[frame], 4*i + j, value);
+            }
+        }
+
+        hardFrames[frame] = punctured;
+    }
+
+    array< uint8_t, 18 > result;
+    volatile uint32_t    cost = 0;
+
+    double hardFps = measure([&](const size_t i)
+    {
+        cost = cost + hardDecoder.decodePunctured(hardFrames[i], result,
+                                                  M17::DATA_PUNCTURE);
+    });
+
+    double softFps = measure([&](const size_t i)
+    {
+        cost = cost + softDecoder.decodePunctured(softFrames[i], result,
+                                                  M17::DATA_PUNCTURE);
+    });
+
+    printf("Stream frame decoding throughput\n");
+    printf("Hard decision: %9.0f frames/s, %6.0f channels\n", hardFps,
+           hardFps / 25.0);
+    printf("Soft decision: %9.0f frames/s, %6.0f channels\n", softFps,
+           softFps / 25.0);
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <audio_path.h>
+
+/*
+ * Test of the audio path management. Path compatibility is given by the
+ * matrix of the Linux audio driver, in which RTX-SPK and MCU-SPK paths are
+ * incompatible while MCU-SPK and RTX-MCU paths can coexist.
+ */
+
+static int failures = 0;
+
+#define CHECK(cond)                                               \
+    do                                                            \
+    {                                                             \
+        if(!(cond))                                               \
+        {                                                         \
+            printf("Line %d: check failed: %s\n", __LINE__, #cond); \
+            failures++;                                           \
+        }                                                         \
+    }                                                             \
+    while(0)
+
+static void testSuspendResume()
+{
+    pathId rx = audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX);
+    CHECK(rx > 0);
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+
+    // Higher priority path suspends the lower priority one
+    pathId vp = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_PROMPT);
+    CHECK(vp > 0);
+    CHECK(audioPath_getStatus(vp) == PATH_OPEN);
+    CHECK(audioPath_getStatus(rx) == PATH_SUSPENDED);
+
+    pathInfo_t info = audioPath_getInfo(rx);
+    CHECK(info.source == SOURCE_RTX);
+    CHECK(info.sink   == SINK_SPK);
+    CHECK(info.prio   == PRIO_RX);
+    CHECK(info.status == PATH_SUSPENDED);
+
+    // Release resumes the suspended path
+    audioPath_release(vp);
+    CHECK(audioPath_getStatus(vp) == PATH_CLOSED);
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+
+    audioPath_release(rx);
+    CHECK(audioPath_getStatus(rx) == PATH_CLOSED);
+}
+
+static void testLowerPriority()
+{
+    pathId vp = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_PROMPT);
+    CHECK(vp > 0);
+
+    // Incompatible path with lower or equal priority cannot be opened
+    CHECK(audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX) == -1);
+    CHECK(audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_PROMPT) == -1);
+    CHECK(audioPath_getStatus(vp) == PATH_OPEN);
+
+    // Compatible path is opened regardless of the priority
+    pathId rx = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_BEEP);
+    CHECK(rx > 0);
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+    CHECK(audioPath_getStatus(vp) == PATH_OPEN);
+
+    audioPath_release(rx);
+    audioPath_release(vp);
+}
+
+static void testChainedRelease()
+{
+    pathId beep = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_BEEP);
+    pathId rx   = audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX);
+    pathId vp   = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_PROMPT);
+    CHECK((beep > 0) && (rx > 0) && (vp > 0));
+    CHECK(audioPath_getStatus(beep) == PATH_SUSPENDED);
+    CHECK(audioPath_getStatus(rx)   == PATH_SUSPENDED);
+    CHECK(audioPath_getStatus(vp)   == PATH_OPEN);
+
+    // Releasing a suspended path passes its suspended paths to the path which
+    // suspended it.
+    audioPath_release(rx);
+    CHECK(audioPath_getStatus(rx)   == PATH_CLOSED);
+    CHECK(audioPath_getStatus(beep) == PATH_SUSPENDED);
+
+    audioPath_release(vp);
+    CHECK(audioPath_getStatus(beep) == PATH_OPEN);
+    audioPath_release(beep);
+
+    // Same scenario, releasing from the top
+    beep = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_BEEP);
+    rx   = audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX);
+    vp   = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_PROMPT);
+
+    audioPath_release(vp);
+    CHECK(audioPath_getStatus(rx)   == PATH_OPEN);
+    CHECK(audioPath_getStatus(beep) == PATH_SUSPENDED);
+
+    audioPath_release(rx);
+    CHECK(audioPath_getStatus(beep) == PATH_OPEN);
+    audioPath_release(beep);
+}
+
+static void testIdentifiers()
+{
+    // Released IDs are not valid anymore, even if the slot gets reused
+    pathId first = audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX);
+    audioPath_release(first);
+    pathId second = audioPath_request(SOURCE_RTX, SINK_SPK, PRIO_RX);
+    CHECK(second > 0);
+    CHECK(second != first);
+    CHECK(audioPath_getStatus(first)  == PATH_CLOSED);
+    CHECK(audioPath_getStatus(second) == PATH_OPEN);
+
+    // Releasing a stale ID does not affect the new path
+    audioPath_release(first);
+    CHECK(audioPath_getStatus(second) == PATH_OPEN);
+    audioPath_release(second);
+
+    // Invalid IDs
+    CHECK(audioPath_getStatus(-1) == PATH_CLOSED);
+    CHECK(audioPath_getStatus(0)  == PATH_CLOSED);
+    audioPath_release(-1);
+    audioPath_release(0);
+}
+
+static void testCapacity()
+{
+    static const enum AudioPriority prio[] = {PRIO_BEEP, PRIO_RX, PRIO_PROMPT,
+                                              PRIO_TX};
+    pathId ids[8];
+    int count = 0;
+
+    // Fill the path table: each couple of compatible paths suspends the one
+    // with lower priority.
+    for(auto p : prio)
+    {
+        ids[count++] = audioPath_request(SOURCE_MCU, SINK_SPK, p);
+        ids[count++] = audioPath_request(SOURCE_RTX, SINK_MCU, p);
+    }
+
+    for(int i = 0; i < count; i++)
+        CHECK(ids[i] > 0);
+
+    CHECK(audioPath_getStatus(ids[count - 1]) == PATH_OPEN);
+    CHECK(audioPath_getStatus(ids[0])         == PATH_SUSPENDED);
+
+    // Table full, a path compatible with the active ones cannot be opened
+    CHECK(audioPath_request(SOURCE_MIC, SINK_SPK, PRIO_TX) == -1);
+
+    // Free one slot, the next request succeeds
+    audioPath_release(ids[0]);
+    ids[0] = audioPath_request(SOURCE_MIC, SINK_SPK, PRIO_TX);
+    CHECK(ids[0] > 0);
+    CHECK(audioPath_getStatus(ids[0]) == PATH_OPEN);
+
+    for(int i = count - 1; i >= 0; i--)
+        audioPath_release(ids[i]);
+
+    CHECK(audioPath_getStatus(ids[1]) == PATH_CLOSED);
+}
+
+static void testPromptOverRx()
+{
+    // M17 voice received and decoded by the MCU
+    pathId rx = audioPath_requestMixed(SOURCE_MCU, SINK_SPK, PRIO_RX,
+                                       AUDIO_GAIN_UNITY);
+    CHECK(rx > 0);
+    CHECK(audioPath_getGain(rx) == AUDIO_GAIN_UNITY);
+
+    // Voice prompt on top of it: both play, the received voice gets ducked
+    pathId vp = audioPath_requestMixed(SOURCE_MCU, SINK_SPK, PRIO_PROMPT,
+                                       AUDIO_GAIN_UNITY);
+    CHECK(vp > 0);
+    CHECK(audioPath_mixable(rx, vp));
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+    CHECK(audioPath_getStatus(vp) == PATH_OPEN);
+    CHECK(audioPath_getGain(vp)   == AUDIO_GAIN_UNITY);
+    CHECK(audioPath_getGain(rx)   == AUDIO_GAIN_DUCK);
+
+    // Output frame as built by the codec: prompt at full level, voice at 1/4
+    stream_sample_t out[4]   = {0, 0, 0, 0};
+    stream_sample_t voice[4] = {4000, -4000, 20000, -20000};
+    stream_sample_t vpSmp[4] = {1000, -1000, 30000, -30000};
+    audioPath_mix(rx, out, voice, 4);
+    audioPath_mix(vp, out, vpSmp, 4);
+    CHECK(out[0] == 2000);
+    CHECK(out[1] == -2000);
+    CHECK(out[2] == INT16_MAX);
+    CHECK(out[3] == INT16_MIN);
+
+    // Exclusive path suspends both the mixed ones
+    pathId tx = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_TX);
+    CHECK(audioPath_getStatus(rx) == PATH_SUSPENDED);
+    CHECK(audioPath_getStatus(vp) == PATH_SUSPENDED);
+    CHECK(audioPath_mixable(rx, vp) == false);
+    CHECK(audioPath_getGain(vp)   == 0);
+    audioPath_release(tx);
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+    CHECK(audioPath_getStatus(vp) == PATH_OPEN);
+
+    // Ducking ends with the prompt
+    audioPath_release(vp);
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+    CHECK(audioPath_getGain(rx)   == AUDIO_GAIN_UNITY);
+
+    out[0] = 0;
+    audioPath_mix(rx, out, voice, 1);
+    CHECK(out[0] == 4000);
+
+    audioPath_setGain(rx, AUDIO_GAIN_UNITY / 2);
+    CHECK(audioPath_getGain(rx) == AUDIO_GAIN_UNITY / 2);
+    audioPath_release(rx);
+
+    // Analog voice from the RTX cannot be mixed, the prompt suspends it
+    rx = audioPath_requestMixed(SOURCE_RTX, SINK_SPK, PRIO_RX,
+                                AUDIO_GAIN_UNITY);
+    vp = audioPath_requestMixed(SOURCE_MCU, SINK_SPK, PRIO_PROMPT,
+                                AUDIO_GAIN_UNITY);
+    CHECK(audioPath_mixable(rx, vp) == false);
+    CHECK(audioPath_getStatus(rx) == PATH_SUSPENDED);
+    audioPath_release(vp);
+    CHECK(audioPath_getStatus(rx) == PATH_OPEN);
+    audioPath_release(rx);
+}
+
+int main()
+{
+    testSuspendResume();
+    testLowerPriority();
+    testChainedRelease();
+    testIdentifiers();
+    testCapacity();
+    testPromptOverRx();
+
+    if(failures != 0)
+    {
+        printf("Audio path test: %d failures\n", failures);
+        return -1;
+    }
+
+    printf("Audio path test: PASS\n");
+    return 0;
+}
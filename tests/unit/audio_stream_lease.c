@@ -0,0 +1,192 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <audio_stream.h>
+#include <audio_path.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+
+/*
+ * Test of the shared input stream API, using the Linux file source driver
+ * connected to the RTX input. The source file contains a ramp, so that the
+ * expected value of each sample can be computed from its position in the
+ * stream. Two readers access the stream concurrently: the primary one checks
+ * data and history samples, the secondary one checks only the data.
+ */
+
+#define FILE_NAME   "/tmp/baseband.raw"
+#define FILE_LEN    4096
+#define BLOCK_LEN   256
+#define HISTORY     40
+#define NUM_BLOCKS  100
+#define SAMPLE_RATE 96000
+
+typedef struct
+{
+    streamId id;
+    uint8_t  reader;
+    int      errors;
+    int      checked;
+    uint32_t lost;
+}
+readerCtx_t;
+
+static stream_sample_t buffer[HISTORY + 2 * BLOCK_LEN];
+
+static inline stream_sample_t expected(const int32_t pos)
+{
+    if(pos < 0)
+        return 0;
+
+    return (stream_sample_t) (pos % FILE_LEN);
+}
+
+static void *readerFunc(void *arg)
+{
+    readerCtx_t *ctx    = (readerCtx_t *) arg;
+    bool         stale  = true;
+
+    for(int i = 0; i < NUM_BLOCKS; i++)
+    {
+        streamLease_t lease = inputStream_acquire(ctx->id, ctx->reader);
+        if((lease.data == NULL) || (lease.len != BLOCK_LEN))
+        {
+            ctx->errors++;
+            return NULL;
+        }
+
+        ctx->lost += lease.lost;
+
+        // Position in the stream of the first sample of the block
+        int32_t start = (lease.seq - 1) * BLOCK_LEN;
+        int     bad   = 0;
+
+        for(size_t j = 0; j < lease.len; j++)
+        {
+            if(lease.data[j] != expected(start + j))
+                bad++;
+        }
+
+        // History of a first half block is copied from the previous block on
+        // its release, or zeroed if that lease was stale.
+        bool firstHalf = (lease.data == &buffer[HISTORY]);
+        if((ctx->reader == 0) && ((firstHalf == false) || (lease.lost == 0)))
+        {
+            for(int32_t j = 1; j <= (int32_t) lease.history; j++)
+            {
+                stream_sample_t exp = expected(start - j);
+                if(firstHalf && stale)
+                    exp = 0;
+
+                if(lease.data[-j] != exp)
+                    bad++;
+            }
+        }
+
+        // Block content is meaningful only if it was not overwritten while
+        // leased.
+        bool valid = inputStream_release(ctx->id, &lease);
+        if(valid)
+        {
+            ctx->checked++;
+            if(bad != 0)
+                ctx->errors++;
+        }
+
+        stale = (valid == false) || (lease.lost != 0);
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    // Write the ramp to the source file
+    FILE *fp = fopen(FILE_NAME, "wb");
+    if(fp == NULL)
+        return -1;
+
+    for(int16_t i = 0; i < FILE_LEN; i++)
+        fwrite(&i, sizeof(int16_t), 1, fp);
+
+    fclose(fp);
+
+    pathId path = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_RX);
+    if(path <= 0)
+    {
+        printf("Error: audio path request failed\n");
+        return -1;
+    }
+
+    // History longer than half of the data area
+    streamId id = inputStream_startShared(path, buffer, 3 * BLOCK_LEN,
+                                          BLOCK_LEN + 1, SAMPLE_RATE, 1);
+    if(id != -EINVAL)
+    {
+        printf("Error: invalid history length accepted\n");
+        return -1;
+    }
+
+    id = inputStream_startShared(path, buffer, HISTORY + 2 * BLOCK_LEN,
+                                 HISTORY, SAMPLE_RATE, 2);
+    if(id < 0)
+    {
+        printf("Error: stream start failed (%d)\n", id);
+        return -1;
+    }
+
+    // Invalid reader
+    streamLease_t lease = inputStream_acquire(id, 2);
+    if(lease.data != NULL)
+    {
+        printf("Error: lease acquired by invalid reader\n");
+        return -1;
+    }
+
+    readerCtx_t primary   = { id, 0, 0, 0, 0 };
+    readerCtx_t secondary = { id, 1, 0, 0, 0 };
+    pthread_t   thread;
+
+    pthread_create(&thread, NULL, readerFunc, &secondary);
+    readerFunc(&primary);
+    pthread_join(thread, NULL);
+
+    audioStream_terminate(id);
+    audioPath_release(path);
+    remove(FILE_NAME);
+
+    printf("Primary:   %d blocks checked, %u lost, %d errors\n",
+           primary.checked, primary.lost, primary.errors);
+    printf("Secondary: %d blocks checked, %u lost, %d errors\n",
+           secondary.checked, secondary.lost, secondary.errors);
+
+    if((primary.errors != 0) || (secondary.errors != 0))
+        return -1;
+
+    // At least half of the blocks have to be read without overruns
+    if((primary.checked < NUM_BLOCKS / 2) || (secondary.checked < NUM_BLOCKS / 2))
+        return -1;
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Common fixture of the unit benchmarks, measuring the cost of a piece of code
+ * in CPU cycles on x86 and in nanoseconds on the other targets.
+ */
+
+/**
+ * Read the CPU cycle counter, when available, otherwise return the elapsed
+ * time in nanoseconds.
+ */
+static inline uint64_t cycleCount()
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #else
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(now).count();
+    #endif
+}
+
+/**
+ * Measure the average cost of a function, after a warm up run of one tenth of
+ * the iterations to bring the caches and the CPU clock to steady state.
+ *
+ * @param func: function to be measured.
+ * @param iterations: number of times the function is called.
+ * @param items: number of items, like samples or bytes, processed by each call.
+ * @return average cost per processed item.
+ */
+template < typename F >
+double measure(F&& func, const size_t iterations, const size_t items = 1)
+{
+    for(size_t i = 0; i < iterations / 10; i++)
+    {
+        func();
+    }
+
+    uint64_t start = cycleCount();
+    for(size_t i = 0; i < iterations; i++)
+    {
+        func();
+    }
+
+    uint64_t stop = cycleCount();
+    return static_cast< double >(stop - start) / (iterations * items);
+}
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <audio_codec.h>
+#include <codec2/codec2.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+/*
+ * Measure the real time factor of CODEC2 encoding and decoding for each of
+ * the modes supported by the codec manager, that is the ratio between the
+ * processing time and the duration of the processed audio. The input is a
+ * synthetic voiced signal, the figures are intended only to compare modes.
+ */
+
+#define SAMPLE_RATE 8000
+#define DURATION    20        // Seconds of audio processed per mode
+
+static const int c2Modes[] = { CODEC2_MODE_3200, CODEC2_MODE_1600,
+                               CODEC2_MODE_700C };
+
+static const char *modeNames[] = { "3200", "1600", "700C" };
+
+static inline double timeSec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + ((double) ts.tv_nsec / 1000000000.0);
+}
+
+/**
+ * Generate a vowel-like signal: harmonics of a slowly varying pitch, shaped by
+ * two formants, plus some noise.
+ */
+static void generateSpeech(int16_t *buf, const size_t len)
+{
+    double phase = 0.0;
+
+    srand(1234);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        double t     = (double) i / SAMPLE_RATE;
+        double pitch = 120.0 + 20.0 * sin(2.0 * M_PI * 0.5 * t);
+        double value = 0.0;
+
+        phase += 2.0 * M_PI * pitch / SAMPLE_RATE;
+
+        for(int h = 1; h * pitch < 3500.0; h++)
+        {
+            double f    = h * pitch;
+            double amp1 = exp(-pow((f - 700.0)  / 150.0, 2.0));
+            double amp2 = exp(-pow((f - 1200.0) / 200.0, 2.0));
+            value += (amp1 + 0.5 * amp2 + 0.02) * sin(h * phase);
+        }
+
+        value += ((double) rand() / RAND_MAX - 0.5) * 0.05;
+        buf[i] = (int16_t) (value * 6000.0);
+    }
+}
+
+int main()
+{
+    const size_t numSamples = SAMPLE_RATE * DURATION;
+    int16_t *audio   = (int16_t *) malloc(numSamples * sizeof(int16_t));
+    int16_t *decoded = (int16_t *) malloc(numSamples * sizeof(int16_t));
+    uint8_t *frames  = (uint8_t *) malloc(numSamples);
+
+    if((audio == NULL) || (decoded == NULL) || (frames == NULL))
+        return -1;
+
+    generateSpeech(audio, numSamples);
+
+    printf("Mode | frame | encode RTF | decode RTF | wakeups/s for batch 1..%d\n",
+           CODEC_MAX_BATCH);
+
+    for(uint8_t mode = CODEC_MODE_3200; mode <= CODEC_MODE_700C; mode++)
+    {
+        struct CODEC2 *codec2   = codec2_create(c2Modes[mode]);
+        size_t         nSamples = codec_frameSamples(mode);
+        size_t         nBytes   = codec_frameSize(mode);
+        size_t         nFrames  = numSamples / nSamples;
+
+        // Frame parameters of the codec manager must match the library ones
+        if((nSamples != (size_t) codec2_samples_per_frame(codec2)) ||
+           (nBytes   != (size_t) codec2_bytes_per_frame(codec2)))
+        {
+            printf("Error: wrong frame parameters for mode %s\n",
+                   modeNames[mode]);
+            return -1;
+        }
+
+        double start = timeSec();
+        for(size_t i = 0; i < nFrames; i++)
+        {
+            codec2_encode(codec2, frames + (i * nBytes), audio + (i * nSamples));
+        }
+
+        double encTime = timeSec() - start;
+
+        start = timeSec();
+        for(size_t i = 0; i < nFrames; i++)
+        {
+            codec2_decode(codec2, decoded + (i * nSamples), frames + (i * nBytes));
+        }
+
+        double decTime = timeSec() - start;
+
+        codec2_destroy(codec2);
+
+        printf("%s | %2zu ms | %10.4f | %10.4f |",
+               modeNames[mode], (nSamples * 1000) / SAMPLE_RATE,
+               encTime / DURATION, decTime / DURATION);
+
+        for(int batch = 1; batch <= CODEC_MAX_BATCH; batch++)
+        {
+            printf(" %5.1f", (double) SAMPLE_RATE / (nSamples * batch));
+        }
+
+        printf("\n");
+    }
+
+    free(audio);
+    free(decoded);
+    free(frames);
+
+    return 0;
+}
@@ -1,6 +1,12 @@
 #include <interfaces/cps_io.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+
+#define BULK_ENTRIES 5000
+#define BULK_BANKS   10
 
 int test_initCPS() {
     // Initialize a new cps
@@ -152,6 +158,169 @@ int test_createOOOCPS() {
     return 0;
 }
 
+/*
+ * Modifications must reach the file on cps_sync(), also the ones written
+ * through after the file has been rewritten. When the file cannot be saved,
+ * the codeplug must stay open with its content until a later save succeeds.
+ */
+int test_sync() {
+    cps_create("/tmp/test8.rtxc");
+
+    if(cps_open("/tmp/test8.rtxc"))
+        return -1;
+
+    contact_t ct1 = { "Test contact 1", 0, {{0}} };
+    contact_t ct2 = { "Test contact 2", 0, {{0}} };
+    contact_t c   = { 0 };
+    cps_insertContact(ct1, 0);
+    if(cps_sync())
+        return -1;
+    cps_writeContact(ct2, 0);
+    if(cps_sync())
+        return -1;
+
+    FILE *file = fopen("/tmp/test8.rtxc", "r");
+    cps_header_t header = { 0 };
+    if(file == NULL)
+        return -1;
+    size_t nRead = fread(&header, sizeof(header), 1, file);
+    nRead       += fread(&c, sizeof(c), 1, file);
+    fclose(file);
+    if((nRead != 2) || (header.ct_count != 1) ||
+       strncmp(ct2.name, c.name, 32L))
+        return -1;
+    cps_close();
+
+    mkdir("/tmp/test8", 0755);
+    cps_create("/tmp/test8/test.rtxc");
+    if(cps_open("/tmp/test8/test.rtxc"))
+        return -1;
+
+    cps_insertContact(ct1, 0);
+    unlink("/tmp/test8/test.rtxc");
+    rmdir("/tmp/test8");
+    if(cps_sync() == 0)
+        return -1;
+
+    cps_close();
+    if(cps_readContact(&c, 0) || strncmp(ct1.name, c.name, 32L))
+        return -1;
+    if(cps_open("/tmp/test8.rtxc") == 0)
+        return -1;
+
+    mkdir("/tmp/test8", 0755);
+    cps_close();
+    if(cps_open("/tmp/test8/test.rtxc"))
+        return -1;
+    if(cps_readContact(&c, 0) || strncmp(ct1.name, c.name, 32L))
+        return -1;
+    cps_close();
+    return 0;
+}
+
+static inline double timeSec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + ((double) ts.tv_nsec / 1000000000.0);
+}
+
+/*
+ * Bulk import of contacts and channels, as done by codeplug tools: most of the
+ * entries are appended, one every ten is inserted at the beginning of the
+ * list. Each channel is also added to one of the banks.
+ */
+int test_bulkInsert() {
+    cps_create("/tmp/test7.rtxc");
+
+    if(cps_open("/tmp/test7.rtxc"))
+        return -1;
+
+    double start = timeSec();
+    for(int i = 0; i < BULK_BANKS; i++)
+    {
+        bankHdr_t b = { "", 0 };
+        snprintf(b.name, sizeof(b.name), "Bank %d", i);
+        cps_insertBankHeader(b, i);
+    }
+
+    for(int i = 0; i < BULK_ENTRIES; i++)
+    {
+        contact_t ct = { "", 3, {{0}} };
+        channel_t ch = { 3, 0, 0, 0, 0, 0, 0, 0, 0, "", "", {0}, {{0}} };
+        uint16_t  pos = ((i % 10) == 9) ? 0 : i;
+
+        snprintf(ct.name, sizeof(ct.name), "Contact %d", i);
+        snprintf(ch.name, sizeof(ch.name), "Channel %d", i);
+        ch.rx_frequency = 430000000 + (i * 12500);
+        ch.m17.contact_index = pos;
+
+        if(cps_insertContact(ct, pos) || cps_insertChannel(ch, pos))
+            return -1;
+        if(cps_insertBankData(pos, i % BULK_BANKS, i / BULK_BANKS))
+            return -1;
+    }
+
+    double insertTime = timeSec() - start;
+
+    start = timeSec();
+    cps_close();
+    double closeTime = timeSec() - start;
+
+    start = timeSec();
+    if(cps_open("/tmp/test7.rtxc"))
+        return -1;
+    double openTime = timeSec() - start;
+
+    // Check the content, every channel must still point to its own contact
+    start = timeSec();
+    for(int i = 0; i < BULK_ENTRIES; i++)
+    {
+        channel_t ch = { 0 };
+        contact_t ct = { 0 };
+        if(cps_readChannel(&ch, i) ||
+           cps_readContact(&ct, ch.m17.contact_index))
+            return -1;
+
+        int chNum = 0;
+        int ctNum = 0;
+        sscanf(ch.name, "Channel %d", &chNum);
+        sscanf(ct.name, "Contact %d", &ctNum);
+        if((chNum != ctNum) ||
+           (ch.rx_frequency != (freq_t) (430000000 + (chNum * 12500))))
+            return -1;
+    }
+
+    for(int i = 0; i < BULK_BANKS; i++)
+    {
+        bankHdr_t b = { "", 0 };
+        if(cps_readBankHeader(&b, i) ||
+           (b.ch_count != (BULK_ENTRIES / BULK_BANKS)))
+            return -1;
+
+        for(int j = 0; j < b.ch_count; j++)
+        {
+            channel_t ch = { 0 };
+            int chNum = 0;
+            if(cps_readChannel(&ch, cps_readBankData(i, j)))
+                return -1;
+            sscanf(ch.name, "Channel %d", &chNum);
+            if((chNum % BULK_BANKS) != i)
+                return -1;
+        }
+    }
+
+    double readTime = timeSec() - start;
+    cps_close();
+
+    printf("Bulk insert of %d channels and contacts: insert %.1f ms, "
+           "close %.1f ms, open %.1f ms, read back %.1f ms\n", BULK_ENTRIES,
+           insertTime * 1000.0, closeTime * 1000.0, openTime * 1000.0,
+           readTime * 1000.0);
+
+    return 0;
+}
+
 int main() {
     if (test_initCPS())
     {
@@ -183,4 +352,14 @@ int main() {
         printf("Error in creation of Out-Of-Order CPS!\n");
         return -1;
     }
+    if (test_sync())
+    {
+        printf("Error in codeplug sync!\n");
+        return -1;
+    }
+    if (test_bulkInsert())
+    {
+        printf("Error in bulk insertion!\n");
+        return -1;
+    }
 }
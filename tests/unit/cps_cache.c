@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cps_cache.h>
+#include <string.h>
+#include <stdio.h>
+
+/**
+ * Reference CTCSS/DCS code lookup, as performed by the native drivers before
+ * the introduction of the BCD tone table.
+ */
+static int linearToneIndex(uint16_t code)
+{
+    if((code == 0) || (code == 0xFFFF))
+        return -1;
+
+    uint32_t freq = ((code >> 12) & 0x0F) * 1000
+                  + ((code >> 8)  & 0x0F) * 100
+                  + ((code >> 4)  & 0x0F) * 10
+                  + (code & 0x0F);
+
+    for(int i = 0; i < MAX_TONE_INDEX; i++)
+    {
+        if(ctcss_tone[i] == freq)
+            return i;
+    }
+
+    return -1;
+}
+
+static bool isBcd(uint16_t code)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        if(((code >> (4 * i)) & 0x0F) > 9)
+            return false;
+    }
+
+    return true;
+}
+
+int test_toneLookup()
+{
+    for(uint32_t code = 0; code <= 0xFFFF; code++)
+    {
+        int expected = -1;
+        if(isBcd(code))
+            expected = linearToneIndex(code);
+
+        if(cps_toneIndex(code) != expected)
+        {
+            printf("Wrong index for tone code 0x%04x\n", code);
+            return -1;
+        }
+    }
+
+    // DCS codes are not mapped to any CTCSS tone
+    if((cps_toneIndex(0x8670) != -1) || (cps_toneIndex(0xC023) != -1))
+        return -1;
+
+    return 0;
+}
+
+int test_channelLRU()
+{
+    cpsCache_flush();
+
+    channel_t ch;
+    int ret;
+    for(uint16_t i = 0; i < CPS_CACHE_CHANNELS; i++)
+    {
+        memset(&ch, 0x00, sizeof(channel_t));
+        snprintf(ch.name, sizeof(ch.name), "Channel %d", i);
+        cpsCache_putChannel(&ch, i, 0);
+    }
+
+    // Touch channel 0, then insert a new one: channel 1 has to be evicted
+    if(cpsCache_getChannel(&ch, 0, &ret) == false)
+        return -1;
+
+    memset(&ch, 0x00, sizeof(channel_t));
+    snprintf(ch.name, sizeof(ch.name), "Channel %d", 100);
+    cpsCache_putChannel(&ch, 100, 0);
+
+    if((cpsCache_hasChannel(0) == false) || cpsCache_hasChannel(1))
+        return -1;
+
+    for(uint16_t i = 2; i < CPS_CACHE_CHANNELS; i++)
+    {
+        char name[CPS_STR_SIZE];
+        snprintf(name, sizeof(name), "Channel %d", i);
+        if((cpsCache_getChannel(&ch, i, &ret) == false) || (ret != 0))
+            return -1;
+        if(strncmp(name, ch.name, sizeof(name)) != 0)
+            return -1;
+    }
+
+    // Updating an entry must not duplicate it
+    snprintf(ch.name, sizeof(ch.name), "Updated");
+    cpsCache_putChannel(&ch, 100, 0);
+    if((cpsCache_getChannel(&ch, 100, &ret) == false) ||
+       (strcmp(ch.name, "Updated") != 0))
+        return -1;
+
+    if(cpsCache_hasChannel(0) == false)
+        return -1;
+
+    cpsCache_flush();
+    if(cpsCache_hasChannel(100))
+        return -1;
+
+    return 0;
+}
+
+int test_failedReads()
+{
+    cpsCache_flush();
+
+    contact_t ct;
+    memset(&ct, 0x00, sizeof(contact_t));
+    snprintf(ct.name, sizeof(ct.name), "Untouched");
+
+    // A cached failure returns -1 without modifying the destination
+    contact_t empty;
+    memset(&empty, 0xAA, sizeof(contact_t));
+    cpsCache_putContact(&empty, 7, -1);
+
+    int ret = 0;
+    if((cpsCache_getContact(&ct, 7, &ret) == false) || (ret != -1))
+        return -1;
+    if(strcmp(ct.name, "Untouched") != 0)
+        return -1;
+
+    if(cpsCache_getContact(&ct, 8, &ret))
+        return -1;
+
+    return 0;
+}
+
+int main()
+{
+    if(test_toneLookup())
+    {
+        printf("Error in CTCSS tone lookup!\n");
+        return -1;
+    }
+    if(test_channelLRU())
+    {
+        printf("Error in channel LRU cache!\n");
+        return -1;
+    }
+    if(test_failedReads())
+    {
+        printf("Error in caching of failed reads!\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <crc.h>
+
+using namespace std;
+
+/**
+ * Reference implementations: the bit-serial CCITT CRC previously used for
+ * settings and xmodem transfers and the bitwise M17 CRC of the link setup
+ * frame.
+ */
+static uint16_t ref_ccitt(const uint8_t *buf, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+static uint16_t ref_m17(const uint8_t *buf, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= (buf[i] << 8);
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            if(crc & 0x8000)
+                crc = (crc << 1) ^ 0x5935;
+            else
+                crc = (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+int test_vectors()
+{
+    const char *check = "123456789";
+
+    // CRC-16/XMODEM check value
+    if(crc_ccitt(check, 9) != 0x31C3)
+        return -1;
+
+    // Test vectors from the M17 specification
+    uint8_t bytes[256];
+    for(size_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = i;
+
+    if((crc_m17(check, 0) != 0xFFFF) || (crc_m17("A", 1) != 0x206E) ||
+       (crc_m17(check, 9) != 0x772B) || (crc_m17(bytes, 256) != 0x1C31))
+        return -1;
+
+    return 0;
+}
+
+int test_crossValidation()
+{
+    default_random_engine rng(5935);
+    uniform_int_distribution< int > rndByte(0, 255);
+    uniform_int_distribution< size_t > rndLen(0, 4096);
+
+    vector< uint8_t > buf(4096 + 8);
+    for(auto& b : buf)
+        b = rndByte(rng);
+
+    for(int i = 0; i < 2000; i++)
+    {
+        // Random length and alignment
+        size_t len = rndLen(rng);
+        size_t ofs = i % 8;
+        const uint8_t *ptr = buf.data() + ofs;
+
+        if(crc_ccitt(ptr, len) != ref_ccitt(ptr, len))
+        {
+            printf("CCITT CRC mismatch, length %zu\n", len);
+            return -1;
+        }
+
+        if(crc_m17(ptr, len) != ref_m17(ptr, len))
+        {
+            printf("M17 CRC mismatch, length %zu\n", len);
+            return -1;
+        }
+
+        buf[rndLen(rng)] = rndByte(rng);
+    }
+
+    return 0;
+}
+
+int test_streaming()
+{
+    default_random_engine rng(1021);
+    uniform_int_distribution< int > rndByte(0, 255);
+    uniform_int_distribution< size_t > rndChunk(0, 37);
+
+    vector< uint8_t > buf(3000);
+    for(auto& b : buf)
+        b = rndByte(rng);
+
+    for(int type = CRC_CCITT; type <= CRC_M17; type++)
+    {
+        for(int i = 0; i < 100; i++)
+        {
+            crc16_t crc;
+            crc_init(&crc, static_cast< crcType >(type));
+
+            size_t pos = 0;
+            while(pos < buf.size())
+            {
+                size_t len = rndChunk(rng);
+                if((pos + len) > buf.size())
+                    len = buf.size() - pos;
+
+                crc_update(&crc, &buf[pos], len);
+                pos += len;
+            }
+
+            uint16_t expected = (type == CRC_M17) ? ref_m17(buf.data(), buf.size())
+                                                  : ref_ccitt(buf.data(), buf.size());
+            if(crc_final(&crc) != expected)
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    if(test_vectors())
+    {
+        printf("Error in CRC test vectors!\n");
+        return -1;
+    }
+
+    if(test_crossValidation())
+    {
+        printf("Error in CRC cross validation!\n");
+        return -1;
+    }
+
+    if(test_streaming())
+    {
+        printf("Error in CRC streaming computation!\n");
+        return -1;
+    }
+
+    return 0;
+}
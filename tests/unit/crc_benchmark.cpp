@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include <crc.h>
+#include "benchmark.hpp"
+
+using namespace std;
+
+static constexpr size_t BLOCK_SIZE = 65536;  // Size of a large buffer, like a codeplug dump chunk
+static constexpr size_t LSF_SIZE   = 28;     // Size of the CRC-protected part of the M17 LSF
+static constexpr size_t NUM_ITER   = 200;
+static constexpr size_t LSF_ITER   = NUM_ITER * (BLOCK_SIZE / LSF_SIZE);  // Same amount of data as the large buffer
+
+/**
+ * Bit-serial CCITT CRC, as previously implemented.
+ */
+static uint16_t ref_ccitt(const uint8_t *buf, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+/**
+ * Bitwise M17 CRC, as previously implemented in the link setup frame.
+ */
+static uint16_t ref_m17(const uint8_t *buf, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= (buf[i] << 8);
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            if(crc & 0x8000)
+                crc = (crc << 1) ^ 0x5935;
+            else
+                crc = (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< int > rndByte(0, 255);
+
+    static array< uint8_t, BLOCK_SIZE > buf;
+    for(auto& b : buf)
+        b = rndByte(rng);
+
+    volatile uint16_t sink;
+
+    double ccittRef = measure([&]() { sink = ref_ccitt(buf.data(), BLOCK_SIZE); }, NUM_ITER, BLOCK_SIZE);
+    double ccittTab = measure([&]() { sink = crc_ccitt(buf.data(), BLOCK_SIZE); }, NUM_ITER, BLOCK_SIZE);
+    double m17Ref   = measure([&]() { sink = ref_m17(buf.data(), BLOCK_SIZE);   }, NUM_ITER, BLOCK_SIZE);
+    double m17Tab   = measure([&]() { sink = crc_m17(buf.data(), BLOCK_SIZE);   }, NUM_ITER, BLOCK_SIZE);
+    double lsfRef   = measure([&]() { sink = ref_m17(buf.data(), LSF_SIZE);     }, LSF_ITER, LSF_SIZE);
+    double lsfTab   = measure([&]() { sink = crc_m17(buf.data(), LSF_SIZE);     }, LSF_ITER, LSF_SIZE);
+    (void) sink;
+
+    #if defined(__x86_64__) || defined(__i386__)
+    printf("CRC cost, cycles per byte\n");
+    #else
+    printf("CRC cost, nanoseconds per byte\n");
+    #endif
+
+    printf("CCITT, 64kB block:  reference %6.2f, table %6.2f\n", ccittRef, ccittTab);
+    printf("M17,   64kB block:  reference %6.2f, table %6.2f\n", m17Ref, m17Tab);
+    printf("M17,   LSF:         reference %6.2f, table %6.2f\n", lsfRef, lsfTab);
+
+    return 0;
+}
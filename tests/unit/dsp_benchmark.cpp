@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include "M17/M17DSP.hpp"
+#include "fir.hpp"
+#include "dsp.h"
+#include "benchmark.hpp"
+
+using namespace std;
+
+static constexpr size_t BLOCK_SIZE = 960;    // Samples per demodulator update
+static constexpr size_t NUM_BLOCKS = 2000;
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< int16_t > rndValue(-4000, 4000);
+
+    array< int16_t, BLOCK_SIZE > input;
+    array< int16_t, BLOCK_SIZE > buffer;
+    array< float,   BLOCK_SIZE > fltIn;
+    array< float,   BLOCK_SIZE > fltBuf;
+    for(size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        input[i] = rndValue(rng);
+        fltIn[i] = static_cast< float >(input[i]);
+    }
+
+    filter_state_t state;
+    dsp_resetFilterState(&state);
+
+    // Microphone conditioning: separate gain and DC removal passes against
+    // the fused kernel.
+    double gainDcr = measure([&]()
+    {
+        buffer = input;
+        for(size_t i = 0; i < BLOCK_SIZE; i++) buffer[i] *= 8;
+        dsp_dcRemoval(&state, buffer.data(), BLOCK_SIZE);
+        for(size_t i = 0; i < BLOCK_SIZE; i++) buffer[i] *= 4;
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double gainDcrFused = measure([&]()
+    {
+        buffer = input;
+        dsp_dcRemovalGain(&state, buffer.data(), BLOCK_SIZE, 8, 4);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double copy = measure([&]()
+    {
+        buffer = input;
+        __asm__ volatile("" : : "r"(buffer.data()) : "memory");
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double dcr = measure([&]()
+    {
+        dsp_dcRemoval(&state, buffer.data(), BLOCK_SIZE);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double gain = measure([&]()
+    {
+        dsp_applyGain(buffer.data(), BLOCK_SIZE, 3);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double invert = measure([&]()
+    {
+        dsp_invertPhase(buffer.data(), BLOCK_SIZE);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double fromFloat = measure([&]()
+    {
+        dsp_fromFloat(fltIn.data(), buffer.data(), BLOCK_SIZE, -1.0f);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    // Demodulator front-end: separate inversion and Q15 RRC passes against
+    // the filter with the inversion folded in.
+    FirQ15< tuple_size< decltype(M17::rrc_taps_24k) >::value >
+        rrcQ15(M17::rrc_taps_24k);
+
+    double invRrc = measure([&]()
+    {
+        buffer = input;
+        dsp_invertPhase(buffer.data(), BLOCK_SIZE);
+        rrcQ15.process(buffer.data(), buffer.data(), BLOCK_SIZE);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double invRrcFused = measure([&]()
+    {
+        buffer = input;
+        rrcQ15.process(buffer.data(), buffer.data(), BLOCK_SIZE, true);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    // Modulator shaping filter: per-sample filtering against the block kernel
+    Fir< tuple_size< decltype(M17::rrc_taps_48k) >::value >
+        rrcFlt(M17::rrc_taps_48k);
+
+    double rrcSample = measure([&]()
+    {
+        for(size_t i = 0; i < BLOCK_SIZE; i++) fltBuf[i] = rrcFlt(fltIn[i]);
+        __asm__ volatile("" : : "r"(fltBuf.data()) : "memory");
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double rrcBlock = measure([&]()
+    {
+        rrcFlt.process(fltIn.data(), fltBuf.data(), BLOCK_SIZE);
+        __asm__ volatile("" : : "r"(fltBuf.data()) : "memory");
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    #if defined(__x86_64__) || defined(__i386__)
+    printf("DSP kernels cost, cycles per sample\n");
+    #else
+    printf("DSP kernels cost, nanoseconds per sample\n");
+    #endif
+
+    printf("dcRemoval                  %7.2f\n", dcr);
+    printf("applyGain                  %7.2f\n", gain);
+    printf("invertPhase                %7.2f\n", invert);
+    printf("fromFloat                  %7.2f\n", fromFloat);
+    printf("block copy (subtracted)    %7.2f\n", copy);
+    printf("gain + dcr + gain:   separate %7.2f, fused %7.2f\n",
+           gainDcr - copy, gainDcrFused - copy);
+    printf("invert + RRC Q15:    separate %7.2f, fused %7.2f\n",
+           invRrc - copy, invRrcFused - copy);
+    printf("RRC float:           sample   %7.2f, block %7.2f\n",
+           rrcSample, rrcBlock);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include "M17/M17DSP.hpp"
+#include "fir.hpp"
+#include "benchmark.hpp"
+
+using namespace std;
+
+static constexpr size_t BLOCK_SIZE = 960;    // Samples per demodulator update
+static constexpr size_t NUM_BLOCKS = 2000;
+
+/**
+ * Former FIR implementation, using a circular history buffer, used as a
+ * baseline for the measurements.
+ */
+template < size_t N >
+class CircularFir
+{
+public:
+
+    CircularFir(const array< float, N >& taps) : taps(taps), pos(0)
+    {
+        hist.fill(0);
+    }
+
+    float operator()(const float input)
+    {
+        hist[pos] = input;
+        pos = (pos + 1) % N;
+
+        float  result = 0.0;
+        size_t index  = pos;
+
+        for(size_t i = 0; i < N; i++)
+        {
+            index   = (index != 0 ? index - 1 : N - 1);
+            result += hist[index] * taps[i];
+        }
+
+        return result;
+    }
+
+private:
+
+    const array< float, N >& taps;
+    array< float, N >        hist;
+    size_t                   pos;
+};
+
+/**
+ * Measure the cost per sample of the different filter implementations for a
+ * given set of coefficients.
+ */
+template < size_t N >
+void benchmark(const array< float, N >& taps, const int16_t amplitude)
+{
+    default_random_engine rng;
+    uniform_int_distribution< int16_t > rndValue(-amplitude, amplitude);
+
+    array< int16_t, BLOCK_SIZE > input;
+    array< int16_t, BLOCK_SIZE > output;
+    array< float,   BLOCK_SIZE > fltBuf;
+    for(auto& sample : input)
+    {
+        sample = rndValue(rng);
+    }
+
+    CircularFir< N > circ(taps);
+    Fir< N >         flt(taps);
+    FirQ15< N >      q15(taps);
+
+    double circular = measure([&]()
+    {
+        for(size_t i = 0; i < BLOCK_SIZE; i++)
+        {
+            float elem = static_cast< float >(input[i]);
+            output[i]  = static_cast< int16_t >(circ(elem));
+        }
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double fltBlock = measure([&]()
+    {
+        for(size_t i = 0; i < BLOCK_SIZE; i++)
+        {
+            fltBuf[i] = static_cast< float >(input[i]);
+        }
+
+        flt.process(fltBuf.data(), fltBuf.data(), BLOCK_SIZE);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    double q15Block = measure([&]()
+    {
+        q15.process(input.data(), output.data(), BLOCK_SIZE);
+    }, NUM_BLOCKS, BLOCK_SIZE);
+
+    printf("%3ld taps: circular %7.2f, float block %7.2f, Q15 block %7.2f\n",
+           N, circular, fltBlock, q15Block);
+}
+
+int main()
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    printf("FIR cost, cycles per sample\n");
+    #else
+    printf("FIR cost, nanoseconds per sample\n");
+    #endif
+
+    benchmark(M17::rrc_taps_24k, INT16_MAX);
+    benchmark(M17::rrc_taps_48k, 5000);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <array>
+#include "M17/M17DSP.hpp"
+#include "fir.hpp"
+
+using namespace std;
+
+default_random_engine rng;
+
+/**
+ * Reference FIR implementation, using a circular history buffer.
+ */
+template < size_t N >
+class RefFir
+{
+public:
+
+    RefFir(const array< float, N >& taps) : taps(taps), pos(0)
+    {
+        hist.fill(0);
+    }
+
+    float operator()(const float input)
+    {
+        hist[pos] = input;
+        pos = (pos + 1) % N;
+
+        float  result = 0.0;
+        size_t index  = pos;
+
+        for(size_t i = 0; i < N; i++)
+        {
+            index   = (index != 0 ? index - 1 : N - 1);
+            result += hist[index] * taps[i];
+        }
+
+        return result;
+    }
+
+private:
+
+    const array< float, N >& taps;
+    array< float, N >        hist;
+    size_t                   pos;
+};
+
+/**
+ * Check that the float block filter gives the same output of the reference
+ * implementation and that the Q15 one stays within a given tolerance.
+ */
+template < size_t N >
+bool testFilter(const array< float, N >& taps, const int16_t amplitude)
+{
+    static constexpr size_t NUM_SAMPLES = 4096;
+    static constexpr size_t BLOCK_SIZE  = 100;
+
+    uniform_int_distribution< int16_t > rndValue(-amplitude, amplitude);
+    array< int16_t, NUM_SAMPLES > input;
+    for(auto& sample : input)
+    {
+        sample = rndValue(rng);
+    }
+
+    RefFir< N > ref(taps);
+    Fir< N >    flt(taps);
+    FirQ15< N > q15(taps);
+
+    array< float, BLOCK_SIZE >   fltBlock;
+    array< int16_t, BLOCK_SIZE > q15Block;
+
+    for(size_t i = 0; i < NUM_SAMPLES; i += BLOCK_SIZE)
+    {
+        size_t len = min(BLOCK_SIZE, NUM_SAMPLES - i);
+
+        for(size_t j = 0; j < len; j++)
+        {
+            fltBlock[j] = static_cast< float >(input[i + j]);
+        }
+
+        flt.process(fltBlock.data(), fltBlock.data(), len);
+        q15.process(&input[i], q15Block.data(), len);
+
+        for(size_t j = 0; j < len; j++)
+        {
+            float expected = ref(static_cast< float >(input[i + j]));
+            if(fltBlock[j] != expected)
+            {
+                printf("Float mismatch at %ld: got %f, expected %f\n", i + j,
+                       fltBlock[j], expected);
+                return false;
+            }
+
+            // Tolerance accounts for coefficient quantization and rounding
+            int32_t error = static_cast< int32_t >(expected) - q15Block[j];
+            if(abs(error) > (2 + (amplitude * N) / 65536))
+            {
+                printf("Q15 mismatch at %ld: got %d, expected %f\n", i + j,
+                       q15Block[j], expected);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    // Dot product kernel against scalar computation, all lengths up to 100
+    uniform_int_distribution< int16_t > rndValue(INT16_MIN, INT16_MAX);
+    array< int16_t, 100 > x;
+    array< int16_t, 100 > h;
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        x[i] = rndValue(rng);
+        h[i] = rndValue(rng) / 128;
+    }
+
+    for(size_t n = 0; n <= x.size(); n++)
+    {
+        int32_t expected = 0;
+        for(size_t i = 0; i < n; i++)
+        {
+            expected += static_cast< int32_t >(x[i]) * h[i];
+        }
+
+        if(fir_dotProductQ15(x.data(), h.data(), n) != expected)
+        {
+            printf("Dot product mismatch for length %ld\n", n);
+            return -1;
+        }
+    }
+
+    if(testFilter(M17::rrc_taps_24k, INT16_MAX) == false) return -1;
+    if(testFilter(M17::rrc_taps_48k, 5000) == false)      return -1;
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <emulator/sdl_engine.h>
+#include <graphics.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Measure the amount of framebuffer data sent to the display for some typical
+ * UI update patterns. Each frame is drawn like the UI does, clearing and
+ * redrawing the whole screen, and then rendered through gfx_render(); bytes
+ * are counted by the SDL display driver. The figures are compared against a
+ * full framebuffer transfer per frame.
+ */
+
+#define NUM_FRAMES 100
+
+static const color_t white  = {255, 255, 255, 255};
+static const color_t yellow = {250, 180,  19, 255};
+
+typedef struct
+{
+    int   page;         // Screen page being shown, 0 = main screen
+    int   seconds;      // Time shown in the top bar
+    float rssi;         // Signal strength shown by the S-meter
+}
+scenarioState_t;
+
+/**
+ * Draw a screen similar to the main VFO screen or, for a non zero page, to
+ * one of the menu pages.
+ */
+static void drawScreen(const scenarioState_t *state)
+{
+    gfx_clearScreen();
+
+    // Top bar with clock and battery
+    point_t clockPos = {0, 5};
+    gfx_print(clockPos, FONT_SIZE_5PT, TEXT_ALIGN_CENTER, white,
+              "%02d:%02d:%02d", (state->seconds / 3600) % 24,
+              (state->seconds / 60) % 60, state->seconds % 60);
+
+    point_t batteryPos = {SCREEN_WIDTH - 21, 1};
+    gfx_drawBattery(batteryPos, 19, 9, 80);
+    gfx_drawHLine(11, 1, white);
+
+    if(state->page != 0)
+    {
+        for(int i = 0; i < 5; i++)
+        {
+            point_t itemPos = {2, 28 + (i * 18)};
+            color_t color   = (i == (state->page % 5)) ? yellow : white;
+            gfx_print(itemPos, FONT_SIZE_8PT, TEXT_ALIGN_LEFT, color,
+                      "Menu entry %d", i + (state->page * 5));
+        }
+
+        return;
+    }
+
+    // Channel and frequency
+    point_t namePos = {0, 30};
+    gfx_print(namePos, FONT_SIZE_8PT, TEXT_ALIGN_CENTER, white, "VFO");
+    point_t freqPos = {0, 60};
+    gfx_print(freqPos, FONT_SIZE_10PT, TEXT_ALIGN_CENTER, white,
+              "430.0125");
+
+    // S-meter at the bottom of the screen
+    point_t smeterPos = {2, SCREEN_HEIGHT - 24};
+    gfx_drawSmeter(smeterPos, SCREEN_WIDTH - 4, 16, state->rssi, 0.1f,
+                   0.5f, true, yellow);
+}
+
+/**
+ * Render a number of frames, updating the screen state with the given step
+ * function before each of them.
+ *
+ * @return average number of bytes sent to the display per frame.
+ */
+static size_t runScenario(scenarioState_t *state,
+                          void (*step)(scenarioState_t *, int))
+{
+    // Start from a screen already in sync with the framebuffer
+    drawScreen(state);
+    gfx_render();
+
+    size_t start = display_bytesPushed();
+
+    for(int i = 0; i < NUM_FRAMES; i++)
+    {
+        step(state, i);
+        drawScreen(state);
+        gfx_render();
+    }
+
+    return (display_bytesPushed() - start) / NUM_FRAMES;
+}
+
+static void stepIdle(scenarioState_t *state, int frame)
+{
+    (void) state;
+    (void) frame;
+}
+
+static void stepSmeter(scenarioState_t *state, int frame)
+{
+    // S-meter updates happen ten times per second, clock changes every ten
+    state->rssi = -120.0f + (float) ((frame * 7) % 60);
+    if((frame % 10) == 0) state->seconds += 1;
+}
+
+static void stepClock(scenarioState_t *state, int frame)
+{
+    (void) frame;
+    state->seconds += 1;
+}
+
+static void stepPages(scenarioState_t *state, int frame)
+{
+    state->page = frame % 4;
+}
+
+int main()
+{
+    scenarioState_t state = {0, 43200, -110.0f};
+
+    gfx_init();
+
+    // Cost of a full framebuffer transfer
+    size_t start = display_bytesPushed();
+    gfx_renderRows(0, SCREEN_HEIGHT);
+    size_t fullFrame = display_bytesPushed() - start;
+
+    struct
+    {
+        const char *name;
+        void (*step)(scenarioState_t *, int);
+    }
+    scenarios[] =
+    {
+        { "Idle redraw   ", stepIdle   },
+        { "S-meter update", stepSmeter },
+        { "Clock tick    ", stepClock  },
+        { "Page change   ", stepPages  },
+    };
+
+    printf("Scenario       | bytes/frame | full frame | ratio\n");
+
+    int ret = 0;
+    for(size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        size_t bytes = runScenario(&state, scenarios[i].step);
+
+        printf("%s | %11zu | %10zu | %5.1f%%\n", scenarios[i].name, bytes,
+               fullFrame, (100.0 * bytes) / fullFrame);
+
+        // Unchanged frames must not reach the display
+        if((scenarios[i].step == stepIdle) && (bytes != 0))
+            ret = -1;
+
+        if(bytes > fullFrame)
+            ret = -1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,236 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/display.h>
+#include <graphics.h>
+#include <gfxfont.h>
+#include <UbuntuRegular6pt7b.h>
+#include <UbuntuRegular8pt7b.h>
+#include <UbuntuRegular12pt7b.h>
+#include <Symbols6pt7b.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Measure the text rendering throughput of gfx_printBuffer() and compare it
+ * with a reference renderer drawing the font bitmaps pixel by pixel through
+ * gfx_setPixel(), as done before the introduction of the glyph cache. The
+ * output of the two renderers is also checked to be the same.
+ */
+
+#define NUM_ROUNDS 2000
+
+static const char *strings[] =
+{
+    "430.0125", "12:34:56", "M17 IU2KWO", "Bank 1 Ch 23", "-121dBm",
+    "CTCSS 88.5", "Volume", "S9+20", "FM 25kHz", "Battery 87%"
+};
+
+#define NUM_STRINGS (sizeof(strings) / sizeof(strings[0]))
+
+typedef struct
+{
+    const char    *name;
+    fontSize_t     size;
+    const GFXfont *font;
+}
+fontInfo_t;
+
+static const fontInfo_t testFonts[] =
+{
+    { "Ubuntu 6pt  ", FONT_SIZE_6PT,  &UbuntuRegular6pt7b  },
+    { "Ubuntu 8pt  ", FONT_SIZE_8PT,  &UbuntuRegular8pt7b  },
+    { "Ubuntu 12pt ", FONT_SIZE_12PT, &UbuntuRegular12pt7b },
+    { "Symbols 6pt ", FONT_SIZE_24PT + 1 + SYMBOLS_SIZE_6PT, &Symbols6pt7b },
+};
+
+#define NUM_FONTS (sizeof(testFonts) / sizeof(testFonts[0]))
+
+static inline double timeSec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + ((double) ts.tv_nsec / 1000000000.0);
+}
+
+/**
+ * Reference text renderer: single line, left aligned text drawn one pixel at
+ * a time.
+ */
+static void refPrint(point_t start, const GFXfont *f, color_t color,
+                     const char *str)
+{
+    for(size_t i = 0; str[i] != '\0'; i++)
+    {
+        const GFXglyph *glyph = &f->glyph[str[i] - f->first];
+        uint16_t bo   = glyph->bitmapOffset;
+        uint8_t  bits = 0;
+        uint8_t  bit  = 0;
+
+        for(uint8_t yy = 0; yy < glyph->height; yy++)
+        {
+            for(uint8_t xx = 0; xx < glyph->width; xx++)
+            {
+                if(!(bit++ & 7))
+                    bits = f->bitmap[bo++];
+
+                int16_t x = start.x + glyph->xOffset + xx;
+                int16_t y = start.y + glyph->yOffset + yy;
+
+                if((bits & 0x80) && (x > 0) && (y > 0) &&
+                   (x < SCREEN_WIDTH) && (y < SCREEN_HEIGHT))
+                {
+                    point_t pos = {x, y};
+                    gfx_setPixel(pos, color);
+                }
+
+                bits <<= 1;
+            }
+        }
+
+        start.x += glyph->xAdvance;
+    }
+}
+
+/**
+ * Symbol fonts only have glyphs for a few characters, remap the test strings
+ * to their range.
+ */
+static void makeString(const fontInfo_t *font, const char *in, char *out)
+{
+    uint16_t first = font->font->first;
+    uint16_t range = font->font->last - first + 1;
+    size_t i;
+
+    for(i = 0; in[i] != '\0'; i++)
+    {
+        if(in[i] > font->font->last)
+            out[i] = first + (in[i] % range);
+        else
+            out[i] = in[i];
+    }
+
+    out[i] = '\0';
+}
+
+int main()
+{
+    static const color_t white = {255, 255, 255, 255};
+
+    gfx_init();
+
+    uint8_t *fb        = (uint8_t *) display_getFrameBuffer();
+    size_t   fbSize    = SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t);
+    uint8_t *reference = (uint8_t *) malloc(fbSize);
+    char     str[NUM_STRINGS][32];
+    int      ret       = 0;
+
+    printf("Font         | reference glyphs/s | cached glyphs/s | speedup\n");
+
+    for(size_t f = 0; f < NUM_FONTS; f++)
+    {
+        const fontInfo_t *font = &testFonts[f];
+        size_t numGlyphs = 0;
+
+        for(size_t s = 0; s < NUM_STRINGS; s++)
+        {
+            makeString(font, strings[s], str[s]);
+            numGlyphs += strlen(str[s]);
+        }
+
+        // Check that both renderers produce the same output
+        for(size_t s = 0; s < NUM_STRINGS; s++)
+        {
+            point_t pos = {(int16_t) ((s % 3) * 2) - 2, (int16_t) (s * 13 + 5)};
+
+            gfx_clearScreen();
+            refPrint(pos, font->font, white, str[s]);
+            memcpy(reference, fb, fbSize);
+
+            gfx_clearScreen();
+            gfx_printBuffer(pos, font->size, TEXT_ALIGN_LEFT, white, str[s]);
+
+            if(memcmp(reference, fb, fbSize) != 0)
+            {
+                printf("Error: mismatch for font %s, string \"%s\"\n",
+                       font->name, str[s]);
+                ret = -1;
+            }
+        }
+
+        double start = timeSec();
+        for(int r = 0; r < NUM_ROUNDS; r++)
+        {
+            for(size_t s = 0; s < NUM_STRINGS; s++)
+            {
+                point_t pos = {2, (int16_t) (10 + s * 11)};
+                refPrint(pos, font->font, white, str[s]);
+            }
+        }
+
+        double refTime = timeSec() - start;
+
+        start = timeSec();
+        for(int r = 0; r < NUM_ROUNDS; r++)
+        {
+            for(size_t s = 0; s < NUM_STRINGS; s++)
+            {
+                point_t pos = {2, (int16_t) (10 + s * 11)};
+                gfx_printBuffer(pos, font->size, TEXT_ALIGN_LEFT, white, str[s]);
+            }
+        }
+
+        double newTime = timeSec() - start;
+        double glyphs  = (double) numGlyphs * NUM_ROUNDS;
+
+        printf("%s | %18.0f | %15.0f | %6.2fx\n", font->name,
+               glyphs / refTime, glyphs / newTime, refTime / newTime);
+    }
+
+    // Cost of the string formatting done by gfx_print()
+    double start = timeSec();
+    for(int r = 0; r < NUM_ROUNDS * 10; r++)
+    {
+        point_t pos = {2, 20};
+        gfx_print(pos, FONT_SIZE_8PT, TEXT_ALIGN_LEFT, white, "%s", "Volume");
+    }
+
+    double fmtTime = timeSec() - start;
+
+    start = timeSec();
+    for(int r = 0; r < NUM_ROUNDS * 10; r++)
+    {
+        point_t pos = {2, 20};
+        gfx_print(pos, FONT_SIZE_8PT, TEXT_ALIGN_LEFT, white, "Volume");
+    }
+
+    double plainTime = timeSec() - start;
+
+    printf("gfx_print: %.2f us with format, %.2f us plain string\n",
+           (fmtTime * 1e6) / (NUM_ROUNDS * 10),
+           (plainTime * 1e6) / (NUM_ROUNDS * 10));
+
+    free(reference);
+
+    return ret;
+}
@@ -0,0 +1,396 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <peripherals/gps.h>
+#include <interfaces/delays.h>
+#include <gps_parser.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char nmeaStream[] =
+    "$GPGGA,223659.000,5333.735,N,00959.130,E,1,12,1.0,0.0,M,0.0,M,,*6F\r\n"
+    "$GPGSA,A,3,01,02,03,04,05,06,07,08,09,10,11,12,1.0,1.0,1.0*30\r\n"
+    "$GPGSV,3,1,12,30,79,066,27,05,63,275,21,07,42,056,,13,40,289,13*76\r\n"
+    "$GPGSV,3,2,12,14,36,147,20,28,30,151,,09,13,100,,02,08,226,30*72\r\n"
+    "$GPGSV,3,3,12,18,05,333,,15,04,289,22,08,03,066,,27,02,030,*79\r\n"
+    "$GPRMC,223659.000,A,5333.735,N,00959.130,E,0.15,92.15,160221,000.0,W*6C\r\n"
+    "$GPVTG,92.15,T,,M,0.15,N,0.28,K,A*0C\r\n"
+    "$PMTK010,002*2D\r\n"
+    "$GPGGA,223700.000,5333.736,N,00959.131,E,1,12,1.0,0.0,M,0.0,M,,*6E\r\n"
+    "$GPGSA,A,3,01,02,03,04,05,06,07,08,09,10,11,12,1.0,1.0,1.0*30\r\n"
+    "$GPGSV,3,1,12,30,79,066,27,05,63,275,21,07,42,056,,13,40,289,13*76\r\n"
+    "$GPGSV,3,2,12,14,36,147,20,28,30,151,,09,13,100,,02,08,226,30*72\r\n"
+    "$GPGSV,3,3,12,18,05,333,,15,04,289,22,08,03,066,,27,02,030,*79\r\n"
+    "$GPRMC,223700.000,A,5333.736,N,00959.131,E,0.15,92.15,160221,000.0,W*6D\r\n"
+    "$GPVTG,92.15,T,,M,0.15,N,0.28,K,A*0C\r\n";
+
+static gpsParser_t parser;
+
+/**
+ * Fix the checksums of an NMEA stream, to allow writing the test sentences
+ * without computing them by hand.
+ */
+static void fixChecksums(char *stream)
+{
+    char   *ptr = stream;
+    uint8_t ck  = 0;
+
+    for(; *ptr != '\0'; ptr++)
+    {
+        if(*ptr == '$')
+        {
+            ck = 0;
+        }
+        else if(*ptr == '*')
+        {
+            char hex[3];
+            snprintf(hex, sizeof(hex), "%02X", ck);
+            ptr[1] = hex[0];
+            ptr[2] = hex[1];
+            ptr   += 2;
+        }
+        else if((*ptr != '\r') && (*ptr != '\n'))
+        {
+            ck ^= *ptr;
+        }
+    }
+}
+
+static size_t buildUbx(uint8_t *buf, const uint8_t cls, const uint8_t id,
+                       const uint8_t *payload, const uint16_t len)
+{
+    buf[0] = 0xB5;
+    buf[1] = 0x62;
+    buf[2] = cls;
+    buf[3] = id;
+    buf[4] = len & 0xFF;
+    buf[5] = len >> 8;
+    memcpy(&buf[6], payload, len);
+
+    uint8_t ckA = 0;
+    uint8_t ckB = 0;
+    for(size_t i = 2; i < (size_t) (len + 6); i++)
+    {
+        ckA += buf[i];
+        ckB += ckA;
+    }
+
+    buf[len + 6] = ckA;
+    buf[len + 7] = ckB;
+
+    return len + 8;
+}
+
+static void putU32(uint8_t *buf, const uint32_t value)
+{
+    buf[0] = value & 0xFF;
+    buf[1] = (value >> 8)  & 0xFF;
+    buf[2] = (value >> 16) & 0xFF;
+    buf[3] = (value >> 24) & 0xFF;
+}
+
+int test_nmeaEpochs()
+{
+    static char stream[sizeof(nmeaStream)];
+    memcpy(stream, nmeaStream, sizeof(nmeaStream));
+    fixChecksums(stream);
+
+    gpsParser_init(&parser, NULL, 0);
+
+    gps_t  fix;
+    int    epochs = 0;
+    size_t pos    = 0;
+    size_t len    = strlen(stream);
+
+    for(; pos < len; pos++)
+    {
+        if(gpsParser_feed(&parser, stream[pos], &fix) == false)
+            continue;
+
+        epochs++;
+        if(epochs == 1)
+        {
+            // First epoch is closed by the time change of the following GGA
+            if((fix.timestamp.hour != 22) || (fix.timestamp.minute != 36) ||
+               (fix.timestamp.second != 59))
+                return -1;
+        }
+    }
+
+    // Second epoch is closed by its last sentence, without waiting for the
+    // next one.
+    if((epochs != 2) || (parser.numEpochs != 2) || (parser.numErrors != 0))
+    {
+        printf("Epochs: %d, errors %u\n", epochs, parser.numErrors);
+        return -1;
+    }
+
+    if((fix.timestamp.minute != 37) || (fix.timestamp.second != 0) ||
+       (fix.timestamp.date != 16) || (fix.timestamp.month != 2) ||
+       (fix.timestamp.year != 21))
+        return -1;
+
+    if((fix.fix_quality != 1) || (fix.fix_type != 3) ||
+       (fix.satellites_tracked != 12) || (fix.satellites_in_view != 12))
+        return -1;
+
+    // Satellites from all the three GSV sentences
+    if((fix.satellites[0].id != 30) || (fix.satellites[0].snr != 27) ||
+       (fix.satellites[4].id != 14) || (fix.satellites[7].snr != 30) ||
+       (fix.satellites[8].id != 18) || (fix.satellites[9].snr != 22) ||
+       (fix.satellites[11].id != 27))
+        return -1;
+
+    if((fix.latitude  < 53.5622f) || (fix.latitude  > 53.5623f) ||
+       (fix.longitude < 9.98551f) || (fix.longitude > 9.98553f))
+        return -1;
+
+    // Speed and course from VTG
+    if((fix.speed < 0.279f) || (fix.speed > 0.281f) || (fix.tmg_true != 92.15f))
+        return -1;
+
+    return 0;
+}
+
+int test_errors()
+{
+    static char stream[sizeof(nmeaStream)];
+    memcpy(stream, nmeaStream, sizeof(nmeaStream));
+    fixChecksums(stream);
+
+    // Corrupt the GSA sentence of the second epoch and truncate one of its
+    // GSV sentences
+    char *gga = strstr(stream, "$GPGGA,223700");
+    char *gsa = strstr(gga, "$GPGSA");
+    gsa[20]   = '9';
+    char *gsv = strstr(gsa, "$GPGSV,3,2");
+    gsv[30]   = '\n';
+
+    gpsParser_init(&parser, NULL, 0);
+
+    gps_t fix;
+    int   epochs = 0;
+    for(size_t pos = 0; pos < strlen(stream); pos++)
+    {
+        if(gpsParser_feed(&parser, stream[pos], &fix))
+            epochs++;
+    }
+
+    if((parser.numErrors != 2) || (epochs != 2))
+        return -1;
+
+    // Second epoch is still closed by VTG
+    if((fix.timestamp.second != 0) || (fix.latitude < 53.5622f) ||
+       (fix.longitude < 9.98551f))
+        return -1;
+
+    // Garbage data
+    uint8_t garbage[512];
+    for(size_t i = 0; i < sizeof(garbage); i++)
+        garbage[i] = (i * 131) & 0xFF;
+
+    gpsParser_feedBlock(&parser, garbage, sizeof(garbage), &fix);
+
+    // Parser recovers at the start of the next sentence
+    uint32_t parsed = parser.numParsed;
+    const char *vtg = "$GPVTG,90.00,T,,M,1.00,N,1.85,K,A*00\r\n";
+    char sentence[64];
+    strcpy(sentence, vtg);
+    fixChecksums(sentence);
+    gpsParser_feedBlock(&parser, (const uint8_t *) sentence, strlen(sentence), &fix);
+
+    return (parser.numParsed == (parsed + 1)) ? 0 : -1;
+}
+
+int test_ubx()
+{
+    uint8_t payload[92] = {0};
+    putU32(&payload[0], 123456);
+    payload[4]  = 2023 & 0xFF;
+    payload[5]  = 2023 >> 8;
+    payload[6]  = 5;        // Month
+    payload[7]  = 14;       // Day
+    payload[8]  = 10;       // Hour
+    payload[9]  = 20;       // Minute
+    payload[10] = 30;       // Second
+    payload[11] = 0x07;     // Valid date and time
+    payload[20] = 3;        // 3D fix
+    payload[21] = 0x01;     // gnssFixOK
+    payload[23] = 9;        // Satellites
+    putU32(&payload[24], (uint32_t) 96000000);      // Longitude, 9.6°
+    putU32(&payload[28], (uint32_t) -453000000);    // Latitude, -45.3°
+    putU32(&payload[36], 125500);                   // Height, 125.5m
+    putU32(&payload[60], 10000);                    // Speed, 10m/s
+    putU32(&payload[64], 9000000);                  // Heading, 90°
+
+    uint8_t msg[128];
+    size_t  len = buildUbx(msg, 0x01, 0x07, payload, sizeof(payload));
+
+    // Interleave with an unrelated UBX message and some NMEA data
+    uint8_t other[8] = {0};
+    uint8_t stream[256];
+    size_t  pos = buildUbx(stream, 0x01, 0x35, other, sizeof(other));
+    memcpy(&stream[pos], "$GPTXT,01*00\r\n", 14);
+    pos += 14;
+    memcpy(&stream[pos], msg, len);
+    pos += len;
+
+    gpsParser_init(&parser, NULL, 0);
+
+    gps_t fix;
+    if(gpsParser_feedBlock(&parser, stream, pos, &fix) == false)
+        return -1;
+
+    if((fix.timestamp.year != 23) || (fix.timestamp.month != 5) ||
+       (fix.timestamp.date != 14) || (fix.timestamp.hour != 10) ||
+       (fix.timestamp.minute != 20) || (fix.timestamp.second != 30))
+        return -1;
+
+    if((fix.fix_quality != 1) || (fix.fix_type != 3) ||
+       (fix.satellites_tracked != 9))
+        return -1;
+
+    if((fix.longitude < 9.5999f) || (fix.longitude > 9.6001f) ||
+       (fix.latitude > -45.2999f) || (fix.latitude < -45.3001f) ||
+       (fix.altitude != 125.5f) || (fix.speed != 36.0f) ||
+       (fix.tmg_true != 90.0f))
+        return -1;
+
+    // Corrupted checksum
+    msg[len - 1] ^= 0x55;
+    if(gpsParser_feedBlock(&parser, msg, len, &fix) == true)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Replay the data coming from the emulated GPS receiver, reading it with the
+ * same period used by the device management thread.
+ */
+int test_replay()
+{
+    gps_init(9600);
+    gps_enable();
+    gpsParser_init(&parser, NULL, 0);
+
+    long long start     = getTick();
+    long long lastEpoch = 0;
+    long long parseTime = 0;
+    long long bytes     = 0;
+
+    while((getTick() - start) < 3500)
+    {
+        uint8_t data[32];
+        size_t  len;
+        gps_t   fix;
+
+        while((len = gps_readData(data, sizeof(data))) > 0)
+        {
+            struct timespec t0, t1;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            bool newFix = gpsParser_feedBlock(&parser, data, len, &fix);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+
+            parseTime += (t1.tv_sec - t0.tv_sec) * 1000000000LL
+                       + (t1.tv_nsec - t0.tv_nsec);
+            bytes     += len;
+
+            if(newFix)
+                lastEpoch = getTick();
+        }
+
+        sleepFor(0u, 50u);
+    }
+
+    gps_disable();
+
+    float elapsed = (getTick() - start) / 1000.0f;
+    printf("Replay: %u sentences, %u epochs, %u errors in %.1fs\n",
+           parser.numParsed, parser.numEpochs, parser.numErrors, elapsed);
+    printf("Replay: %.1f sentences/s, %lld bytes, %.2fus per sentence\n",
+           parser.numParsed / elapsed, bytes,
+           (parseTime / 1000.0f) / parser.numParsed);
+
+    // One epoch per second, 7 sentences per epoch
+    if((parser.numErrors != 0) || (parser.numEpochs < 3) ||
+       (parser.numParsed < 3 * 7) || (lastEpoch == 0))
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Measure the parser throughput on a memory buffer.
+ */
+void benchmark()
+{
+    static char stream[sizeof(nmeaStream)];
+    memcpy(stream, nmeaStream, sizeof(nmeaStream));
+    fixChecksums(stream);
+
+    gpsParser_init(&parser, NULL, 0);
+
+    const size_t len    = strlen(stream);
+    const int    rounds = 20000;
+    gps_t        fix;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int i = 0; i < rounds; i++)
+        gpsParser_feedBlock(&parser, (const uint8_t *) stream, len, &fix);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("Throughput: %.0f sentences/s, %.1f MB/s\n",
+           parser.numParsed / secs, (len * rounds) / secs / 1e6);
+}
+
+int main()
+{
+    if(test_nmeaEpochs())
+    {
+        printf("Error in NMEA epoch assembly!\n");
+        return -1;
+    }
+
+    if(test_errors())
+    {
+        printf("Error in NMEA error handling!\n");
+        return -1;
+    }
+
+    if(test_ubx())
+    {
+        printf("Error in UBX parsing!\n");
+        return -1;
+    }
+
+    if(test_replay())
+    {
+        printf("Error in GPS replay!\n");
+        return -1;
+    }
+
+    benchmark();
+
+    return 0;
+}
@@ -0,0 +1,395 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <nvmem_journal.h>
+#include <posix_file.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define BANK_SIZE   512
+#define FILE_SIZE   (2 * BANK_SIZE)
+#define FILE_NAME   "journal_test.bin"
+#define KEY_A_SIZE  32
+#define KEY_B_SIZE  96
+
+/*
+ * NVM device wrapping the POSIX file driver, allowing to simulate a power loss
+ * after a given number of bytes have been written or erased.
+ */
+static int  budget   = -1;
+static bool powerOff = false;
+static int  erases[2];
+
+static int cut_read(const struct nvmDevice *dev, uint32_t offset, void *data,
+                    size_t len)
+{
+    return posix_file_api.read(dev, offset, data, len);
+}
+
+static int cut_write(const struct nvmDevice *dev, uint32_t offset,
+                     const void *data, size_t len)
+{
+    if(powerOff)
+        return -EIO;
+
+    if((budget >= 0) && (len > (size_t) budget))
+    {
+        // Only the first part of the data reaches the memory
+        if(budget > 0)
+            posix_file_api.write(dev, offset, data, budget);
+
+        powerOff = true;
+        return -EIO;
+    }
+
+    if(budget >= 0)
+        budget -= len;
+
+    return posix_file_api.write(dev, offset, data, len);
+}
+
+static int cut_erase(const struct nvmDevice *dev, uint32_t offset, size_t size)
+{
+    if(powerOff)
+        return -EIO;
+
+    erases[offset / BANK_SIZE] += 1;
+
+    if((budget >= 0) && (size > (size_t) budget))
+    {
+        // Erase interrupted halfway
+        posix_file_api.erase(dev, offset, size / 2);
+        powerOff = true;
+        return -EIO;
+    }
+
+    return posix_file_api.erase(dev, offset, size);
+}
+
+static const struct nvmParams *cut_params(const struct nvmDevice *dev)
+{
+    return posix_file_api.params(dev);
+}
+
+static const struct nvmApi cut_api =
+{
+    .read   = cut_read,
+    .write  = cut_write,
+    .erase  = cut_erase,
+    .sync   = NULL,
+    .params = cut_params
+};
+
+static int fd;
+static const struct posixFileCfg cfg =
+{
+    .fileName = FILE_NAME,
+    .fileSize = FILE_SIZE
+};
+
+static const struct nvmDevice testDevice =
+{
+    .config = &cfg,
+    .priv   = &fd,
+    .api    = &cut_api
+};
+
+static const struct nvmPartition testPartitions[] =
+{
+    { .offset = 0,         .size = BANK_SIZE },
+    { .offset = BANK_SIZE, .size = BANK_SIZE }
+};
+
+static const struct nvmArea testArea =
+{
+    .name       = "Journal test area",
+    .dev        = &testDevice,
+    .startAddr  = 0,
+    .size       = FILE_SIZE,
+    .partitions = testPartitions
+};
+
+static uint8_t keyA[KEY_A_SIZE];
+static uint8_t keyB[KEY_B_SIZE];
+
+static const struct nvmJournalKey testKeys[] =
+{
+    { keyA, KEY_A_SIZE },
+    { keyB, KEY_B_SIZE }
+};
+
+static nvmJournal_t journal;
+
+/**
+ * Simulate a device reboot: clear the RAM copies of the keys and reopen the
+ * journal.
+ */
+static int reboot()
+{
+    powerOff = false;
+    budget   = -1;
+
+    memset(keyA, 0x55, sizeof(keyA));
+    memset(keyB, 0x55, sizeof(keyB));
+
+    return nvmJournal_open(&journal, &testArea, 0, 1, testKeys, 2);
+}
+
+int test_basic()
+{
+    if(reboot() != -ENOENT)
+        return -1;
+
+    uint8_t a[KEY_A_SIZE];
+    uint8_t b[KEY_B_SIZE];
+    if(nvmJournal_read(&journal, 0, a) != -ENOENT)
+        return -1;
+
+    for(size_t i = 0; i < sizeof(a); i++) a[i] = i;
+    for(size_t i = 0; i < sizeof(b); i++) b[i] = i * 3;
+
+    if((nvmJournal_write(&journal, 0, a) < 0) ||
+       (nvmJournal_write(&journal, 1, b) < 0))
+        return -1;
+
+    // Unchanged value: nothing is written
+    uint32_t head = journal.head;
+    if((nvmJournal_write(&journal, 1, b) < 0) || (journal.head != head))
+        return -1;
+
+    // Single byte change: a record of nine bytes is appended
+    b[40] = 0xAA;
+    if((nvmJournal_write(&journal, 1, b) < 0) || (journal.head != (head + 9)))
+        return -1;
+
+    b[41] = 0x00;
+    b[50] = 0x00;
+    if(nvmJournal_write(&journal, 1, b) < 0)
+        return -1;
+
+    if(reboot() != 0)
+        return -1;
+
+    uint8_t tmp[KEY_B_SIZE];
+    if((nvmJournal_read(&journal, 0, tmp) < 0) || (memcmp(tmp, a, sizeof(a)) != 0))
+        return -1;
+
+    if((nvmJournal_read(&journal, 1, tmp) < 0) || (memcmp(tmp, b, sizeof(b)) != 0))
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Randomly update the keys, cutting the power at random points of the write
+ * operations. After each power cut the content of the store must be either the
+ * old or the new value of the key being written, all the other keys must be
+ * unchanged.
+ */
+int test_powerCut()
+{
+    uint8_t model[2][KEY_B_SIZE];
+    uint8_t value[KEY_B_SIZE];
+    uint8_t tmp[KEY_B_SIZE];
+    size_t  size[2] = { KEY_A_SIZE, KEY_B_SIZE };
+    int     cuts    = 0;
+
+    srand(1234);
+    erases[0] = 0;
+    erases[1] = 0;
+
+    reboot();
+    nvmJournal_read(&journal, 0, model[0]);
+    nvmJournal_read(&journal, 1, model[1]);
+
+    for(int i = 0; i < 20000; i++)
+    {
+        uint8_t key = rand() % 2;
+        memcpy(value, model[key], size[key]);
+
+        int changes = 1 + rand() % 4;
+        for(int j = 0; j < changes; j++)
+            value[rand() % size[key]] = rand();
+
+        if((rand() % 8) == 0)
+            budget = rand() % (BANK_SIZE + 64);
+
+        int ret = nvmJournal_write(&journal, key, value);
+        if(powerOff == false)
+        {
+            budget = -1;
+            if(ret < 0)
+                return -1;
+
+            memcpy(model[key], value, size[key]);
+            continue;
+        }
+
+        cuts++;
+        ret = reboot();
+        if(ret < 0)
+        {
+            printf("Journal lost after power cut %d\n", cuts);
+            return -1;
+        }
+
+        // Interrupted key: either old or new value
+        nvmJournal_read(&journal, key, tmp);
+        if(memcmp(tmp, model[key], size[key]) != 0)
+        {
+            if(memcmp(tmp, value, size[key]) != 0)
+            {
+                printf("Key %d corrupted after power cut %d\n", key, cuts);
+                return -1;
+            }
+
+            memcpy(model[key], value, size[key]);
+        }
+
+        // Other key untouched
+        uint8_t other = key ^ 1;
+        nvmJournal_read(&journal, other, tmp);
+        if(memcmp(tmp, model[other], size[other]) != 0)
+        {
+            printf("Key %d changed after power cut %d\n", other, cuts);
+            return -1;
+        }
+    }
+
+    if(reboot() < 0)
+        return -1;
+
+    for(uint8_t key = 0; key < 2; key++)
+    {
+        nvmJournal_read(&journal, key, tmp);
+        if(memcmp(tmp, model[key], size[key]) != 0)
+            return -1;
+    }
+
+    printf("%d power cuts, bank erases: %d, %d\n", cuts, erases[0], erases[1]);
+
+    // Wear is spread over the two banks
+    if(abs(erases[0] - erases[1]) > (cuts + 1))
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Once the spare bank has been prepared, the next compaction must not erase
+ * it again. An interrupted preparation must leave the data untouched.
+ */
+int test_prepare()
+{
+    uint8_t a[KEY_A_SIZE];
+    uint8_t b[KEY_B_SIZE];
+    uint8_t tmp[KEY_B_SIZE];
+
+    if(reboot() < 0)
+        return -1;
+
+    nvmJournal_read(&journal, 0, a);
+    nvmJournal_read(&journal, 1, b);
+
+    // After a compaction the spare bank holds the previous copy of the data
+    uint32_t compactions = journal.numCompactions;
+    while(journal.numCompactions == compactions)
+    {
+        b[rand() % KEY_B_SIZE] += 1;
+        if(nvmJournal_write(&journal, 1, b) < 0)
+            return -1;
+    }
+
+    // Interrupted erase of the spare bank
+    budget = BANK_SIZE / 4;
+    nvmJournal_prepare(&journal);
+    if((powerOff == false) || (reboot() < 0))
+        return -1;
+
+    if((nvmJournal_read(&journal, 0, tmp) < 0) || (memcmp(tmp, a, sizeof(a)) != 0))
+        return -1;
+    if((nvmJournal_read(&journal, 1, tmp) < 0) || (memcmp(tmp, b, sizeof(b)) != 0))
+        return -1;
+
+    uint8_t spare = journal.bank ^ 1;
+    if(nvmJournal_prepare(&journal) < 0)
+        return -1;
+
+    // Already erased, nothing to do
+    int count = erases[spare];
+    if((nvmJournal_prepare(&journal) < 0) || (erases[spare] != count))
+        return -1;
+
+    compactions = journal.numCompactions;
+    while(journal.numCompactions == compactions)
+    {
+        b[rand() % KEY_B_SIZE] += 1;
+        if(nvmJournal_write(&journal, 1, b) < 0)
+            return -1;
+    }
+
+    if((journal.bank != spare) || (erases[spare] != count))
+        return -1;
+
+    if(reboot() < 0)
+        return -1;
+
+    if((nvmJournal_read(&journal, 1, tmp) < 0) || (memcmp(tmp, b, sizeof(b)) != 0))
+        return -1;
+
+    return 0;
+}
+
+int main()
+{
+    unlink(FILE_NAME);
+    if(posixFile_init(&testDevice, NULL) < 0)
+    {
+        printf("Error opening test file!\n");
+        return -1;
+    }
+
+    int ret = 0;
+    if(test_basic())
+    {
+        printf("Error in journal basic operations!\n");
+        ret = -1;
+    }
+
+    if((ret == 0) && test_powerCut())
+    {
+        printf("Error in journal power cut test!\n");
+        ret = -1;
+    }
+
+    if((ret == 0) && test_prepare())
+    {
+        printf("Error in journal spare bank preparation!\n");
+        ret = -1;
+    }
+
+    posixFile_terminate(&testDevice);
+    unlink(FILE_NAME);
+
+    return ret;
+}
@@ -0,0 +1,267 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <interfaces/delays.h>
+#include <emulator/emulator.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <scan.h>
+#include <rtx.h>
+
+#define BASE_FREQ   430000000
+#define STEP_FREQ   25000
+#define NUM_STEPS   40
+#define LIVE_FREQ   (BASE_FREQ + 20 * STEP_FREQ)
+#define HOME_FREQ   433000000
+
+static pthread_mutex_t rtx_mutex;
+static rtxStatus_t     cfg;
+static bool            liveSignal = true;
+
+/**
+ * Run one RTX task step, feeding the emulated RSSI according to the frequency
+ * the radio is currently tuned to.
+ */
+static void rtxStep()
+{
+    rtxStatus_t status = rtx_getCurrentStatus();
+    if(liveSignal && (status.rxFrequency == LIVE_FREQ))
+        emulator_state.RSSI = -60.0f;
+    else
+        emulator_state.RSSI = -125.0f;
+
+    rtx_task();
+}
+
+static channel_t fmChannel(const char *name, freq_t freq)
+{
+    channel_t channel;
+    memset(&channel, 0x00, sizeof(channel_t));
+
+    channel.mode         = OPMODE_FM;
+    channel.bandwidth    = BW_25;
+    channel.power        = 100;
+    channel.rx_frequency = freq;
+    channel.tx_frequency = freq;
+    strncpy(channel.name, name, sizeof(channel.name) - 1);
+
+    return channel;
+}
+
+int test_rangeList()
+{
+    channel_t tpl = fmChannel("VFO", 145000000);
+    tpl.tx_frequency = 144400000;
+
+    int ret = scan_loadRange(&tpl, BASE_FREQ, BASE_FREQ + (NUM_STEPS - 1) * STEP_FREQ,
+                             STEP_FREQ);
+    if(ret != NUM_STEPS)
+        return -1;
+
+    for(uint16_t i = 0; i < NUM_STEPS; i++)
+    {
+        scanEntry_t entry;
+        if(scan_getEntry(&entry, i) != 0)
+            return -1;
+
+        freq_t rx = BASE_FREQ + i * STEP_FREQ;
+        if((entry.rxFrequency != rx) || (entry.txFrequency != (rx - 600000)))
+            return -1;
+
+        if(entry.opMode != OPMODE_FM)
+            return -1;
+    }
+
+    if(scan_getEntry(NULL, NUM_STEPS) != -1)
+        return -1;
+
+    // Restore a simplex template for the following tests
+    tpl = fmChannel("VFO", BASE_FREQ);
+    ret = scan_loadRange(&tpl, BASE_FREQ, BASE_FREQ + (NUM_STEPS - 1) * STEP_FREQ,
+                         STEP_FREQ);
+
+    return (ret == NUM_STEPS) ? 0 : -1;
+}
+
+int test_bankList()
+{
+    cps_create("/tmp/scan_test.rtxc");
+    if(cps_open("/tmp/scan_test.rtxc") != 0)
+        return -1;
+
+    channel_t ch0 = fmChannel("FM 1", 145500000);
+    ch0.fm.rxToneEn = 1;
+    ch0.fm.rxTone   = 3;
+    channel_t ch1 = fmChannel("DMR", 438000000);
+    ch1.mode = OPMODE_DMR;
+    channel_t ch2 = fmChannel("M17", 433475000);
+    ch2.mode = OPMODE_M17;
+
+    cps_insertChannel(ch0, 0);
+    cps_insertChannel(ch1, 1);
+    cps_insertChannel(ch2, 2);
+
+    bankHdr_t bank;
+    memset(&bank, 0x00, sizeof(bankHdr_t));
+    strncpy(bank.name, "Bank", sizeof(bank.name) - 1);
+    cps_insertBankHeader(bank, 0);
+    cps_insertBankData(2, 0, 0);
+    cps_insertBankData(1, 0, 1);
+
+    // DMR channels are not scanned
+    if(scan_loadBank(-1) != 2)
+        return -1;
+
+    scanEntry_t entry;
+    scan_getEntry(&entry, 0);
+    if((entry.index != 0) || (entry.rxToneEn != 1) || (entry.rxTone != ctcss_tone[3]))
+        return -1;
+
+    if(scan_loadBank(0) != 1)
+        return -1;
+
+    scan_getEntry(&entry, 0);
+    if((entry.index != 2) || (entry.opMode != OPMODE_M17))
+        return -1;
+
+    cps_close();
+    return 0;
+}
+
+int test_scan()
+{
+    scanTiming_t timing = { 5, 200, 300 };
+    if(scan_start(&timing) != 0)
+        return -1;
+
+    // Run until the scan stops on the live channel
+    long long start = getTick();
+    rtxStatus_t status;
+    do
+    {
+        rtxStep();
+        status = rtx_getCurrentStatus();
+        if((getTick() - start) > 5000)
+        {
+            printf("Live channel not found\n");
+            return -1;
+        }
+    }
+    while(rtx_rxSquelchOpen() == false);
+
+    if((status.rxFrequency != LIVE_FREQ) || (status.scan == 0))
+        return -1;
+
+    // Stay on the channel as long as the squelch is open
+    for(int i = 0; i < 20; i++)
+    {
+        rtxStep();
+        if(rtx_getCurrentStatus().rxFrequency != LIVE_FREQ)
+        {
+            printf("Scan did not stop on the live channel\n");
+            return -1;
+        }
+    }
+
+    // Resume after the hold time once the signal is gone
+    liveSignal = false;
+    start = getTick();
+    while(rtx_getCurrentStatus().rxFrequency == LIVE_FREQ)
+    {
+        rtxStep();
+        if((getTick() - start) > 2000)
+        {
+            printf("Scan did not resume\n");
+            return -1;
+        }
+    }
+
+    long long holdTime = getTick() - start;
+    if(holdTime < timing.holdTime)
+        return -1;
+
+    // Measure the hop rate with all the channels below squelch
+    scanStats_t before, after;
+    scan_getStats(&before);
+    start = getTick();
+    while((getTick() - start) < 1000)
+        rtxStep();
+
+    scan_getStats(&after);
+    float rate = (after.hops - before.hops) * 1000.0f / (after.elapsed - before.elapsed);
+    printf("Hop rate: %.1f hops/s, %u hops, %u skipped, %u stops\n", rate,
+           after.hops, after.skipped, after.stops);
+
+    // Early exit must make hopping faster than the FM update period
+    if((rate < 34.0f) || (after.stops != 1))
+        return -1;
+
+    scan_stop();
+    rtxStep();
+
+    status = rtx_getCurrentStatus();
+    if(scan_running() || (status.rxFrequency != HOME_FREQ) || (status.scan != 0))
+        return -1;
+
+    return 0;
+}
+
+int main()
+{
+    pthread_mutex_init(&rtx_mutex, NULL);
+    rtx_init(&rtx_mutex);
+
+    memset(&cfg, 0x00, sizeof(rtxStatus_t));
+    cfg.opMode      = OPMODE_FM;
+    cfg.bandwidth   = BW_25;
+    cfg.rxFrequency = HOME_FREQ;
+    cfg.txFrequency = HOME_FREQ;
+    cfg.sqlLevel    = 4;
+    rtx_configure(&cfg);
+
+    for(int i = 0; i < 5; i++)
+        rtxStep();
+
+    if(test_rangeList())
+    {
+        printf("Error in range scan list!\n");
+        return -1;
+    }
+    if(test_bankList())
+    {
+        printf("Error in bank scan list!\n");
+        return -1;
+    }
+    if(test_rangeList())
+    {
+        printf("Error in range scan list!\n");
+        return -1;
+    }
+    if(test_scan())
+    {
+        printf("Error in scan!\n");
+        return -1;
+    }
+
+    rtx_terminate();
+    return 0;
+}
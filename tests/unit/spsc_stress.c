@@ -0,0 +1,305 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <spsc.h>
+
+/*
+ * Stress test for the lock-free SPSC queue. A producer and a consumer thread
+ * exchange sequence-numbered elements, the consumer checks that no element is
+ * lost, duplicated or corrupted and records the time spent by each element in
+ * the queue. The same measurement is done on a mutex/condition variable queue,
+ * equivalent to the one formerly used by the audio codec, as a baseline.
+ */
+
+#define NUM_ELEMENTS 200000
+#define QUEUE_SIZE   4
+
+typedef struct
+{
+    uint64_t seq;       // Sequence number
+    uint64_t check;     // Bitwise inverse of seq, to detect torn reads
+    uint64_t time;      // Push timestamp, in nanoseconds
+}
+element_t;
+
+typedef struct
+{
+    bool (*push)(void *q, const element_t *elem);
+    bool (*pop)(void *q, element_t *elem);
+    void *queue;
+    uint32_t *latency;
+    size_t    received;
+    int       errors;
+}
+testCtx_t;
+
+static inline uint64_t timeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/*
+ * Baseline queue, mutex and condition variable.
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    uint8_t         readPos;
+    uint8_t         writePos;
+    uint8_t         numElements;
+    element_t       data[QUEUE_SIZE];
+}
+lockQueue_t;
+
+static bool lockPush(void *ptr, const element_t *elem)
+{
+    lockQueue_t *q = (lockQueue_t *) ptr;
+
+    pthread_mutex_lock(&q->mutex);
+    while(q->numElements >= QUEUE_SIZE)
+        pthread_cond_wait(&q->cond, &q->mutex);
+
+    q->data[q->writePos] = *elem;
+    q->writePos = (q->writePos + 1) % QUEUE_SIZE;
+    if(q->numElements == 0)
+        pthread_cond_signal(&q->cond);
+    q->numElements += 1;
+    pthread_mutex_unlock(&q->mutex);
+
+    return true;
+}
+
+static bool lockPop(void *ptr, element_t *elem)
+{
+    lockQueue_t *q = (lockQueue_t *) ptr;
+
+    pthread_mutex_lock(&q->mutex);
+    while(q->numElements == 0)
+        pthread_cond_wait(&q->cond, &q->mutex);
+
+    *elem = q->data[q->readPos];
+    q->readPos = (q->readPos + 1) % QUEUE_SIZE;
+    if(q->numElements >= QUEUE_SIZE)
+        pthread_cond_signal(&q->cond);
+    q->numElements -= 1;
+    pthread_mutex_unlock(&q->mutex);
+
+    return true;
+}
+
+static bool spscPush(void *q, const element_t *elem)
+{
+    return spsc_push((spscQueue_t *) q, elem, true);
+}
+
+static bool spscPop(void *q, element_t *elem)
+{
+    return spsc_pop((spscQueue_t *) q, elem, true);
+}
+
+static bool spscPushOverwrite(void *q, const element_t *elem)
+{
+    spsc_pushOverwrite((spscQueue_t *) q, elem);
+    return true;
+}
+
+static bool spscPopPolling(void *q, element_t *elem)
+{
+    while(spsc_pop((spscQueue_t *) q, elem, false) == false)
+        sched_yield();
+
+    return true;
+}
+
+static void *producer(void *arg)
+{
+    testCtx_t *ctx = (testCtx_t *) arg;
+
+    for(uint64_t i = 0; i < NUM_ELEMENTS; i++)
+    {
+        element_t elem = { i, ~i, timeNs() };
+        ctx->push(ctx->queue, &elem);
+    }
+
+    return NULL;
+}
+
+/*
+ * When elements can be overwritten the consumer only checks that sequence
+ * numbers are strictly increasing, otherwise every element must be received.
+ */
+static void consume(testCtx_t *ctx, const bool lossy)
+{
+    uint64_t expected = 0;
+
+    while(expected < NUM_ELEMENTS)
+    {
+        element_t elem;
+        ctx->pop(ctx->queue, &elem);
+        uint64_t now = timeNs();
+
+        if((elem.check != ~elem.seq) || (elem.seq < expected) ||
+           ((lossy == false) && (elem.seq != expected)))
+        {
+            ctx->errors++;
+            return;
+        }
+
+        ctx->latency[ctx->received++] = (uint32_t) (now - elem.time);
+        expected = elem.seq + 1;
+
+        // Last element may have been overwritten only by itself
+        if(lossy && (elem.seq == NUM_ELEMENTS - 1))
+            return;
+    }
+}
+
+static int cmpLatency(const void *a, const void *b)
+{
+    uint32_t x = *((const uint32_t *) a);
+    uint32_t y = *((const uint32_t *) b);
+
+    return (x > y) - (x < y);
+}
+
+static int runTest(const char *name, testCtx_t *ctx, const bool lossy)
+{
+    pthread_t thread;
+
+    ctx->received = 0;
+    ctx->errors   = 0;
+
+    uint64_t start = timeNs();
+    pthread_create(&thread, NULL, producer, ctx);
+    consume(ctx, lossy);
+    pthread_join(thread, NULL);
+    uint64_t stop = timeNs();
+
+    if(ctx->errors != 0)
+    {
+        printf("%-22s: sequence error after %zu elements\n", name, ctx->received);
+        return -1;
+    }
+
+    qsort(ctx->latency, ctx->received, sizeof(uint32_t), cmpLatency);
+
+    double elapsed = (double) (stop - start) / 1000000000.0;
+    size_t n       = ctx->received;
+
+    printf("%-22s: %6.2f Melem/s, %7zu received, latency [us] p50 %7.2f, "
+           "p99 %7.2f, p99.9 %8.2f, max %8.2f\n",
+           name, (double) NUM_ELEMENTS / elapsed / 1000000.0, n,
+           ctx->latency[n / 2] / 1000.0,
+           ctx->latency[(n * 99) / 100] / 1000.0,
+           ctx->latency[(n * 999) / 1000] / 1000.0,
+           ctx->latency[n - 1] / 1000.0);
+
+    return 0;
+}
+
+int main()
+{
+    static element_t storage[QUEUE_SIZE];
+    spscQueue_t spsc;
+    lockQueue_t lock;
+    testCtx_t   ctx;
+    int         ret = 0;
+
+    // Capacity must be a power of two
+    if(spsc_init(&spsc, storage, sizeof(element_t), 3, true))
+    {
+        printf("Error: queue with invalid capacity accepted\n");
+        return -1;
+    }
+
+    // Non-blocking calls on empty and full queue
+    element_t elem = { 0, ~0ULL, 0 };
+    spsc_init(&spsc, storage, sizeof(element_t), QUEUE_SIZE, false);
+    if(spsc_pop(&spsc, &elem, true))
+    {
+        printf("Error: pop from empty queue\n");
+        return -1;
+    }
+
+    for(size_t i = 0; i < QUEUE_SIZE; i++)
+        spsc_push(&spsc, &elem, false);
+
+    if((spsc_size(&spsc) != QUEUE_SIZE) || spsc_push(&spsc, &elem, true))
+    {
+        printf("Error: push to full queue\n");
+        return -1;
+    }
+
+    if(spsc_pushOverwrite(&spsc, &elem) == false)
+    {
+        printf("Error: overwrite on full queue did not discard an element\n");
+        return -1;
+    }
+
+    spsc_terminate(&spsc);
+
+    ctx.latency = (uint32_t *) malloc(NUM_ELEMENTS * sizeof(uint32_t));
+    if(ctx.latency == NULL)
+        return -1;
+
+    pthread_mutex_init(&lock.mutex, NULL);
+    pthread_cond_init(&lock.cond, NULL);
+    lock.readPos     = 0;
+    lock.writePos    = 0;
+    lock.numElements = 0;
+
+    ctx.queue = &lock;
+    ctx.push  = lockPush;
+    ctx.pop   = lockPop;
+    ret |= runTest("mutex, blocking", &ctx, false);
+
+    spsc_init(&spsc, storage, sizeof(element_t), QUEUE_SIZE, true);
+    ctx.queue = &spsc;
+    ctx.push  = spscPush;
+    ctx.pop   = spscPop;
+    ret |= runTest("spsc, blocking", &ctx, false);
+
+    spsc_reset(&spsc);
+    ctx.push = spscPush;
+    ctx.pop  = spscPopPolling;
+    ret |= runTest("spsc, polling", &ctx, false);
+
+    spsc_reset(&spsc);
+    ctx.push = spscPushOverwrite;
+    ctx.pop  = spscPopPolling;
+    ret |= runTest("spsc, overwrite", &ctx, true);
+
+    spsc_terminate(&spsc);
+    pthread_mutex_destroy(&lock.mutex);
+    pthread_cond_destroy(&lock.cond);
+    free(ctx.latency);
+
+    return ret;
+}
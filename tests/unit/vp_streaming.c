@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <voicePrompts.h>
+#include <audio_codec.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <state.h>
+
+#define TOC_SIZE    350
+#define FRAME_TIME  20      // Duration of a CODEC2 3200 frame, in ms
+#define MAX_UI_TICK 400     // Longest interval between two UI ticks, in ms
+
+// Only digits and uppercase letters, mapped one-to-one to voice prompts
+static const char sequence[] = "OPENRTX0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/**
+ * Compute the number of codec2 frames of the test sequence from the voice
+ * prompt table of contents.
+ */
+static long sequenceFrames()
+{
+    uint32_t toc[TOC_SIZE];
+    FILE *fp = fopen("voiceprompts.vpc", "rb");
+    if(fp == NULL)
+        return -1;
+
+    fseek(fp, 8, SEEK_SET);
+    size_t ret = fread(toc, sizeof(toc), 1, fp);
+    fclose(fp);
+    if(ret != 1)
+        return -1;
+
+    long frames = 0;
+    for(size_t i = 0; i < strlen(sequence); i++)
+    {
+        char c = sequence[i];
+        uint16_t prompt;
+
+        if((c >= '0') && (c <= '9'))
+            prompt = PROMPT_0 + (c - '0');
+        else
+            prompt = PROMPT_A + (c - 'A');
+
+        frames += (toc[prompt + 1] - toc[prompt]) / 8;
+    }
+
+    return frames;
+}
+
+int main()
+{
+    long frames = sequenceFrames();
+    if(frames <= 0)
+    {
+        printf("Error: voiceprompts.vpc not found\n");
+        return -1;
+    }
+
+    state.settings.vpLevel         = vpHigh;
+    state.settings.vpPhoneticSpell = 0;
+
+    vp_init();
+    vp_flush();
+    vp_queueString(sequence, 0);
+    vp_play();
+
+    // Simulate a busy UI thread, ticking the voice prompts at irregular and
+    // long intervals.
+    srand(17);
+    long long start = getTick();
+    long long limit = (frames * FRAME_TIME) + 5000;
+    uint32_t  ticks = 0;
+
+    do
+    {
+        vp_tick();
+        ticks++;
+        sleepFor(0, 100 + (rand() % (MAX_UI_TICK - 100)));
+    }
+    while((vp_isPlaying() || (ticks < 2)) && ((getTick() - start) < limit));
+
+    long long elapsed   = getTick() - start;
+    long long expected  = frames * FRAME_TIME;
+    uint32_t  underruns = codec_getUnderruns();
+
+    printf("%ld frames, expected %lldms, played in %lldms, %u UI ticks, "
+           "%u underruns\n", frames, expected, elapsed, ticks, underruns);
+
+    vp_terminate();
+
+    if(vp_isPlaying())
+    {
+        printf("Error: playback not terminated\n");
+        return -1;
+    }
+
+    if(underruns != 0)
+    {
+        printf("Error: playback underruns\n");
+        return -1;
+    }
+
+    // Playback time can only exceed the audio length by the output stream
+    // latency and by the UI ticks needed to detect the start and the end of
+    // the prompt.
+    if((elapsed < expected) || (elapsed > (expected + 2 * MAX_UI_TICK + 400)))
+    {
+        printf("Error: unexpected playback duration\n");
+        return -1;
+    }
+
+    return 0;
+}